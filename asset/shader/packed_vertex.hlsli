@@ -0,0 +1,11 @@
+// packed_vertex_* 用の復元関数
+// 位置/UV は DXGI_FORMAT_R16G16B16A16_FLOAT / R16G16_FLOAT、色は R8G8B8A8_UNORM で入力されるため変換は不要
+// 法線は DXGI_FORMAT_R16G16_SNORM で八面体エンコードされた値が [-1, 1] の float2 として入力される
+
+float3 decode_octahedral(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0f) ? -t : t;
+    return normalize(n);
+}
@@ -1,10 +1,23 @@
 #include "d3d11_scene_triangle.h"
 
+#include <filesystem>
+
 #include "dxlib/debug.h"
 #include "dxlib/static_mesh.h"
 
 namespace app {
 
+namespace {
+
+// asset_cooker の出力 (.cso) があれば読み込み、無ければソース (.hlsl) を起動時にコンパイルします
+const wchar_t* shader_path(const wchar_t* cooked, const wchar_t* source)
+{
+	std::error_code ec;
+	return std::filesystem::exists(cooked, ec) ? cooked : source;
+}
+
+} // namespace
+
 d3d11_scene_triangle::d3d11_scene_triangle(ID3D11Device* d3d11_device, ID3D11DeviceContext* d3d11_device_context)
     : m_d3d11_device(d3d11_device)
     , m_d3d11_device_context(d3d11_device_context)
@@ -49,7 +62,7 @@ bool d3d11_scene_triangle::initialize()
 
 	hr = dxlib::d3d11::create_vertex_shader_from_hlsl(
 	    m_d3d11_device,
-	    L"../../asset/shader/static_mesh_pc_vs.hlsl",
+	    shader_path(L"../../cooked/shader/static_mesh_pc_vs.cso", L"../../asset/shader/static_mesh_pc_vs.hlsl"),
 	    "main",
 	    "vs_5_0",
 	    m_d3d11_vertex_shader.GetAddressOf(),
@@ -58,7 +71,7 @@ bool d3d11_scene_triangle::initialize()
 
 	hr = dxlib::d3d11::create_pixel_shader_from_hlsl(
 	    m_d3d11_device,
-	    L"../../asset/shader/static_mesh_pc_ps.hlsl",
+	    shader_path(L"../../cooked/shader/static_mesh_pc_ps.cso", L"../../asset/shader/static_mesh_pc_ps.hlsl"),
 	    "main",
 	    "ps_5_0",
 	    m_d3d11_pixel_shader.GetAddressOf());
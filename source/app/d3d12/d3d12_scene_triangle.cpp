@@ -1,10 +1,23 @@
 #include "d3d12_scene_triangle.h"
 
+#include <filesystem>
+
 #include "dxlib/debug.h"
 #include "dxlib/static_mesh.h"
 
 namespace app {
 
+namespace {
+
+// asset_cooker の出力 (.cso) があれば読み込み、無ければソース (.hlsl) を起動時にコンパイルします
+const wchar_t* shader_path(const wchar_t* cooked, const wchar_t* source)
+{
+	std::error_code ec;
+	return std::filesystem::exists(cooked, ec) ? cooked : source;
+}
+
+} // namespace
+
 d3d12_scene_triangle::d3d12_scene_triangle(ID3D12Device* d3d12_device, ID3D12GraphicsCommandList* d3d12_graphics_command_list)
     : m_d3d12_device(d3d12_device)
     , m_d3d12_graphics_command_list(d3d12_graphics_command_list)
@@ -65,7 +78,7 @@ bool d3d12_scene_triangle::initialize()
 
 	MSWRL::ComPtr<ID3DBlob> vertex_shader;
 	hr = dxlib::d3d12::create_vertex_shader_from_hlsl(
-	    L"../../asset/shader/static_mesh_pc_vs.hlsl",
+	    shader_path(L"../../cooked/shader/static_mesh_pc_vs.cso", L"../../asset/shader/static_mesh_pc_vs.hlsl"),
 	    "main",
 	    "vs_5_0",
 	    vertex_shader.GetAddressOf());
@@ -73,7 +86,7 @@ bool d3d12_scene_triangle::initialize()
 
 	MSWRL::ComPtr<ID3DBlob> pixel_shader;
 	hr = dxlib::d3d12::create_pixel_shader_from_hlsl(
-	    L"../../asset/shader/static_mesh_pc_ps.hlsl",
+	    shader_path(L"../../cooked/shader/static_mesh_pc_ps.cso", L"../../asset/shader/static_mesh_pc_ps.hlsl"),
 	    "main",
 	    "ps_5_0",
 	    pixel_shader.GetAddressOf());
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace dxlib {
+
+//! \brief Align バイト境界に揃えて確保するアロケーター
+//!
+//! SIMD のアライン済みロード/ストアや GPU アップロード用の配列に使用します。
+template<class T, size_t Align = alignof(std::max_align_t)>
+struct aligned_allocator
+{
+	static_assert((Align & (Align - 1)) == 0, "Align must be a power of two.");
+
+	using value_type = T;
+
+	template<class U>
+	struct rebind
+	{
+		using other = aligned_allocator<U, Align>;
+	};
+
+	static constexpr size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+
+	aligned_allocator() noexcept = default;
+
+	template<class U>
+	constexpr aligned_allocator(const aligned_allocator<U, Align>&) noexcept
+	{
+	}
+
+	[[nodiscard]] T* allocate(size_t n)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+	}
+
+	void deallocate(T* p, size_t) noexcept
+	{
+		::operator delete(p, std::align_val_t(alignment));
+	}
+
+	template<class U>
+	[[nodiscard]] constexpr bool operator==(const aligned_allocator<U, Align>&) const noexcept
+	{
+		return true;
+	}
+};
+
+//! \brief Align バイト境界に揃えた std::vector
+template<class T, size_t Align>
+using aligned_vector = std::vector<T, aligned_allocator<T, Align>>;
+
+} // namespace dxlib
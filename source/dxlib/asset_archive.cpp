@@ -0,0 +1,578 @@
+#include "asset_archive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
+#include <system_error>
+#include <utility>
+
+#include "debug.h"
+#include "lz4.h"
+#include "thread_pool.h"
+
+namespace {
+
+using namespace dxlib;
+
+constexpr uint32_t archive_magic = 'D' | ('X' << 8) | ('P' << 16) | ('K' << 24);
+
+constexpr uint32_t empty_slot = UINT32_MAX;
+
+// 並列に展開、圧縮するブロック数の単位
+constexpr size_t block_grain = 4;
+
+bool in_range(uint64_t offset, uint64_t size, uint64_t total) noexcept
+{
+	return offset <= total && size <= total - offset;
+}
+
+template<class T>
+bool array_in_range(uint64_t offset, uint64_t count, uint64_t total) noexcept
+{
+	return offset % alignof(T) == 0 && count <= total / sizeof(T) && in_range(offset, count * sizeof(T), total);
+}
+
+uint64_t align_up(uint64_t value, uint64_t alignment) noexcept
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+std::string to_utf8(const std::u8string& s)
+{
+	return std::string(reinterpret_cast<const char*>(s.data()), s.size());
+}
+
+// マウントしたアーカイブ
+struct mount
+{
+	std::string                          prefix; //!< 正規化した絶対パス + '/'
+	std::shared_ptr<const asset_archive> archive;
+};
+
+struct mount_table
+{
+	std::shared_mutex  mutex;
+	std::vector<mount> mounts;
+};
+
+mount_table& mounts()
+{
+	static mount_table table;
+	return table;
+}
+
+std::string absolute_key(const wchar_t* filename)
+{
+	std::error_code       ec;
+	std::filesystem::path path = std::filesystem::absolute(filename, ec);
+	return archive_path(ec ? std::filesystem::path(filename) : path);
+}
+
+} // namespace
+
+namespace dxlib {
+
+std::string archive_path(const std::filesystem::path& path)
+{
+	std::string name = to_utf8(path.generic_u8string());
+	std::replace(name.begin(), name.end(), '\\', '/');
+	name = to_utf8(std::filesystem::path(std::u8string(name.begin(), name.end())).lexically_normal().generic_u8string());
+	if (name == ".") {
+		name.clear();
+	}
+	for (char& c : name) {
+		if (c >= 'A' && c <= 'Z') {
+			c = static_cast<char>(c - 'A' + 'a');
+		}
+	}
+	return name;
+}
+
+uint64_t archive_hash(std::string_view name) noexcept
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : name) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// --- asset_archive ---
+
+bool asset_archive::open(const wchar_t* filename)
+{
+	close();
+
+	mapped_file file;
+	if (!file.open(filename)) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
+		return false;
+	}
+
+	const uint8_t* const base = file.data();
+	const uint64_t       size = file.size();
+	archive_header       header;
+	if (size < sizeof(header)) {
+		_LOG_ERROR_MSG(L"%s is not an archive.\n", filename);
+		return false;
+	}
+	std::memcpy(&header, base, sizeof(header));
+	if (header.magic != archive_magic || header.version != archive_version || header.file_size != size) {
+		_LOG_ERROR_MSG(L"%s is not an archive.\n", filename);
+		return false;
+	}
+
+	auto invalid = [&]()
+	{
+		_LOG_ERROR_MSG(L"%s is corrupted.\n", filename);
+		return false;
+	};
+
+	if (!array_in_range<archive_entry>(header.entries_offset, header.entry_count, size)
+	    || !array_in_range<archive_block>(header.blocks_offset, header.block_count, size)
+	    || !array_in_range<uint32_t>(header.slots_offset, header.slot_count, size)
+	    || !in_range(header.names_offset, header.names_size, size)
+	    || header.names_size > UINT32_MAX
+	    || !std::has_single_bit(header.slot_count)
+	    || header.slot_count <= header.entry_count
+	    || !std::has_single_bit(header.alignment)) {
+		return invalid();
+	}
+
+	const std::span entries(reinterpret_cast<const archive_entry*>(base + header.entries_offset), header.entry_count);
+	const std::span blocks(reinterpret_cast<const archive_block*>(base + header.blocks_offset), header.block_count);
+	const std::span slots(reinterpret_cast<const uint32_t*>(base + header.slots_offset), header.slot_count);
+	const std::string_view names(reinterpret_cast<const char*>(base + header.names_offset), static_cast<size_t>(header.names_size));
+
+	// 各エントリがちょうど 1 つのスロットにあること (slot_count > entry_count なので空きスロットも必ず残ります)
+	std::vector<bool> referenced(header.entry_count, false);
+	for (uint32_t slot : slots) {
+		if (slot == empty_slot) {
+			continue;
+		}
+		if (slot >= header.entry_count || referenced[slot]) {
+			return invalid();
+		}
+		referenced[slot] = true;
+	}
+	if (std::find(referenced.begin(), referenced.end(), false) != referenced.end()) {
+		return invalid();
+	}
+	for (const auto& entry : entries) {
+		if (!in_range(entry.name_offset, entry.name_size, names.size())
+		    || entry.hash != archive_hash(names.substr(entry.name_offset, entry.name_size))) {
+			return invalid();
+		}
+		if (entry.block_count == 0) {
+			if (!in_range(entry.offset, entry.size, size)) {
+				return invalid();
+			}
+			continue;
+		}
+		if (!in_range(entry.first_block, entry.block_count, blocks.size())
+		    || entry.block_count != (entry.size + archive_block_size - 1) / archive_block_size) {
+			return invalid();
+		}
+		// read は i 番目のブロックを i * archive_block_size の位置に展開するので、最後以外は全て archive_block_size です
+		uint64_t raw_size = 0;
+		for (uint32_t i = 0; i < entry.block_count; ++i) {
+			const archive_block& block = blocks[entry.first_block + i];
+			if (block.raw_size > archive_block_size
+			    || (i + 1 < entry.block_count && block.raw_size != archive_block_size)
+			    || block.compressed_size > block.raw_size
+			    || !in_range(block.offset, block.compressed_size, size)) {
+				return invalid();
+			}
+			raw_size += block.raw_size;
+		}
+		if (raw_size != entry.size) {
+			return invalid();
+		}
+	}
+
+	m_file    = std::move(file);
+	m_entries = entries;
+	m_blocks  = blocks;
+	m_slots   = slots;
+	m_names   = names;
+
+	return true;
+}
+
+void asset_archive::close() noexcept
+{
+	m_file.close();
+	m_entries = {};
+	m_blocks  = {};
+	m_slots   = {};
+	m_names   = {};
+}
+
+const archive_entry* asset_archive::find(std::string_view name) const noexcept
+{
+	if (m_slots.empty()) {
+		return nullptr;
+	}
+
+	const uint64_t hash = archive_hash(name);
+	const size_t   mask = m_slots.size() - 1;
+	size_t         slot = static_cast<size_t>(hash) & mask;
+	for (size_t probe = 0; probe < m_slots.size(); ++probe, slot = (slot + 1) & mask) {
+		const uint32_t index = m_slots[slot];
+		if (index == empty_slot) {
+			return nullptr;
+		}
+		const archive_entry& entry = m_entries[index];
+		if (entry.hash == hash && this->name(entry) == name) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+std::string_view asset_archive::name(const archive_entry& entry) const noexcept
+{
+	return m_names.substr(entry.name_offset, entry.name_size);
+}
+
+std::span<const uint8_t> asset_archive::view(const archive_entry& entry) const noexcept
+{
+	if (entry.block_count != 0) {
+		return {};
+	}
+	return m_file.span().subspan(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.size));
+}
+
+bool asset_archive::read(const archive_entry& entry, std::span<uint8_t> buffer, thread_pool* pool) const noexcept
+{
+	ASSERT_RETURN(buffer.size() >= entry.size, false);
+
+	if (entry.block_count == 0) {
+		const auto data = view(entry);
+		if (!data.empty()) {
+			std::memcpy(buffer.data(), data.data(), data.size());
+		}
+		return true;
+	}
+
+	const auto       blocks = m_blocks.subspan(entry.first_block, entry.block_count);
+	std::atomic_bool failed = false;
+	auto             decode = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			const archive_block& block = blocks[i];
+			const auto           src   = m_file.span().subspan(static_cast<size_t>(block.offset), block.compressed_size);
+			const auto           dst   = buffer.subspan(i * archive_block_size, block.raw_size);
+			if (block.compressed_size == block.raw_size) {
+				std::memcpy(dst.data(), src.data(), src.size());
+			}
+			else if (lz4_decompress(src, dst) != block.raw_size) {
+				failed = true;
+			}
+		}
+	};
+	if (pool && blocks.size() > block_grain) {
+		pool->parallel_for(blocks.size(), block_grain, decode);
+	}
+	else {
+		decode(0, blocks.size());
+	}
+	return !failed;
+}
+
+// --- archive_builder ---
+
+void archive_builder::add(const std::filesystem::path& name, std::vector<uint8_t> data)
+{
+	m_sources.push_back({ archive_path(name), std::move(data) });
+}
+
+bool archive_builder::add_file(const std::filesystem::path& name, const wchar_t* filename)
+{
+	file_reader reader;
+	if (!reader.open(filename)) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
+		return false;
+	}
+	if (reader.size() > SIZE_MAX) {
+		_LOG_ERROR_MSG(L"%s is too large.\n", filename);
+		return false;
+	}
+
+	std::vector<uint8_t> data(static_cast<size_t>(reader.size()));
+	if (reader.read_at(0, data) != data.size()) {
+		_LOG_ERROR_MSG(L"%s read failed.\n", filename);
+		return false;
+	}
+	add(name, std::move(data));
+
+	return true;
+}
+
+bool archive_builder::add_directory(const wchar_t* directory)
+{
+	const std::filesystem::path root(directory);
+	std::error_code             ec;
+	for (std::filesystem::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+		if (!it->is_regular_file(ec)) {
+			continue;
+		}
+		if (!add_file(it->path().lexically_relative(root), it->path().wstring().c_str())) {
+			return false;
+		}
+	}
+	if (ec) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", directory);
+		return false;
+	}
+	return true;
+}
+
+bool archive_builder::write(const wchar_t* filename, const archive_options& options, thread_pool* pool) const
+{
+	ASSERT_RETURN(std::has_single_bit(options.alignment), false);
+	ASSERT_RETURN(m_sources.size() < empty_slot, false);
+
+	// 名前の順に並べます
+	std::vector<uint32_t> order(m_sources.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+	    {
+		    return m_sources[a].name < m_sources[b].name;
+	    });
+	for (size_t i = 1; i < order.size(); ++i) {
+		if (m_sources[order[i - 1]].name == m_sources[order[i]].name) {
+			_LOG_ERROR_MSG(L"%s: duplicate entry name.\n", filename);
+			return false;
+		}
+	}
+
+	// 全てのブロックを圧縮します
+	struct job
+	{
+		uint32_t source;
+		uint32_t block;
+	};
+	std::vector<job>      jobs;
+	std::vector<uint32_t> first_job(order.size() + 1, 0);
+	if (options.compress) {
+		for (size_t i = 0; i < order.size(); ++i) {
+			const size_t size = m_sources[order[i]].data.size();
+			for (size_t offset = 0; offset < size; offset += archive_block_size) {
+				jobs.push_back({ order[i], static_cast<uint32_t>(offset / archive_block_size) });
+			}
+			first_job[i + 1] = static_cast<uint32_t>(jobs.size());
+		}
+	}
+	std::vector<std::vector<uint8_t>> compressed(jobs.size());
+	auto                              compress = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			const auto& data = m_sources[jobs[i].source].data;
+			const auto  src  = std::span<const uint8_t>(data).subspan(size_t(jobs[i].block) * archive_block_size);
+			const auto  raw  = src.first(std::min<size_t>(src.size(), archive_block_size));
+			auto&       dst  = compressed[i];
+			dst.resize(lz4_compress_bound(raw.size()));
+			const size_t n = lz4_compress(raw, dst);
+			if (n == 0 || n >= raw.size()) {
+				// 縮まないブロックはそのまま格納します
+				dst.assign(raw.begin(), raw.end());
+			}
+			else {
+				dst.resize(n);
+			}
+		}
+	};
+	if (pool && jobs.size() > block_grain) {
+		pool->parallel_for(jobs.size(), block_grain, compress);
+	}
+	else {
+		compress(0, jobs.size());
+	}
+
+	// 目次を作ります
+	std::vector<archive_entry> entries(order.size());
+	std::vector<archive_block> blocks;
+	std::string                names;
+	for (size_t i = 0; i < order.size(); ++i) {
+		const source& src   = m_sources[order[i]];
+		archive_entry& entry = entries[i];
+		entry.hash           = archive_hash(src.name);
+		entry.size           = src.data.size();
+		entry.name_offset    = static_cast<uint32_t>(names.size());
+		entry.name_size      = static_cast<uint32_t>(src.name.size());
+		names += src.name;
+
+		uint64_t compressed_size = 0;
+		for (uint32_t j = first_job[i]; j < first_job[i + 1]; ++j) {
+			compressed_size += compressed[j].size();
+		}
+		const uint64_t saving = entry.size * options.min_saving_pct / 100;
+		if (first_job[i] == first_job[i + 1] || compressed_size + std::max<uint64_t>(saving, 1) > entry.size) {
+			continue;
+		}
+		entry.first_block = static_cast<uint32_t>(blocks.size());
+		entry.block_count = first_job[i + 1] - first_job[i];
+		for (uint32_t j = first_job[i]; j < first_job[i + 1]; ++j) {
+			const size_t raw_size = std::min<size_t>(src.data.size() - size_t(jobs[j].block) * archive_block_size, archive_block_size);
+			blocks.push_back({ 0, static_cast<uint32_t>(compressed[j].size()), static_cast<uint32_t>(raw_size) });
+		}
+	}
+	ASSERT_RETURN(names.size() <= UINT32_MAX, false);
+
+	const uint32_t        slot_count = std::bit_ceil(std::max<uint32_t>(static_cast<uint32_t>(entries.size()) * 2, 1));
+	std::vector<uint32_t> slots(slot_count, empty_slot);
+	for (uint32_t i = 0; i < entries.size(); ++i) {
+		size_t slot = static_cast<size_t>(entries[i].hash) & (slot_count - 1);
+		while (slots[slot] != empty_slot) {
+			slot = (slot + 1) & (slot_count - 1);
+		}
+		slots[slot] = i;
+	}
+
+	// データの配置を決めます
+	archive_header header = {};
+	header.magic          = archive_magic;
+	header.version        = archive_version;
+	header.entry_count    = static_cast<uint32_t>(entries.size());
+	header.block_count    = static_cast<uint32_t>(blocks.size());
+	header.slot_count     = slot_count;
+	header.alignment      = options.alignment;
+	header.entries_offset = sizeof(archive_header);
+	header.blocks_offset  = header.entries_offset + entries.size() * sizeof(archive_entry);
+	header.slots_offset   = header.blocks_offset + blocks.size() * sizeof(archive_block);
+	header.names_offset   = header.slots_offset + slots.size() * sizeof(uint32_t);
+	header.names_size     = names.size();
+
+	uint64_t offset = header.names_offset + header.names_size;
+	for (auto& entry : entries) {
+		if (entry.block_count == 0) {
+			offset       = align_up(offset, options.alignment);
+			entry.offset = offset;
+			offset += entry.size;
+			continue;
+		}
+		entry.offset = offset;
+		for (auto& block : std::span(blocks).subspan(entry.first_block, entry.block_count)) {
+			block.offset = offset;
+			offset += block.compressed_size;
+		}
+	}
+	header.file_size = offset;
+
+	// 書き出します
+	std::ofstream stream(std::filesystem::path(filename), std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
+		return false;
+	}
+	uint64_t position = 0;
+	auto     put      = [&](const void* data, size_t size)
+	{
+		stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		position += size;
+	};
+	auto pad = [&](uint64_t target)
+	{
+		static constexpr char zeros[256] = {};
+		while (position < target) {
+			put(zeros, static_cast<size_t>(std::min<uint64_t>(target - position, sizeof(zeros))));
+		}
+	};
+	put(&header, sizeof(header));
+	put(entries.data(), entries.size() * sizeof(archive_entry));
+	put(blocks.data(), blocks.size() * sizeof(archive_block));
+	put(slots.data(), slots.size() * sizeof(uint32_t));
+	put(names.data(), names.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const archive_entry& entry = entries[i];
+		pad(entry.offset);
+		if (entry.block_count == 0) {
+			put(m_sources[order[i]].data.data(), static_cast<size_t>(entry.size));
+			continue;
+		}
+		for (uint32_t j = first_job[i]; j < first_job[i + 1]; ++j) {
+			put(compressed[j].data(), compressed[j].size());
+		}
+	}
+	stream.close();
+	if (!stream) {
+		_LOG_ERROR_MSG(L"%s write failed.\n", filename);
+		return false;
+	}
+
+	return true;
+}
+
+// --- mount ---
+
+bool mount_archive(const wchar_t* filename, const wchar_t* mount_point)
+{
+	auto archive = std::make_shared<asset_archive>();
+	if (!archive->open(filename)) {
+		return false;
+	}
+
+	std::string prefix = absolute_key(mount_point);
+	if (!prefix.empty() && prefix.back() != '/') {
+		prefix += '/';
+	}
+
+	auto&               table = mounts();
+	std::unique_lock    lock(table.mutex);
+	table.mounts.push_back({ std::move(prefix), std::move(archive) });
+
+	return true;
+}
+
+void unmount_archives() noexcept
+{
+	auto&            table = mounts();
+	std::unique_lock lock(table.mutex);
+	table.mounts.clear();
+}
+
+archive_load_result load_archived_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint64_t& file_size)
+{
+	auto&            table = mounts();
+	std::shared_lock lock(table.mutex);
+	if (table.mounts.empty()) {
+		return archive_load_result::not_found;
+	}
+
+	const std::string key = absolute_key(filename);
+	for (auto it = table.mounts.rbegin(); it != table.mounts.rend(); ++it) {
+		if (!key.starts_with(it->prefix)) {
+			continue;
+		}
+		const archive_entry* entry = it->archive->find(std::string_view(key).substr(it->prefix.size()));
+		if (!entry) {
+			continue;
+		}
+		if (entry->size > SIZE_MAX) {
+			_LOG_ERROR_MSG(L"%s is too large.\n", filename);
+			return archive_load_result::failed;
+		}
+
+		const auto size = static_cast<size_t>(entry->size);
+		auto       data = std::make_unique_for_overwrite<uint8_t[]>(size);
+		if (!it->archive->read(*entry, std::span<uint8_t>(data.get(), size), &thread_pool::shared())) {
+			_LOG_ERROR_MSG(L"%s read failed.\n", filename);
+			return archive_load_result::failed;
+		}
+
+		file_data = std::move(data);
+		file_size = size;
+
+		return archive_load_result::loaded;
+	}
+	return archive_load_result::not_found;
+}
+
+} // namespace dxlib
@@ -0,0 +1,230 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "file.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+// アセットのアーカイブ
+//
+// 複数のファイルを 1 つのファイルにまとめます。ファイルの構成は次のとおりです。
+//   archive_header
+//   archive_entry[entry_count]  名前の順
+//   archive_block[block_count]  圧縮したエントリのブロック
+//   uint32_t[slot_count]        名前のハッシュによるオープンアドレス法の表 (エントリ番号、空きは UINT32_MAX)
+//   char[names_size]            エントリ名 (UTF-8、終端なし)
+//   データ
+// 目次 (データより前) は先頭のページにまとまるので、mmap したときにエントリを探しても目次以外のページには触れません。
+//
+// エントリのデータは archive_block_size ごとに LZ4 で圧縮し、縮まないエントリはそのまま格納します。
+// そのまま格納したエントリは alignment の倍数のオフセットに置くので、view() でマップした領域を
+// コピーせずにアップロードバッファへ直接渡せます (既定の 512 は D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT)。
+// 圧縮したエントリはブロックごとに独立して展開できます。
+//
+// エントリ名は archive_path で正規化します (区切りは '/'、ASCII の大文字は小文字)。
+// mount_archive でマウントしたアーカイブは load_file から透過的に参照されます。
+
+//! \brief 圧縮の単位
+constexpr uint32_t archive_block_size = 64 * 1024;
+
+//! \brief 既定のデータの配置
+constexpr uint32_t archive_default_alignment = 512;
+
+//! \brief アーカイブのヘッダー
+struct archive_header
+{
+	uint32_t magic;          //!< 'D', 'X', 'P', 'K'
+	uint32_t version;        //!< archive_version
+	uint32_t entry_count;    //!< エントリ数
+	uint32_t block_count;    //!< ブロック数
+	uint32_t slot_count;     //!< ハッシュ表の大きさ (2 のべき乗)
+	uint32_t alignment;      //!< そのまま格納したエントリのデータの配置
+	uint64_t entries_offset; //!< archive_entry の配列のオフセット
+	uint64_t blocks_offset;  //!< archive_block の配列のオフセット
+	uint64_t slots_offset;   //!< ハッシュ表のオフセット
+	uint64_t names_offset;   //!< エントリ名のオフセット
+	uint64_t names_size;     //!< エントリ名のバイトサイズ
+	uint64_t file_size;      //!< アーカイブのバイトサイズ
+};
+
+//! \brief アーカイブのエントリ
+struct archive_entry
+{
+	uint64_t hash;        //!< 名前のハッシュ (archive_hash)
+	uint64_t size;        //!< 展開後のバイトサイズ
+	uint64_t offset;      //!< そのまま格納した場合はデータのオフセット、圧縮した場合は最初のブロックのオフセット
+	uint32_t name_offset; //!< エントリ名の names_offset からのオフセット
+	uint32_t name_size;   //!< エントリ名のバイトサイズ
+	uint32_t first_block; //!< 最初のブロック番号
+	uint32_t block_count; //!< ブロック数 (0 の場合はそのまま格納しています)
+};
+
+//! \brief 圧縮したブロック
+struct archive_block
+{
+	uint64_t offset;          //!< データのオフセット
+	uint32_t compressed_size; //!< 圧縮後のバイトサイズ (raw_size と同じ場合は圧縮していません)
+	uint32_t raw_size;        //!< 展開後のバイトサイズ (最後のブロック以外は archive_block_size)
+};
+
+//! \brief アーカイブの形式のバージョン
+constexpr uint32_t archive_version = 1;
+
+//! \brief エントリ名を正規化します
+//!
+//! '\\' を '/' に置き換え、"." と ".." を取り除き、ASCII の大文字を小文字にします。
+[[nodiscard]] std::string archive_path(const std::filesystem::path& path);
+
+//! \brief 正規化したエントリ名のハッシュ (FNV-1a 64 ビット)
+[[nodiscard]] uint64_t archive_hash(std::string_view name) noexcept;
+
+//! \brief 読み取り専用でマップしたアーカイブ
+//!
+//! open で目次を全て検証するので、その後の find、view、read はデータの範囲を検査しません。
+//! 全てのメンバ関数は const で、複数のスレッドから同時に呼び出せます。
+class asset_archive
+{
+public:
+	//! \brief アーカイブを開きます
+	//!
+	//! \return 開けない場合、形式が正しくない場合は false
+	bool open(const wchar_t* filename);
+
+	//! \brief アーカイブを閉じます
+	void close() noexcept;
+
+	[[nodiscard]] bool is_open() const noexcept
+	{
+		return m_file.is_open();
+	}
+
+	//! \brief 全てのエントリ (名前の順)
+	[[nodiscard]] std::span<const archive_entry> entries() const noexcept
+	{
+		return m_entries;
+	}
+
+	//! \brief エントリを探します
+	//!
+	//! \param[in] name 正規化したエントリ名 (archive_path)
+	//! \return 見つからない場合は nullptr
+	[[nodiscard]] const archive_entry* find(std::string_view name) const noexcept;
+
+	//! \brief エントリ名
+	[[nodiscard]] std::string_view name(const archive_entry& entry) const noexcept;
+
+	//! \brief そのまま格納したエントリのデータ (マップした領域を指します)
+	//!
+	//! \return 圧縮したエントリの場合は空
+	[[nodiscard]] std::span<const uint8_t> view(const archive_entry& entry) const noexcept;
+
+	//! \brief エントリを展開します
+	//!
+	//! \param[in]  entry
+	//! \param[out] buffer entry.size バイト以上
+	//! \param[in]  pool   ブロックの並列展開に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+	//! \return データが壊れている場合は false
+	bool read(const archive_entry& entry, std::span<uint8_t> buffer, thread_pool* pool = nullptr) const noexcept;
+
+private:
+	mapped_file                    m_file;
+	std::span<const archive_entry> m_entries;
+	std::span<const archive_block> m_blocks;
+	std::span<const uint32_t>      m_slots;
+	std::string_view               m_names;
+};
+
+//! \brief アーカイブの作成の設定
+struct archive_options
+{
+	uint32_t alignment      = archive_default_alignment; //!< そのまま格納するエントリのデータの配置 (2 のべき乗)
+	bool     compress       = true;                      //!< false の場合は全てのエントリをそのまま格納します
+	uint32_t min_saving_pct = 12;                        //!< 圧縮で減るサイズがこの割合 (%) 未満のエントリはそのまま格納します
+};
+
+//! \brief アーカイブを作ります
+//!
+//! 同じ入力からは (追加の順番や pool によらず) 同じバイト列のアーカイブを作ります。
+class archive_builder
+{
+public:
+	//! \brief エントリを追加します
+	//!
+	//! \param[in] name エントリ名 (archive_path で正規化します)
+	//! \param[in] data
+	void add(const std::filesystem::path& name, std::vector<uint8_t> data);
+
+	//! \brief ファイルを読み込んでエントリを追加します
+	//!
+	//! \return 読み込みに失敗した場合は false
+	bool add_file(const std::filesystem::path& name, const wchar_t* filename);
+
+	//! \brief ディレクトリ以下の全てのファイルを、ディレクトリからの相対パスを名前として追加します
+	//!
+	//! \return ディレクトリを開けない場合、ファイルの読み込みに失敗した場合は false
+	bool add_directory(const wchar_t* directory);
+
+	//! \brief 追加したエントリ数
+	[[nodiscard]] size_t entry_count() const noexcept
+	{
+		return m_sources.size();
+	}
+
+	//! \brief アーカイブを書き出します
+	//!
+	//! \param[in] filename
+	//! \param[in] options
+	//! \param[in] pool     ブロックの並列圧縮に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+	//! \return 名前が重複している場合、書き込みに失敗した場合は false
+	bool write(const wchar_t* filename, const archive_options& options = {}, thread_pool* pool = nullptr) const;
+
+private:
+	struct source
+	{
+		std::string          name;
+		std::vector<uint8_t> data;
+	};
+
+	std::vector<source> m_sources;
+};
+
+//! \brief マウントしたアーカイブからの読み込みの結果
+enum class archive_load_result : uint8_t
+{
+	not_found, //!< マウントしたアーカイブに含まれません
+	loaded,    //!< 読み込みました
+	failed,    //!< アーカイブに含まれますが展開に失敗しました
+};
+
+//! \brief アーカイブをマウントします
+//!
+//! mount_point 以下のパスを load_file で読むと、ディスクより先にアーカイブを探します。
+//! 後からマウントしたアーカイブが優先されます (パッチのアーカイブで上書きできます)。
+//! パスは作業ディレクトリからの絶対パスにして比較するので、相対パスと絶対パスのどちらでも解決されます。
+//!
+//! \param[in] filename    アーカイブのファイル名
+//! \param[in] mount_point アーカイブのエントリ名の基準になるディレクトリ (asset_packer に渡したディレクトリ)
+//! \return アーカイブを開けない場合は false
+bool mount_archive(const wchar_t* filename, const wchar_t* mount_point);
+
+//! \brief 全てのアーカイブのマウントを解除します
+void unmount_archives() noexcept;
+
+//! \brief マウントしたアーカイブからファイルを読み込みます
+//!
+//! \param[in]  filename
+//! \param[out] file_data
+//! \param[out] file_size
+archive_load_result load_archived_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint64_t& file_size);
+
+} // namespace dxlib
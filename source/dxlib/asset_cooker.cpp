@@ -0,0 +1,604 @@
+#include "asset_cooker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "debug.h"
+#include "file.h"
+#include "thread_pool.h"
+
+namespace {
+
+using namespace dxlib;
+
+constexpr const char* manifest_header = "dxlib_cook_manifest 1";
+
+// --- XXH64 ---
+
+constexpr uint64_t prime64_1 = 11400714785074694791ull;
+constexpr uint64_t prime64_2 = 14029467366897019727ull;
+constexpr uint64_t prime64_3 = 1609587929392839161ull;
+constexpr uint64_t prime64_4 = 9650029242287828579ull;
+constexpr uint64_t prime64_5 = 2870177450012600261ull;
+
+inline uint64_t read64(const uint8_t* p) noexcept
+{
+	uint64_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint32_t read32(const uint8_t* p) noexcept
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input) noexcept
+{
+	acc += input * prime64_2;
+	acc = std::rotl(acc, 31);
+	return acc * prime64_1;
+}
+
+inline uint64_t xxh_merge(uint64_t acc, uint64_t value) noexcept
+{
+	acc ^= xxh_round(0, value);
+	return acc * prime64_1 + prime64_4;
+}
+
+// --- ファイル ---
+
+std::string to_utf8(const std::filesystem::path& path)
+{
+	const std::u8string s = path.generic_u8string();
+	return std::string(reinterpret_cast<const char*>(s.data()), s.size());
+}
+
+std::filesystem::path from_utf8(const std::string& s)
+{
+	return std::filesystem::path(std::u8string(s.begin(), s.end()));
+}
+
+bool read_file(const std::filesystem::path& path, std::vector<uint8_t>& data)
+{
+	file_reader reader;
+	if (!reader.open(path.wstring().c_str()) || reader.size() > SIZE_MAX) {
+		return false;
+	}
+	data.resize(static_cast<size_t>(reader.size()));
+	return reader.read_at(0, data) == data.size();
+}
+
+bool write_file(const std::filesystem::path& path, std::span<const uint8_t> data)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	stream.close();
+	return static_cast<bool>(stream);
+}
+
+int64_t write_time(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	const auto      time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+std::string to_lower(std::string s)
+{
+	for (char& c : s) {
+		if (c >= 'A' && c <= 'Z') {
+			c = static_cast<char>(c - 'A' + 'a');
+		}
+	}
+	return s;
+}
+
+std::vector<std::string> split(const std::string& line, char delimiter)
+{
+	std::vector<std::string> fields;
+	size_t                   begin = 0;
+	while (true) {
+		const size_t end = line.find(delimiter, begin);
+		fields.push_back(line.substr(begin, end - begin));
+		if (end == std::string::npos) {
+			return fields;
+		}
+		begin = end + 1;
+	}
+}
+
+// --- 前回の結果 ---
+
+struct file_record
+{
+	int64_t                  size  = -1;
+	int64_t                  mtime = 0;
+	uint64_t                 hash  = 0;
+	bool                     scanned = false;
+	std::vector<std::string> dependencies;
+};
+
+struct manifest
+{
+	std::unordered_map<std::string, file_record> files;   //!< ソースのファイル
+	std::unordered_map<std::string, uint64_t>    outputs; //!< 出力と鍵
+};
+
+manifest load_manifest(const std::filesystem::path& path)
+{
+	manifest      result;
+	std::ifstream stream(path);
+	std::string   line;
+	if (!std::getline(stream, line) || line != manifest_header) {
+		return result;
+	}
+	// F <file> <size> <mtime> <hash>
+	// D <file> <dependency>...
+	// O <output> <key>
+	while (std::getline(stream, line)) {
+		const auto fields = split(line, '\t');
+		if (fields.size() == 5 && fields[0] == "F") {
+			auto& record = result.files[fields[1]];
+			record.size  = std::stoll(fields[2]);
+			record.mtime = std::stoll(fields[3]);
+			record.hash  = std::stoull(fields[4], nullptr, 16);
+		}
+		else if (fields.size() >= 2 && fields[0] == "D") {
+			auto& record   = result.files[fields[1]];
+			record.scanned = true;
+			record.dependencies.assign(fields.begin() + 2, fields.end());
+		}
+		else if (fields.size() == 3 && fields[0] == "O") {
+			result.outputs[fields[1]] = std::stoull(fields[2], nullptr, 16);
+		}
+	}
+	return result;
+}
+
+// --- 依存関係のグラフ ---
+
+struct file_node
+{
+	std::filesystem::path    path;              //!< ディスク上のパス
+	int64_t                  size      = -1;    //!< 存在しない場合は -1
+	int64_t                  mtime     = 0;
+	uint64_t                 hash      = 0;
+	bool                     hashed    = false;
+	bool                     scanned   = false;
+	std::vector<std::string> dependencies;
+};
+
+class file_graph
+{
+public:
+	explicit file_graph(std::filesystem::path source)
+	    : m_source(std::move(source))
+	{
+	}
+
+	//! ソースのディレクトリ内のファイルは相対パス、ディレクトリ外のファイルは絶対パスを名前にします
+	std::string key(const std::filesystem::path& path) const
+	{
+		const auto normal   = path.lexically_normal();
+		const auto relative = normal.lexically_relative(m_source);
+		if (relative.empty() || *relative.begin() == "..") {
+			std::error_code ec;
+			const auto      absolute = std::filesystem::absolute(normal, ec);
+			return to_utf8((ec ? normal : absolute).lexically_normal());
+		}
+		return to_utf8(relative);
+	}
+
+	std::filesystem::path path(const std::string& key) const
+	{
+		const auto path = from_utf8(key);
+		return path.is_absolute() ? path : m_source / path;
+	}
+
+	//! ノードを追加します (既にある場合は何もしません)
+	file_node& add(const std::string& key)
+	{
+		const auto [it, inserted] = m_index.try_emplace(key, m_nodes.size());
+		if (inserted) {
+			m_keys.push_back(key);
+			m_nodes.push_back({});
+			m_nodes.back().path = path(key);
+		}
+		return m_nodes[it->second];
+	}
+
+	file_node* find(const std::string& key)
+	{
+		const auto it = m_index.find(key);
+		return it != m_index.end() ? &m_nodes[it->second] : nullptr;
+	}
+
+	std::vector<file_node>& nodes() noexcept
+	{
+		return m_nodes;
+	}
+
+	const std::string& key(size_t index) const noexcept
+	{
+		return m_keys[index];
+	}
+
+private:
+	std::filesystem::path                   m_source;
+	std::vector<file_node>                  m_nodes;
+	std::vector<std::string>                m_keys;
+	std::unordered_map<std::string, size_t> m_index;
+};
+
+//! ハッシュを求めます (サイズと更新時刻が前回と同じ場合は前回のハッシュと依存関係を使います)
+void hash_node(file_node& node, const file_record* record)
+{
+	if (node.hashed) {
+		return;
+	}
+	node.hashed = true;
+
+	std::error_code ec;
+	const auto      size = std::filesystem::file_size(node.path, ec);
+	if (ec) {
+		node.size = -1;
+		return;
+	}
+	node.size  = static_cast<int64_t>(size);
+	node.mtime = write_time(node.path);
+	if (record && record->size == node.size && record->mtime == node.mtime) {
+		node.hash         = record->hash;
+		node.scanned      = record->scanned;
+		node.dependencies = record->dependencies;
+		return;
+	}
+
+	std::vector<uint8_t> data;
+	if (!read_file(node.path, data)) {
+		node.size = -1;
+		return;
+	}
+	node.hash = content_hash(data);
+}
+
+template<class Fn>
+void parallel(thread_pool* pool, size_t count, size_t grain, Fn&& fn)
+{
+	if (pool && count > grain) {
+		pool->parallel_for(count, grain, fn);
+	}
+	else {
+		fn(0, count);
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+
+uint64_t content_hash(std::span<const uint8_t> data, uint64_t seed) noexcept
+{
+	const uint8_t*       p    = data.data();
+	const uint8_t* const end  = p + data.size();
+	uint64_t             hash = 0;
+
+	if (data.size() >= 32) {
+		uint64_t v1 = seed + prime64_1 + prime64_2;
+		uint64_t v2 = seed + prime64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - prime64_1;
+		for (; end - p >= 32; p += 32) {
+			v1 = xxh_round(v1, read64(p));
+			v2 = xxh_round(v2, read64(p + 8));
+			v3 = xxh_round(v3, read64(p + 16));
+			v4 = xxh_round(v4, read64(p + 24));
+		}
+		hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+		hash = xxh_merge(hash, v1);
+		hash = xxh_merge(hash, v2);
+		hash = xxh_merge(hash, v3);
+		hash = xxh_merge(hash, v4);
+	}
+	else {
+		hash = seed + prime64_5;
+	}
+	hash += data.size();
+
+	for (; end - p >= 8; p += 8) {
+		hash ^= xxh_round(0, read64(p));
+		hash = std::rotl(hash, 27) * prime64_1 + prime64_4;
+	}
+	if (end - p >= 4) {
+		hash ^= read32(p) * prime64_1;
+		hash = std::rotl(hash, 23) * prime64_2 + prime64_3;
+		p += 4;
+	}
+	for (; p < end; ++p) {
+		hash ^= *p * prime64_5;
+		hash = std::rotl(hash, 11) * prime64_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= prime64_2;
+	hash ^= hash >> 29;
+	hash *= prime64_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+void scan_hlsl_includes(const std::filesystem::path& source, std::span<const uint8_t> data, std::vector<std::filesystem::path>& dependencies)
+{
+	const std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+	const auto             directory = source.parent_path();
+
+	size_t i           = 0;
+	bool   line_start  = true;
+	auto   skip_spaces = [&]()
+	{
+		while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) {
+			++i;
+		}
+	};
+	while (i < text.size()) {
+		const char c = text[i];
+		if (c == '\n') {
+			line_start = true;
+			++i;
+		}
+		else if (c == ' ' || c == '\t' || c == '\r') {
+			++i;
+		}
+		else if (text.compare(i, 2, "//") == 0) {
+			i = std::min(text.find('\n', i), text.size());
+		}
+		else if (text.compare(i, 2, "/*") == 0) {
+			i = std::min(text.find("*/", i + 2), text.size() - 2) + 2;
+		}
+		else if (c == '#' && line_start) {
+			++i;
+			skip_spaces();
+			if (text.compare(i, 7, "include") == 0) {
+				i += 7;
+				skip_spaces();
+				const char close = i < text.size() && text[i] == '<' ? '>' : '"';
+				if (i < text.size() && (text[i] == '"' || text[i] == '<')) {
+					const size_t end = text.find(close, i + 1);
+					if (end != std::string_view::npos && text.find('\n', i) > end) {
+						const auto name = text.substr(i + 1, end - i - 1);
+						dependencies.push_back((directory / from_utf8(std::string(name))).lexically_normal());
+						i = end + 1;
+					}
+				}
+			}
+			line_start = false;
+		}
+		else {
+			line_start = false;
+			++i;
+		}
+	}
+}
+
+cook_rule copy_rule(std::vector<std::string> extensions)
+{
+	cook_rule rule;
+	rule.name       = "copy";
+	rule.extensions = std::move(extensions);
+	rule.cook       = [](const std::filesystem::path&, std::span<const uint8_t> data, std::vector<uint8_t>& output)
+	{
+		output.assign(data.begin(), data.end());
+		return true;
+	};
+	return rule;
+}
+
+void asset_cooker::add_rule(cook_rule rule)
+{
+	ASSERT_RETURN(rule.cook);
+	m_rules.push_back(std::move(rule));
+}
+
+cook_report asset_cooker::cook(const std::filesystem::path& source, const std::filesystem::path& output, const cook_options& options, thread_pool* pool) const
+{
+	cook_report report;
+
+	const auto source_root   = source.lexically_normal();
+	const auto manifest_path = output / cook_manifest_name;
+	const auto previous      = load_manifest(manifest_path);
+
+	// ソースのファイルを列挙します
+	file_graph graph(source_root);
+	{
+		std::error_code ec;
+		for (std::filesystem::recursive_directory_iterator it(source_root, ec), end; !ec && it != end; it.increment(ec)) {
+			if (it->is_regular_file(ec)) {
+				graph.add(graph.key(it->path()));
+			}
+		}
+		if (ec) {
+			_LOG_ERROR_MSG(L"%s open failed.\n", source.wstring().c_str());
+		}
+	}
+
+	auto record = [&](const std::string& key) -> const file_record*
+	{
+		const auto it = previous.files.find(key);
+		return it != previous.files.end() ? &it->second : nullptr;
+	};
+
+	// ハッシュを並列に求めます
+	const size_t source_count = graph.nodes().size();
+	parallel(pool, source_count, 16, [&](size_t begin, size_t end)
+	    {
+		    for (size_t i = begin; i < end; ++i) {
+			    hash_node(graph.nodes()[i], record(graph.key(i)));
+		    }
+	    });
+
+	// クックする出力を決めます
+	struct job
+	{
+		size_t           node;
+		const cook_rule* rule;
+		std::string      output;
+		uint64_t         key;
+	};
+	std::vector<job> jobs;
+	for (size_t i = 0; i < source_count; ++i) {
+		const std::string extension = to_lower(to_utf8(graph.nodes()[i].path.extension()));
+		for (const auto& rule : m_rules) {
+			if (std::find(rule.extensions.begin(), rule.extensions.end(), extension) != rule.extensions.end()) {
+				auto name = from_utf8(graph.key(i));
+				if (!rule.output_extension.empty()) {
+					name.replace_extension(rule.output_extension);
+				}
+				jobs.push_back({ i, &rule, to_utf8(name), 0 });
+				break;
+			}
+		}
+	}
+
+	// 依存関係を辿って鍵を求めます (新しく見つかったファイルはグラフに追加します)
+	for (auto& job : jobs) {
+		std::vector<size_t>        stack = { job.node };
+		std::unordered_set<size_t> visited(stack.begin(), stack.end());
+		std::vector<size_t>        closure;
+		while (!stack.empty()) {
+			const size_t index = stack.back();
+			stack.pop_back();
+			closure.push_back(index);
+
+			file_node& node = graph.nodes()[index];
+			if (node.size >= 0 && !node.scanned && job.rule->scan) {
+				std::vector<uint8_t>               data;
+				std::vector<std::filesystem::path> dependencies;
+				if (read_file(node.path, data)) {
+					job.rule->scan(node.path, data, dependencies);
+				}
+				node.scanned = true;
+				node.dependencies.clear();
+				for (const auto& dependency : dependencies) {
+					node.dependencies.push_back(graph.key(dependency));
+				}
+			}
+
+			// graph.add はノードの配列を伸ばすので、依存関係を先に複製します
+			const std::vector<std::string> dependencies = graph.nodes()[index].dependencies;
+			for (const auto& dependency : dependencies) {
+				graph.add(dependency);
+				const size_t next = std::distance(graph.nodes().data(), graph.find(dependency));
+				hash_node(graph.nodes()[next], record(dependency));
+				if (visited.insert(next).second) {
+					stack.push_back(next);
+				}
+			}
+		}
+
+		std::sort(closure.begin() + 1, closure.end(), [&](size_t a, size_t b)
+		    {
+			    return graph.key(a) < graph.key(b);
+		    });
+		std::string key_source = job.rule->name + '\0' + std::to_string(job.rule->version) + '\0' + job.rule->parameters + '\0';
+		for (size_t index : closure) {
+			const file_node& node = graph.nodes()[index];
+			key_source += graph.key(index);
+			key_source += '\0';
+			key_source += node.size >= 0 ? std::to_string(node.hash) : "missing";
+			key_source += '\0';
+		}
+		job.key = content_hash(std::span(reinterpret_cast<const uint8_t*>(key_source.data()), key_source.size()));
+	}
+
+	// 変更のある出力を並列にクックします
+	std::vector<const job*> pending;
+	std::vector<uint8_t>    succeeded(jobs.size(), 1);
+	for (const auto& job : jobs) {
+		const auto it = previous.outputs.find(job.output);
+		std::error_code ec;
+		if (options.force || it == previous.outputs.end() || it->second != job.key || !std::filesystem::exists(output / from_utf8(job.output), ec)) {
+			std::filesystem::create_directories((output / from_utf8(job.output)).parent_path(), ec);
+			pending.push_back(&job);
+		}
+		else {
+			++report.up_to_date;
+		}
+	}
+	parallel(pool, pending.size(), 1, [&](size_t begin, size_t end)
+	    {
+		    for (size_t i = begin; i < end; ++i) {
+			    const job&           job  = *pending[i];
+			    const file_node&     node = graph.nodes()[job.node];
+			    std::vector<uint8_t> data;
+			    std::vector<uint8_t> cooked;
+			    if (node.size < 0 || !read_file(node.path, data) || !job.rule->cook(node.path, data, cooked) || !write_file(output / from_utf8(job.output), cooked)) {
+				    succeeded[&job - jobs.data()] = 0;
+			    }
+		    }
+	    });
+	for (const job* job : pending) {
+		if (succeeded[job - jobs.data()]) {
+			++report.cooked;
+		}
+		else {
+			_LOG_ERROR_MSG(L"%s cook failed.\n", graph.nodes()[job->node].path.wstring().c_str());
+			report.failed.push_back(graph.key(job->node));
+		}
+	}
+
+	// ソースがなくなった出力を削除します
+	std::unordered_set<std::string> outputs;
+	for (const auto& job : jobs) {
+		outputs.insert(job.output);
+	}
+	for (const auto& [name, key] : previous.outputs) {
+		std::error_code ec;
+		if (!outputs.contains(name) && std::filesystem::remove(output / from_utf8(name), ec)) {
+			++report.removed;
+		}
+	}
+
+	// 結果を保存します (失敗した出力は保存しないので次回もクックします)
+	std::error_code ec;
+	std::filesystem::create_directories(output, ec);
+	std::ostringstream stream;
+	stream << manifest_header << '\n';
+	for (size_t i = 0; i < graph.nodes().size(); ++i) {
+		const file_node& node = graph.nodes()[i];
+		if (node.size < 0) {
+			continue;
+		}
+		stream << "F\t" << graph.key(i) << '\t' << node.size << '\t' << node.mtime << '\t' << std::hex << node.hash << std::dec << '\n';
+		if (node.scanned) {
+			stream << "D\t" << graph.key(i);
+			for (const auto& dependency : node.dependencies) {
+				stream << '\t' << dependency;
+			}
+			stream << '\n';
+		}
+	}
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (succeeded[i]) {
+			stream << "O\t" << jobs[i].output << '\t' << std::hex << jobs[i].key << std::dec << '\n';
+		}
+	}
+	const std::string text = stream.str();
+	if (!write_file(manifest_path, std::span(reinterpret_cast<const uint8_t*>(text.data()), text.size()))) {
+		_LOG_ERROR_MSG(L"%s write failed.\n", manifest_path.wstring().c_str());
+	}
+
+	return report;
+}
+
+} // namespace dxlib
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dxlib {
+
+class thread_pool;
+
+// アセットのクック
+//
+// ソースのディレクトリのファイルを規則 (cook_rule) で実行時の形式に変換し、出力のディレクトリに書き出します。
+// 出力ごとの鍵は次の内容のハッシュです。
+//   規則の名前、バージョン、パラメーター
+//   ソースの内容
+//   ソースが (推移的に) 依存する全てのファイルの名前と内容 (HLSL の #include など)
+// 鍵が前回と同じで出力が残っている場合はクックしません。
+//
+// 前回の結果は出力のディレクトリの cook_manifest_name に保存します。ファイルのサイズと更新時刻が前回と同じ場合は、
+// 保存したハッシュと依存関係を再利用するので、変更のないファイルは読み込みません。
+// ハッシュの計算と変換は pool で並列に処理します。ソースがなくなった出力は削除します。
+
+//! \brief 前回の結果を保存するファイルの名前 (出力のディレクトリに置きます)
+constexpr const char* cook_manifest_name = "cook_manifest.txt";
+
+//! \brief 内容のハッシュ (XXH64)
+[[nodiscard]] uint64_t content_hash(std::span<const uint8_t> data, uint64_t seed = 0) noexcept;
+
+//! \brief 変換の規則
+struct cook_rule
+{
+	//! \brief 依存するファイルを列挙します
+	//!
+	//! \param[in]  source       ソースのパス
+	//! \param[in]  data         ソースの内容
+	//! \param[out] dependencies 依存するファイルのパス
+	using scan_function = std::function<void(const std::filesystem::path& source, std::span<const uint8_t> data, std::vector<std::filesystem::path>& dependencies)>;
+
+	//! \brief 変換します (複数のスレッドから同時に呼び出されます)
+	//!
+	//! \param[in]  source ソースのパス
+	//! \param[in]  data   ソースの内容
+	//! \param[out] output 出力の内容
+	//! \return 失敗した場合は false
+	using cook_function = std::function<bool(const std::filesystem::path& source, std::span<const uint8_t> data, std::vector<uint8_t>& output)>;
+
+	std::string              name;             //!< 規則の名前
+	uint32_t                 version = 1;      //!< 出力の形式や変換の処理を変えたときに上げます
+	std::string              parameters;       //!< 出力に影響する設定 (コンパイルオプションなど)
+	std::vector<std::string> extensions;       //!< 対象のソースの拡張子 (".hlsl" のように小文字で指定します)
+	std::string              output_extension; //!< 出力の拡張子 (空の場合はソースの拡張子のまま)
+	scan_function            scan;             //!< 依存するファイルの列挙 (依存しない場合は空)
+	cook_function            cook;             //!< 変換
+};
+
+//! \brief クックの設定
+struct cook_options
+{
+	bool force = false; //!< 鍵によらず全てクックします
+};
+
+//! \brief クックの結果
+struct cook_report
+{
+	uint32_t                 cooked     = 0; //!< クックした出力の数
+	uint32_t                 up_to_date = 0; //!< 前回から変更のない出力の数
+	uint32_t                 removed    = 0; //!< ソースがなくなり削除した出力の数
+	std::vector<std::string> failed;         //!< クックに失敗したソース (次回もクックします)
+};
+
+//! \brief HLSL の #include を列挙します (cook_rule::scan)
+//!
+//! #include "..." と #include <...> をインクルードするファイルのディレクトリからの相対パスとして解決します。
+//! コメントは読み飛ばしますが、#if は評価しないので、条件付きのインクルードも全て依存関係に含みます。
+void scan_hlsl_includes(const std::filesystem::path& source, std::span<const uint8_t> data, std::vector<std::filesystem::path>& dependencies);
+
+//! \brief ソースをそのままコピーする規則
+[[nodiscard]] cook_rule copy_rule(std::vector<std::string> extensions);
+
+//! \brief アセットのクッカー
+class asset_cooker
+{
+public:
+	//! \brief 規則を追加します
+	//!
+	//! 拡張子が複数の規則に一致する場合は先に追加した規則を使います。
+	void add_rule(cook_rule rule);
+
+	//! \brief source 以下の全てのファイルをクックします
+	//!
+	//! 出力は output からの source と同じ相対パスに、拡張子を規則の output_extension に変えて書き出します。
+	//!
+	//! \param[in] source  ソースのディレクトリ
+	//! \param[in] output  出力のディレクトリ
+	//! \param[in] options
+	//! \param[in] pool    並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+	cook_report cook(const std::filesystem::path& source, const std::filesystem::path& output, const cook_options& options = {}, thread_pool* pool = nullptr) const;
+
+private:
+	std::vector<cook_rule> m_rules;
+};
+
+} // namespace dxlib
@@ -0,0 +1,556 @@
+#include "async_io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "debug.h"
+#include "file.h"
+#include "thread_pool.h"
+
+namespace dxlib {
+namespace detail {
+
+struct io_operation
+{
+	std::wstring                          path;
+	uint64_t                              offset = 0;
+	std::span<uint8_t>                    destination;
+	io_priority                           priority = io_priority::normal;
+	uint64_t                              sequence = 0;
+	std::function<void(const io_result&)> callback;
+
+	std::atomic<io_status>        status = io_status::pending;
+	std::promise<io_result>       promise;
+	std::shared_future<io_result> future;
+
+	// 発行後の状態 (I/O スレッドだけが触ります)
+	file_reader file;
+	uint64_t    length = 0; //!< ファイル末尾で切り詰めた読み込みサイズ
+	uint64_t    bytes  = 0;
+#if defined(__linux__)
+	iovec                         iov = {};
+	std::shared_ptr<io_operation> self; //!< io_uring で発行中の間、自身を保持します
+#endif
+};
+
+} // namespace detail
+} // namespace dxlib
+
+namespace {
+
+using dxlib::io_priority;
+using dxlib::io_status;
+using dxlib::detail::io_operation;
+
+using operation_ptr = std::shared_ptr<io_operation>;
+
+// 優先度の高い順、同じ優先度では古い順
+struct operation_order
+{
+	bool operator()(const operation_ptr& a, const operation_ptr& b) const noexcept
+	{
+		if (a->priority != b->priority) {
+			return a->priority < b->priority;
+		}
+		return a->sequence > b->sequence;
+	}
+};
+
+// 1 回の読み込みの最大バイト数
+constexpr uint64_t max_read_size = uint64_t(1) << 30;
+
+#if defined(__linux__)
+// liburing を使わずにシステムコールで直接操作する io_uring
+//
+// 投入と回収はディスパッチスレッドだけが行うので、カーネルと共有するインデックス以外は同期しません。
+class uring
+{
+public:
+	uring() = default;
+
+	~uring()
+	{
+		if (m_sqes) {
+			munmap(m_sqes, m_sqes_size);
+		}
+		if (m_cq_ring && m_cq_ring != m_sq_ring) {
+			munmap(m_cq_ring, m_cq_size);
+		}
+		if (m_sq_ring) {
+			munmap(m_sq_ring, m_sq_size);
+		}
+		if (m_fd >= 0) {
+			::close(m_fd);
+		}
+	}
+
+	uring(const uring&) = delete;
+
+	uring& operator=(const uring&) = delete;
+
+	bool init(uint32_t entries) noexcept
+	{
+		io_uring_params params = {};
+		m_fd                   = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+		if (m_fd < 0) {
+			return false;
+		}
+
+		m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+		}
+		m_sq_ring = map(m_sq_size, IORING_OFF_SQ_RING);
+		m_cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? m_sq_ring : map(m_cq_size, IORING_OFF_CQ_RING);
+		m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes      = static_cast<io_uring_sqe*>(map(m_sqes_size, IORING_OFF_SQES));
+		if (!m_sq_ring || !m_cq_ring || !m_sqes) {
+			return false;
+		}
+
+		auto* sq     = static_cast<uint8_t*>(m_sq_ring);
+		auto* cq     = static_cast<uint8_t*>(m_cq_ring);
+		m_sq_head    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+		m_sq_tail    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		m_sq_mask    = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		m_sq_array   = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		m_sq_entries = params.sq_entries;
+		m_cq_head    = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		m_cq_tail    = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		m_cq_mask    = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		m_cqes       = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		m_tail       = *m_sq_tail;
+		return true;
+	}
+
+	//! \brief 空きがなければ nullptr
+	io_uring_sqe* next_sqe() noexcept
+	{
+		const unsigned head = std::atomic_ref<unsigned>(*m_sq_head).load(std::memory_order_acquire);
+		if (m_tail - head >= m_sq_entries) {
+			return nullptr;
+		}
+		const unsigned index = m_tail & m_sq_mask;
+		io_uring_sqe*  sqe   = &m_sqes[index];
+		std::memset(sqe, 0, sizeof(*sqe));
+		m_sq_array[index] = index;
+		++m_tail;
+		++m_unsubmitted;
+		return sqe;
+	}
+
+	//! \brief 用意した要求を投入し、min_complete 件の完了まで待ちます
+	//!
+	//! \return 0 または -errno
+	int enter(uint32_t min_complete) noexcept
+	{
+		std::atomic_ref<unsigned>(*m_sq_tail).store(m_tail, std::memory_order_release);
+		const long submitted = syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, min_complete, min_complete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+		if (submitted < 0) {
+			return -errno;
+		}
+		m_unsubmitted -= static_cast<unsigned>(submitted);
+		return 0;
+	}
+
+	//! \brief 完了したものごとに fn(user_data, res) を呼びます
+	template<class Fn>
+	void reap(Fn&& fn) noexcept
+	{
+		unsigned       head = *m_cq_head;
+		const unsigned tail = std::atomic_ref<unsigned>(*m_cq_tail).load(std::memory_order_acquire);
+		for (; head != tail; ++head) {
+			const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+			fn(cqe.user_data, cqe.res);
+		}
+		std::atomic_ref<unsigned>(*m_cq_head).store(head, std::memory_order_release);
+	}
+
+private:
+	void* map(size_t size, uint64_t offset) noexcept
+	{
+		void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, static_cast<off_t>(offset));
+		return p == MAP_FAILED ? nullptr : p;
+	}
+
+private:
+	int           m_fd          = -1;
+	void*         m_sq_ring     = nullptr;
+	void*         m_cq_ring     = nullptr;
+	io_uring_sqe* m_sqes        = nullptr;
+	size_t        m_sq_size     = 0;
+	size_t        m_cq_size     = 0;
+	size_t        m_sqes_size   = 0;
+	unsigned*     m_sq_head     = nullptr;
+	unsigned*     m_sq_tail     = nullptr;
+	unsigned*     m_sq_array    = nullptr;
+	unsigned      m_sq_mask     = 0;
+	unsigned      m_sq_entries  = 0;
+	unsigned*     m_cq_head     = nullptr;
+	unsigned*     m_cq_tail     = nullptr;
+	unsigned      m_cq_mask     = 0;
+	io_uring_cqe* m_cqes        = nullptr;
+	unsigned      m_tail        = 0; //!< 次に書く SQ の位置
+	unsigned      m_unsubmitted = 0; //!< 用意して未投入の要求数
+};
+
+// ディスパッチスレッドを起こす eventfd の poll の user_data (要求は 0 以外のポインタ)
+constexpr uint64_t wakeup_user_data = 0;
+#endif
+
+} // namespace
+
+namespace dxlib {
+
+// --- io_request ---
+
+io_request::io_request(std::shared_ptr<detail::io_operation> operation) noexcept
+    : m_operation(std::move(operation))
+{
+}
+
+io_status io_request::status() const noexcept
+{
+	ASSERT_RETURN(m_operation, io_status::failed);
+	return m_operation->status.load(std::memory_order_acquire);
+}
+
+io_result io_request::wait() const
+{
+	ASSERT_RETURN(m_operation, io_result { io_status::failed, 0 });
+	return m_operation->future.get();
+}
+
+std::shared_future<io_result> io_request::future() const
+{
+	ASSERT_RETURN(m_operation, {});
+	return m_operation->future;
+}
+
+// --- async_io::engine ---
+
+class async_io::engine
+{
+public:
+	explicit engine(const async_io_options& options)
+	    : m_queue_depth(std::max(options.queue_depth, 1u))
+	{
+#if defined(__linux__)
+		if (options.use_io_uring && m_ring.init(m_queue_depth + 1)) {
+			m_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+			if (m_wakeup >= 0) {
+				m_backend    = io_backend::io_uring;
+				m_dispatcher = std::thread(&engine::dispatch_main, this);
+				return;
+			}
+		}
+#endif
+		m_backend = io_backend::worker_threads;
+		m_workers = std::make_unique<thread_pool>(std::max(options.worker_count, 1u));
+	}
+
+	~engine()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		while (operation_ptr op = pop()) {
+			complete(*op, io_status::cancelled);
+		}
+#if defined(__linux__)
+		if (m_dispatcher.joinable()) {
+			wake();
+			m_dispatcher.join();
+		}
+		if (m_wakeup >= 0) {
+			::close(m_wakeup);
+		}
+#endif
+		m_workers.reset();
+	}
+
+	[[nodiscard]] io_backend backend() const noexcept
+	{
+		return m_backend;
+	}
+
+	void push(std::span<const operation_ptr> ops)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			for (const operation_ptr& op : ops) {
+				op->sequence = m_sequence++;
+				m_queue.push(op);
+			}
+			m_outstanding += ops.size();
+		}
+		if (m_backend == io_backend::io_uring) {
+			wake();
+		}
+		else {
+			// 各タスクは実行時点で最も優先度の高い要求を処理します
+			for (size_t i = 0; i < ops.size(); ++i) {
+				m_workers->submit([this]()
+				    {
+					    if (operation_ptr op = pop()) {
+						    read_sync(*op);
+					    }
+				    });
+			}
+		}
+	}
+
+	bool cancel(io_operation& op)
+	{
+		io_status expected = io_status::pending;
+		if (!op.status.compare_exchange_strong(expected, io_status::cancelled)) {
+			return false;
+		}
+		// キューからは pop で読み飛ばします
+		complete(op, io_status::cancelled);
+		return true;
+	}
+
+	void wait_idle()
+	{
+		std::unique_lock lock(m_mutex);
+		m_idle.wait(lock, [this]()
+		    {
+			    return m_outstanding == 0;
+		    });
+	}
+
+private:
+	// 発行待ちの要求のうち最も優先度の高いもの
+	operation_ptr pop()
+	{
+		std::lock_guard lock(m_mutex);
+		while (!m_queue.empty()) {
+			operation_ptr op = m_queue.top();
+			m_queue.pop();
+			io_status expected = io_status::pending;
+			if (op->status.compare_exchange_strong(expected, io_status::running)) {
+				return op;
+			}
+		}
+		return nullptr;
+	}
+
+	// ファイルを開いて読むサイズを決めます
+	// 読むものがない場合は完了させて false を返します
+	bool begin(io_operation& op)
+	{
+		if (!op.file.open(op.path.c_str())) {
+			complete(op, io_status::failed);
+			return false;
+		}
+		const uint64_t size = op.file.size();
+		op.length           = op.offset < size ? std::min<uint64_t>(op.destination.size(), size - op.offset) : 0;
+		if (op.length == 0) {
+			complete(op, io_status::completed);
+			return false;
+		}
+		return true;
+	}
+
+	void read_sync(io_operation& op)
+	{
+		if (!begin(op)) {
+			return;
+		}
+		op.bytes = op.file.read_at(op.offset, op.destination.first(static_cast<size_t>(op.length)));
+		complete(op, op.bytes == op.length ? io_status::completed : io_status::failed);
+	}
+
+	void complete(io_operation& op, io_status status)
+	{
+		op.file.close();
+
+		const io_result result { status, op.bytes };
+		if (op.callback) {
+			op.callback(result);
+		}
+		op.status.store(status, std::memory_order_release);
+		op.promise.set_value(result);
+
+		std::lock_guard lock(m_mutex);
+		if (--m_outstanding == 0) {
+			m_idle.notify_all();
+		}
+	}
+
+#if defined(__linux__)
+	void wake() noexcept
+	{
+		const uint64_t one = 1;
+		[[maybe_unused]] const ssize_t written = ::write(m_wakeup, &one, sizeof(one));
+	}
+
+	void arm_wakeup() noexcept
+	{
+		io_uring_sqe* sqe = m_ring.next_sqe();
+		ASSERT_RETURN(sqe);
+		sqe->opcode      = IORING_OP_POLL_ADD;
+		sqe->fd          = m_wakeup;
+		sqe->poll_events = POLLIN;
+		sqe->user_data   = wakeup_user_data;
+	}
+
+	// 残りを読む要求を用意します
+	void prepare_read(io_operation& op) noexcept
+	{
+		io_uring_sqe* sqe = m_ring.next_sqe();
+		ASSERT_RETURN(sqe);
+		op.iov.iov_base = op.destination.data() + op.bytes;
+		op.iov.iov_len  = static_cast<size_t>(std::min(op.length - op.bytes, max_read_size));
+		sqe->opcode     = IORING_OP_READV;
+		sqe->fd         = op.file.native_handle();
+		sqe->addr       = reinterpret_cast<uint64_t>(&op.iov);
+		sqe->len        = 1;
+		sqe->off        = op.offset + op.bytes;
+		sqe->user_data  = reinterpret_cast<uint64_t>(&op);
+	}
+
+	void dispatch_main()
+	{
+		uint32_t in_flight = 0;
+		arm_wakeup();
+
+		for (;;) {
+			while (in_flight < m_queue_depth) {
+				operation_ptr op = pop();
+				if (!op) {
+					break;
+				}
+				if (begin(*op)) {
+					prepare_read(*op);
+					op->self = op;
+					++in_flight;
+				}
+			}
+			{
+				std::lock_guard lock(m_mutex);
+				if (m_stop && in_flight == 0 && m_queue.empty()) {
+					break;
+				}
+			}
+
+			const int error = m_ring.enter(1);
+			ASSERT(error == 0 || error == -EINTR || error == -EAGAIN || error == -EBUSY);
+
+			m_ring.reap([&](uint64_t user_data, int32_t res)
+			    {
+				    if (user_data == wakeup_user_data) {
+					    uint64_t                       value = 0;
+					    [[maybe_unused]] const ssize_t read  = ::read(m_wakeup, &value, sizeof(value));
+					    arm_wakeup();
+					    return;
+				    }
+				    auto& op = *reinterpret_cast<io_operation*>(user_data);
+				    if (res == -EINTR || res == -EAGAIN) {
+					    prepare_read(op);
+					    return;
+				    }
+				    if (res > 0) {
+					    op.bytes += static_cast<uint64_t>(res);
+					    if (op.bytes < op.length) {
+						    prepare_read(op);
+						    return;
+					    }
+				    }
+				    // 0 はファイルが途中で短くなった場合です
+				    const operation_ptr keep = std::move(op.self);
+				    --in_flight;
+				    complete(op, op.bytes == op.length ? io_status::completed : io_status::failed);
+			    });
+		}
+	}
+#endif
+
+private:
+	std::mutex                                                                     m_mutex;
+	std::condition_variable                                                        m_idle;
+	std::priority_queue<operation_ptr, std::vector<operation_ptr>, operation_order> m_queue;
+	uint64_t                                                                       m_sequence    = 0;
+	size_t                                                                         m_outstanding = 0;
+	bool                                                                           m_stop        = false;
+
+	uint32_t                     m_queue_depth;
+	io_backend                   m_backend = io_backend::worker_threads;
+	std::unique_ptr<thread_pool> m_workers;
+#if defined(__linux__)
+	uring       m_ring;
+	int         m_wakeup = -1;
+	std::thread m_dispatcher;
+#endif
+};
+
+// --- async_io ---
+
+async_io::async_io(const async_io_options& options)
+    : m_engine(std::make_unique<engine>(options))
+{
+}
+
+async_io::~async_io() = default;
+
+io_backend async_io::backend() const noexcept
+{
+	return m_engine->backend();
+}
+
+std::vector<io_request> async_io::submit(std::span<read_request> requests)
+{
+	std::vector<operation_ptr> ops(requests.size());
+	std::vector<io_request>    handles(requests.size());
+	for (size_t i = 0; i < requests.size(); ++i) {
+		auto op         = std::make_shared<detail::io_operation>();
+		op->path        = std::move(requests[i].path);
+		op->offset      = requests[i].offset;
+		op->destination = requests[i].destination;
+		op->priority    = requests[i].priority;
+		op->callback    = std::move(requests[i].callback);
+		op->future      = op->promise.get_future().share();
+		handles[i]      = io_request(op);
+		ops[i]          = std::move(op);
+	}
+	m_engine->push(ops);
+	return handles;
+}
+
+io_request async_io::submit(read_request request)
+{
+	return std::move(submit(std::span<read_request>(&request, 1)).front());
+}
+
+bool async_io::cancel(const io_request& request)
+{
+	ASSERT_RETURN(request.valid(), false);
+	return m_engine->cancel(*request.m_operation);
+}
+
+void async_io::wait_idle()
+{
+	m_engine->wait_idle();
+}
+
+} // namespace dxlib
@@ -0,0 +1,152 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dxlib {
+
+// 非同期のファイル読み込み
+//
+// 読み込み要求をまとめて受け取り、優先度の高い順 (同じ優先度では受け取った順) に発行します。
+// - Linux では io_uring で最大 queue_depth 件を同時に発行し、1 つのディスパッチスレッドが完了を処理します
+// - それ以外の環境 (io_uring を使えない Linux を含む) ではワーカースレッドが file_reader::read_at で読みます
+// 完了はコールバック (I/O スレッドから呼ばれます) と io_request の wait / future のどちらでも受け取れます。
+// コールバックは wait / future より先に呼ばれるので、コールバックで行った処理は wait の後に参照できます。
+//
+// ファイルは要求ごとに開きます。io_uring でも open は同期的にディスパッチスレッドで行います。
+
+//! \brief 要求の優先度
+enum class io_priority : uint8_t
+{
+	low,
+	normal,
+	high,
+};
+
+//! \brief 要求の状態
+enum class io_status : uint8_t
+{
+	pending,   //!< 発行待ち (cancel できます)
+	running,   //!< 発行済み
+	completed, //!< 完了 (ファイル末尾に達した場合は bytes が要求より少なくなります)
+	failed,    //!< 開けない、または読み込みに失敗しました
+	cancelled, //!< 発行前に取り消されました
+};
+
+//! \brief 読み込みに使う仕組み
+enum class io_backend : uint8_t
+{
+	io_uring,
+	worker_threads,
+};
+
+//! \brief 要求の結果
+struct io_result
+{
+	io_status status = io_status::pending;
+	uint64_t  bytes  = 0; //!< 読んだバイト数
+};
+
+//! \brief 読み込み要求
+struct read_request
+{
+	std::wstring                          path;
+	uint64_t                              offset = 0;                   //!< ファイル先頭からのバイトオフセット
+	std::span<uint8_t>                    destination;                  //!< destination.size() バイトを読みます (完了まで有効である必要があります)
+	io_priority                           priority = io_priority::normal;
+	std::function<void(const io_result&)> callback;                     //!< 完了時に I/O スレッドから呼ばれます (省略可)
+};
+
+//! \brief async_io の設定
+struct async_io_options
+{
+	uint32_t queue_depth  = 64;   //!< io_uring で同時に発行する最大の要求数
+	uint32_t worker_count = 4;    //!< ワーカースレッド数 (io_uring を使わない場合)
+	bool     use_io_uring = true; //!< false の場合は Linux でもワーカースレッドを使います
+};
+
+namespace detail {
+
+struct io_operation;
+
+} // namespace detail
+
+//! \brief 発行した読み込み要求
+class io_request
+{
+public:
+	io_request() = default;
+
+	[[nodiscard]] bool valid() const noexcept
+	{
+		return m_operation != nullptr;
+	}
+
+	//! \brief 現在の状態
+	[[nodiscard]] io_status status() const noexcept;
+
+	//! \brief 完了 (または失敗、取り消し) まで待ちます
+	io_result wait() const;
+
+	//! \brief 完了時に結果が設定される future
+	[[nodiscard]] std::shared_future<io_result> future() const;
+
+private:
+	friend class async_io;
+
+	explicit io_request(std::shared_ptr<detail::io_operation> operation) noexcept;
+
+private:
+	std::shared_ptr<detail::io_operation> m_operation;
+};
+
+//! \brief 非同期のファイル読み込み
+class async_io
+{
+public:
+	explicit async_io(const async_io_options& options = {});
+
+	//! \brief デストラクタ
+	//!
+	//! 発行前の要求は取り消し、発行済みの要求の完了を待ちます。
+	~async_io();
+
+	async_io(const async_io&) = delete;
+
+	async_io& operator=(const async_io&) = delete;
+
+	//! \brief 実際に使われている仕組み
+	[[nodiscard]] io_backend backend() const noexcept;
+
+	//! \brief 要求をまとめて発行します
+	//!
+	//! requests の path と callback は移動されます。
+	//!
+	//! \return requests と同じ順の要求
+	std::vector<io_request> submit(std::span<read_request> requests);
+
+	//! \brief 要求を 1 つ発行します
+	io_request submit(read_request request);
+
+	//! \brief 発行前の要求を取り消します
+	//!
+	//! 取り消した要求のコールバックは io_status::cancelled で呼び出しスレッドから呼ばれます。
+	//!
+	//! \return 取り消した場合は true、既に発行済みまたは完了している場合は false
+	bool cancel(const io_request& request);
+
+	//! \brief 全ての要求が終わるまで待ちます
+	void wait_idle();
+
+private:
+	class engine;
+
+	std::unique_ptr<engine> m_engine;
+};
+
+} // namespace dxlib
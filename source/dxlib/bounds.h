@@ -0,0 +1,23 @@
+﻿#pragma once
+
+#include "vector.h"
+
+namespace dxlib {
+namespace geometry {
+
+//! \brief 境界球
+struct bounding_sphere
+{
+	float3 center;
+	float  radius;
+};
+
+//! \brief 軸平行境界ボックス
+struct bounding_box
+{
+	float3 min;
+	float3 max;
+};
+
+} // namespace geometry
+} // namespace dxlib
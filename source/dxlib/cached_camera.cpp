@@ -0,0 +1,212 @@
+#include "cached_camera.h"
+
+namespace {
+
+bool equal(const float3& a, const float3& b) noexcept
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+} // namespace
+
+namespace dxlib {
+namespace scene {
+
+cached_camera::cached_camera(const camera& cam, float aspect, depth_mode mode) noexcept
+    : m_camera(cam)
+    , m_aspect(aspect)
+    , m_mode(mode)
+{
+}
+
+void cached_camera::set(const camera& cam) noexcept
+{
+	set_position(cam.position);
+	set_focus(cam.focus);
+	set_up(cam.up);
+	set_near_z(cam.near_z);
+	set_far_z(cam.far_z);
+	set_fov_y(cam.fov_y);
+}
+
+void cached_camera::set_position(const float3& position) noexcept
+{
+	if (!equal(m_camera.position, position)) {
+		m_camera.position = position;
+		mark(dirty_view);
+	}
+}
+
+void cached_camera::set_focus(const float3& focus) noexcept
+{
+	if (!equal(m_camera.focus, focus)) {
+		m_camera.focus = focus;
+		mark(dirty_view);
+	}
+}
+
+void cached_camera::set_up(const float3& up) noexcept
+{
+	if (!equal(m_camera.up, up)) {
+		m_camera.up = up;
+		mark(dirty_view);
+	}
+}
+
+void cached_camera::set_near_z(float near_z) noexcept
+{
+	if (m_camera.near_z != near_z) {
+		m_camera.near_z = near_z;
+		mark(dirty_projection);
+	}
+}
+
+void cached_camera::set_far_z(float far_z) noexcept
+{
+	if (m_camera.far_z != far_z) {
+		m_camera.far_z = far_z;
+		// 無限遠の射影は far_z を使用しません
+		if (m_mode == depth_mode::standard || m_mode == depth_mode::reverse_z) {
+			mark(dirty_projection);
+		}
+	}
+}
+
+void cached_camera::set_fov_y(float fov_y) noexcept
+{
+	if (m_camera.fov_y != fov_y) {
+		m_camera.fov_y = fov_y;
+		mark(dirty_projection);
+	}
+}
+
+void cached_camera::set_aspect(float aspect) noexcept
+{
+	if (m_aspect != aspect) {
+		m_aspect = aspect;
+		mark(dirty_projection);
+	}
+}
+
+void cached_camera::set_depth_mode(depth_mode mode) noexcept
+{
+	if (m_mode != mode) {
+		m_mode = mode;
+		mark(dirty_projection);
+	}
+}
+
+const camera& cached_camera::parameters() const noexcept
+{
+	return m_camera;
+}
+
+float cached_camera::aspect() const noexcept
+{
+	return m_aspect;
+}
+
+depth_mode cached_camera::mode() const noexcept
+{
+	return m_mode;
+}
+
+void cached_camera::update() const noexcept
+{
+	if (m_dirty == 0) {
+		return;
+	}
+
+	if (m_dirty & dirty_view) {
+		m_view = math::look_at_lh(m_camera.position, m_camera.focus, m_camera.up);
+
+		// ビュー行列は正規直交な回転と平行移動なので、回転部分の転置と視点の位置から逆行列を作れます
+		m_inverse_view = {
+			m_view._00, m_view._10, m_view._20, 0.0f,
+			m_view._01, m_view._11, m_view._21, 0.0f,
+			m_view._02, m_view._12, m_view._22, 0.0f,
+			m_camera.position.x, m_camera.position.y, m_camera.position.z, 1.0f
+		};
+	}
+
+	if (m_dirty & dirty_projection) {
+		switch (m_mode) {
+		case depth_mode::standard:
+			m_projection = math::perspective_fov_lh(m_camera.fov_y, m_aspect, m_camera.near_z, m_camera.far_z);
+			break;
+		case depth_mode::reverse_z:
+			m_projection = math::perspective_fov_lh_reverse_z(m_camera.fov_y, m_aspect, m_camera.near_z, m_camera.far_z);
+			break;
+		case depth_mode::infinite:
+			m_projection = math::perspective_fov_lh_infinite(m_camera.fov_y, m_aspect, m_camera.near_z);
+			break;
+		case depth_mode::infinite_reverse_z:
+			m_projection = math::perspective_fov_lh_infinite_reverse_z(m_camera.fov_y, m_aspect, m_camera.near_z);
+			break;
+		}
+		m_inverse_projection = math::inverse(m_projection);
+	}
+
+	m_view_projection         = m_view * m_projection;
+	m_inverse_view_projection = m_inverse_projection * m_inverse_view;
+	m_frustum                 = make_frustum(m_view_projection);
+
+	++m_revision;
+	m_dirty = 0;
+}
+
+const float4x4& cached_camera::view() const noexcept
+{
+	update();
+	return m_view;
+}
+
+const float4x4& cached_camera::projection() const noexcept
+{
+	update();
+	return m_projection;
+}
+
+const float4x4& cached_camera::view_projection() const noexcept
+{
+	update();
+	return m_view_projection;
+}
+
+const float4x4& cached_camera::inverse_view() const noexcept
+{
+	update();
+	return m_inverse_view;
+}
+
+const float4x4& cached_camera::inverse_projection() const noexcept
+{
+	update();
+	return m_inverse_projection;
+}
+
+const float4x4& cached_camera::inverse_view_projection() const noexcept
+{
+	update();
+	return m_inverse_view_projection;
+}
+
+const frustum& cached_camera::view_frustum() const noexcept
+{
+	update();
+	return m_frustum;
+}
+
+uint32_t cached_camera::revision() const noexcept
+{
+	update();
+	return m_revision;
+}
+
+void cached_camera::mark(uint8_t flags) noexcept
+{
+	m_dirty |= flags;
+}
+
+} // namespace scene
+} // namespace dxlib
@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <cstdint>
+
+#include "camera.h"
+#include "culling.h"
+#include "matrix.h"
+
+namespace dxlib {
+namespace scene {
+
+//! \brief 射影行列の深度の扱い
+enum class depth_mode : uint8_t
+{
+	standard,           //!< near_z -> 0, far_z -> 1
+	reverse_z,          //!< near_z -> 1, far_z -> 0
+	infinite,           //!< near_z -> 0, 無限遠 -> 1 (far_z は無視)
+	infinite_reverse_z, //!< near_z -> 1, 無限遠 -> 0 (far_z は無視)
+};
+
+//! \brief camera から求めた行列をキャッシュするクラス
+//!
+//! ビュー/射影行列とその積・逆行列、視錐台をダーティフラグで管理し、
+//! パラメーターが変更された後の最初の取得時にだけ再計算します。
+//! 静止したカメラやシャドウビューは毎フレームの取得でも分岐 1 回分のコストしかかかりません。
+//! 取得関数は内部状態を更新するため、同じインスタンスを複数スレッドから同時に参照する場合は事前に update() を呼び出してください。
+class cached_camera
+{
+public:
+	cached_camera() = default;
+
+	//! \brief コンストラクタ
+	//!
+	//! \param[in] cam
+	//! \param[in] aspect 横幅 / 立幅
+	//! \param[in] mode
+	cached_camera(const camera& cam, float aspect, depth_mode mode = depth_mode::standard) noexcept;
+
+	//! \brief 全パラメーターを設定します
+	void set(const camera& cam) noexcept;
+
+	void set_position(const float3& position) noexcept;
+
+	void set_focus(const float3& focus) noexcept;
+
+	void set_up(const float3& up) noexcept;
+
+	void set_near_z(float near_z) noexcept;
+
+	void set_far_z(float far_z) noexcept;
+
+	//! \brief 垂直画角 (ラジアン) を設定します
+	void set_fov_y(float fov_y) noexcept;
+
+	//! \brief アスペクト比 (横幅 / 立幅) を設定します
+	void set_aspect(float aspect) noexcept;
+
+	void set_depth_mode(depth_mode mode) noexcept;
+
+	//! \brief カメラのパラメーター
+	[[nodiscard]] const camera& parameters() const noexcept;
+
+	[[nodiscard]] float aspect() const noexcept;
+
+	[[nodiscard]] depth_mode mode() const noexcept;
+
+	//! \brief 変更されたパラメーターに依存する行列を再計算します
+	void update() const noexcept;
+
+	[[nodiscard]] const float4x4& view() const noexcept;
+
+	[[nodiscard]] const float4x4& projection() const noexcept;
+
+	//! \brief view() * projection()
+	[[nodiscard]] const float4x4& view_projection() const noexcept;
+
+	[[nodiscard]] const float4x4& inverse_view() const noexcept;
+
+	[[nodiscard]] const float4x4& inverse_projection() const noexcept;
+
+	[[nodiscard]] const float4x4& inverse_view_projection() const noexcept;
+
+	//! \brief view_projection() から抽出した視錐台
+	[[nodiscard]] const frustum& view_frustum() const noexcept;
+
+	//! \brief 行列が再計算されるたびに増加する値
+	//!
+	//! 前回の値と比較することで、カメラに依存する処理 (シャドウビューの再描画など) を省略できます。
+	[[nodiscard]] uint32_t revision() const noexcept;
+
+private:
+	void mark(uint8_t flags) noexcept;
+
+private:
+	enum : uint8_t
+	{
+		dirty_view       = 1 << 0,
+		dirty_projection = 1 << 1,
+	};
+
+	camera     m_camera = { float3(0.0f, 0.0f, -1.0f), float3(0.0f), float3(0.0f, 1.0f, 0.0f), 0.1f, 1000.0f, 1.0f };
+	float      m_aspect = 1.0f;
+	depth_mode m_mode   = depth_mode::standard;
+
+	mutable float4x4 m_view;
+	mutable float4x4 m_projection;
+	mutable float4x4 m_view_projection;
+	mutable float4x4 m_inverse_view;
+	mutable float4x4 m_inverse_projection;
+	mutable float4x4 m_inverse_view_projection;
+	mutable frustum  m_frustum;
+	mutable uint32_t m_revision = 0;
+	mutable uint8_t  m_dirty    = dirty_view | dirty_projection;
+};
+
+} // namespace scene
+} // namespace dxlib
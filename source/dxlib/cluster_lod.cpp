@@ -0,0 +1,308 @@
+#include "cluster_lod.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "debug.h"
+#include "mesh_simplify.h"
+#include "thread_pool.h"
+#include "vertex_weld.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+// グループの三角形数がこの比率より減らなかった場合は、そのグループを簡略化しません
+constexpr float min_group_reduction = 0.85f;
+
+// a と b を含む球
+bounding_sphere merge(const bounding_sphere& a, const bounding_sphere& b) noexcept
+{
+	const float3 d    = b.center - a.center;
+	const float  dist = length(d);
+	if (dist + b.radius <= a.radius) {
+		return a;
+	}
+	if (dist + a.radius <= b.radius) {
+		return b;
+	}
+	const float r = (dist + a.radius + b.radius) * 0.5f;
+	return { a.center + d * ((r - a.radius) / dist), r };
+}
+
+// src のメッシュレットを dst の末尾に追加します (頂点番号は vertex_ids で元の頂点番号に戻します)
+void append(meshlet_mesh& dst, const meshlet_mesh& src, std::span<const uint32_t> vertex_ids)
+{
+	const uint32_t vertex_base   = static_cast<uint32_t>(dst.vertices.size());
+	const uint32_t triangle_base = static_cast<uint32_t>(dst.triangles.size());
+	for (meshlet m : src.meshlets) {
+		m.vertex_offset += vertex_base;
+		m.triangle_offset += triangle_base;
+		dst.meshlets.push_back(m);
+	}
+	dst.bounds.insert(dst.bounds.end(), src.bounds.begin(), src.bounds.end());
+	for (const uint32_t v : src.vertices) {
+		dst.vertices.push_back(vertex_ids[v]);
+	}
+	dst.triangles.insert(dst.triangles.end(), src.triangles.begin(), src.triangles.end());
+}
+
+// 段のクラスタを、頂点の位置を多く共有するクラスタ同士で group_size 個ずつのグループに分けます
+// グループは groups[offset[g] .. offset[g + 1]) に段の中の番号で格納します
+void partition(const cluster_lod_dag& dag, std::span<const uint32_t> level, std::span<const uint32_t> position_id, uint32_t group_size, std::vector<uint32_t>& groups, std::vector<uint32_t>& offset)
+{
+	const uint32_t count = static_cast<uint32_t>(level.size());
+
+	// (位置番号, クラスタ) の組を位置番号順に並べ、同じ位置を持つクラスタの組を隣接とします
+	std::vector<uint64_t> pairs;
+	for (uint32_t i = 0; i < count; ++i) {
+		const size_t first = pairs.size();
+		for (const uint32_t v : dag.meshlets.meshlet_vertices(level[i])) {
+			pairs.push_back(static_cast<uint64_t>(position_id[v]) << 32 | i);
+		}
+		std::sort(pairs.begin() + first, pairs.end());
+		pairs.erase(std::unique(pairs.begin() + first, pairs.end()), pairs.end());
+	}
+	std::sort(pairs.begin(), pairs.end());
+
+	std::vector<uint64_t> edges;
+	for (size_t b = 0, e = 0; b < pairs.size(); b = e) {
+		while (e < pairs.size() && (pairs[e] >> 32) == (pairs[b] >> 32)) {
+			++e;
+		}
+		for (size_t i = b; i < e; ++i) {
+			for (size_t j = b; j < e; ++j) {
+				if (i != j) {
+					edges.push_back((pairs[i] & 0xffffffffull) << 32 | (pairs[j] & 0xffffffffull));
+				}
+			}
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+
+	// クラスタごとの隣接クラスタと共有する位置の数 (CSR)
+	std::vector<uint32_t> adjacency_offset(count + 1, 0);
+	std::vector<uint32_t> neighbor;
+	std::vector<uint32_t> weight;
+	for (size_t b = 0, e = 0; b < edges.size(); b = e) {
+		while (e < edges.size() && edges[e] == edges[b]) {
+			++e;
+		}
+		++adjacency_offset[(edges[b] >> 32) + 1];
+		neighbor.push_back(static_cast<uint32_t>(edges[b]));
+		weight.push_back(static_cast<uint32_t>(e - b));
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		adjacency_offset[i + 1] += adjacency_offset[i];
+	}
+
+	// 未割り当ての最初のクラスタから始め、グループと最も多く位置を共有するクラスタを加えていきます
+	std::vector<uint8_t>  grouped(count, 0);
+	std::vector<uint32_t> shared(count, 0);
+	std::vector<uint32_t> touched;
+	groups.clear();
+	offset.assign(1, 0);
+	for (uint32_t seed = 0; seed < count; ++seed) {
+		if (grouped[seed]) {
+			continue;
+		}
+		uint32_t next = seed;
+		for (uint32_t n = 0; n < group_size && next != ~0u; ++n) {
+			grouped[next] = 1;
+			groups.push_back(next);
+			for (uint32_t a = adjacency_offset[next]; a < adjacency_offset[next + 1]; ++a) {
+				if (shared[neighbor[a]] == 0) {
+					touched.push_back(neighbor[a]);
+				}
+				shared[neighbor[a]] += weight[a];
+			}
+
+			next = ~0u;
+			for (const uint32_t c : touched) {
+				if (!grouped[c] && (next == ~0u || shared[c] > shared[next] || (shared[c] == shared[next] && c < next))) {
+					next = c;
+				}
+			}
+		}
+		for (const uint32_t c : touched) {
+			shared[c] = 0;
+		}
+		touched.clear();
+		offset.push_back(static_cast<uint32_t>(groups.size()));
+	}
+}
+
+// グループの簡略化の結果
+struct group_result
+{
+	meshlet_mesh          mesh;       // 簡略化した三角形のクラスタ (頂点番号は vertex_ids の番号)
+	std::vector<uint32_t> vertex_ids; // グループ内の頂点番号 -> 元の頂点番号
+	bounding_sphere       bounds;
+	float                 error;
+	bool                  simplified;
+};
+
+void simplify_group(const cluster_lod_dag& dag, std::span<const uint32_t> clusters, position_view positions, const cluster_lod_options& options, group_result& result)
+{
+	result.simplified = false;
+
+	// グループの三角形を元の頂点番号で集め、グループ内の頂点番号に詰めます
+	std::vector<uint32_t> indices;
+	float                 child_error = 0.0f;
+	result.bounds                     = dag.clusters[clusters[0]].bounds;
+	for (const uint32_t c : clusters) {
+		const std::span<const uint32_t> vertices  = dag.meshlets.meshlet_vertices(c);
+		const std::span<const uint8_t>  triangles = dag.meshlets.meshlet_triangles(c);
+		for (const uint8_t t : triangles) {
+			indices.push_back(vertices[t]);
+		}
+		child_error   = std::max(child_error, dag.clusters[c].error);
+		result.bounds = merge(result.bounds, dag.clusters[c].bounds);
+	}
+
+	std::vector<uint32_t>& ids = result.vertex_ids;
+	ids.assign(indices.begin(), indices.end());
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	for (uint32_t& i : indices) {
+		i = static_cast<uint32_t>(std::lower_bound(ids.begin(), ids.end(), i) - ids.begin());
+	}
+	std::vector<float3> local_positions(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i) {
+		local_positions[i] = positions[ids[i]];
+	}
+
+	const uint32_t index_count = static_cast<uint32_t>(indices.size());
+	const uint32_t target      = static_cast<uint32_t>(index_count * options.reduction) / 3 * 3;
+
+	simplify_options simplify_options;
+	simplify_options.target_error = options.max_error - child_error;
+	simplify_options.lock_border  = true;
+
+	const position_view   local_view { std::span<const float3>(local_positions) };
+	const simplify_result simplified = simplify(std::span<const uint32_t>(indices), local_view, target, std::span<uint32_t>(indices), simplify_options);
+	if (simplified.index_count == 0 || simplified.index_count > index_count * min_group_reduction) {
+		return;
+	}
+	indices.resize(simplified.index_count);
+
+	result.mesh       = build_meshlets(std::span<const uint32_t>(indices), local_view, options.meshlet);
+	result.error      = child_error + simplified.error;
+	result.simplified = true;
+}
+
+template<class Index>
+cluster_lod_dag build_cluster_lod_impl(std::span<const Index> indices, position_view positions, const cluster_lod_options& options, dxlib::thread_pool* pool)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0 && options.group_size >= 2, {});
+
+	cluster_lod_dag dag;
+	dag.meshlets = build_meshlets(indices, positions, options.meshlet);
+	dag.clusters.resize(dag.meshlets.meshlets.size());
+	for (size_t i = 0; i < dag.clusters.size(); ++i) {
+		dag.clusters[i] = { dag.meshlets.bounds[i].sphere, 0.0f, {}, FLT_MAX, 0 };
+	}
+	dag.level_count = dag.clusters.empty() ? 0 : 1;
+
+	// 同じ位置の頂点を隣接の判定で同一視します (-0 と +0 は同じ位置として扱われます)
+	std::vector<float3> packed(positions.count);
+	for (uint32_t v = 0; v < positions.count; ++v) {
+		packed[v] = positions[v];
+	}
+	const vertex_element  layout[] = { { vertex_semantic::position, vertex_format::float32x3, 0 } };
+	std::vector<uint32_t> position_id(positions.count);
+	generate_weld_remap(packed.data(), sizeof(float3), positions.count, layout, position_id);
+
+	std::vector<uint32_t> level(dag.clusters.size());
+	for (uint32_t i = 0; i < level.size(); ++i) {
+		level[i] = i;
+	}
+
+	std::vector<uint32_t>     groups;
+	std::vector<uint32_t>     group_offset;
+	std::vector<uint32_t>     next_level;
+	std::vector<group_result> results;
+	while (level.size() > 1 && dag.level_count < options.max_levels) {
+		partition(dag, level, position_id, options.group_size, groups, group_offset);
+		for (uint32_t& g : groups) {
+			g = level[g];
+		}
+
+		const size_t group_count = group_offset.size() - 1;
+		results.assign(group_count, {});
+		auto simplify_range = [&](size_t begin, size_t end)
+		{
+			for (size_t g = begin; g < end; ++g) {
+				const std::span<const uint32_t> clusters(groups.data() + group_offset[g], group_offset[g + 1] - group_offset[g]);
+				simplify_group(dag, clusters, positions, options, results[g]);
+			}
+		};
+		if (pool && group_count > 1) {
+			pool->parallel_for(group_count, 1, simplify_range);
+		}
+		else {
+			simplify_range(0, group_count);
+		}
+
+		// 結果はグループの順に追加するので、並列化の有無で DAG は変わりません
+		// 簡略化できなかったグループのクラスタは、次の段で別のクラスタと組み合わせて再び試します
+		next_level.clear();
+		bool progress = false;
+		for (size_t g = 0; g < group_count; ++g) {
+			const group_result& r = results[g];
+			if (!r.simplified) {
+				next_level.insert(next_level.end(), groups.begin() + group_offset[g], groups.begin() + group_offset[g + 1]);
+				continue;
+			}
+			progress = true;
+			for (uint32_t i = group_offset[g]; i < group_offset[g + 1]; ++i) {
+				dag.clusters[groups[i]].parent_bounds = r.bounds;
+				dag.clusters[groups[i]].parent_error  = r.error;
+			}
+			const uint32_t first = static_cast<uint32_t>(dag.clusters.size());
+			append(dag.meshlets, r.mesh, r.vertex_ids);
+			for (uint32_t i = first; i < dag.meshlets.meshlets.size(); ++i) {
+				dag.clusters.push_back({ r.bounds, r.error, {}, FLT_MAX, dag.level_count });
+				next_level.push_back(i);
+			}
+		}
+		if (!progress) {
+			break;
+		}
+		++dag.level_count;
+		level.swap(next_level);
+	}
+	return dag;
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+cluster_lod_dag build_cluster_lod(std::span<const uint16_t> indices, position_view positions, const cluster_lod_options& options, thread_pool* pool)
+{
+	return build_cluster_lod_impl(indices, positions, options, pool);
+}
+
+cluster_lod_dag build_cluster_lod(std::span<const uint32_t> indices, position_view positions, const cluster_lod_options& options, thread_pool* pool)
+{
+	return build_cluster_lod_impl(indices, positions, options, pool);
+}
+
+uint32_t select_clusters(const cluster_lod_dag& dag, const lod_selector& selector, std::span<uint32_t> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= dag.clusters.size(), 0);
+
+	uint32_t count = 0;
+	for (size_t i = 0; i < dag.clusters.size(); ++i) {
+		const lod_cluster& c = dag.clusters[i];
+		if (selector.is_acceptable(c.error, c.bounds) && (c.parent_error == FLT_MAX || !selector.is_acceptable(c.parent_error, c.parent_bounds))) {
+			out[count++] = static_cast<uint32_t>(i);
+		}
+	}
+	return count;
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mesh_lod.h"
+#include "mesh_optimizer.h"
+#include "meshlet.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+namespace geometry {
+
+// クラスタ単位の階層 LOD
+//
+// メッシュをメッシュレット (クラスタ) に分割し、次の手順を繰り返して粗いクラスタを作ります。
+// 1. 隣接する (頂点の位置を共有する) クラスタを group_size 個ずつのグループにまとめます
+// 2. グループの三角形をグループの境界を固定したまま半分に簡略化します
+// 3. 簡略化した三角形を新しいクラスタに分割します
+// グループの境界は固定されるので、隣接するグループが別の段で描画されても継ぎ目に隙間はできません。
+// 新しい頂点は作らないため、全ての段で元の頂点バッファを共有します。
+//
+// 各クラスタは自身の誤差 (自身を作ったグループの誤差) と親の誤差 (自身を含むグループを簡略化した誤差) を持ち、
+// どちらも同じグループのクラスタで同じ値になります。実行時は
+//   自身の誤差が許容範囲内 かつ 親の誤差が許容範囲外
+// のクラスタを描画すると、元のメッシュの各部分をちょうど 1 回ずつ覆うカットになります。
+// 誤差と境界球は子から親に向かって単調に大きくなるように作るので、この判定はクラスタごとに独立して行えます。
+
+//! \brief build_cluster_lod の設定
+struct cluster_lod_options
+{
+	meshlet_options meshlet;              //!< クラスタの頂点数と三角形数の上限
+	uint32_t        group_size = 8;       //!< 1 つのグループにまとめるクラスタ数
+	float           reduction  = 0.5f;    //!< グループを簡略化するときの三角形数の比率
+	uint32_t        max_levels = 24;      //!< 元のメッシュを含む最大の段数
+	float           max_error  = FLT_MAX; //!< 許容する誤差 (メッシュの座標系での距離)
+};
+
+//! \brief クラスタの LOD 情報
+struct lod_cluster
+{
+	bounding_sphere bounds;        //!< 誤差を評価する境界球 (自身を作ったグループの境界球)
+	float           error;         //!< 元のメッシュに対する誤差
+	bounding_sphere parent_bounds; //!< 親のグループの境界球
+	float           parent_error;  //!< 親のグループの誤差 (最も粗い段では FLT_MAX)
+	uint32_t        level;         //!< 段 (0 が元のメッシュ)
+};
+
+//! \brief クラスタの DAG
+//!
+//! clusters[i] は meshlets.meshlets[i] の LOD 情報です。カリング用の境界は meshlets.bounds にあります。
+struct cluster_lod_dag
+{
+	meshlet_mesh             meshlets;
+	std::vector<lod_cluster> clusters;
+	uint32_t                 level_count = 0;
+};
+
+//! \brief 三角形リストからクラスタの DAG を作ります
+//!
+//! 段ごとのグループの簡略化とクラスタ分割は pool で並列に処理します。結果は pool の有無とスレッド数に依存しません。
+//!
+//! \param[in] indices   三角形リスト
+//! \param[in] positions 頂点の位置 (positions.count が頂点数)
+//! \param[in] options
+//! \param[in] pool      並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+[[nodiscard]] cluster_lod_dag build_cluster_lod(std::span<const uint16_t> indices, position_view positions, const cluster_lod_options& options = {}, thread_pool* pool = nullptr);
+[[nodiscard]] cluster_lod_dag build_cluster_lod(std::span<const uint32_t> indices, position_view positions, const cluster_lod_options& options = {}, thread_pool* pool = nullptr);
+
+//! \brief ビューに対して描画するクラスタを選びます
+//!
+//! 選んだクラスタは元のメッシュを隙間や重なりなく覆います。視錐台や法線コーンによるカリングは含まないので、
+//! 必要であれば結果のクラスタの meshlets.bounds に対して行います。
+//! selector はメッシュの座標系でのカメラから作ります。
+//!
+//! \param[in]  dag
+//! \param[in]  selector
+//! \param[out] out      選んだクラスタの番号 (昇順)、dag.clusters.size() 要素以上
+//! \return 選んだクラスタ数
+uint32_t select_clusters(const cluster_lod_dag& dag, const lod_selector& selector, std::span<uint32_t> out) noexcept;
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,309 @@
+#include "culling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "debug.h"
+#include "simd.h"
+
+namespace {
+
+using namespace dxlib::math::simd;
+
+// 1 平面あたり (nx, ny, nz, d, |nx|, |ny|, |nz|, -) の 8 float
+constexpr size_t plane_stride = 8;
+constexpr size_t view_stride  = plane_stride * dxlib::scene::frustum::plane_count;
+
+// 出力は最大幅分をまとめて書き込むため、末尾にこの要素数の余白を確保します
+constexpr size_t output_slack = vfloat8_width;
+
+static_assert(sizeof(dxlib::geometry::bounding_sphere) == sizeof(float) * 4);
+static_assert(sizeof(dxlib::geometry::bounding_box) == sizeof(float) * 6);
+
+// V と同じ幅で v を複製します
+inline vfloat4 splat(vfloat4, float v) noexcept
+{
+	return vsplat4(v);
+}
+
+inline vfloat8 splat(vfloat8, float v) noexcept
+{
+	return vsplat8(v);
+}
+
+// 全平面に対する符号付き距離 + 半径の最小値
+template<class V>
+V sphere_distance(const float* planes, V x, V y, V z, V r) noexcept
+{
+	V d = splat(x, FLT_MAX);
+	for (size_t p = 0; p < dxlib::scene::frustum::plane_count; ++p, planes += plane_stride) {
+		V s = vmadd(x, splat(x, planes[0]), splat(x, planes[3]));
+		s   = vmadd(y, splat(x, planes[1]), s);
+		s   = vmadd(z, splat(x, planes[2]), s);
+		d   = vmin(d, vadd(s, r));
+	}
+	return d;
+}
+
+// 全平面に対する中心の符号付き距離 + 射影半径の最小値
+template<class V>
+V box_distance(const float* planes, V cx, V cy, V cz, V ex, V ey, V ez) noexcept
+{
+	V d = splat(cx, FLT_MAX);
+	for (size_t p = 0; p < dxlib::scene::frustum::plane_count; ++p, planes += plane_stride) {
+		V s = vmadd(cx, splat(cx, planes[0]), splat(cx, planes[3]));
+		s   = vmadd(cy, splat(cx, planes[1]), s);
+		s   = vmadd(cz, splat(cx, planes[2]), s);
+		s   = vmadd(ex, splat(cx, planes[4]), s);
+		s   = vmadd(ey, splat(cx, planes[5]), s);
+		s   = vmadd(ez, splat(cx, planes[6]), s);
+		d   = vmin(d, s);
+	}
+	return d;
+}
+
+// mask の立っているレーンのインデックスを分岐なしで詰めて書き込みます (out には width 要素の余白が必要)
+template<size_t Width>
+uint32_t emit(int mask, uint32_t base, uint32_t* out, uint32_t count) noexcept
+{
+	for (uint32_t i = 0; i < Width; ++i) {
+		out[count] = base + i;
+		count += (mask >> i) & 1;
+	}
+	return count;
+}
+
+// n 要素のうち先頭から remain 要素だけ有効なレーンマスク
+constexpr int lane_mask(size_t remain, size_t width) noexcept
+{
+	return remain >= width ? (1 << width) - 1 : (1 << remain) - 1;
+}
+
+float4 normalize_plane(const float4& p) noexcept
+{
+	const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+	if (len < 1e-6f) {
+		return { 0.0f, 0.0f, 0.0f, 1.0f };
+	}
+	const float inv = 1.0f / len;
+	return { p.x * inv, p.y * inv, p.z * inv, p.w * inv };
+}
+
+} // namespace
+
+namespace dxlib {
+namespace scene {
+
+frustum make_frustum(const float4x4& m) noexcept
+{
+	// 行ベクトル規約では clip = v * M なので、各クリップ成分は M の列との内積になります
+	const float4 c0 = { m._00, m._10, m._20, m._30 };
+	const float4 c1 = { m._01, m._11, m._21, m._31 };
+	const float4 c2 = { m._02, m._12, m._22, m._32 };
+	const float4 c3 = { m._03, m._13, m._23, m._33 };
+
+	frustum f;
+	f.planes[frustum::left]   = normalize_plane(c3 + c0);
+	f.planes[frustum::right]  = normalize_plane(c3 - c0);
+	f.planes[frustum::bottom] = normalize_plane(c3 + c1);
+	f.planes[frustum::top]    = normalize_plane(c3 - c1);
+	f.planes[frustum::near_z] = normalize_plane(c2);
+	f.planes[frustum::far_z]  = normalize_plane(c3 - c2);
+	return f;
+}
+
+frustum make_frustum(const camera& cam, float aspect) noexcept
+{
+	const float4x4 view = math::look_at_lh(cam.position, cam.focus, cam.up);
+	const float4x4 proj = math::perspective_fov_lh(cam.fov_y, aspect, cam.near_z, cam.far_z);
+	return make_frustum(view * proj);
+}
+
+void frustum_culler::set_views(std::span<const frustum> views)
+{
+	m_planes.assign(views.size() * view_stride, 0.0f);
+	for (size_t v = 0; v < views.size(); ++v) {
+		for (size_t p = 0; p < frustum::plane_count; ++p) {
+			const float4& src = views[v].planes[p];
+			float*        dst = &m_planes[v * view_stride + p * plane_stride];
+			dst[0]            = src.x;
+			dst[1]            = src.y;
+			dst[2]            = src.z;
+			dst[3]            = src.w;
+			dst[4]            = std::abs(src.x);
+			dst[5]            = std::abs(src.y);
+			dst[6]            = std::abs(src.z);
+		}
+	}
+	m_visible.resize(views.size());
+	m_count.assign(views.size(), 0);
+}
+
+size_t frustum_culler::view_count() const noexcept
+{
+	return m_count.size();
+}
+
+void frustum_culler::prepare(size_t count)
+{
+	ASSERT(count <= UINT32_MAX);
+	for (auto& visible : m_visible) {
+		if (visible.size() < count + output_slack) {
+			visible.resize(count + output_slack);
+		}
+	}
+	std::fill(m_count.begin(), m_count.end(), 0u);
+}
+
+void frustum_culler::cull(std::span<const geometry::bounding_sphere> spheres)
+{
+	prepare(spheres.size());
+
+	const size_t views = view_count();
+	for (size_t i = 0; i < spheres.size(); i += vfloat4_width) {
+		const size_t remain = spheres.size() - i;
+
+		// 端数は 0 埋めしたコピーから読み、レーンマスクで除外します
+		geometry::bounding_sphere        tail[vfloat4_width] = {};
+		const geometry::bounding_sphere* src                 = &spheres[i];
+		if (remain < vfloat4_width) {
+			std::copy_n(src, remain, tail);
+			src = tail;
+		}
+
+		vfloat4 x = vload4(&src[0].center.x);
+		vfloat4 y = vload4(&src[1].center.x);
+		vfloat4 z = vload4(&src[2].center.x);
+		vfloat4 r = vload4(&src[3].center.x);
+		vtranspose(x, y, z, r);
+
+		const int valid = lane_mask(remain, vfloat4_width);
+		for (size_t v = 0; v < views; ++v) {
+			const vfloat4 d = sphere_distance(&m_planes[v * view_stride], x, y, z, r);
+			const int     m = vmask(vcmpge(d, vzero4())) & valid;
+			m_count[v]      = emit<vfloat4_width>(m, static_cast<uint32_t>(i), m_visible[v].data(), m_count[v]);
+		}
+	}
+}
+
+void frustum_culler::cull(const container::soa_vector<geometry::bounding_sphere>& spheres)
+{
+	using traits = container::soa_traits<geometry::bounding_sphere>;
+	cull_spheres(spheres.plane<traits::center, 0>(), spheres.plane<traits::center, 1>(), spheres.plane<traits::center, 2>(), spheres.plane<traits::radius>(), spheres.size());
+}
+
+void frustum_culler::cull(std::span<const geometry::bounding_box> boxes)
+{
+	prepare(boxes.size());
+
+	const size_t views = view_count();
+	const vfloat4 half = vsplat4(0.5f);
+	for (size_t i = 0; i < boxes.size(); i += vfloat4_width) {
+		const size_t remain = boxes.size() - i;
+
+		geometry::bounding_box        tail[vfloat4_width] = {};
+		const geometry::bounding_box* src                 = &boxes[i];
+		if (remain < vfloat4_width) {
+			std::copy_n(src, remain, tail);
+			src = tail;
+		}
+
+		// 4 個の AABB は min, max を交互に並べた float3 x8 として読み、偶数/奇数で分けます
+		vfloat4 x0, y0, z0, x1, y1, z1;
+		vload_aos3(&src[0].min.x, x0, y0, z0);
+		vload_aos3(&src[2].min.x, x1, y1, z1);
+		const vfloat4 min_x = vshuffle<0, 2, 0, 2>(x0, x1);
+		const vfloat4 min_y = vshuffle<0, 2, 0, 2>(y0, y1);
+		const vfloat4 min_z = vshuffle<0, 2, 0, 2>(z0, z1);
+		const vfloat4 max_x = vshuffle<1, 3, 1, 3>(x0, x1);
+		const vfloat4 max_y = vshuffle<1, 3, 1, 3>(y0, y1);
+		const vfloat4 max_z = vshuffle<1, 3, 1, 3>(z0, z1);
+
+		const vfloat4 cx = vmul(vadd(min_x, max_x), half);
+		const vfloat4 cy = vmul(vadd(min_y, max_y), half);
+		const vfloat4 cz = vmul(vadd(min_z, max_z), half);
+		const vfloat4 ex = vmul(vsub(max_x, min_x), half);
+		const vfloat4 ey = vmul(vsub(max_y, min_y), half);
+		const vfloat4 ez = vmul(vsub(max_z, min_z), half);
+
+		const int valid = lane_mask(remain, vfloat4_width);
+		for (size_t v = 0; v < views; ++v) {
+			const vfloat4 d = box_distance(&m_planes[v * view_stride], cx, cy, cz, ex, ey, ez);
+			const int     m = vmask(vcmpge(d, vzero4())) & valid;
+			m_count[v]      = emit<vfloat4_width>(m, static_cast<uint32_t>(i), m_visible[v].data(), m_count[v]);
+		}
+	}
+}
+
+void frustum_culler::cull(const container::soa_vector<geometry::bounding_box>& boxes)
+{
+	using traits = container::soa_traits<geometry::bounding_box>;
+
+	const float* min_x = boxes.plane<traits::min, 0>().data();
+	const float* min_y = boxes.plane<traits::min, 1>().data();
+	const float* min_z = boxes.plane<traits::min, 2>().data();
+	const float* max_x = boxes.plane<traits::max, 0>().data();
+	const float* max_y = boxes.plane<traits::max, 1>().data();
+	const float* max_z = boxes.plane<traits::max, 2>().data();
+
+	prepare(boxes.size());
+
+	const size_t  views = view_count();
+	const vfloat8 half  = vsplat8(0.5f);
+	for (size_t i = 0; i < boxes.size(); i += vfloat8_width) {
+		const vfloat8 x0 = vload8a(min_x + i);
+		const vfloat8 y0 = vload8a(min_y + i);
+		const vfloat8 z0 = vload8a(min_z + i);
+		const vfloat8 x1 = vload8a(max_x + i);
+		const vfloat8 y1 = vload8a(max_y + i);
+		const vfloat8 z1 = vload8a(max_z + i);
+
+		const vfloat8 cx = vmul(vadd(x0, x1), half);
+		const vfloat8 cy = vmul(vadd(y0, y1), half);
+		const vfloat8 cz = vmul(vadd(z0, z1), half);
+		const vfloat8 ex = vmul(vsub(x1, x0), half);
+		const vfloat8 ey = vmul(vsub(y1, y0), half);
+		const vfloat8 ez = vmul(vsub(z1, z0), half);
+
+		// パディング部分は 0 の AABB として原点に存在するため、レーンマスクで除外します
+		const int valid = lane_mask(boxes.size() - i, vfloat8_width);
+		for (size_t v = 0; v < views; ++v) {
+			const vfloat8 d = box_distance(&m_planes[v * view_stride], cx, cy, cz, ex, ey, ez);
+			const int     m = vmask(vcmpge(d, vzero8())) & valid;
+			m_count[v]      = emit<vfloat8_width>(m, static_cast<uint32_t>(i), m_visible[v].data(), m_count[v]);
+		}
+	}
+}
+
+void frustum_culler::cull_spheres(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<const float> radius, size_t count)
+{
+	const size_t padded = (count + vfloat8_width - 1) / vfloat8_width * vfloat8_width;
+	ASSERT_RETURN(x.size() >= padded && y.size() >= padded && z.size() >= padded && radius.size() >= padded);
+
+	prepare(count);
+
+	const size_t views = view_count();
+	for (size_t i = 0; i < count; i += vfloat8_width) {
+		const vfloat8 cx = vload8(x.data() + i);
+		const vfloat8 cy = vload8(y.data() + i);
+		const vfloat8 cz = vload8(z.data() + i);
+		const vfloat8 r  = vload8(radius.data() + i);
+
+		const int valid = lane_mask(count - i, vfloat8_width);
+		for (size_t v = 0; v < views; ++v) {
+			const vfloat8 d = sphere_distance(&m_planes[v * view_stride], cx, cy, cz, r);
+			const int     m = vmask(vcmpge(d, vzero8())) & valid;
+			m_count[v]      = emit<vfloat8_width>(m, static_cast<uint32_t>(i), m_visible[v].data(), m_count[v]);
+		}
+	}
+}
+
+std::span<const uint32_t> frustum_culler::visible(size_t view) const noexcept
+{
+	ASSERT_RETURN(view < m_visible.size(), {});
+	return { m_visible[view].data(), m_count[view] };
+}
+
+} // namespace scene
+} // namespace dxlib
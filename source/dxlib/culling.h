@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bounds.h"
+#include "camera.h"
+#include "matrix.h"
+#include "soa.h"
+#include "vector.h"
+
+namespace dxlib {
+namespace scene {
+
+//! \brief 視錐台
+//!
+//! 各平面は (nx, ny, nz, d) で、法線は内向き・正規化済みです。dot(n, p) + d >= 0 が内側です。
+struct frustum
+{
+	enum : size_t
+	{
+		left,
+		right,
+		bottom,
+		top,
+		near_z,
+		far_z,
+		plane_count,
+	};
+
+	float4 planes[plane_count];
+};
+
+//! \brief ビュー射影行列から視錐台を抽出します (Gribb-Hartmann)
+//!
+//! 深度範囲は D3D と同じ [0, 1] を前提とします。Reverse-Z の射影では near_z と far_z の平面が入れ替わります。
+//! 無限遠の射影などで平面が縮退する場合は常に内側となる平面 (0, 0, 0, 1) を設定します。
+//!
+//! \param[in] view_proj
+//!
+//! \ret frustum
+[[nodiscard]] frustum make_frustum(const float4x4& view_proj) noexcept;
+
+//! \brief カメラから視錐台を作成します
+//!
+//! \param[in] cam
+//! \param[in] aspect 横幅 / 立幅
+//!
+//! \ret frustum
+[[nodiscard]] frustum make_frustum(const camera& cam, float aspect) noexcept;
+
+//! \brief 境界ボリュームの配列を複数の視錐台でまとめてカリングするクラス
+//!
+//! メインカメラとシャドウビューのように複数のビューを 1 回の走査で処理します。
+//! 境界ボリュームは 1 ブロック分を 1 回だけロードし、全ビューの平面と判定します。
+//! 構造体配列 (AoS) の入力は 4 要素ずつ、soa_vector の入力は 8 要素ずつ処理します。
+//! 結果はビューごとの可視インデックスの昇順リストで、次の cull まで有効です。
+class frustum_culler
+{
+public:
+	frustum_culler() = default;
+
+	//! \brief 判定に使用するビューを設定します
+	//!
+	//! \param[in] views
+	void set_views(std::span<const frustum> views);
+
+	//! \brief ビュー数
+	[[nodiscard]] size_t view_count() const noexcept;
+
+	//! \brief 球をカリングします
+	void cull(std::span<const geometry::bounding_sphere> spheres);
+
+	//! \brief 球をカリングします
+	void cull(const container::soa_vector<geometry::bounding_sphere>& spheres);
+
+	//! \brief AABB をカリングします
+	void cull(std::span<const geometry::bounding_box> boxes);
+
+	//! \brief AABB をカリングします
+	void cull(const container::soa_vector<geometry::bounding_box>& boxes);
+
+	//! \brief 成分ごとの配列で表した球をカリングします
+	//!
+	//! soa_vector<point_light> の position / range プレーンのように、球以外の構造体のプレーンを直接渡せます。
+	//! 各配列は count を 8 の倍数に切り上げた長さが必要です。
+	//!
+	//! \param[in] x
+	//! \param[in] y
+	//! \param[in] z
+	//! \param[in] radius
+	//! \param[in] count 要素数
+	void cull_spheres(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<const float> radius, size_t count);
+
+	//! \brief view 番目のビューで可視な要素のインデックス
+	[[nodiscard]] std::span<const uint32_t> visible(size_t view) const noexcept;
+
+private:
+	void prepare(size_t count);
+
+private:
+	// ビューごとの平面 (nx, ny, nz, d) と |n| を 8 float ずつ並べたもの
+	std::vector<float> m_planes;
+
+	std::vector<std::vector<uint32_t>> m_visible;
+	std::vector<uint32_t>              m_count;
+};
+
+} // namespace scene
+} // namespace dxlib
@@ -2,7 +2,10 @@
 
 #include <d3d11.h>
 
+#include <array>
+
 #include "dxgi_api.h"
+#include "vertex_layout.h"
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3dcompiler.lib")
@@ -68,6 +71,8 @@ HRESULT create_sampler_state(
     const D3D11_SAMPLER_DESC* d3d11_sampler_desc,
     ID3D11SamplerState**      d3d11_sampler_state);
 
+// create_*_shader_from_hlsl  .hlsl RpCA.cso (asset_cooker ̏o) ͂̂܂ܓǂݍ݂܂B
+// .cso ̏ꍇ entry_point  shader_model ͎gp܂B
 HRESULT create_vertex_shader_from_hlsl(
     ID3D11Device*        d3d11_device,
     const wchar_t*       filename,
@@ -76,6 +81,33 @@ HRESULT create_vertex_shader_from_hlsl(
     ID3D11VertexShader** d3d11_vertex_shader,
     ID3D11InputLayout**  d3d11_input_layout);
 
+HRESULT create_vertex_shader_from_hlsl(
+    ID3D11Device*                   d3d11_device,
+    const wchar_t*                  filename,
+    const char*                     entry_point,
+    const char*                     shader_model,
+    const D3D11_INPUT_ELEMENT_DESC* d3d11_input_element_descs,
+    UINT                            d3d11_input_element_count,
+    ID3D11VertexShader**            d3d11_vertex_shader,
+    ID3D11InputLayout**             d3d11_input_layout);
+
+template<size_t N>
+std::array<D3D11_INPUT_ELEMENT_DESC, N> make_input_element_descs(
+    const std::array<geometry::vertex_input_element, N>& elements) noexcept
+{
+	std::array<D3D11_INPUT_ELEMENT_DESC, N> descs = {};
+	for (size_t i = 0; i < N; ++i) {
+		descs[i].SemanticName         = geometry::semantic_name(elements[i].semantic);
+		descs[i].SemanticIndex        = 0;
+		descs[i].Format               = geometry::to_dxgi_format(elements[i].format);
+		descs[i].InputSlot            = elements[i].slot;
+		descs[i].AlignedByteOffset    = elements[i].offset;
+		descs[i].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+		descs[i].InstanceDataStepRate = 0;
+	}
+	return descs;
+}
+
 HRESULT create_hull_shader_from_hlsl(
     ID3D11Device*      d3d11_device,
     const wchar_t*     filename,
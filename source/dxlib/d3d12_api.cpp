@@ -7,10 +7,35 @@
 
 namespace {
 
+// RpCς݂̃VF[_[ (asset_cooker ̏o) ǂݍ݂܂
+HRESULT load_compiled_shader(ID3DBlob** blob, const wchar_t* filename)
+{
+	std::unique_ptr<uint8_t[]> data;
+	uint64_t                   size = 0;
+	if (!dxlib::load_file(filename, data, size)) {
+		_LOG_ERROR_MSG(L"%s load failed.\n", filename);
+		return E_FAIL;
+	}
+
+	HRESULT hr = D3DCreateBlob(static_cast<SIZE_T>(size), blob);
+	RETURN_IF_FAILED(hr, hr);
+	memcpy((*blob)->GetBufferPointer(), data.get(), static_cast<size_t>(size));
+
+	return hr;
+}
+
+// gq .cso ̏ꍇ̓RpCɓǂݍ݂܂
+// entry_point  shader_model ͎gp܂ (asset_cooker t@C猈߂lŃRpCς݂ł)
 HRESULT compile_shader(ID3DBlob** blob, const wchar_t* filename, const char* entry_point, const char* shader_model)
 {
 	HRESULT hr = S_OK;
 
+	const size_t length = wcslen(filename);
+	if (length >= 4 && _wcsicmp(filename + length - 4, L".cso") == 0) {
+		return load_compiled_shader(blob, filename);
+	}
+	ASSERT_RETURN(entry_point && shader_model, E_INVALIDARG);
+
 #if defined(_DEBUG)
 	constexpr UINT32 compile_flag = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #else
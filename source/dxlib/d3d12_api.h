@@ -2,9 +2,11 @@
 
 #include <d3d12.h>
 
+#include <array>
 #include <vector>
 
 #include "dxgi_api.h"
+#include "vertex_layout.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "d3dcompiler.lib")
@@ -165,9 +167,9 @@ HRESULT create_graphics_pipeline_state(
 //! \brief _VF[_[̍쐬
 //!
 //! \param[in] d3d12_device
-//! \param[in] filename
-//! \param[in] entry_point
-//! \param[in] shader_model
+//! \param[in] filename     .hlsl ̓RpCA.cso (asset_cooker ̏o) ͂̂܂ܓǂݍ݂܂
+//! \param[in] entry_point  .cso ̏ꍇ͎gp܂
+//! \param[in] shader_model .cso ̏ꍇ͎gp܂
 //! \param[out] d3d12_vertex_shader
 //!
 //! \ret HRESULT
@@ -196,12 +198,36 @@ HRESULT create_vertex_shader_from_hlsl(
     D3D12_INPUT_ELEMENT_DESCS& d3d12_input_element_descs = nullptr);
 #endif
 
+//! \brief ͗vf̍쐬
+//!
+//! ʒuǂރpX ([xvpXAVhE) ł geometry::position_input_elements<V>() n܂B
+//!
+//! \param[in] elements geometry::input_elements<V>(streams) ̌
+//!
+//! \ret D3D12_GRAPHICS_PIPELINE_STATE_DESC::InputLayout ɐݒ肷͗vf
+template<size_t N>
+std::array<D3D12_INPUT_ELEMENT_DESC, N> make_input_element_descs(
+    const std::array<geometry::vertex_input_element, N>& elements) noexcept
+{
+	std::array<D3D12_INPUT_ELEMENT_DESC, N> descs = {};
+	for (size_t i = 0; i < N; ++i) {
+		descs[i].SemanticName         = geometry::semantic_name(elements[i].semantic);
+		descs[i].SemanticIndex        = 0;
+		descs[i].Format               = geometry::to_dxgi_format(elements[i].format);
+		descs[i].InputSlot            = elements[i].slot;
+		descs[i].AlignedByteOffset    = elements[i].offset;
+		descs[i].InputSlotClass       = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+		descs[i].InstanceDataStepRate = 0;
+	}
+	return descs;
+}
+
 //! \brief sNZVF[_[̍쐬
 //!
 //! \param[in] d3d12_device
-//! \param[in] filename
-//! \param[in] entry_point
-//! \param[in] shader_model
+//! \param[in] filename     .hlsl ̓RpCA.cso (asset_cooker ̏o) ͂̂܂ܓǂݍ݂܂
+//! \param[in] entry_point  .cso ̏ꍇ͎gp܂
+//! \param[in] shader_model .cso ̏ꍇ͎gp܂
 //! \param[out] d3d12_pixel_shader
 //!
 //! \ret HRESULT
@@ -0,0 +1,324 @@
+﻿#pragma once
+
+#include "math.h"
+#include "simd.h"
+
+// 多項式近似による高速な数学関数
+//
+// いずれも vfloat4 / vfloat8 版とスカラー版があり、スカラー版は vfloat4 版の 1 要素目を返します。
+// そのため幅によらず同じ入力には同じ結果を返します (FMA の有無による差は除きます)。
+// 誤差は倍精度の <cmath> の結果との差を float の ULP で表したもので、記載の範囲を検査した最大値を切り上げています。
+// NaN や範囲外の入力に対する挙動は関数ごとに記載しています。
+namespace dxlib {
+namespace math {
+namespace fast {
+
+namespace detail {
+
+using namespace dxlib::math::simd;
+
+inline vfloat4 splat(vfloat4, float v) noexcept
+{
+	return vsplat4(v);
+}
+
+inline vfloat8 splat(vfloat8, float v) noexcept
+{
+	return vsplat8(v);
+}
+
+//! \brief x を π/2 の倍数 q と残り r (|r| <= π/4) に分解します
+//!
+//! q は 0 ~ 3 に畳み込んだ値を返します。
+template<class V>
+inline void reduce_half_pi(V x, V& r, V& q) noexcept
+{
+	// π/2 を 3 分割した Cody-Waite 法です。上位 2 つは仮数部が短いので、FMA が無くても |x| <= 8192 で n * dp が厳密になります
+	const V n = vround(vmul(x, splat(x, 0.636619772367581343f)));
+	r         = vnmadd(n, splat(x, 1.5703125f), x);
+	r         = vnmadd(n, splat(x, 4.837512969970703125e-4f), r);
+	r         = vnmadd(n, splat(x, 7.54978995489188216e-8f), r);
+
+	// n mod 4 (n - 4 * floor(n / 4))。n / 4 の小数部は 0, 0.25, 0.5, 0.75 なので丸めの境界に乗りません
+	q = vnmadd(vround(vsub(vmul(n, splat(x, 0.25f)), splat(x, 0.375f))), splat(x, 4.0f), n);
+}
+
+//! \brief |r| <= π/4 の sin
+template<class V>
+inline V sin_poly(V r, V z) noexcept
+{
+	V p = vmadd(splat(r, -1.9515295891e-4f), z, splat(r, 8.3321608736e-3f));
+	p   = vmadd(p, z, splat(r, -1.6666654611e-1f));
+	return vmadd(vmul(p, z), r, r);
+}
+
+//! \brief |r| <= π/4 の cos
+template<class V>
+inline V cos_poly(V z) noexcept
+{
+	V p = vmadd(splat(z, 2.443315711809948e-5f), z, splat(z, -1.388731625493765e-3f));
+	p   = vmadd(p, z, splat(z, 4.166664568298827e-2f));
+	return vmadd(vmul(p, z), z, vnmadd(splat(z, 0.5f), z, splat(z, 1.0f)));
+}
+
+template<class V>
+inline void sincos(V x, V& s, V& c) noexcept
+{
+	V r, q;
+	reduce_half_pi(x, r, q);
+
+	const V z     = vmul(r, r);
+	const V ps    = sin_poly(r, z);
+	const V pc    = cos_poly(z);
+	const V sign  = splat(x, -0.0f);
+	const V half  = splat(x, 0.5f);
+	const V odd   = vcmpge(vnmadd(vround(vsub(vmul(q, half), splat(x, 0.25f))), splat(x, 2.0f), q), half);
+	const V s_neg = vcmpge(q, splat(x, 1.5f));
+	const V c_neg = vand(vcmpge(q, half), vcmplt(q, splat(x, 2.5f)));
+
+	s = vxor(vselect(odd, pc, ps), vand(s_neg, sign));
+	c = vxor(vselect(odd, ps, pc), vand(c_neg, sign));
+}
+
+//! \brief 0 <= x の atan
+template<class V>
+inline V atan_positive(V x) noexcept
+{
+	const V one  = splat(x, 1.0f);
+	const V big  = vcmplt(splat(x, 2.414213562373095f), x);
+	const V mid  = vcmplt(splat(x, 0.414213562373095f), x);
+	const V base = vselect(big, splat(x, pi<float> * 0.5f), vand(mid, splat(x, pi<float> * 0.25f)));
+
+	// tan(3π/8) より大きければ -1 / x、tan(π/8) より大きければ (x - 1) / (x + 1) に縮小します
+	const V num = vselect(big, vneg(one), vselect(mid, vsub(x, one), x));
+	const V den = vselect(big, x, vselect(mid, vadd(x, one), one));
+	const V t   = vdiv(num, den);
+
+	const V z = vmul(t, t);
+	V       p = vmadd(splat(x, 8.05374449538e-2f), z, splat(x, -1.38776856032e-1f));
+	p         = vmadd(p, z, splat(x, 1.99777106478e-1f));
+	p         = vmadd(p, z, splat(x, -3.33329491539e-1f));
+	return vadd(base, vmadd(vmul(p, z), t, t));
+}
+
+template<class V>
+inline V atan(V x) noexcept
+{
+	const V sign = vand(x, splat(x, -0.0f));
+	return vxor(atan_positive(vxor(x, sign)), sign);
+}
+
+template<class V>
+inline V atan2(V y, V x) noexcept
+{
+	const V sign = splat(x, -0.0f);
+	const V ax   = vabs(x);
+	const V ay   = vabs(y);
+	const V lo   = vmin(ax, ay);
+	const V hi   = vmax(ax, ay);
+
+	// (0, 0) は 0 / 0 の NaN をマスクで落として 0 を返します
+	V a = atan_positive(vand(vdiv(lo, hi), vcmplt(splat(x, 0.0f), hi)));
+	a   = vselect(vcmplt(ax, ay), vsub(splat(x, pi<float> * 0.5f), a), a);
+	a   = vselect(vcmplt(x, splat(x, 0.0f)), vsub(splat(x, pi<float>), a), a);
+	return vxor(a, vand(y, sign));
+}
+
+template<class V>
+inline V exp(V x) noexcept
+{
+	// 上限は結果が無限大に、下限は 0 に丸められる値です。NaN は vmin / vmax を通して伝搬させます
+	x = vmax(splat(x, -104.0f), vmin(splat(x, 89.0f), x));
+
+	const V n = vround(vmul(x, splat(x, 1.44269504088896341f)));
+	V       r = vnmadd(n, splat(x, 0.693359375f), x);
+	r         = vnmadd(n, splat(x, -2.12194440e-4f), r);
+
+	const V z = vmul(r, r);
+	V       p = vmadd(splat(x, 1.9875691500e-4f), r, splat(x, 1.3981999507e-3f));
+	p         = vmadd(p, r, splat(x, 8.3334519073e-3f));
+	p         = vmadd(p, r, splat(x, 4.1665795894e-2f));
+	p         = vmadd(p, r, splat(x, 1.6666665459e-1f));
+	p         = vmadd(p, r, splat(x, 5.0000001201e-1f));
+	p         = vadd(vmadd(p, z, r), splat(x, 1.0f));
+
+	// 2^n を 2 つに分けて掛けることで、n = 128 (オーバーフロー) や非正規化数の結果も正しく丸めます
+	const V h = vround(vmul(n, splat(x, 0.5f)));
+	return vmul(vmul(p, vpow2i(h)), vpow2i(vsub(n, h)));
+}
+
+template<class V>
+inline V rsqrt(V x) noexcept
+{
+	// Newton 法を 1 回適用します。x * e を先に求めて FLT_MIN 付近でも非正規化数を経由しないようにします
+	// 推定値が 0 か無限大 (x が無限大か 0 以下) のときは推定値をそのまま返します
+	const V e     = vrsqrt_est(x);
+	const V t     = vmul(vmul(x, e), e);
+	const V r     = vmul(e, vnmadd(t, splat(x, 0.5f), splat(x, 1.5f)));
+	const V valid = vand(vcmplt(splat(x, 0.0f), e), vcmplt(e, splat(x, std::numeric_limits<float>::infinity())));
+	return vselect(valid, r, e);
+}
+
+} // namespace detail
+
+// --- vfloat4 / vfloat8 ---
+
+//! \brief 1 / sqrt(x)
+//!
+//! 正規化数に対して最大誤差 4 ULP。0 は +inf、+inf は 0、負数と NaN は NaN を返します。
+//! SSE / AVX では非正規化数も 0 として扱います。
+inline simd::vfloat4 rsqrt(simd::vfloat4 x) noexcept
+{
+	return detail::rsqrt(x);
+}
+
+//! \copydoc rsqrt(simd::vfloat4)
+inline simd::vfloat8 rsqrt(simd::vfloat8 x) noexcept
+{
+	return detail::rsqrt(x);
+}
+
+//! \brief sin(x) と cos(x)
+//!
+//! |x| <= π で最大誤差 2 ULP、|x| <= 8192 で絶対誤差 1e-7 以下。それより大きな値は範囲縮小の精度が落ちます。
+//! NaN は NaN を返します。
+inline void sincos(simd::vfloat4 x, simd::vfloat4& s, simd::vfloat4& c) noexcept
+{
+	detail::sincos(x, s, c);
+}
+
+//! \copydoc sincos(simd::vfloat4, simd::vfloat4&, simd::vfloat4&)
+inline void sincos(simd::vfloat8 x, simd::vfloat8& s, simd::vfloat8& c) noexcept
+{
+	detail::sincos(x, s, c);
+}
+
+//! \brief sin(x)
+//!
+//! 範囲と誤差は sincos と同じです。
+inline simd::vfloat4 sin(simd::vfloat4 x) noexcept
+{
+	simd::vfloat4 s, c;
+	detail::sincos(x, s, c);
+	return s;
+}
+
+//! \copydoc sin(simd::vfloat4)
+inline simd::vfloat8 sin(simd::vfloat8 x) noexcept
+{
+	simd::vfloat8 s, c;
+	detail::sincos(x, s, c);
+	return s;
+}
+
+//! \brief cos(x)
+//!
+//! 範囲と誤差は sincos と同じです。
+inline simd::vfloat4 cos(simd::vfloat4 x) noexcept
+{
+	simd::vfloat4 s, c;
+	detail::sincos(x, s, c);
+	return c;
+}
+
+//! \copydoc cos(simd::vfloat4)
+inline simd::vfloat8 cos(simd::vfloat8 x) noexcept
+{
+	simd::vfloat8 s, c;
+	detail::sincos(x, s, c);
+	return c;
+}
+
+//! \brief atan(x)
+//!
+//! 全範囲で最大誤差 3 ULP。±inf は ±π/2、NaN は NaN を返します。
+inline simd::vfloat4 atan(simd::vfloat4 x) noexcept
+{
+	return detail::atan(x);
+}
+
+//! \copydoc atan(simd::vfloat4)
+inline simd::vfloat8 atan(simd::vfloat8 x) noexcept
+{
+	return detail::atan(x);
+}
+
+//! \brief atan2(y, x)
+//!
+//! 正規化数の入力に対して最大誤差 4 ULP。(0, 0) は ±0 を返し、x の符号付きゼロは区別しません。
+//! 無限大と NaN の入力は未対応です。
+inline simd::vfloat4 atan2(simd::vfloat4 y, simd::vfloat4 x) noexcept
+{
+	return detail::atan2(y, x);
+}
+
+//! \copydoc atan2(simd::vfloat4, simd::vfloat4)
+inline simd::vfloat8 atan2(simd::vfloat8 y, simd::vfloat8 x) noexcept
+{
+	return detail::atan2(y, x);
+}
+
+//! \brief exp(x)
+//!
+//! 正規化数の結果に対して最大誤差 2 ULP。x > 88.73 は +inf、x < -104 は 0、NaN は NaN を返します。
+inline simd::vfloat4 exp(simd::vfloat4 x) noexcept
+{
+	return detail::exp(x);
+}
+
+//! \copydoc exp(simd::vfloat4)
+inline simd::vfloat8 exp(simd::vfloat8 x) noexcept
+{
+	return detail::exp(x);
+}
+
+// --- scalar ---
+
+//! \copydoc rsqrt(simd::vfloat4)
+inline float rsqrt(float x) noexcept
+{
+	return simd::vget_x(rsqrt(simd::vsplat4(x)));
+}
+
+//! \copydoc sincos(simd::vfloat4, simd::vfloat4&, simd::vfloat4&)
+inline void sincos(float x, float& s, float& c) noexcept
+{
+	simd::vfloat4 vs, vc;
+	detail::sincos(simd::vsplat4(x), vs, vc);
+	s = simd::vget_x(vs);
+	c = simd::vget_x(vc);
+}
+
+//! \copydoc sin(simd::vfloat4)
+inline float sin(float x) noexcept
+{
+	return simd::vget_x(sin(simd::vsplat4(x)));
+}
+
+//! \copydoc cos(simd::vfloat4)
+inline float cos(float x) noexcept
+{
+	return simd::vget_x(cos(simd::vsplat4(x)));
+}
+
+//! \copydoc atan(simd::vfloat4)
+inline float atan(float x) noexcept
+{
+	return simd::vget_x(atan(simd::vsplat4(x)));
+}
+
+//! \copydoc atan2(simd::vfloat4, simd::vfloat4)
+inline float atan2(float y, float x) noexcept
+{
+	return simd::vget_x(atan2(simd::vsplat4(y), simd::vsplat4(x)));
+}
+
+//! \copydoc exp(simd::vfloat4)
+inline float exp(float x) noexcept
+{
+	return simd::vget_x(exp(simd::vsplat4(x)));
+}
+
+} // namespace fast
+} // namespace math
+} // namespace dxlib
@@ -1,32 +1,331 @@
 #include "file.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "asset_archive.h"
 #include "debug.h"
 
+namespace {
+
+using dxlib::native_file_handle;
+
+#if defined(_WIN32)
+const native_file_handle invalid_handle = INVALID_HANDLE_VALUE;
+#else
+constexpr native_file_handle invalid_handle = -1;
+#endif
+
+bool open_native(const wchar_t* filename, bool sequential, native_file_handle& handle, uint64_t& size) noexcept
+{
+#if defined(_WIN32)
+	handle = CreateFileW(
+	    filename,
+	    GENERIC_READ,
+	    FILE_SHARE_READ,
+	    nullptr,
+	    OPEN_EXISTING,
+	    FILE_ATTRIBUTE_NORMAL | (sequential ? FILE_FLAG_SEQUENTIAL_SCAN : 0),
+	    nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(handle, &file_size)) {
+		CloseHandle(handle);
+		handle = INVALID_HANDLE_VALUE;
+		return false;
+	}
+	size = static_cast<uint64_t>(file_size.QuadPart);
+#else
+	const std::filesystem::path path(filename);
+	handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (handle < 0) {
+		return false;
+	}
+	struct stat st = {};
+	if (fstat(handle, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(handle);
+		handle = -1;
+		return false;
+	}
+	size = static_cast<uint64_t>(st.st_size);
+	if (sequential) {
+		posix_fadvise(handle, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+#endif
+	return true;
+}
+
+void close_native(native_file_handle handle) noexcept
+{
+#if defined(_WIN32)
+	CloseHandle(handle);
+#else
+	::close(handle);
+#endif
+}
+
+// 1 回のシステムコールで読む最大のバイト数
+constexpr size_t max_read_size = size_t(1) << 30;
+
+size_t read_native_at(native_file_handle handle, uint64_t offset, uint8_t* buffer, size_t size) noexcept
+{
+	size_t total = 0;
+	while (total < size) {
+		const size_t request = std::min(size - total, max_read_size);
+#if defined(_WIN32)
+		OVERLAPPED overlapped = {};
+		overlapped.Offset     = static_cast<DWORD>(offset + total);
+		overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+		DWORD read            = 0;
+		if (!ReadFile(handle, buffer + total, static_cast<DWORD>(request), &read, &overlapped)) {
+			return GetLastError() == ERROR_HANDLE_EOF ? total : 0;
+		}
+#else
+		const ssize_t read = pread(handle, buffer + total, request, static_cast<off_t>(offset + total));
+		if (read < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return 0;
+		}
+#endif
+		if (read == 0) {
+			break;
+		}
+		total += static_cast<size_t>(read);
+	}
+	return total;
+}
+
+} // namespace
+
 namespace dxlib {
 
+bool load_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint64_t& file_size)
+{
+	switch (load_archived_file(filename, file_data, file_size)) {
+	case archive_load_result::loaded:
+		return true;
+	case archive_load_result::failed:
+		return false;
+	default:
+		break;
+	}
+
+	file_reader reader;
+	if (!reader.open(filename)) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
+		return false;
+	}
+	if (reader.size() > SIZE_MAX) {
+		_LOG_ERROR_MSG(L"%s is too large.\n", filename);
+		return false;
+	}
+
+	const auto size = static_cast<size_t>(reader.size());
+	auto       data = std::make_unique_for_overwrite<uint8_t[]>(size);
+	if (reader.read_at(0, std::span<uint8_t>(data.get(), size)) != size) {
+		_LOG_ERROR_MSG(L"%s read failed.\n", filename);
+		return false;
+	}
+
+	file_data = std::move(data);
+	file_size = size;
+
+	return true;
+}
+
 bool load_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint32_t& file_size)
 {
-	std::ifstream ifs;
-	ifs.open(filename, std::ifstream::in | std::ifstream::binary);
-	if (ifs.fail()) {
-		ifs.close();
+	std::unique_ptr<uint8_t[]> data;
+	uint64_t                   size = 0;
+	if (!load_file(filename, data, size)) {
+		return false;
+	}
+	if (size > UINT32_MAX) {
+		_LOG_ERROR_MSG(L"%s is too large.\n", filename);
+		return false;
+	}
+
+	file_data = std::move(data);
+	file_size = static_cast<uint32_t>(size);
+
+	return true;
+}
+
+// --- mapped_file ---
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_open(std::exchange(other.m_open, false))
+{
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+	if (this != &other) {
+		close();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_open = std::exchange(other.m_open, false);
+	}
+	return *this;
+}
+
+bool mapped_file::open(const wchar_t* filename, bool sequential)
+{
+	close();
+
+	native_file_handle handle = invalid_handle;
+	uint64_t           size   = 0;
+	if (!open_native(filename, sequential, handle, size)) {
 		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
 		return false;
 	}
+	if (size > SIZE_MAX) {
+		close_native(handle);
+		_LOG_ERROR_MSG(L"%s is too large.\n", filename);
+		return false;
+	}
+
+	// 空のファイルはマップできないので、マップせずに成功とします
+	const void* data = nullptr;
+	if (size > 0) {
+#if defined(_WIN32)
+		// ビューがマッピングを参照するので、ハンドルはマップ後すぐに閉じられます
+		HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+#else
+		data = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, handle, 0);
+		if (data == MAP_FAILED) {
+			data = nullptr;
+		}
+		else if (sequential) {
+			madvise(const_cast<void*>(data), static_cast<size_t>(size), MADV_SEQUENTIAL);
+		}
+#endif
+	}
+	close_native(handle);
+
+	if (size > 0 && !data) {
+		_LOG_ERROR_MSG(L"%s map failed.\n", filename);
+		return false;
+	}
+
+	m_data = static_cast<const uint8_t*>(data);
+	m_size = size;
+	m_open = true;
+	return true;
+}
+
+void mapped_file::close() noexcept
+{
+	if (m_data) {
+#if defined(_WIN32)
+		UnmapViewOfFile(m_data);
+#else
+		munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+#endif
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
 
-	ifs.seekg(0, std::ios_base::end);
-	auto cso_size = static_cast<uint32_t>(ifs.tellg());
-	ifs.seekg(0, std::ios_base::beg);
+// --- file_reader ---
 
-	auto cso_data = std::make_unique<uint8_t[]>(cso_size);
-	ifs.read(reinterpret_cast<char*>(cso_data.get()), cso_size);
+file_reader::~file_reader()
+{
+	close();
+}
 
-	file_data = std::move(cso_data);
-	file_size = cso_size;
+file_reader::file_reader(file_reader&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, invalid_handle))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_position(std::exchange(other.m_position, 0))
+    , m_open(std::exchange(other.m_open, false))
+{
+}
 
+file_reader& file_reader::operator=(file_reader&& other) noexcept
+{
+	if (this != &other) {
+		close();
+		m_handle   = std::exchange(other.m_handle, invalid_handle);
+		m_size     = std::exchange(other.m_size, 0);
+		m_position = std::exchange(other.m_position, 0);
+		m_open     = std::exchange(other.m_open, false);
+	}
+	return *this;
+}
+
+bool file_reader::open(const wchar_t* filename)
+{
+	close();
+
+	if (!open_native(filename, true, m_handle, m_size)) {
+		m_handle = invalid_handle;
+		return false;
+	}
+	m_position = 0;
+	m_open     = true;
 	return true;
 }
 
+void file_reader::close() noexcept
+{
+	if (m_open) {
+		close_native(m_handle);
+	}
+	m_handle   = invalid_handle;
+	m_size     = 0;
+	m_position = 0;
+	m_open     = false;
+}
+
+size_t file_reader::read(std::span<uint8_t> buffer) noexcept
+{
+	const size_t n = read_at(m_position, buffer);
+	m_position += n;
+	return n;
+}
+
+size_t file_reader::read_at(uint64_t offset, std::span<uint8_t> buffer) const noexcept
+{
+	ASSERT_RETURN(m_open, 0);
+
+	if (offset >= m_size) {
+		return 0;
+	}
+	const uint64_t rest = m_size - offset;
+	const size_t   size = rest < buffer.size() ? static_cast<size_t>(rest) : buffer.size();
+	return read_native_at(m_handle, offset, buffer.data(), size);
+}
+
 } // namespace dxlib
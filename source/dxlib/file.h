@@ -1,9 +1,188 @@
-#pragma once
+﻿#pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 
 namespace dxlib {
 
-bool load_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& filedata, uint32_t& filesize);
+// ファイルの読み込み
+//
+// - load_file   : ファイル全体をヒープに確保してコピーします
+// - mapped_file : ファイルを読み取り専用でメモリにマップします (コピーなし、ページは最初に触れたときに読まれます)
+// - file_reader : 呼び出し側のバッファにチャンク単位で読みます (大きなファイルを一定のメモリで処理できます)
+// サイズとオフセットは全て 64 ビットです。
+// load_file は mount_archive でマウントしたアーカイブ (asset_archive.h) をディスクより先に探します。
 
-}
\ No newline at end of file
+#if defined(_WIN32)
+using native_file_handle = void*; //!< HANDLE
+#else
+using native_file_handle = int; //!< ファイルディスクリプタ
+#endif
+
+//! \brief ファイル全体を読み込みます
+//!
+//! \param[in]  filename
+//! \param[out] file_data
+//! \param[out] file_size
+//! \return 開けない場合、読み込みに失敗した場合は false
+bool load_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint64_t& file_size);
+
+//! \copydoc load_file(const wchar_t*, std::unique_ptr<uint8_t[]>&, uint64_t&)
+//!
+//! 4 GB 以上のファイルは false を返します。
+bool load_file(const wchar_t* filename, std::unique_ptr<uint8_t[]>& file_data, uint32_t& file_size);
+
+//! \brief 読み取り専用でメモリにマップしたファイル
+//!
+//! Linux では mmap、Windows では CreateFileMapping / MapViewOfFile を使います。
+//! マップした後はファイルハンドルを閉じるので、開いたままのハンドルは残りません。
+//! マップした内容は close (デストラクタ) まで有効です。
+class mapped_file
+{
+public:
+	mapped_file() = default;
+
+	~mapped_file();
+
+	mapped_file(mapped_file&& other) noexcept;
+
+	mapped_file& operator=(mapped_file&& other) noexcept;
+
+	mapped_file(const mapped_file&) = delete;
+
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	//! \brief ファイルをマップします
+	//!
+	//! 空のファイルは data() が nullptr、size() が 0 の状態で成功します。
+	//!
+	//! \param[in] filename
+	//! \param[in] sequential 先頭から順に読む場合は true (先読みを促します)
+	//! \return 開けない場合、マップに失敗した場合は false
+	bool open(const wchar_t* filename, bool sequential = false);
+
+	//! \brief マップを解除してファイルを閉じます
+	void close() noexcept;
+
+	[[nodiscard]] bool is_open() const noexcept
+	{
+		return m_open;
+	}
+
+	[[nodiscard]] const uint8_t* data() const noexcept
+	{
+		return m_data;
+	}
+
+	[[nodiscard]] uint64_t size() const noexcept
+	{
+		return m_size;
+	}
+
+	//! \brief ファイル全体
+	[[nodiscard]] std::span<const uint8_t> span() const noexcept
+	{
+		return { m_data, static_cast<size_t>(m_size) };
+	}
+
+private:
+	const uint8_t* m_data = nullptr;
+	uint64_t       m_size = 0;
+	bool           m_open = false;
+};
+
+//! \brief 呼び出し側のバッファにチャンク単位で読むファイル
+class file_reader
+{
+public:
+	file_reader() = default;
+
+	~file_reader();
+
+	file_reader(file_reader&& other) noexcept;
+
+	file_reader& operator=(file_reader&& other) noexcept;
+
+	file_reader(const file_reader&) = delete;
+
+	file_reader& operator=(const file_reader&) = delete;
+
+	//! \brief ファイルを開きます
+	//!
+	//! \param[in] filename
+	//! \return 開けない場合は false
+	bool open(const wchar_t* filename);
+
+	//! \brief ファイルを閉じます
+	void close() noexcept;
+
+	[[nodiscard]] bool is_open() const noexcept
+	{
+		return m_open;
+	}
+
+	//! \brief ファイルのバイトサイズ
+	[[nodiscard]] uint64_t size() const noexcept
+	{
+		return m_size;
+	}
+
+	//! \brief 次に read で読む位置
+	[[nodiscard]] uint64_t position() const noexcept
+	{
+		return m_position;
+	}
+
+	//! \brief 次に read で読む位置を設定します
+	void seek(uint64_t position) noexcept
+	{
+		m_position = position < m_size ? position : m_size;
+	}
+
+	//! \brief 現在の位置から buffer に読み、位置を進めます
+	//!
+	//! \return 読んだバイト数 (ファイル末尾では buffer.size() 未満、エラーの場合は 0)
+	size_t read(std::span<uint8_t> buffer) noexcept;
+
+	//! \brief offset から buffer に読みます (位置は変わりません)
+	//!
+	//! 位置を共有しないので、同じ file_reader に対して複数のスレッドから呼び出せます。
+	//!
+	//! \return 読んだバイト数 (ファイル末尾では buffer.size() 未満、エラーの場合は 0)
+	size_t read_at(uint64_t offset, std::span<uint8_t> buffer) const noexcept;
+
+	//! \brief 現在の位置から末尾まで buffer 単位で読み、読んだチャンクごとに fn(std::span<const uint8_t>) を呼びます
+	//!
+	//! \return 末尾まで読んだ場合は true、読み込みに失敗した場合や fn が false を返した場合は false
+	template<class Fn>
+	bool for_each_chunk(std::span<uint8_t> buffer, Fn&& fn)
+	{
+		while (m_position < m_size) {
+			const size_t n = read(buffer);
+			if (n == 0 || !fn(std::span<const uint8_t>(buffer.data(), n))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//! \brief OS のファイルハンドル
+	[[nodiscard]] native_file_handle native_handle() const noexcept
+	{
+		return m_handle;
+	}
+
+private:
+#if defined(_WIN32)
+	native_file_handle m_handle = nullptr;
+#else
+	native_file_handle m_handle = -1;
+#endif
+	uint64_t m_size     = 0;
+	uint64_t m_position = 0;
+	bool     m_open     = false;
+};
+
+} // namespace dxlib
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstdint>
+
+namespace dxlib {
+namespace math {
+
+// IEEE 754 binary16 (半精度浮動小数点数) との変換
+//
+// 丸めは最近接偶数丸めで、範囲外の値は無限大になります。
+// NaN は quiet NaN になり、ペイロードは仮数部の上位ビットが残ります (float_to_half では下位 13 ビットを切り捨てます)。
+// NaN を含め、DXGI_FORMAT_R16*_FLOAT や F16C 命令と同じビット列を返します。
+
+//! \brief float を半精度のビット列に変換します
+[[nodiscard]] constexpr uint16_t float_to_half(float f) noexcept
+{
+	const uint32_t bits = std::bit_cast<uint32_t>(f);
+	const uint32_t sign = (bits >> 16) & 0x8000u;
+	const uint32_t abs  = bits & 0x7fffffffu;
+
+	// NaN / 無限大 / 半精度の最大値を超える値
+	if (abs >= 0x47800000u) {
+		const uint32_t nan = abs > 0x7f800000u ? 0x0200u | ((abs >> 13) & 0x03ffu) : 0u;
+		return static_cast<uint16_t>(sign | 0x7c00u | nan);
+	}
+
+	// 非正規化数: 仮数部を揃える加算で丸めます
+	if (abs < 0x38800000u) {
+		const float    magic = std::bit_cast<float>(((127u - 15u) + (23u - 10u) + 1u) << 23);
+		const uint32_t r     = std::bit_cast<uint32_t>(std::bit_cast<float>(abs) + magic) - std::bit_cast<uint32_t>(magic);
+		return static_cast<uint16_t>(sign | r);
+	}
+
+	// 正規化数: 指数部を付け替え、仮数部の最下位ビットが奇数なら切り上げ側に寄せます
+	const uint32_t odd = (abs >> 13) & 1u;
+	return static_cast<uint16_t>(sign | ((abs + 0xc8000fffu + odd) >> 13));
+}
+
+//! \brief 半精度のビット列を float に変換します
+[[nodiscard]] constexpr float half_to_float(uint16_t h) noexcept
+{
+	const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+	const uint32_t abs  = h & 0x7fffu;
+
+	// 指数部を 2^(127-15) 倍で補正すると非正規化数も正しく変換されます
+	const float magic  = std::bit_cast<float>((254u - 15u) << 23);
+	uint32_t    result = std::bit_cast<uint32_t>(std::bit_cast<float>(abs << 13) * magic);
+	if (abs >= 0x7c00u) {
+		result |= 0xffu << 23;
+	}
+	if (abs > 0x7c00u) {
+		result |= 0x00400000u; // quiet NaN
+	}
+	return std::bit_cast<float>(result | sign);
+}
+
+} // namespace math
+} // namespace dxlib
@@ -0,0 +1,69 @@
+#include "index_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "debug.h"
+
+namespace dxlib {
+namespace geometry {
+
+index_format select_index_format(std::span<const uint32_t> indices, uint32_t& base_vertex) noexcept
+{
+	if (indices.empty()) {
+		base_vertex = 0;
+		return index_format::uint16;
+	}
+	const auto [min, max] = std::minmax_element(indices.begin(), indices.end());
+	base_vertex           = *min;
+	return *max - *min <= std::numeric_limits<uint16_t>::max() ? index_format::uint16 : index_format::uint32;
+}
+
+mesh_index_buffer build_index_buffer(std::span<const uint32_t> indices, std::span<const index_range> submeshes)
+{
+	mesh_index_buffer buffer;
+	buffer.submeshes.resize(submeshes.size());
+
+	// 先に配置を決めてからまとめて確保します
+	size_t size = 0;
+	for (size_t i = 0; i < submeshes.size(); ++i) {
+		const index_range& range = submeshes[i];
+		ASSERT_RETURN(range.offset + size_t(range.count) <= indices.size(), {});
+
+		uint32_t   base   = 0;
+		const auto format = select_index_format(indices.subspan(range.offset, range.count), base);
+		ASSERT_RETURN(format == index_format::uint32 || base <= static_cast<uint32_t>(std::numeric_limits<int32_t>::max()), {});
+
+		index_submesh& sub = buffer.submeshes[i];
+		sub.format         = format;
+		sub.byte_offset    = static_cast<uint32_t>(size);
+		sub.index_count    = range.count;
+		sub.base_vertex    = format == index_format::uint16 ? static_cast<int32_t>(base) : 0;
+
+		// 次の部分メッシュが uint32 でも揃うように 4 バイト境界に合わせます
+		size = (size + size_t(range.count) * index_size(format) + 3) & ~size_t(3);
+	}
+	ASSERT_RETURN(size <= std::numeric_limits<uint32_t>::max(), {});
+	buffer.data.resize(size);
+
+	for (size_t i = 0; i < submeshes.size(); ++i) {
+		const index_range&   range = submeshes[i];
+		const index_submesh& sub   = buffer.submeshes[i];
+		uint8_t*             out   = buffer.data.data() + sub.byte_offset;
+		if (sub.format == index_format::uint16) {
+			const uint32_t base = static_cast<uint32_t>(sub.base_vertex);
+			for (uint32_t k = 0; k < range.count; ++k) {
+				const uint16_t index = static_cast<uint16_t>(indices[range.offset + k] - base);
+				std::memcpy(out + k * sizeof(uint16_t), &index, sizeof(uint16_t));
+			}
+		}
+		else {
+			std::memcpy(out, indices.data() + range.offset, range.count * sizeof(uint32_t));
+		}
+	}
+	return buffer;
+}
+
+} // namespace geometry
+} // namespace dxlib
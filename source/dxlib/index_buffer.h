@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(_ENABLE_D3D11) || defined(_ENABLE_D3D12) || __has_include(<dxgiformat.h>)
+#include <dxgiformat.h>
+#endif
+
+#include "mesh_optimizer.h"
+
+namespace dxlib {
+namespace geometry {
+
+// 部分メッシュごとのインデックス幅の選択
+//
+// 32 ビットのインデックス列を部分メッシュごとに調べ、参照する頂点の範囲が 65536 個に収まる部分メッシュは
+// 最小の頂点番号を base_vertex に移して 16 ビットで格納します。
+// 頂点バッファ全体が 65536 頂点を超えるメッシュでも、多くの部分メッシュは 16 ビットで描画できます。
+
+//! \brief インデックスのフォーマット
+enum class index_format : uint8_t
+{
+	uint16,
+	uint32,
+};
+
+//! \brief インデックスのバイトサイズ
+[[nodiscard]] constexpr uint32_t index_size(index_format format) noexcept
+{
+	return format == index_format::uint16 ? 2 : 4;
+}
+
+#if defined(_ENABLE_D3D11) || defined(_ENABLE_D3D12) || __has_include(<dxgiformat.h>)
+//! \brief DXGI_FORMAT
+[[nodiscard]] constexpr DXGI_FORMAT to_dxgi_format(index_format format) noexcept
+{
+	return format == index_format::uint16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+#endif
+
+//! \brief 部分メッシュの描画情報
+//!
+//! バッファの byte_offset から format でバインドし、DrawIndexed(index_count, 0, base_vertex) で描画します。
+//! byte_offset は 4 の倍数なので、バッファ先頭から format でバインドして start_index から描画することもできます。
+struct index_submesh
+{
+	index_format format;
+	uint32_t     byte_offset; //!< バッファ先頭からのバイトオフセット
+	uint32_t     index_count;
+	int32_t      base_vertex; //!< 各インデックスに加算する頂点番号 (BaseVertexLocation)
+
+	//! \brief バッファ先頭から format でバインドした場合の StartIndexLocation
+	[[nodiscard]] uint32_t start_index() const noexcept
+	{
+		return byte_offset / index_size(format);
+	}
+};
+
+//! \brief 部分メッシュごとに幅を選んだインデックスバッファ
+struct mesh_index_buffer
+{
+	std::vector<uint8_t>       data;      //!< そのまま upload バッファにコピーできます
+	std::vector<index_submesh> submeshes; //!< build_index_buffer に渡した部分メッシュの順
+};
+
+//! \brief インデックス列を格納できる最小のフォーマットを選びます
+//!
+//! \param[in]  indices
+//! \param[out] base_vertex 最小の頂点番号 (空の場合は 0)
+//! \return 最大と最小の頂点番号の差が 65535 以下なら uint16
+[[nodiscard]] index_format select_index_format(std::span<const uint32_t> indices, uint32_t& base_vertex) noexcept;
+
+//! \brief 部分メッシュごとに幅を選んでインデックスバッファを作ります
+//!
+//! \param[in] indices   全ての部分メッシュのインデックス
+//! \param[in] submeshes 部分メッシュの範囲
+[[nodiscard]] mesh_index_buffer build_index_buffer(std::span<const uint32_t> indices, std::span<const index_range> submeshes);
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,350 @@
+#include "index_codec.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t magic[4] = { 'D', 'X', 'I', 'B' };
+
+constexpr uint32_t header_size = 8;
+
+// コードの上位 4 ビット: 共有する辺の FIFO 上の位置 (15 は辺を共有しない三角形)
+// コードの下位 4 ビット: 辺を共有する三角形の残りの頂点
+//   0       次の新しい頂点
+//   1 ~ 14  頂点 FIFO 上の位置 + 1
+//   15      直前の頂点番号との差分
+// 辺を共有しない三角形の下位 3 ビットは各頂点が次の新しい頂点か (そうでなければ差分) を表します。
+constexpr uint32_t free_triangle   = 15;
+constexpr uint32_t next_vertex     = 0;
+constexpr uint32_t explicit_vertex = 15;
+
+constexpr uint32_t edge_fifo_size   = 16;
+constexpr uint32_t vertex_fifo_size = 16;
+
+// 符号化と復号で同じ順に更新する状態
+struct codec_state
+{
+	codec_state() noexcept
+	{
+		std::memset(edges, 0xff, sizeof(edges));
+		std::memset(vertices, 0xff, sizeof(vertices));
+	}
+
+	void push_edge(uint32_t a, uint32_t b) noexcept
+	{
+		edges[edge_head & (edge_fifo_size - 1)][0] = a;
+		edges[edge_head & (edge_fifo_size - 1)][1] = b;
+		++edge_head;
+	}
+
+	void push_vertex(uint32_t v) noexcept
+	{
+		vertices[vertex_head & (vertex_fifo_size - 1)] = v;
+		++vertex_head;
+	}
+
+	// slot 番目に新しい要素
+	[[nodiscard]] const uint32_t* edge(uint32_t slot) const noexcept
+	{
+		return edges[(edge_head - 1 - slot) & (edge_fifo_size - 1)];
+	}
+
+	[[nodiscard]] uint32_t vertex(uint32_t slot) const noexcept
+	{
+		return vertices[(vertex_head - 1 - slot) & (vertex_fifo_size - 1)];
+	}
+
+	uint32_t edges[edge_fifo_size][2];
+	uint32_t vertices[vertex_fifo_size];
+	uint32_t edge_head   = 0;
+	uint32_t vertex_head = 0;
+	uint32_t next        = 0; //!< 次の新しい頂点
+	uint32_t last        = 0; //!< 直前の頂点
+};
+
+bool read_header(std::span<const uint8_t> data, uint32_t& count) noexcept
+{
+	if (data.size() < header_size || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+		return false;
+	}
+	std::memcpy(&count, data.data() + 4, sizeof(count));
+	return count % 3 == 0 && data.size() - header_size >= count / 3;
+}
+
+// --- 符号化 ---
+
+class writer
+{
+public:
+	explicit writer(std::span<uint8_t> out) noexcept
+	    : m_out(out)
+	{
+	}
+
+	void put(uint8_t v) noexcept
+	{
+		if (m_size < m_out.size()) {
+			m_out[m_size] = v;
+		}
+		++m_size;
+	}
+
+	void put_varint(uint32_t v) noexcept
+	{
+		while (v >= 0x80) {
+			put(static_cast<uint8_t>(v | 0x80));
+			v >>= 7;
+		}
+		put(static_cast<uint8_t>(v));
+	}
+
+	void put_delta(uint32_t v, uint32_t last) noexcept
+	{
+		const int32_t d = static_cast<int32_t>(v - last);
+		put_varint((static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31));
+	}
+
+	[[nodiscard]] bool overflow() const noexcept
+	{
+		return m_size > m_out.size();
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+private:
+	std::span<uint8_t> m_out;
+	size_t             m_size = 0;
+};
+
+int find_edge(const codec_state& s, uint32_t a, uint32_t b) noexcept
+{
+	for (uint32_t i = 0; i < free_triangle; ++i) {
+		const uint32_t* e = s.edge(i);
+		if (e[0] == a && e[1] == b) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+int find_vertex(const codec_state& s, uint32_t v) noexcept
+{
+	for (uint32_t i = 0; i < explicit_vertex - 1; ++i) {
+		if (s.vertex(i) == v) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+template<class Index>
+size_t encode_impl(std::span<uint8_t> out, std::span<const Index> indices) noexcept
+{
+	if (indices.size() % 3 != 0 || indices.size() > UINT32_MAX || out.size() < header_size + indices.size() / 3) {
+		return 0;
+	}
+
+	const size_t triangle_count = indices.size() / 3;
+	const auto   count          = static_cast<uint32_t>(indices.size());
+	std::memcpy(out.data(), magic, sizeof(magic));
+	std::memcpy(out.data() + 4, &count, sizeof(count));
+
+	uint8_t*    codes = out.data() + header_size;
+	writer      data(out.subspan(header_size + triangle_count));
+	codec_state s;
+
+	for (size_t t = 0; t < triangle_count; ++t) {
+		const uint32_t tri[3] = { indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2] };
+
+		// 直前の三角形と逆向きの辺を共有する回転を探します
+		int      slot     = -1;
+		uint32_t rotation = 0;
+		for (; rotation < 3; ++rotation) {
+			slot = find_edge(s, tri[(rotation + 1) % 3], tri[rotation]);
+			if (slot >= 0) {
+				break;
+			}
+		}
+
+		if (slot >= 0) {
+			const uint32_t a = tri[(rotation + 1) % 3];
+			const uint32_t b = tri[rotation];
+			const uint32_t c = tri[(rotation + 2) % 3];
+
+			uint32_t vertex_code = explicit_vertex;
+			if (c == s.next) {
+				vertex_code = next_vertex;
+				++s.next;
+			}
+			else if (const int fifo = find_vertex(s, c); fifo >= 0) {
+				vertex_code = static_cast<uint32_t>(fifo) + 1;
+			}
+			else {
+				data.put_delta(c, s.last);
+			}
+			if (vertex_code == next_vertex || vertex_code == explicit_vertex) {
+				s.push_vertex(c);
+			}
+			s.last   = c;
+			codes[t] = static_cast<uint8_t>((static_cast<uint32_t>(slot) << 4) | vertex_code);
+			s.push_edge(a, c);
+			s.push_edge(c, b);
+		}
+		else {
+			uint32_t flags = 0;
+			for (uint32_t k = 0; k < 3; ++k) {
+				if (tri[k] == s.next) {
+					flags |= 1u << k;
+					++s.next;
+				}
+				else {
+					data.put_delta(tri[k], s.last);
+				}
+				s.push_vertex(tri[k]);
+				s.last = tri[k];
+			}
+			codes[t] = static_cast<uint8_t>((free_triangle << 4) | flags);
+			s.push_edge(tri[0], tri[1]);
+			s.push_edge(tri[1], tri[2]);
+			s.push_edge(tri[2], tri[0]);
+		}
+	}
+	return data.overflow() ? 0 : header_size + triangle_count + data.size();
+}
+
+// --- 復号 ---
+
+class reader
+{
+public:
+	reader(const uint8_t* data, const uint8_t* end) noexcept
+	    : m_data(data)
+	    , m_end(end)
+	{
+	}
+
+	uint32_t get_delta(uint32_t last) noexcept
+	{
+		uint32_t v     = 0;
+		uint32_t shift = 0;
+		for (;;) {
+			if (m_data == m_end || shift > 28) {
+				m_error = true;
+				return last;
+			}
+			const uint8_t b = *m_data++;
+			v |= static_cast<uint32_t>(b & 0x7f) << shift;
+			if (b < 0x80) {
+				break;
+			}
+			shift += 7;
+		}
+		return last + ((v >> 1) ^ (0u - (v & 1)));
+	}
+
+	[[nodiscard]] bool error() const noexcept
+	{
+		return m_error;
+	}
+
+private:
+	const uint8_t* m_data;
+	const uint8_t* m_end;
+	bool           m_error = false;
+};
+
+template<class Index>
+bool decode_impl(std::span<Index> out, std::span<const uint8_t> data) noexcept
+{
+	uint32_t count = 0;
+	if (!read_header(data, count) || out.size() < count) {
+		return false;
+	}
+
+	const size_t   triangle_count = count / 3;
+	const uint8_t* codes          = data.data() + header_size;
+	reader         in(codes + triangle_count, data.data() + data.size());
+	codec_state    s;
+
+	for (size_t t = 0; t < triangle_count; ++t) {
+		const uint32_t code = codes[t];
+		const uint32_t slot = code >> 4;
+		Index*         tri  = out.data() + t * 3;
+
+		if (slot != free_triangle) {
+			const uint32_t* e = s.edge(slot);
+			const uint32_t  a = e[0];
+			const uint32_t  b = e[1];
+
+			const uint32_t vertex_code = code & 15;
+			uint32_t       c;
+			if (vertex_code == next_vertex) {
+				c = s.next++;
+				s.push_vertex(c);
+			}
+			else if (vertex_code != explicit_vertex) {
+				c = s.vertex(vertex_code - 1);
+			}
+			else {
+				c = in.get_delta(s.last);
+				s.push_vertex(c);
+			}
+			s.last = c;
+			tri[0] = static_cast<Index>(b);
+			tri[1] = static_cast<Index>(a);
+			tri[2] = static_cast<Index>(c);
+			s.push_edge(a, c);
+			s.push_edge(c, b);
+		}
+		else {
+			uint32_t v[3];
+			for (uint32_t k = 0; k < 3; ++k) {
+				v[k] = (code >> k) & 1 ? s.next++ : in.get_delta(s.last);
+				s.push_vertex(v[k]);
+				s.last = v[k];
+				tri[k] = static_cast<Index>(v[k]);
+			}
+			s.push_edge(v[0], v[1]);
+			s.push_edge(v[1], v[2]);
+			s.push_edge(v[2], v[0]);
+		}
+	}
+	return !in.error();
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+size_t encode_index_buffer(std::span<uint8_t> out, std::span<const uint16_t> indices) noexcept
+{
+	return encode_impl(out, indices);
+}
+
+size_t encode_index_buffer(std::span<uint8_t> out, std::span<const uint32_t> indices) noexcept
+{
+	return encode_impl(out, indices);
+}
+
+uint32_t decoded_index_count(std::span<const uint8_t> data) noexcept
+{
+	uint32_t count = 0;
+	return read_header(data, count) ? count : 0;
+}
+
+bool decode_index_buffer(std::span<uint16_t> out, std::span<const uint8_t> data) noexcept
+{
+	return decode_impl(out, data);
+}
+
+bool decode_index_buffer(std::span<uint32_t> out, std::span<const uint8_t> data) noexcept
+{
+	return decode_impl(out, data);
+}
+
+} // namespace geometry
+} // namespace dxlib
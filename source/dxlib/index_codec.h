@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dxlib {
+namespace geometry {
+
+// インデックスバッファの圧縮 (ファイル保存用)
+//
+// 三角形リストを 1 三角形 1 バイトのコードと可変長の差分に符号化します。
+// - 直前の三角形の辺 (15 本の FIFO) を共有する三角形は、辺の位置と残りの 1 頂点だけを書きます
+// - 頂点は「次の新しい頂点」(optimize_vertex_fetch 後は多くの頂点がこれになります)、直前の頂点 (14 個の FIFO) の位置、
+//   または直前の頂点番号との差分 (zigzag + LEB128) のいずれかで書きます
+// 辺を共有しやすいように三角形内の頂点を回転するので、復号した三角形は頂点の順番 (向きは同じ) が元と異なることがあります。
+// optimize_mesh 済みのメッシュでは 1 三角形あたり 1 ~ 2 バイト程度になります。
+//
+// 形式
+//   magic   (4 バイト)
+//   count   (4 バイト、インデックス数)
+//   codes   (三角形数バイト)
+//   data    (可変長)
+
+//! \brief encode_index_buffer の出力の最大バイトサイズ
+[[nodiscard]] constexpr size_t encode_index_buffer_bound(size_t index_count) noexcept
+{
+	// ヘッダー + コード + 1 頂点あたり最大 5 バイト
+	return 8 + index_count / 3 + index_count * 5;
+}
+
+//! \brief 三角形リストを圧縮します
+//!
+//! \param[out] out     encode_index_buffer_bound(indices.size()) バイト以上
+//! \param[in]  indices 三角形リスト
+//! \return 書き込んだバイト数 (out が足りない場合は 0)
+[[nodiscard]] size_t encode_index_buffer(std::span<uint8_t> out, std::span<const uint16_t> indices) noexcept;
+[[nodiscard]] size_t encode_index_buffer(std::span<uint8_t> out, std::span<const uint32_t> indices) noexcept;
+
+//! \brief 圧縮したインデックスの数
+//!
+//! \return data が圧縮したインデックスでない場合は 0
+[[nodiscard]] uint32_t decoded_index_count(std::span<const uint8_t> data) noexcept;
+
+//! \brief 圧縮したインデックスを復元します
+//!
+//! 頂点番号の範囲は検査しないので、信頼できないデータの場合は復元後に頂点数と比較してください。
+//!
+//! \param[out] out  decoded_index_count(data) 要素以上
+//! \param[in]  data encode_index_buffer の出力
+//! \return data の形式が正しくない (途中で切れているなど) 場合や out が足りない場合は false
+bool decode_index_buffer(std::span<uint16_t> out, std::span<const uint8_t> data) noexcept;
+bool decode_index_buffer(std::span<uint32_t> out, std::span<const uint8_t> data) noexcept;
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,254 @@
+#include "lz4.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 一致の最小長
+constexpr size_t min_match = 4;
+
+// 最後の一致はブロック末尾の 12 バイトより前から始まり、末尾の 5 バイトはリテラルです
+constexpr size_t last_literals  = 5;
+constexpr size_t match_safe_end = 12;
+
+constexpr size_t max_offset = 65535;
+
+constexpr uint32_t hash_bits = 14;
+
+inline uint32_t read32(const uint8_t* p) noexcept
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint32_t hash4(uint32_t v) noexcept
+{
+	return (v * 2654435761u) >> (32 - hash_bits);
+}
+
+class writer
+{
+public:
+	writer(uint8_t* data, size_t size) noexcept
+	    : m_data(data)
+	    , m_end(data + size)
+	{
+	}
+
+	bool length(size_t n) noexcept
+	{
+		for (; n >= 255; n -= 255) {
+			if (!put(255)) {
+				return false;
+			}
+		}
+		return put(static_cast<uint8_t>(n));
+	}
+
+	bool put(uint8_t v) noexcept
+	{
+		if (m_data == m_end) {
+			return false;
+		}
+		*m_data++ = v;
+		return true;
+	}
+
+	bool copy(const uint8_t* src, size_t n) noexcept
+	{
+		if (static_cast<size_t>(m_end - m_data) < n) {
+			return false;
+		}
+		if (n != 0) {
+			std::memcpy(m_data, src, n);
+		}
+		m_data += n;
+		return true;
+	}
+
+	// リテラルと一致 (match_length == 0 の場合は最後のリテラルのみ) を 1 つのシーケンスとして書きます
+	bool sequence(const uint8_t* literals, size_t literal_length, size_t offset, size_t match_length) noexcept
+	{
+		const size_t lit   = literal_length < 15 ? literal_length : 15;
+		const size_t ml    = match_length ? match_length - min_match : 0;
+		const size_t match = ml < 15 ? ml : 15;
+		if (!put(static_cast<uint8_t>((lit << 4) | match))) {
+			return false;
+		}
+		if (lit == 15 && !length(literal_length - 15)) {
+			return false;
+		}
+		if (!copy(literals, literal_length)) {
+			return false;
+		}
+		if (match_length == 0) {
+			return true;
+		}
+		if (!put(static_cast<uint8_t>(offset)) || !put(static_cast<uint8_t>(offset >> 8))) {
+			return false;
+		}
+		return match < 15 || length(ml - 15);
+	}
+
+	[[nodiscard]] uint8_t* position() const noexcept
+	{
+		return m_data;
+	}
+
+private:
+	uint8_t* m_data;
+	uint8_t* m_end;
+};
+
+} // namespace
+
+namespace dxlib {
+
+size_t lz4_compress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept
+{
+	const uint8_t* const base   = src.data();
+	const size_t         size   = src.size();
+	writer               out(dst.data(), dst.size());
+	size_t               anchor = 0;
+
+	if (size > match_safe_end) {
+		// 位置 + 1 を保持します (0 は空き)
+		std::vector<uint32_t> table(size_t(1) << hash_bits, 0);
+
+		const size_t match_limit = size - last_literals;
+		const size_t scan_limit  = size - match_safe_end;
+		size_t       ip          = 0;
+		while (ip < scan_limit) {
+			const uint32_t sequence = read32(base + ip);
+			const uint32_t h        = hash4(sequence);
+			const size_t   ref      = table[h];
+			table[h]                = static_cast<uint32_t>(ip + 1);
+
+			if (ref == 0 || ip - (ref - 1) > max_offset || read32(base + ref - 1) != sequence) {
+				// 一致しない間は徐々に読み飛ばします (圧縮できないデータで速度を保つため)
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			size_t match = ref - 1;
+			// 後方に伸ばします
+			while (ip > anchor && match > 0 && base[ip - 1] == base[match - 1]) {
+				--ip;
+				--match;
+			}
+			// 前方に伸ばします
+			size_t length = min_match;
+			while (ip + length < match_limit && base[match + length] == base[ip + length]) {
+				++length;
+			}
+
+			if (!out.sequence(base + anchor, ip - anchor, ip - match, length)) {
+				return 0;
+			}
+			ip += length;
+			anchor = ip;
+			if (ip - 2 < scan_limit) {
+				table[hash4(read32(base + ip - 2))] = static_cast<uint32_t>(ip - 2 + 1);
+			}
+		}
+	}
+
+	if (!out.sequence(base + anchor, size - anchor, 0, 0)) {
+		return 0;
+	}
+	return static_cast<size_t>(out.position() - dst.data());
+}
+
+size_t lz4_decompress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept
+{
+	const uint8_t*       ip   = src.data();
+	const uint8_t* const iend = ip + src.size();
+	uint8_t*             op   = dst.data();
+	uint8_t* const       oend = op + dst.size();
+
+	auto read_length = [&](size_t& length)
+	{
+		uint8_t b;
+		do {
+			if (ip == iend) {
+				return false;
+			}
+			b = *ip++;
+			length += b;
+		} while (b == 255);
+		return true;
+	};
+
+	while (ip < iend) {
+		const uint8_t token = *ip++;
+
+		size_t literal_length = token >> 4;
+		if (literal_length == 15 && !read_length(literal_length)) {
+			return 0;
+		}
+		if (literal_length > static_cast<size_t>(iend - ip) || literal_length > static_cast<size_t>(oend - op)) {
+			return 0;
+		}
+		if (literal_length <= 16 && iend - ip >= 16 && oend - op >= 16) {
+			// 短いリテラルは固定長でコピーします
+			std::memcpy(op, ip, 16);
+		}
+		else if (literal_length != 0) {
+			std::memcpy(op, ip, literal_length);
+		}
+		ip += literal_length;
+		op += literal_length;
+
+		// 最後のシーケンスは一致を持ちません
+		if (ip == iend) {
+			break;
+		}
+
+		if (iend - ip < 2) {
+			return 0;
+		}
+		const size_t offset = ip[0] | (size_t(ip[1]) << 8);
+		ip += 2;
+		if (offset == 0 || offset > static_cast<size_t>(op - dst.data())) {
+			return 0;
+		}
+
+		size_t match_length = token & 15;
+		if (match_length == 15 && !read_length(match_length)) {
+			return 0;
+		}
+		match_length += min_match;
+		if (match_length > static_cast<size_t>(oend - op)) {
+			return 0;
+		}
+
+		// 固定長のコピーが末尾を越えて書いた分は出力の範囲内で、次のシーケンスが上書きします
+		const uint8_t* match = op - offset;
+		const bool     slack = static_cast<size_t>(oend - op) >= match_length + 16;
+		if (offset >= 16 && slack) {
+			for (size_t i = 0; i < match_length; i += 16) {
+				std::memcpy(op + i, match + i, 16);
+			}
+		}
+		else if (offset >= 8 && slack) {
+			for (size_t i = 0; i < match_length; i += 8) {
+				std::memcpy(op + i, match + i, 8);
+			}
+		}
+		else if (offset >= match_length) {
+			std::memcpy(op, match, match_length);
+		}
+		else {
+			// 重なる場合は 1 バイトずつコピーして繰り返しを展開します
+			for (size_t i = 0; i < match_length; ++i) {
+				op[i] = match[i];
+			}
+		}
+		op += match_length;
+	}
+	return static_cast<size_t>(op - dst.data());
+}
+
+} // namespace dxlib
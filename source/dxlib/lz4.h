@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dxlib {
+
+// LZ4 ブロック形式の圧縮と展開
+//
+// LZ4 のブロック形式 (フレームヘッダーなし) と互換で、lz4 の LZ4_decompress_safe でも展開できます。
+// 圧縮はハッシュ表で 4 バイトの一致を探す貪欲法です。展開は出力の大きさを呼び出し側が知っている前提で、
+// 壊れたデータでも入力と出力の範囲外には読み書きしません。
+
+//! \brief 圧縮後の最大バイトサイズ
+[[nodiscard]] constexpr size_t lz4_compress_bound(size_t size) noexcept
+{
+	return size + size / 255 + 16;
+}
+
+//! \brief 圧縮します
+//!
+//! \param[in]  src
+//! \param[out] dst lz4_compress_bound(src.size()) バイト以上
+//! \return 圧縮後のバイトサイズ (dst が足りない場合は 0)
+[[nodiscard]] size_t lz4_compress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept;
+
+//! \brief 展開します
+//!
+//! \param[in]  src
+//! \param[out] dst 展開後のバイトサイズ以上
+//! \return 展開後のバイトサイズ (src が壊れている場合や dst が足りない場合は 0)
+[[nodiscard]] size_t lz4_decompress(std::span<const uint8_t> src, std::span<uint8_t> dst) noexcept;
+
+} // namespace dxlib
@@ -1,5 +1,9 @@
 ﻿#pragma once
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 #include "vector.h"
 
 namespace dxlib {
@@ -20,5 +24,101 @@ inline constexpr T rad2deg(T rad)
 	return rad * (180.0f / pi<T>);
 }
 
+// --- constexpr 対応の基本関数 ---
+//
+// 定数評価時は double で反復/級数展開し、実行時は <cmath> を呼び出します。
+// ビュー/射影行列をコンパイル時に構築するためのもので、定数評価時の誤差は double の丸め程度です。
+
+namespace detail {
+
+constexpr double constexpr_sqrt(double x) noexcept
+{
+	if (x < 0.0) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	if (x == 0.0 || x != x || x == std::numeric_limits<double>::infinity()) {
+		return x;
+	}
+	// 上から単調に収束するので、減少しなくなった時点で打ち切ります
+	double r = x > 1.0 ? x : 1.0;
+	for (int i = 0; i < 2048; ++i) {
+		const double next = 0.5 * (r + x / r);
+		if (next >= r) {
+			break;
+		}
+		r = next;
+	}
+	return r;
+}
+
+//! \brief [-pi, pi] に範囲を縮小した x の (sin, cos) を Taylor 展開で求めます
+constexpr void constexpr_sincos(double x, double& s, double& c) noexcept
+{
+	constexpr double two_pi = 2.0 * pi<double>;
+	x -= two_pi * static_cast<double>(static_cast<long long>(x / two_pi));
+	if (x > pi<double>) {
+		x -= two_pi;
+	}
+	else if (x < -pi<double>) {
+		x += two_pi;
+	}
+
+	const double x2   = x * x;
+	double       term = x;
+	s                 = x;
+	c                 = 1.0;
+	double cterm      = 1.0;
+	for (int n = 1; n < 16; ++n) {
+		term *= -x2 / ((2 * n) * (2 * n + 1));
+		cterm *= -x2 / ((2 * n - 1) * (2 * n));
+		s += term;
+		c += cterm;
+	}
+}
+
+} // namespace detail
+
+template<class T>
+[[nodiscard]] constexpr T sqrt(T x) noexcept
+{
+	if (std::is_constant_evaluated()) {
+		return static_cast<T>(detail::constexpr_sqrt(static_cast<double>(x)));
+	}
+	return std::sqrt(x);
+}
+
+template<class T>
+[[nodiscard]] constexpr T sin(T x) noexcept
+{
+	if (std::is_constant_evaluated()) {
+		double s = 0.0, c = 0.0;
+		detail::constexpr_sincos(static_cast<double>(x), s, c);
+		return static_cast<T>(s);
+	}
+	return std::sin(x);
+}
+
+template<class T>
+[[nodiscard]] constexpr T cos(T x) noexcept
+{
+	if (std::is_constant_evaluated()) {
+		double s = 0.0, c = 0.0;
+		detail::constexpr_sincos(static_cast<double>(x), s, c);
+		return static_cast<T>(c);
+	}
+	return std::cos(x);
+}
+
+template<class T>
+[[nodiscard]] constexpr T tan(T x) noexcept
+{
+	if (std::is_constant_evaluated()) {
+		double s = 0.0, c = 0.0;
+		detail::constexpr_sincos(static_cast<double>(x), s, c);
+		return static_cast<T>(s / c);
+	}
+	return std::tan(x);
+}
+
 } // namespace math
 } // namespace dxlib
@@ -1,5 +1,9 @@
 ﻿#pragma once
 
+#include <cmath>
+
+#include "math.h"
+#include "simd.h"
 #include "vector.h"
 
 namespace dxlib {
@@ -10,6 +14,11 @@ struct mat2
 {
 	T _00, _01;
 	T _10, _11;
+
+	[[nodiscard]] static constexpr mat2 identity() noexcept
+	{
+		return { T(1), T(0), T(0), T(1) };
+	}
 };
 
 template<typename T>
@@ -18,6 +27,11 @@ struct mat3
 	T _00, _01, _02;
 	T _10, _11, _12;
 	T _20, _21, _22;
+
+	[[nodiscard]] static constexpr mat3 identity() noexcept
+	{
+		return { T(1), T(0), T(0), T(0), T(1), T(0), T(0), T(0), T(1) };
+	}
 };
 
 template<typename T>
@@ -27,8 +41,478 @@ struct mat4
 	T _10, _11, _12, _13;
 	T _20, _21, _22, _23;
 	T _30, _31, _32, _33;
+
+	[[nodiscard]] static constexpr mat4 identity() noexcept
+	{
+		return { T(1), T(0), T(0), T(0), T(0), T(1), T(0), T(0), T(0), T(0), T(1), T(0), T(0), T(0), T(0), T(1) };
+	}
 };
 
+// 行列は DirectXMath と同じく行ベクトル (v * M) 規約・左手座標系で扱います。
+// float の行列は simd.h で選択されたバックエンドで計算し、それ以外の型はスカラーで計算します。
+
+namespace detail {
+
+inline simd::vfloat4 load_row(const mat4<float>& m, int row) noexcept
+{
+	return simd::vload4(reinterpret_cast<const float*>(&m) + row * 4);
+}
+
+inline void store_row(mat4<float>& m, int row, simd::vfloat4 v) noexcept
+{
+	simd::vstore4(reinterpret_cast<float*>(&m) + row * 4, v);
+}
+
+//! \brief v * M
+inline simd::vfloat4 transform(simd::vfloat4 v, simd::vfloat4 r0, simd::vfloat4 r1, simd::vfloat4 r2, simd::vfloat4 r3) noexcept
+{
+	simd::vfloat4 r = simd::vmul(simd::vsplat<0>(v), r0);
+	r               = simd::vmadd(simd::vsplat<1>(v), r1, r);
+	r               = simd::vmadd(simd::vsplat<2>(v), r2, r);
+	return simd::vmadd(simd::vsplat<3>(v), r3, r);
+}
+
+// 行優先 2x2 行列 (x00, x01, x10, x11) の演算
+inline simd::vfloat4 mat2_mul(simd::vfloat4 a, simd::vfloat4 b) noexcept
+{
+	return simd::vmadd(a, simd::vshuffle<0, 3, 0, 3>(b, b), simd::vmul(simd::vshuffle<1, 0, 3, 2>(a, a), simd::vshuffle<2, 1, 2, 1>(b, b)));
+}
+
+//! \brief adj(a) * b
+inline simd::vfloat4 mat2_adj_mul(simd::vfloat4 a, simd::vfloat4 b) noexcept
+{
+	return simd::vsub(simd::vmul(simd::vshuffle<3, 3, 0, 0>(a, a), b), simd::vmul(simd::vshuffle<1, 1, 2, 2>(a, a), simd::vshuffle<2, 3, 0, 1>(b, b)));
+}
+
+//! \brief a * adj(b)
+inline simd::vfloat4 mat2_mul_adj(simd::vfloat4 a, simd::vfloat4 b) noexcept
+{
+	return simd::vsub(simd::vmul(a, simd::vshuffle<3, 0, 3, 0>(b, b)), simd::vmul(simd::vshuffle<1, 0, 3, 2>(a, a), simd::vshuffle<2, 1, 2, 1>(b, b)));
+}
+
+} // namespace detail
+
+// --- transpose ---
+
+template<typename T>
+[[nodiscard]] constexpr mat4<T> transpose(const mat4<T>& m) noexcept
+{
+	return {
+		m._00, m._10, m._20, m._30,
+		m._01, m._11, m._21, m._31,
+		m._02, m._12, m._22, m._32,
+		m._03, m._13, m._23, m._33
+	};
+}
+
+[[nodiscard]] inline mat4<float> transpose(const mat4<float>& m) noexcept
+{
+	simd::vfloat4 r0 = detail::load_row(m, 0);
+	simd::vfloat4 r1 = detail::load_row(m, 1);
+	simd::vfloat4 r2 = detail::load_row(m, 2);
+	simd::vfloat4 r3 = detail::load_row(m, 3);
+	simd::vtranspose(r0, r1, r2, r3);
+
+	mat4<float> r;
+	detail::store_row(r, 0, r0);
+	detail::store_row(r, 1, r1);
+	detail::store_row(r, 2, r2);
+	detail::store_row(r, 3, r3);
+	return r;
+}
+
+// --- multiply ---
+
+template<typename T>
+[[nodiscard]] inline mat4<T> mul(const mat4<T>& a, const mat4<T>& b) noexcept
+{
+	const T* pa = &a._00;
+	const T* pb = &b._00;
+	mat4<T>  r  = {};
+	T*       pr = &r._00;
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			T sum = pa[i * 4 + 0] * pb[0 * 4 + j];
+			for (int k = 1; k < 4; ++k) {
+				sum += pa[i * 4 + k] * pb[k * 4 + j];
+			}
+			pr[i * 4 + j] = sum;
+		}
+	}
+	return r;
+}
+
+[[nodiscard]] inline mat4<float> mul(const mat4<float>& a, const mat4<float>& b) noexcept
+{
+	const simd::vfloat4 b0 = detail::load_row(b, 0);
+	const simd::vfloat4 b1 = detail::load_row(b, 1);
+	const simd::vfloat4 b2 = detail::load_row(b, 2);
+	const simd::vfloat4 b3 = detail::load_row(b, 3);
+
+	mat4<float> r;
+	for (int i = 0; i < 4; ++i) {
+		detail::store_row(r, i, detail::transform(detail::load_row(a, i), b0, b1, b2, b3));
+	}
+	return r;
+}
+
+template<typename T>
+[[nodiscard]] inline mat4<T> operator*(const mat4<T>& a, const mat4<T>& b) noexcept
+{
+	return mul(a, b);
+}
+
+// --- transform ---
+
+//! \brief v * M
+template<typename T>
+[[nodiscard]] constexpr vec4<T> transform(const vec4<T>& v, const mat4<T>& m) noexcept
+{
+	return {
+		v.x * m._00 + v.y * m._10 + v.z * m._20 + v.w * m._30,
+		v.x * m._01 + v.y * m._11 + v.z * m._21 + v.w * m._31,
+		v.x * m._02 + v.y * m._12 + v.z * m._22 + v.w * m._32,
+		v.x * m._03 + v.y * m._13 + v.z * m._23 + v.w * m._33
+	};
+}
+
+//! \brief v * M
+[[nodiscard]] inline vec4<float> transform(const vec4<float>& v, const mat4<float>& m) noexcept
+{
+	vec4<float> r;
+	simd::vstore4(&r.x, detail::transform(simd::vload4(&v.x), detail::load_row(m, 0), detail::load_row(m, 1), detail::load_row(m, 2), detail::load_row(m, 3)));
+	return r;
+}
+
+//! \brief (p, 1) * M の xyz を返します (w 除算は行いません)
+template<typename T>
+[[nodiscard]] constexpr vec3<T> transform_point(const vec3<T>& p, const mat4<T>& m) noexcept
+{
+	const vec4<T> r = transform(vec4<T>(p, T(1)), m);
+	return { r.x, r.y, r.z };
+}
+
+//! \brief (v, 0) * M の xyz を返します
+template<typename T>
+[[nodiscard]] constexpr vec3<T> transform_vector(const vec3<T>& v, const mat4<T>& m) noexcept
+{
+	const vec4<T> r = transform(vec4<T>(v, T(0)), m);
+	return { r.x, r.y, r.z };
+}
+
+//! \brief (p, 1) * M を w で除算した座標を返します
+template<typename T>
+[[nodiscard]] constexpr vec3<T> transform_coord(const vec3<T>& p, const mat4<T>& m) noexcept
+{
+	const vec4<T> r = transform(vec4<T>(p, T(1)), m);
+	return { r.x / r.w, r.y / r.w, r.z / r.w };
+}
+
+// --- inverse ---
+
+template<typename T>
+[[nodiscard]] constexpr T determinant(const mat4<T>& m) noexcept
+{
+	const T s0 = m._00 * m._11 - m._10 * m._01;
+	const T s1 = m._00 * m._12 - m._10 * m._02;
+	const T s2 = m._00 * m._13 - m._10 * m._03;
+	const T s3 = m._01 * m._12 - m._11 * m._02;
+	const T s4 = m._01 * m._13 - m._11 * m._03;
+	const T s5 = m._02 * m._13 - m._12 * m._03;
+	const T c5 = m._22 * m._33 - m._32 * m._23;
+	const T c4 = m._21 * m._33 - m._31 * m._23;
+	const T c3 = m._21 * m._32 - m._31 * m._22;
+	const T c2 = m._20 * m._33 - m._30 * m._23;
+	const T c1 = m._20 * m._32 - m._30 * m._22;
+	const T c0 = m._20 * m._31 - m._30 * m._21;
+	return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+//! \brief 逆行列
+//!
+//! 特異行列の場合は DirectXMath と同様に無限大/NaN を含む行列を返します。
+template<typename T>
+[[nodiscard]] constexpr mat4<T> inverse(const mat4<T>& m) noexcept
+{
+	const T s0 = m._00 * m._11 - m._10 * m._01;
+	const T s1 = m._00 * m._12 - m._10 * m._02;
+	const T s2 = m._00 * m._13 - m._10 * m._03;
+	const T s3 = m._01 * m._12 - m._11 * m._02;
+	const T s4 = m._01 * m._13 - m._11 * m._03;
+	const T s5 = m._02 * m._13 - m._12 * m._03;
+	const T c5 = m._22 * m._33 - m._32 * m._23;
+	const T c4 = m._21 * m._33 - m._31 * m._23;
+	const T c3 = m._21 * m._32 - m._31 * m._22;
+	const T c2 = m._20 * m._33 - m._30 * m._23;
+	const T c1 = m._20 * m._32 - m._30 * m._22;
+	const T c0 = m._20 * m._31 - m._30 * m._21;
+
+	const T inv_det = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+	return {
+		(m._11 * c5 - m._12 * c4 + m._13 * c3) * inv_det,
+		(-m._01 * c5 + m._02 * c4 - m._03 * c3) * inv_det,
+		(m._31 * s5 - m._32 * s4 + m._33 * s3) * inv_det,
+		(-m._21 * s5 + m._22 * s4 - m._23 * s3) * inv_det,
+
+		(-m._10 * c5 + m._12 * c2 - m._13 * c1) * inv_det,
+		(m._00 * c5 - m._02 * c2 + m._03 * c1) * inv_det,
+		(-m._30 * s5 + m._32 * s2 - m._33 * s1) * inv_det,
+		(m._20 * s5 - m._22 * s2 + m._23 * s1) * inv_det,
+
+		(m._10 * c4 - m._11 * c2 + m._13 * c0) * inv_det,
+		(-m._00 * c4 + m._01 * c2 - m._03 * c0) * inv_det,
+		(m._30 * s4 - m._31 * s2 + m._33 * s0) * inv_det,
+		(-m._20 * s4 + m._21 * s2 - m._23 * s0) * inv_det,
+
+		(-m._10 * c3 + m._11 * c1 - m._12 * c0) * inv_det,
+		(m._00 * c3 - m._01 * c1 + m._02 * c0) * inv_det,
+		(-m._30 * s3 + m._31 * s1 - m._32 * s0) * inv_det,
+		(m._20 * s3 - m._21 * s1 + m._22 * s0) * inv_det
+	};
+}
+
+//! \brief 逆行列
+//!
+//! 2x2 ブロックに分割して余因子を求めます。
+//! 特異行列の場合は DirectXMath と同様に無限大/NaN を含む行列を返します。
+[[nodiscard]] inline mat4<float> inverse(const mat4<float>& m) noexcept
+{
+	using namespace simd;
+
+	const vfloat4 r0 = math::detail::load_row(m, 0);
+	const vfloat4 r1 = math::detail::load_row(m, 1);
+	const vfloat4 r2 = math::detail::load_row(m, 2);
+	const vfloat4 r3 = math::detail::load_row(m, 3);
+
+	// | A B |
+	// | C D |
+	const vfloat4 a = vshuffle<0, 1, 0, 1>(r0, r1);
+	const vfloat4 b = vshuffle<2, 3, 2, 3>(r0, r1);
+	const vfloat4 c = vshuffle<0, 1, 0, 1>(r2, r3);
+	const vfloat4 d = vshuffle<2, 3, 2, 3>(r2, r3);
+
+	// (|A|, |B|, |C|, |D|)
+	const vfloat4 det_lhs = vmul(vshuffle<0, 2, 0, 2>(r0, r2), vshuffle<1, 3, 1, 3>(r1, r3));
+	const vfloat4 det_rhs = vmul(vshuffle<1, 3, 1, 3>(r0, r2), vshuffle<0, 2, 0, 2>(r1, r3));
+	const vfloat4 det_sub = vsub(det_lhs, det_rhs);
+	const vfloat4 det_a = vsplat<0>(det_sub);
+	const vfloat4 det_b = vsplat<1>(det_sub);
+	const vfloat4 det_c = vsplat<2>(det_sub);
+	const vfloat4 det_d = vsplat<3>(det_sub);
+
+	const vfloat4 d_c = math::detail::mat2_adj_mul(d, c);
+	const vfloat4 a_b = math::detail::mat2_adj_mul(a, b);
+
+	vfloat4 x = vsub(vmul(det_d, a), math::detail::mat2_mul(b, d_c));
+	vfloat4 w = vsub(vmul(det_a, d), math::detail::mat2_mul(c, a_b));
+	vfloat4 y = vsub(vmul(det_b, c), math::detail::mat2_mul_adj(d, a_b));
+	vfloat4 z = vsub(vmul(det_c, b), math::detail::mat2_mul_adj(a, d_c));
+
+	// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+	const float det_ad = vget_x(det_a) * vget_x(det_d);
+	const float det_bc = vget_x(det_b) * vget_x(det_c);
+	const float trace  = vhsum(vmul(a_b, vshuffle<0, 2, 1, 3>(d_c, d_c)));
+	const float det    = det_ad + det_bc - trace;
+
+	const vfloat4 inv_det = vdiv(vset4(1.0f, -1.0f, -1.0f, 1.0f), vsplat4(det));
+	x                     = vmul(x, inv_det);
+	y                     = vmul(y, inv_det);
+	z                     = vmul(z, inv_det);
+	w                     = vmul(w, inv_det);
+
+	mat4<float> r;
+	math::detail::store_row(r, 0, vshuffle<3, 1, 3, 1>(x, y));
+	math::detail::store_row(r, 1, vshuffle<2, 0, 2, 0>(x, y));
+	math::detail::store_row(r, 2, vshuffle<3, 1, 3, 1>(z, w));
+	math::detail::store_row(r, 3, vshuffle<2, 0, 2, 0>(z, w));
+	return r;
+}
+
+// --- view / projection ---
+//
+// いずれも constexpr で、定数評価時は math.h の constexpr 版 sqrt / tan を使用します。
+// 深度は D3D と同じく [0, 1] に写します。
+
+namespace detail {
+
+template<typename T>
+[[nodiscard]] constexpr vec3<T> normalize_constexpr(const vec3<T>& v) noexcept
+{
+	return v * vec3<T>(T(1) / math::sqrt(dot(v, v)));
+}
+
+} // namespace detail
+
+//! \brief 左手座標系のビュー行列
+//!
+//! \param[in] eye
+//! \param[in] direction 視線方向 (正規化不要)
+//! \param[in] up
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> look_to_lh(const vec3<T>& eye, const vec3<T>& direction, const vec3<T>& up) noexcept
+{
+	const vec3<T> z = detail::normalize_constexpr(direction);
+	const vec3<T> x = detail::normalize_constexpr(cross(up, z));
+	const vec3<T> y = cross(z, x);
+	return {
+		x.x, y.x, z.x, T(0),
+		x.y, y.y, z.y, T(0),
+		x.z, y.z, z.z, T(0),
+		-dot(x, eye), -dot(y, eye), -dot(z, eye), T(1)
+	};
+}
+
+//! \brief 左手座標系のビュー行列
+//!
+//! \param[in] eye
+//! \param[in] focus
+//! \param[in] up
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> look_at_lh(const vec3<T>& eye, const vec3<T>& focus, const vec3<T>& up) noexcept
+{
+	return look_to_lh(eye, focus - eye, up);
+}
+
+//! \brief 左手座標系の透視投影行列
+//!
+//! near_z を 0、far_z を 1 に写します。
+//!
+//! \param[in] fov_y  垂直画角 (ラジアン)
+//! \param[in] aspect 横幅 / 立幅
+//! \param[in] near_z
+//! \param[in] far_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> perspective_fov_lh(T fov_y, T aspect, T near_z, T far_z) noexcept
+{
+	const T h     = T(1) / math::tan(fov_y * T(0.5));
+	const T w     = h / aspect;
+	const T range = far_z / (far_z - near_z);
+	return {
+		w, T(0), T(0), T(0),
+		T(0), h, T(0), T(0),
+		T(0), T(0), range, T(1),
+		T(0), T(0), -range * near_z, T(0)
+	};
+}
+
+//! \brief 左手座標系の Reverse-Z 透視投影行列
+//!
+//! near_z を 1、far_z を 0 に写します。浮動小数点深度バッファの精度が遠方まで均一になります。
+//! 深度テストは GREATER、クリア値は 0 を使用します。
+//!
+//! \param[in] fov_y  垂直画角 (ラジアン)
+//! \param[in] aspect 横幅 / 立幅
+//! \param[in] near_z
+//! \param[in] far_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> perspective_fov_lh_reverse_z(T fov_y, T aspect, T near_z, T far_z) noexcept
+{
+	const T h     = T(1) / math::tan(fov_y * T(0.5));
+	const T w     = h / aspect;
+	const T range = near_z / (near_z - far_z);
+	return {
+		w, T(0), T(0), T(0),
+		T(0), h, T(0), T(0),
+		T(0), T(0), range, T(1),
+		T(0), T(0), -range * far_z, T(0)
+	};
+}
+
+//! \brief 左手座標系の far_z を無限遠とした透視投影行列
+//!
+//! near_z を 0、無限遠を 1 に写します。
+//!
+//! \param[in] fov_y  垂直画角 (ラジアン)
+//! \param[in] aspect 横幅 / 立幅
+//! \param[in] near_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> perspective_fov_lh_infinite(T fov_y, T aspect, T near_z) noexcept
+{
+	const T h = T(1) / math::tan(fov_y * T(0.5));
+	const T w = h / aspect;
+	return {
+		w, T(0), T(0), T(0),
+		T(0), h, T(0), T(0),
+		T(0), T(0), T(1), T(1),
+		T(0), T(0), -near_z, T(0)
+	};
+}
+
+//! \brief 左手座標系の far_z を無限遠とした Reverse-Z 透視投影行列
+//!
+//! near_z を 1、無限遠を 0 に写します。
+//!
+//! \param[in] fov_y  垂直画角 (ラジアン)
+//! \param[in] aspect 横幅 / 立幅
+//! \param[in] near_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> perspective_fov_lh_infinite_reverse_z(T fov_y, T aspect, T near_z) noexcept
+{
+	const T h = T(1) / math::tan(fov_y * T(0.5));
+	const T w = h / aspect;
+	return {
+		w, T(0), T(0), T(0),
+		T(0), h, T(0), T(0),
+		T(0), T(0), T(0), T(1),
+		T(0), T(0), near_z, T(0)
+	};
+}
+
+//! \brief 左手座標系の平行投影行列
+//!
+//! シャドウマップなどのビューに使用します。
+//!
+//! \param[in] left
+//! \param[in] right
+//! \param[in] bottom
+//! \param[in] top
+//! \param[in] near_z
+//! \param[in] far_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> orthographic_off_center_lh(T left, T right, T bottom, T top, T near_z, T far_z) noexcept
+{
+	const T rw    = T(1) / (right - left);
+	const T rh    = T(1) / (top - bottom);
+	const T range = T(1) / (far_z - near_z);
+	return {
+		rw + rw, T(0), T(0), T(0),
+		T(0), rh + rh, T(0), T(0),
+		T(0), T(0), range, T(0),
+		-(left + right) * rw, -(top + bottom) * rh, -range * near_z, T(1)
+	};
+}
+
+//! \brief 左手座標系の原点中心の平行投影行列
+//!
+//! \param[in] width
+//! \param[in] height
+//! \param[in] near_z
+//! \param[in] far_z
+//!
+//! \ret mat4
+template<typename T>
+[[nodiscard]] constexpr mat4<T> orthographic_lh(T width, T height, T near_z, T far_z) noexcept
+{
+	const T hw = width * T(0.5);
+	const T hh = height * T(0.5);
+	return orthographic_off_center_lh(-hw, hw, -hh, hh, near_z, far_z);
+}
+
 } // namespace math
 } // namespace dxlib
 
@@ -0,0 +1,313 @@
+#include "mesh_file.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "debug.h"
+#include "vertex_stream.h"
+
+namespace {
+
+using namespace dxlib;
+using namespace dxlib::geometry;
+
+constexpr uint32_t mesh_file_magic = 'D' | ('X' << 8) | ('M' << 16) | ('S' << 24);
+
+// ファイルに直接書き込む構造体の大きさ (形式の一部です)
+static_assert(sizeof(mesh_file_header) == 224);
+static_assert(sizeof(mesh_file_stream) == 24);
+static_assert(sizeof(mesh_file_submesh) == 48);
+static_assert(sizeof(vertex_input_element) == 12);
+static_assert(sizeof(lod_level) == 12);
+static_assert(sizeof(meshlet) == 16);
+static_assert(sizeof(meshlet_bounds) == 44);
+
+template<class T>
+bool resolve(std::span<const uint8_t> file, const mesh_file_array<T>& array, std::span<const T>& out) noexcept
+{
+	if (array.offset % mesh_file_alignment != 0
+	    || array.offset > file.size()
+	    || array.count > (file.size() - array.offset) / sizeof(T)) {
+		return false;
+	}
+	out = { reinterpret_cast<const T*>(file.data() + array.offset), static_cast<size_t>(array.count) };
+	return true;
+}
+
+// 16 バイト境界に揃えて追記します
+class section_writer
+{
+public:
+	template<class T>
+	mesh_file_array<T> append(std::span<const T> data)
+	{
+		m_data.resize((m_data.size() + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment, 0);
+		const mesh_file_array<T> array = { m_data.size(), data.size() };
+		const auto*              bytes = reinterpret_cast<const uint8_t*>(data.data());
+		m_data.insert(m_data.end(), bytes, bytes + data.size_bytes());
+		return array;
+	}
+
+	std::vector<uint8_t>& data() noexcept
+	{
+		return m_data;
+	}
+
+private:
+	std::vector<uint8_t> m_data;
+};
+
+// 点群の境界ボックスの中心を中心とする境界球
+bounding_sphere compute_bounds(position_view positions, std::span<const uint32_t> indices, bounding_box* box) noexcept
+{
+	float3 lo(FLT_MAX);
+	float3 hi(-FLT_MAX);
+	for (uint32_t i : indices) {
+		lo = component_min(lo, positions[i]);
+		hi = component_max(hi, positions[i]);
+	}
+	if (indices.empty()) {
+		lo = hi = float3(0.0f);
+	}
+	if (box) {
+		*box = { lo, hi };
+	}
+
+	const float3 center = (lo + hi) * 0.5f;
+	float        radius = 0.0f;
+	for (uint32_t i : indices) {
+		radius = std::max(radius, length(positions[i] - center));
+	}
+	return { center, radius };
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+bool open_mesh(std::span<const uint8_t> file, mesh_view& view) noexcept
+{
+	view = {};
+	if (file.size() < sizeof(mesh_file_header) || reinterpret_cast<uintptr_t>(file.data()) % mesh_file_alignment != 0) {
+		return false;
+	}
+
+	const auto* header = reinterpret_cast<const mesh_file_header*>(file.data());
+	if (header->magic != mesh_file_magic || header->version != mesh_file_version || header->file_size != file.size()) {
+		return false;
+	}
+
+	mesh_view out;
+	out.header = header;
+	if (!resolve(file, header->elements, out.elements)
+	    || !resolve(file, header->stream_table, out.streams)
+	    || !resolve(file, header->submeshes, out.submeshes)
+	    || !resolve(file, header->lods, out.lods)
+	    || !resolve(file, header->meshlets, out.meshlets)
+	    || !resolve(file, header->meshlet_bounds, out.meshlet_bounds)
+	    || !resolve(file, header->meshlet_vertices, out.meshlet_vertices)
+	    || !resolve(file, header->meshlet_triangles, out.meshlet_triangles)
+	    || !resolve(file, header->vertex_data, out.vertex_data)
+	    || !resolve(file, header->index_data, out.index_data)
+	    || out.meshlet_bounds.size() != out.meshlets.size()) {
+		return false;
+	}
+
+	// 表の範囲を検査します (要素数は部分メッシュとストリームの数だけです)
+	for (const auto& stream : out.streams) {
+		if (stream.offset > out.vertex_data.size() || stream.size > out.vertex_data.size() - stream.offset) {
+			return false;
+		}
+	}
+	for (const auto& submesh : out.submeshes) {
+		const uint64_t index_bytes = uint64_t(submesh.indices.index_count) * index_size(submesh.indices.format);
+		if (submesh.indices.byte_offset > out.index_data.size()
+		    || index_bytes > out.index_data.size() - submesh.indices.byte_offset
+		    || submesh.lod_count == 0
+		    || submesh.lod_offset > out.lods.size()
+		    || submesh.lod_count > out.lods.size() - submesh.lod_offset
+		    || submesh.meshlet_offset > out.meshlets.size()
+		    || submesh.meshlet_count > out.meshlets.size() - submesh.meshlet_offset) {
+			return false;
+		}
+	}
+
+	view = out;
+	return true;
+}
+
+bool mapped_mesh::open(const wchar_t* filename)
+{
+	close();
+
+	if (!m_file.open(filename)) {
+		_LOG_ERROR_MSG(L"%s open failed.\n", filename);
+		return false;
+	}
+	if (!open_mesh(m_file.span(), m_view)) {
+		_LOG_ERROR_MSG(L"%s is not a mesh file.\n", filename);
+		m_file.close();
+		return false;
+	}
+
+	return true;
+}
+
+void mapped_mesh::close() noexcept
+{
+	m_view = {};
+	m_file.close();
+}
+
+std::vector<uint8_t> write_mesh_file(const mesh_source& source, const mesh_file_options& options)
+{
+	ASSERT_RETURN(!source.elements.empty(), {});
+	ASSERT_RETURN(source.elements.front().semantic == vertex_semantic::position, {});
+	ASSERT_RETURN(source.elements.front().format == vertex_format::float32x3 && source.elements.front().offset == 0, {});
+	ASSERT_RETURN(source.vertices && source.stride >= sizeof(float3), {});
+
+	position_view positions;
+	positions.data   = static_cast<const uint8_t*>(source.vertices);
+	positions.stride = source.stride;
+	positions.count  = source.vertex_count;
+
+	const index_range                  whole     = { 0, static_cast<uint32_t>(source.indices.size()) };
+	const std::span<const index_range> submeshes = source.submeshes.empty() ? std::span(&whole, 1) : source.submeshes;
+
+	// 部分メッシュごとに LOD とメッシュレットを作ります
+	std::vector<uint32_t>    indices;
+	std::vector<index_range> ranges;
+	std::vector<lod_level>   lods;
+	std::vector<uint32_t>    lod_offsets;
+	meshlet_mesh             meshlets;
+	std::vector<uint32_t>    meshlet_offsets;
+	std::vector<uint32_t>    meshlet_counts;
+	for (const auto& range : submeshes) {
+		ASSERT_RETURN(range.offset <= source.indices.size() && range.count <= source.indices.size() - range.offset, {});
+		const auto submesh_indices = source.indices.subspan(range.offset, range.count);
+
+		lod_chain<uint32_t> chain;
+		if (options.build_lods) {
+			chain = build_lod_chain(submesh_indices, positions, options.lod);
+		}
+		else {
+			chain.indices.assign(submesh_indices.begin(), submesh_indices.end());
+			chain.levels.push_back({ 0, range.count, 0.0f });
+		}
+		lod_offsets.push_back(static_cast<uint32_t>(lods.size()));
+		lods.insert(lods.end(), chain.levels.begin(), chain.levels.end());
+		ranges.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(chain.indices.size()) });
+		indices.insert(indices.end(), chain.indices.begin(), chain.indices.end());
+
+		meshlet_offsets.push_back(static_cast<uint32_t>(meshlets.meshlets.size()));
+		if (options.build_meshlets && range.count > 0) {
+			meshlet_mesh part = build_meshlets(submesh_indices, positions, options.meshlet);
+			for (auto m : part.meshlets) {
+				m.vertex_offset += static_cast<uint32_t>(meshlets.vertices.size());
+				m.triangle_offset += static_cast<uint32_t>(meshlets.triangles.size());
+				meshlets.meshlets.push_back(m);
+			}
+			meshlets.bounds.insert(meshlets.bounds.end(), part.bounds.begin(), part.bounds.end());
+			meshlets.vertices.insert(meshlets.vertices.end(), part.vertices.begin(), part.vertices.end());
+			meshlets.triangles.insert(meshlets.triangles.end(), part.triangles.begin(), part.triangles.end());
+		}
+		meshlet_counts.push_back(static_cast<uint32_t>(meshlets.meshlets.size()) - meshlet_offsets.back());
+	}
+
+	// 部分メッシュ (全ての段を含む範囲) ごとに幅を選びます
+	const mesh_index_buffer index_buffer = build_index_buffer(indices, ranges);
+	ASSERT_RETURN(index_buffer.submeshes.size() == submeshes.size(), {});
+
+	std::vector<mesh_file_submesh> submesh_table(submeshes.size());
+	std::memset(submesh_table.data(), 0, submesh_table.size() * sizeof(mesh_file_submesh));
+	for (size_t i = 0; i < submeshes.size(); ++i) {
+		const index_submesh& built = index_buffer.submeshes[i];
+		const uint32_t       first = lod_offsets[i];
+		const uint32_t       count = static_cast<uint32_t>((i + 1 < submeshes.size() ? lod_offsets[i + 1] : lods.size()) - first);
+		for (uint32_t k = 0; k < count; ++k) {
+			lods[first + k].index_offset += built.start_index();
+		}
+
+		mesh_file_submesh& submesh  = submesh_table[i];
+		submesh.indices.format      = built.format;
+		submesh.indices.byte_offset = lods[first].index_offset * index_size(built.format);
+		submesh.indices.index_count = lods[first].index_count;
+		submesh.indices.base_vertex = built.base_vertex;
+		submesh.bounds              = compute_bounds(positions, source.indices.subspan(submeshes[i].offset, submeshes[i].count), nullptr);
+		submesh.lod_offset          = first;
+		submesh.lod_count           = count;
+		submesh.meshlet_offset      = meshlet_offsets[i];
+		submesh.meshlet_count       = meshlet_counts[i];
+	}
+
+	// 頂点レイアウトとストリーム
+	const uint32_t position_bytes = format_size(source.elements.front().format);
+	const bool     split          = options.streams == vertex_streams::split_position && source.stride > position_bytes;
+
+	std::vector<vertex_input_element> elements(source.elements.size());
+	std::memset(elements.data(), 0, elements.size() * sizeof(vertex_input_element));
+	for (size_t i = 0; i < elements.size(); ++i) {
+		const bool attribute = split && i > 0;
+		elements[i].semantic = source.elements[i].semantic;
+		elements[i].format   = source.elements[i].format;
+		elements[i].slot     = attribute ? 1 : 0;
+		elements[i].offset   = attribute ? source.elements[i].offset - position_bytes : source.elements[i].offset;
+	}
+
+	const size_t                  vertex_bytes = size_t(source.stride) * source.vertex_count;
+	std::vector<uint8_t>          vertex_data(vertex_bytes);
+	std::vector<mesh_file_stream> streams;
+	if (split) {
+		const size_t position_total = size_t(position_bytes) * source.vertex_count;
+		deinterleave_position(source.vertices, source.stride, position_bytes, source.vertex_count, vertex_data.data(), vertex_data.data() + position_total);
+		streams.push_back({ 0, position_bytes, 0, position_total });
+		streams.push_back({ 1, source.stride - position_bytes, position_total, vertex_bytes - position_total });
+	}
+	else {
+		if (vertex_bytes != 0) {
+			std::memcpy(vertex_data.data(), source.vertices, vertex_bytes);
+		}
+		streams.push_back({ 0, source.stride, 0, vertex_bytes });
+	}
+
+	// 全ての頂点の境界
+	std::vector<uint32_t> all(source.vertex_count);
+	for (uint32_t i = 0; i < source.vertex_count; ++i) {
+		all[i] = i;
+	}
+
+	mesh_file_header header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic        = mesh_file_magic;
+	header.version      = mesh_file_version;
+	header.sphere       = compute_bounds(positions, all, &header.box);
+	header.vertex_count = source.vertex_count;
+	header.streams      = split ? vertex_streams::split_position : vertex_streams::interleaved;
+
+	section_writer writer;
+	writer.append(std::span<const mesh_file_header>(&header, 1));
+	header.elements          = writer.append(std::span<const vertex_input_element>(elements));
+	header.stream_table      = writer.append(std::span<const mesh_file_stream>(streams));
+	header.submeshes         = writer.append(std::span<const mesh_file_submesh>(submesh_table));
+	header.lods              = writer.append(std::span<const lod_level>(lods));
+	header.meshlets          = writer.append(std::span<const meshlet>(meshlets.meshlets));
+	header.meshlet_bounds    = writer.append(std::span<const geometry::meshlet_bounds>(meshlets.bounds));
+	header.meshlet_vertices  = writer.append(std::span<const uint32_t>(meshlets.vertices));
+	header.meshlet_triangles = writer.append(std::span<const uint8_t>(meshlets.triangles));
+	header.vertex_data       = writer.append(std::span<const uint8_t>(vertex_data));
+	header.index_data        = writer.append(std::span<const uint8_t>(index_buffer.data));
+
+	// 末尾も揃えて、連続して並べたファイルの先頭が 16 バイト境界になるようにします
+	auto& data = writer.data();
+	data.resize((data.size() + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment, 0);
+	header.file_size = data.size();
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	return std::move(data);
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,207 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bounds.h"
+#include "file.h"
+#include "index_buffer.h"
+#include "mesh_lod.h"
+#include "mesh_simplify.h"
+#include "meshlet.h"
+#include "static_mesh.h"
+#include "vertex_layout.h"
+
+namespace dxlib {
+namespace geometry {
+
+// メッシュファイル
+//
+// ファイルの構成は次のとおりです。全てのセクションはファイル先頭から 16 バイト境界に置きます。
+//   mesh_file_header
+//   vertex_input_element[] 頂点レイアウト
+//   mesh_file_stream[]     入力スロットごとの頂点ストリーム
+//   mesh_file_submesh[]    部分メッシュ
+//   lod_level[]            部分メッシュごとの LOD (lod_level::index_offset は部分メッシュのフォーマットでの StartIndexLocation)
+//   meshlet[], meshlet_bounds[], uint32_t[] (頂点番号), uint8_t[] (三角形)
+//   頂点データ             ストリームの順に連続して置きます
+//   インデックスデータ     build_index_buffer の出力 (部分メッシュごとに 16 / 32 ビット)
+// 配列は全て mesh_file_array (ファイル先頭からのオフセットと要素数) で参照します。
+//
+// open_mesh はヘッダーとセクションの範囲だけを検査し、オフセットをポインターに置き換えた mesh_view を作ります。
+// 要素ごとの解析や変換は行わないので、mapped_file や asset_archive::view でマップした領域をそのまま使えます。
+// 頂点データとインデックスデータはそのまま upload バッファにコピーできます。
+// 要素の内容 (インデックスの範囲など) は検査しないので、write_mesh_file で作ったファイルを前提とします。
+
+//! \brief メッシュファイルの形式のバージョン
+constexpr uint32_t mesh_file_version = 1;
+
+//! \brief セクションの配置
+constexpr uint32_t mesh_file_alignment = 16;
+
+//! \brief ファイル内の配列
+template<class T>
+struct mesh_file_array
+{
+	uint64_t offset; //!< ファイル先頭からのバイトオフセット
+	uint64_t count;  //!< 要素数
+};
+
+//! \brief 入力スロットの頂点ストリーム
+struct mesh_file_stream
+{
+	uint32_t slot;   //!< 入力スロット
+	uint32_t stride; //!< 頂点のバイトサイズ
+	uint64_t offset; //!< 頂点データの先頭からのバイトオフセット
+	uint64_t size;   //!< バイトサイズ
+};
+
+//! \brief 部分メッシュ
+struct mesh_file_submesh
+{
+	index_submesh   indices;        //!< 最も細かい段のインデックス
+	bounding_sphere bounds;         //!< 参照する頂点の境界球
+	uint32_t        lod_offset;     //!< mesh_view::lods 内の先頭位置
+	uint32_t        lod_count;      //!< LOD の段数 (1 以上、先頭は indices と同じ範囲)
+	uint32_t        meshlet_offset; //!< mesh_view::meshlets 内の先頭位置
+	uint32_t        meshlet_count;  //!< メッシュレット数 (作らない場合は 0)
+};
+
+//! \brief メッシュファイルのヘッダー
+struct mesh_file_header
+{
+	uint32_t                                  magic;        //!< 'D', 'X', 'M', 'S'
+	uint32_t                                  version;      //!< mesh_file_version
+	uint64_t                                  file_size;    //!< ファイルのバイトサイズ
+	bounding_box                              box;          //!< 全ての頂点の境界ボックス
+	bounding_sphere                           sphere;       //!< 全ての頂点の境界球
+	uint32_t                                  vertex_count; //!< 頂点数
+	vertex_streams                            streams;      //!< 頂点ストリームの構成
+	uint8_t                                   reserved[3];
+	mesh_file_array<vertex_input_element>     elements;
+	mesh_file_array<mesh_file_stream>         stream_table;
+	mesh_file_array<mesh_file_submesh>        submeshes;
+	mesh_file_array<lod_level>                lods;
+	mesh_file_array<meshlet>                  meshlets;
+	mesh_file_array<geometry::meshlet_bounds> meshlet_bounds;
+	mesh_file_array<uint32_t>                 meshlet_vertices;
+	mesh_file_array<uint8_t>                  meshlet_triangles;
+	mesh_file_array<uint8_t>                  vertex_data;
+	mesh_file_array<uint8_t>                  index_data;
+};
+
+//! \brief メッシュファイルの内容を参照するビュー
+//!
+//! 参照先のメモリ (マップしたファイルなど) が有効な間だけ使えます。
+struct mesh_view
+{
+	const mesh_file_header*                   header = nullptr;
+	std::span<const vertex_input_element>     elements;
+	std::span<const mesh_file_stream>         streams;
+	std::span<const mesh_file_submesh>        submeshes;
+	std::span<const lod_level>                lods;
+	std::span<const meshlet>                  meshlets;
+	std::span<const geometry::meshlet_bounds> meshlet_bounds;
+	std::span<const uint32_t>                 meshlet_vertices;
+	std::span<const uint8_t>                  meshlet_triangles;
+	std::span<const uint8_t>                  vertex_data;
+	std::span<const uint8_t>                  index_data;
+
+	//! \brief streams[i] の頂点データ (入力スロットの頂点バッファにそのままコピーできます)
+	[[nodiscard]] std::span<const uint8_t> stream_data(size_t i) const noexcept
+	{
+		return vertex_data.subspan(static_cast<size_t>(streams[i].offset), static_cast<size_t>(streams[i].size));
+	}
+
+	//! \brief submeshes[i] の LOD (細かい順)
+	[[nodiscard]] std::span<const lod_level> submesh_lods(size_t i) const noexcept
+	{
+		return lods.subspan(submeshes[i].lod_offset, submeshes[i].lod_count);
+	}
+
+	//! \brief submeshes[i] のメッシュレット
+	[[nodiscard]] std::span<const meshlet> submesh_meshlets(size_t i) const noexcept
+	{
+		return meshlets.subspan(submeshes[i].meshlet_offset, submeshes[i].meshlet_count);
+	}
+};
+
+//! \brief メッシュファイルを開きます
+//!
+//! \param[in]  file ファイルの内容 (16 バイト境界に置かれている必要があります)
+//! \param[out] view
+//! \return 形式が正しくない場合、セクションが範囲外の場合は false
+bool open_mesh(std::span<const uint8_t> file, mesh_view& view) noexcept;
+
+//! \brief メモリにマップしたメッシュファイル
+class mapped_mesh
+{
+public:
+	//! \brief ファイルをマップして開きます
+	//!
+	//! \return 開けない場合、形式が正しくない場合は false
+	bool open(const wchar_t* filename);
+
+	//! \brief ファイルを閉じます
+	void close() noexcept;
+
+	[[nodiscard]] bool is_open() const noexcept
+	{
+		return m_view.header != nullptr;
+	}
+
+	[[nodiscard]] const mesh_view& view() const noexcept
+	{
+		return m_view;
+	}
+
+private:
+	mapped_file m_file;
+	mesh_view   m_view;
+};
+
+//! \brief write_mesh_file の入力
+struct mesh_source
+{
+	std::span<const vertex_element> elements;     //!< 頂点レイアウト (先頭は float32x3 の位置)
+	const void*                     vertices     = nullptr;
+	uint32_t                        stride       = 0;
+	uint32_t                        vertex_count = 0;
+	std::span<const uint32_t>       indices;   //!< 三角形リスト
+	std::span<const index_range>    submeshes; //!< 部分メッシュ (空の場合は全体で 1 つ)
+};
+
+//! \brief write_mesh_file の設定
+struct mesh_file_options
+{
+	vertex_streams    streams        = vertex_streams::interleaved;
+	bool              build_lods     = true; //!< 部分メッシュごとに build_lod_chain で LOD を作ります
+	lod_chain_options lod;
+	bool              build_meshlets = true; //!< 部分メッシュの最も細かい段を build_meshlets で分割します
+	meshlet_options   meshlet;
+};
+
+//! \brief メッシュファイルの内容を作ります
+//!
+//! \return ファイルの内容 (入力が正しくない場合は空)
+[[nodiscard]] std::vector<uint8_t> write_mesh_file(const mesh_source& source, const mesh_file_options& options = {});
+
+//! \brief static_mesh をメッシュファイルの内容に変換します
+template<class Vertex, size_t NV, size_t NI>
+[[nodiscard]] std::vector<uint8_t> write_mesh_file(const static_mesh<Vertex, NV, NI>& mesh, const mesh_file_options& options = {})
+{
+	const std::vector<uint32_t> indices(mesh.indices.begin(), mesh.indices.end());
+
+	mesh_source source;
+	source.elements     = vertex_traits<Vertex>::elements;
+	source.vertices     = mesh.vertices.data();
+	source.stride       = sizeof(Vertex);
+	source.vertex_count = mesh.vertex_count;
+	source.indices      = indices;
+	return write_mesh_file(source, options);
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,47 @@
+#include "mesh_lod.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dxlib {
+namespace geometry {
+
+lod_selector::lod_selector(const scene::camera& camera, float viewport_height, float pixel_error) noexcept
+    : m_position(camera.position)
+    , m_near_z(camera.near_z)
+    , m_error_scale(viewport_height / (2.0f * std::tan(camera.fov_y * 0.5f) * pixel_error))
+    , m_pixel_error(pixel_error)
+{
+}
+
+float lod_selector::projected_error(float error, float distance) const noexcept
+{
+	return error * m_error_scale * m_pixel_error / std::max(distance, m_near_z);
+}
+
+bool lod_selector::is_acceptable(float error, const bounding_sphere& bounds) const noexcept
+{
+	return error * m_error_scale <= std::max(length(bounds.center - m_position) - bounds.radius, m_near_z);
+}
+
+uint32_t lod_selector::select(std::span<const lod_level> levels, const bounding_sphere& bounds, float scale) const noexcept
+{
+	// 画面上の誤差が 1 以下 <=> error * scale * m_error_scale <= distance
+	const float limit = std::max(length(bounds.center - m_position) - bounds.radius, m_near_z) / (scale * m_error_scale);
+
+	uint32_t level = 0;
+	for (uint32_t i = 1; i < levels.size() && levels[i].error <= limit; ++i) {
+		level = i;
+	}
+	return level;
+}
+
+void lod_selector::select(std::span<const lod_level> levels, std::span<const bounding_sphere> bounds, std::span<const float> scale, std::span<uint32_t> out) const noexcept
+{
+	for (size_t i = 0; i < bounds.size(); ++i) {
+		out[i] = select(levels, bounds[i], scale[i]);
+	}
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "bounds.h"
+#include "camera.h"
+
+namespace dxlib {
+namespace geometry {
+
+//! \brief LOD の 1 段
+struct lod_level
+{
+	uint32_t index_offset; //!< インデックスバッファ内の先頭位置
+	uint32_t index_count;  //!< インデックス数
+	float    error;        //!< 元のメッシュに対する誤差 (メッシュの座標系での距離)
+};
+
+//! \brief 画面上の誤差から LOD の段を選びます
+//!
+//! 誤差 e のメッシュを距離 d から見たときの画面上の誤差 (ピクセル) は e * viewport_height / (2 * d * tan(fov_y / 2)) です。
+//! 距離は境界球の表面までの距離 (near_z 以上) とし、画面上の誤差が pixel_error 以下の段のうち最も粗い段を選びます。
+class lod_selector
+{
+public:
+	//! \brief コンストラクタ
+	//!
+	//! \param[in] camera
+	//! \param[in] viewport_height ビューポートの高さ (ピクセル)
+	//! \param[in] pixel_error     許容する画面上の誤差 (ピクセル)
+	lod_selector(const scene::camera& camera, float viewport_height, float pixel_error = 1.0f) noexcept;
+
+	//! \brief 距離 distance にある誤差 error の画面上の誤差 (ピクセル、pixel_error では割りません)
+	[[nodiscard]] float projected_error(float error, float distance) const noexcept;
+
+	//! \brief 境界球 bounds の位置にある誤差 error が画面上で pixel_error 以下になるか
+	//!
+	//! 境界球を含む大きな球、または大きな誤差に対して単調 (true から false にしか変わらない) です。
+	[[nodiscard]] bool is_acceptable(float error, const bounding_sphere& bounds) const noexcept;
+
+	//! \brief 段を選びます
+	//!
+	//! \param[in] levels 細かい順の LOD
+	//! \param[in] bounds ワールド座標系での境界球
+	//! \param[in] scale  メッシュの座標系からワールド座標系への拡大率 (誤差に掛けます)
+	//! \return levels の番号
+	[[nodiscard]] uint32_t select(std::span<const lod_level> levels, const bounding_sphere& bounds, float scale = 1.0f) const noexcept;
+
+	//! \brief 複数のインスタンスの段をまとめて選びます
+	//!
+	//! \param[in]  levels
+	//! \param[in]  bounds ワールド座標系での境界球
+	//! \param[in]  scale  インスタンスごとの拡大率
+	//! \param[out] out    bounds.size() 要素以上
+	void select(std::span<const lod_level> levels, std::span<const bounding_sphere> bounds, std::span<const float> scale, std::span<uint32_t> out) const noexcept;
+
+private:
+	float3 m_position;
+	float  m_near_z;
+	float  m_error_scale; //!< viewport_height / (2 * tan(fov_y / 2) * pixel_error)
+	float  m_pixel_error;
+};
+
+} // namespace geometry
+} // namespace dxlib
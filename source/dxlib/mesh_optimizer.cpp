@@ -0,0 +1,702 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "debug.h"
+#include "thread_pool.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+constexpr uint32_t invalid = ~0u;
+
+constexpr uint32_t min_cache_size = 4;
+constexpr uint32_t max_cache_size = 64;
+
+uint32_t clamp_cache_size(uint32_t cache_size) noexcept
+{
+	return std::clamp(cache_size, min_cache_size, max_cache_size);
+}
+
+// --- 作業領域 ---
+
+// 部分メッシュの頂点を 0 から連続する番号に詰め直したもの
+struct local_mesh
+{
+	std::vector<uint32_t> indices;  // ローカル番号の三角形リスト
+	std::vector<uint32_t> vertices; // ローカル番号 -> 元の番号
+};
+
+// 元の番号からローカル番号への対応表
+//
+// 表はスレッドごとに 1 つだけ確保し、load で書き込んだ要素だけを戻して使い回します。
+// そのため頂点数の大きな頂点バッファを共有する小さな部分メッシュでも、load の処理量は部分メッシュの大きさに比例します。
+class local_mapper
+{
+public:
+	explicit local_mapper(uint32_t vertex_count)
+	    : m_map(thread_map())
+	    , m_vertex_count(vertex_count)
+	{
+		if (m_map.size() < vertex_count) {
+			m_map.resize(vertex_count, invalid);
+		}
+	}
+
+	//! 範囲外の頂点番号を含む場合は false を返します
+	template<class Index>
+	bool load(std::span<const Index> indices, local_mesh& mesh)
+	{
+		mesh.indices.resize(indices.size());
+		mesh.vertices.clear();
+		mesh.vertices.reserve(indices.size());
+
+		bool valid = true;
+		for (size_t i = 0; i < indices.size(); ++i) {
+			if (indices[i] >= m_vertex_count) {
+				valid = false;
+				break;
+			}
+			uint32_t& local = m_map[indices[i]];
+			if (local == invalid) {
+				local = static_cast<uint32_t>(mesh.vertices.size());
+				mesh.vertices.push_back(indices[i]);
+			}
+			mesh.indices[i] = local;
+		}
+		for (const uint32_t v : mesh.vertices) {
+			m_map[v] = invalid;
+		}
+		ASSERT_RETURN(valid, false);
+		return true;
+	}
+
+	template<class Index>
+	static void store(const local_mesh& mesh, std::span<Index> indices) noexcept
+	{
+		for (size_t i = 0; i < indices.size(); ++i) {
+			indices[i] = static_cast<Index>(mesh.vertices[mesh.indices[i]]);
+		}
+	}
+
+private:
+	static std::vector<uint32_t>& thread_map()
+	{
+		thread_local std::vector<uint32_t> map;
+		return map;
+	}
+
+	std::vector<uint32_t>& m_map;
+	uint32_t               m_vertex_count;
+};
+
+// 頂点ごとの隣接三角形 (CSR)
+// 各頂点の先頭 live[v] 個が未出力の三角形です
+struct adjacency
+{
+	explicit adjacency(const local_mesh& mesh)
+	{
+		const size_t vertex_count = mesh.vertices.size();
+		live.assign(vertex_count, 0);
+		for (const uint32_t v : mesh.indices) {
+			++live[v];
+		}
+		offset.resize(vertex_count + 1);
+		offset[0] = 0;
+		for (size_t v = 0; v < vertex_count; ++v) {
+			offset[v + 1] = offset[v] + live[v];
+		}
+		triangles.resize(mesh.indices.size());
+		std::vector<uint32_t> cursor(offset.begin(), offset.end() - 1);
+		for (size_t i = 0; i < mesh.indices.size(); ++i) {
+			triangles[cursor[mesh.indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	// 頂点 v の未出力の三角形から t を取り除きます
+	void remove(uint32_t v, uint32_t t) noexcept
+	{
+		uint32_t* begin = &triangles[offset[v]];
+		uint32_t* last  = begin + live[v] - 1;
+		std::iter_swap(std::find(begin, last, t), last);
+		--live[v];
+	}
+
+	std::vector<uint32_t> offset;
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> live;
+};
+
+// --- 頂点キャッシュのシミュレーション ---
+
+// 最後に読み込んだ時刻で FIFO キャッシュを表します (time - stamp[v] < cache_size ならキャッシュ内)
+class fifo_cache
+{
+public:
+	fifo_cache(size_t vertex_count, uint32_t cache_size)
+	    : m_stamp(vertex_count, 0)
+	    , m_size(cache_size)
+	    , m_time(cache_size + 1)
+	{
+	}
+
+	// v を参照し、キャッシュミスなら true を返します
+	bool access(uint32_t v) noexcept
+	{
+		if (m_time - m_stamp[v] > m_size) {
+			m_stamp[v] = m_time++;
+			return true;
+		}
+		return false;
+	}
+
+	void clear() noexcept
+	{
+		m_time += m_size + 1;
+	}
+
+private:
+	std::vector<uint32_t> m_stamp;
+	uint32_t              m_size;
+	uint32_t              m_time;
+};
+
+vertex_cache_stats analyze(const local_mesh& mesh, uint32_t cache_size)
+{
+	fifo_cache         cache(mesh.vertices.size(), cache_size);
+	vertex_cache_stats stats;
+	stats.triangle_count = static_cast<uint32_t>(mesh.indices.size() / 3);
+	stats.vertex_count   = static_cast<uint32_t>(mesh.vertices.size());
+	for (const uint32_t v : mesh.indices) {
+		stats.transformed_count += cache.access(v) ? 1 : 0;
+	}
+	return stats;
+}
+
+// --- Tipsify ---
+
+void tipsify(local_mesh& mesh, uint32_t cache_size)
+{
+	const uint32_t vertex_count   = static_cast<uint32_t>(mesh.vertices.size());
+	const size_t   triangle_count = mesh.indices.size() / 3;
+	if (triangle_count == 0) {
+		return;
+	}
+
+	adjacency             adj(mesh);
+	std::vector<uint32_t> stamp(vertex_count, 0);
+	std::vector<uint8_t>  emitted(triangle_count, 0);
+	std::vector<uint32_t> dead_end;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> out;
+	out.reserve(mesh.indices.size());
+	dead_end.reserve(mesh.indices.size());
+
+	const uint32_t k      = cache_size;
+	uint32_t       time   = k + 1;
+	uint32_t       cursor = 0;
+	uint32_t       fan    = 0;
+	while (fan != invalid) {
+		// fan を中心とする未出力の三角形を全て出力します
+		candidates.clear();
+		for (uint32_t i = adj.offset[fan]; i < adj.offset[fan + 1]; ++i) {
+			const uint32_t t = adj.triangles[i];
+			if (emitted[t]) {
+				continue;
+			}
+			emitted[t] = 1;
+			for (uint32_t c = 0; c < 3; ++c) {
+				const uint32_t v = mesh.indices[t * 3 + c];
+				out.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				--adj.live[v];
+				if (time - stamp[v] > k) {
+					stamp[v] = time++;
+				}
+			}
+		}
+
+		// 次の中心: 扇を出力してもキャッシュに残る頂点のうち、最も古いもの
+		fan           = invalid;
+		int64_t score = -1;
+		for (const uint32_t v : candidates) {
+			if (adj.live[v] == 0) {
+				continue;
+			}
+			const uint32_t age = time - stamp[v];
+			const int64_t  p   = age + 2 * adj.live[v] <= k ? age : 0;
+			if (p > score) {
+				score = p;
+				fan   = v;
+			}
+		}
+
+		// 行き止まりの場合は最近出力した頂点、それもなければ未出力の三角形を持つ頂点を順に探します
+		while (fan == invalid && !dead_end.empty()) {
+			const uint32_t v = dead_end.back();
+			dead_end.pop_back();
+			if (adj.live[v] > 0) {
+				fan = v;
+			}
+		}
+		while (fan == invalid && cursor < vertex_count) {
+			if (adj.live[cursor] > 0) {
+				fan = cursor;
+			}
+			++cursor;
+		}
+	}
+
+	mesh.indices.swap(out);
+}
+
+// --- Forsyth ---
+
+// スコアの計算に使う LRU キャッシュの要素数
+// 論文の推奨値で、実際の FIFO キャッシュの大きさに合わせるより 16 要素の FIFO での ACMR も良くなります
+constexpr uint32_t forsyth_cache_size = 32;
+
+class forsyth_score
+{
+public:
+	explicit forsyth_score(uint32_t cache_size) noexcept
+	{
+		// 直前の三角形の 3 頂点は一定値、それ以降は古いほど下がります
+		constexpr float last_triangle_score = 0.75f;
+		constexpr float cache_decay_power   = 1.5f;
+		for (uint32_t i = 0; i < cache_size; ++i) {
+			m_cache[i] = i < 3 ? last_triangle_score : std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(cache_size - 3), cache_decay_power);
+		}
+
+		// 残りの三角形が少ない頂点を優先して、孤立した三角形が残らないようにします
+		constexpr float valence_boost_scale = 2.0f;
+		constexpr float valence_boost_power = 0.5f;
+		m_valence[0]                        = 0.0f;
+		for (uint32_t i = 1; i < max_valence; ++i) {
+			m_valence[i] = valence_boost_scale * std::pow(static_cast<float>(i), -valence_boost_power);
+		}
+	}
+
+	// position はキャッシュ内の位置 (キャッシュ外は invalid)
+	[[nodiscard]] float operator()(uint32_t position, uint32_t live) const noexcept
+	{
+		if (live == 0) {
+			return -1.0f;
+		}
+		const float cache = position == invalid ? 0.0f : m_cache[position];
+		return cache + m_valence[std::min(live, max_valence - 1)];
+	}
+
+private:
+	static constexpr uint32_t max_valence = 32;
+
+	float m_cache[forsyth_cache_size];
+	float m_valence[max_valence];
+};
+
+void forsyth(local_mesh& mesh)
+{
+	constexpr uint32_t cache_size = forsyth_cache_size;
+
+	const uint32_t vertex_count   = static_cast<uint32_t>(mesh.vertices.size());
+	const uint32_t triangle_count = static_cast<uint32_t>(mesh.indices.size() / 3);
+	if (triangle_count == 0) {
+		return;
+	}
+
+	const forsyth_score score(cache_size);
+	adjacency           adj(mesh);
+	std::vector<uint32_t> position(vertex_count, invalid);
+	std::vector<float>    vertex_score(vertex_count);
+	std::vector<float>    triangle_score(triangle_count, 0.0f);
+	std::vector<uint8_t>  emitted(triangle_count, 0);
+	for (uint32_t v = 0; v < vertex_count; ++v) {
+		vertex_score[v] = score(invalid, adj.live[v]);
+	}
+	for (uint32_t t = 0; t < triangle_count; ++t) {
+		for (uint32_t c = 0; c < 3; ++c) {
+			triangle_score[t] += vertex_score[mesh.indices[t * 3 + c]];
+		}
+	}
+
+	uint32_t best = static_cast<uint32_t>(std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> next_cache;
+	std::vector<uint32_t> out;
+	cache.reserve(cache_size + 3);
+	next_cache.reserve(cache_size + 3);
+	out.reserve(mesh.indices.size());
+
+	uint32_t cursor = 0;
+	for (uint32_t n = 0; n < triangle_count; ++n) {
+		// キャッシュ内に候補がない場合は未出力の三角形を順に探します
+		if (best == invalid) {
+			while (emitted[cursor]) {
+				++cursor;
+			}
+			best = cursor;
+		}
+
+		const uint32_t* tri = &mesh.indices[best * 3];
+		emitted[best]       = 1;
+		out.insert(out.end(), tri, tri + 3);
+		for (uint32_t c = 0; c < 3; ++c) {
+			adj.remove(tri[c], best);
+		}
+
+		// LRU: 出力した 3 頂点を先頭に移動します
+		next_cache.assign(tri, tri + 3);
+		for (const uint32_t v : cache) {
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				next_cache.push_back(v);
+			}
+		}
+
+		// 位置が変わった頂点のスコアを更新し、その三角形から次を選びます
+		best             = invalid;
+		float best_score = -1.0f;
+		for (uint32_t i = 0; i < next_cache.size(); ++i) {
+			const uint32_t v = next_cache[i];
+			position[v]      = i < cache_size ? i : invalid;
+
+			const float s     = score(position[v], adj.live[v]);
+			const float delta = s - vertex_score[v];
+			vertex_score[v]   = s;
+			for (uint32_t j = adj.offset[v]; j < adj.offset[v] + adj.live[v]; ++j) {
+				const uint32_t t = adj.triangles[j];
+				triangle_score[t] += delta;
+			}
+		}
+		for (uint32_t i = 0; i < next_cache.size() && i < cache_size; ++i) {
+			const uint32_t v = next_cache[i];
+			for (uint32_t j = adj.offset[v]; j < adj.offset[v] + adj.live[v]; ++j) {
+				const uint32_t t = adj.triangles[j];
+				if (triangle_score[t] > best_score) {
+					best_score = triangle_score[t];
+					best       = t;
+				}
+			}
+		}
+
+		if (next_cache.size() > cache_size) {
+			next_cache.resize(cache_size);
+		}
+		cache.swap(next_cache);
+	}
+
+	mesh.indices.swap(out);
+}
+
+void optimize_cache(local_mesh& mesh, vertex_cache_method method, uint32_t cache_size)
+{
+	if (method == vertex_cache_method::forsyth) {
+		forsyth(mesh);
+	}
+	else {
+		tipsify(mesh, cache_size);
+	}
+}
+
+// --- オーバードロー ---
+
+// 三角形の開始位置でクラスタに分割します
+// キャッシュが空になる位置 (3 頂点ともミス) で分け、さらにクラスタ内の ACMR が全体の threshold 倍以下になった位置で分けます
+// 並べ替え後のキャッシュの状態は分からないので、クラスタの先頭ではキャッシュを空にしてシミュレーションします
+std::vector<uint32_t> build_clusters(const local_mesh& mesh, uint32_t cache_size, float threshold)
+{
+	const uint32_t triangle_count = static_cast<uint32_t>(mesh.indices.size() / 3);
+
+	std::vector<uint32_t> hard;
+	{
+		fifo_cache cache(mesh.vertices.size(), cache_size);
+		for (uint32_t t = 0; t < triangle_count; ++t) {
+			uint32_t misses = 0;
+			for (uint32_t c = 0; c < 3; ++c) {
+				misses += cache.access(mesh.indices[t * 3 + c]) ? 1 : 0;
+			}
+			if (t == 0 || misses == 3) {
+				hard.push_back(t);
+			}
+		}
+	}
+	hard.push_back(triangle_count);
+
+	std::vector<uint32_t> clusters;
+	fifo_cache            cache(mesh.vertices.size(), cache_size);
+	for (size_t h = 0; h + 1 < hard.size(); ++h) {
+		const uint32_t begin = hard[h];
+		const uint32_t end   = hard[h + 1];
+
+		cache.clear();
+		uint32_t misses = 0;
+		for (uint32_t i = begin * 3; i < end * 3; ++i) {
+			misses += cache.access(mesh.indices[i]) ? 1 : 0;
+		}
+		const float limit = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+		cache.clear();
+		uint32_t start = begin;
+		misses         = 0;
+		for (uint32_t t = begin; t < end; ++t) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				misses += cache.access(mesh.indices[t * 3 + c]) ? 1 : 0;
+			}
+			if (static_cast<float>(misses) <= limit * static_cast<float>(t - start + 1)) {
+				clusters.push_back(start);
+				start  = t + 1;
+				misses = 0;
+				cache.clear();
+			}
+		}
+		if (start < end) {
+			clusters.push_back(start);
+		}
+	}
+	clusters.push_back(triangle_count);
+	return clusters;
+}
+
+void optimize_overdraw(local_mesh& mesh, position_view positions, uint32_t cache_size, float threshold)
+{
+	const uint32_t triangle_count = static_cast<uint32_t>(mesh.indices.size() / 3);
+	if (triangle_count == 0) {
+		return;
+	}
+
+	const std::vector<uint32_t> clusters      = build_clusters(mesh, cache_size, threshold);
+	const size_t                cluster_count = clusters.size() - 1;
+
+	// クラスタごとの面積で重み付けした重心と法線 (外積の合計)
+	struct cluster_info
+	{
+		float3 centroid;
+		float3 normal;
+		float  area;
+		float  sort_key;
+	};
+	std::vector<cluster_info> info(cluster_count);
+	float3                    mesh_centroid(0.0f);
+	float                     mesh_area = 0.0f;
+	for (size_t k = 0; k < cluster_count; ++k) {
+		cluster_info& ci = info[k];
+		ci.centroid      = float3(0.0f);
+		ci.normal        = float3(0.0f);
+		ci.area          = 0.0f;
+		for (uint32_t t = clusters[k]; t < clusters[k + 1]; ++t) {
+			const float3& p0   = positions[mesh.vertices[mesh.indices[t * 3 + 0]]];
+			const float3& p1   = positions[mesh.vertices[mesh.indices[t * 3 + 1]]];
+			const float3& p2   = positions[mesh.vertices[mesh.indices[t * 3 + 2]]];
+			const float3  n    = cross(p1 - p0, p2 - p0);
+			const float   area = length(n);
+			ci.centroid += (p0 + p1 + p2) * (area / 3.0f);
+			ci.normal += n;
+			ci.area += area;
+		}
+		mesh_centroid += ci.centroid;
+		mesh_area += ci.area;
+		if (ci.area > 0.0f) {
+			ci.centroid *= 1.0f / ci.area;
+		}
+	}
+	if (mesh_area > 0.0f) {
+		mesh_centroid *= 1.0f / mesh_area;
+	}
+
+	// 重心から外側を向くクラスタほど手前にあるので先に描画します
+	std::vector<uint32_t> order(cluster_count);
+	for (size_t k = 0; k < cluster_count; ++k) {
+		cluster_info& ci = info[k];
+		const float   nl = length(ci.normal);
+		ci.sort_key      = nl > 0.0f ? dot(ci.centroid - mesh_centroid, ci.normal) / nl : 0.0f;
+		order[k]         = static_cast<uint32_t>(k);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+	    {
+		    return info[a].sort_key > info[b].sort_key;
+	    });
+
+	std::vector<uint32_t> out;
+	out.reserve(mesh.indices.size());
+	for (const uint32_t k : order) {
+		out.insert(out.end(), mesh.indices.begin() + clusters[k] * 3, mesh.indices.begin() + clusters[k + 1] * 3);
+	}
+	mesh.indices.swap(out);
+}
+
+// --- 公開関数の実装 ---
+
+template<class Index>
+vertex_cache_stats analyze_impl(std::span<const Index> indices, uint32_t vertex_count, uint32_t cache_size)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0, {});
+
+	local_mesh   mesh;
+	local_mapper mapper(vertex_count);
+	if (!mapper.load(indices, mesh)) {
+		return {};
+	}
+	return analyze(mesh, clamp_cache_size(cache_size));
+}
+
+template<class Index>
+void optimize_vertex_cache_impl(std::span<Index> indices, uint32_t vertex_count, vertex_cache_method method, uint32_t cache_size)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0);
+
+	local_mesh   mesh;
+	local_mapper mapper(vertex_count);
+	if (!mapper.load(std::span<const Index>(indices), mesh)) {
+		return;
+	}
+	optimize_cache(mesh, method, clamp_cache_size(cache_size));
+	local_mapper::store(mesh, indices);
+}
+
+template<class Index>
+void optimize_overdraw_impl(std::span<Index> indices, position_view positions, uint32_t cache_size, float threshold)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0);
+
+	local_mesh   mesh;
+	local_mapper mapper(positions.count);
+	if (!mapper.load(std::span<const Index>(indices), mesh)) {
+		return;
+	}
+	optimize_overdraw(mesh, positions, clamp_cache_size(cache_size), threshold);
+	local_mapper::store(mesh, indices);
+}
+
+template<class Index>
+uint32_t optimize_vertex_fetch_impl(std::span<Index> indices, std::span<uint32_t> remap)
+{
+	std::fill(remap.begin(), remap.end(), unused_vertex);
+
+	uint32_t next = 0;
+	for (Index& i : indices) {
+		ASSERT_RETURN(i < remap.size(), next);
+		uint32_t& r = remap[i];
+		if (r == unused_vertex) {
+			r = next++;
+		}
+		i = static_cast<Index>(r);
+	}
+	return next;
+}
+
+template<class Index>
+mesh_optimize_result optimize_mesh_impl(std::span<Index> indices, std::span<const index_range> submeshes, position_view positions, uint32_t vertex_count, std::span<uint32_t> remap, const mesh_optimize_options& options, dxlib::thread_pool* pool)
+{
+	const index_range whole { 0, static_cast<uint32_t>(indices.size()) };
+	if (submeshes.empty()) {
+		submeshes = std::span<const index_range>(&whole, 1);
+	}
+
+	const uint32_t cache_size = clamp_cache_size(options.cache_size);
+	const bool     overdraw   = options.overdraw_threshold > 0.0f && positions.data != nullptr;
+
+	struct submesh_stats
+	{
+		vertex_cache_stats before;
+		vertex_cache_stats after;
+	};
+	std::vector<submesh_stats> stats(submeshes.size());
+
+	auto optimize_range = [&](size_t begin, size_t end)
+	{
+		local_mesh   mesh;
+		local_mapper mapper(vertex_count);
+		for (size_t s = begin; s < end; ++s) {
+			const index_range& r = submeshes[s];
+			ASSERT_RETURN(r.count % 3 == 0 && r.offset + r.count <= indices.size());
+
+			const std::span<Index> range = indices.subspan(r.offset, r.count);
+			if (!mapper.load(std::span<const Index>(range), mesh)) {
+				continue;
+			}
+			stats[s].before = analyze(mesh, cache_size);
+			optimize_cache(mesh, options.method, cache_size);
+			if (overdraw) {
+				optimize_overdraw(mesh, positions, cache_size, options.overdraw_threshold);
+			}
+			stats[s].after = analyze(mesh, cache_size);
+			local_mapper::store(mesh, range);
+		}
+	};
+	if (pool && submeshes.size() > 1) {
+		pool->parallel_for(submeshes.size(), 1, optimize_range);
+	}
+	else {
+		optimize_range(0, submeshes.size());
+	}
+
+	mesh_optimize_result result {};
+	for (const submesh_stats& s : stats) {
+		result.before += s.before;
+		result.after += s.after;
+	}
+	result.vertex_count = remap.empty() ? vertex_count : optimize_vertex_fetch_impl(indices, remap);
+	return result;
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+vertex_cache_stats analyze_vertex_cache(std::span<const uint16_t> indices, uint32_t vertex_count, uint32_t cache_size)
+{
+	return analyze_impl(indices, vertex_count, cache_size);
+}
+
+vertex_cache_stats analyze_vertex_cache(std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size)
+{
+	return analyze_impl(indices, vertex_count, cache_size);
+}
+
+void optimize_vertex_cache(std::span<uint16_t> indices, uint32_t vertex_count, vertex_cache_method method, uint32_t cache_size)
+{
+	optimize_vertex_cache_impl(indices, vertex_count, method, cache_size);
+}
+
+void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count, vertex_cache_method method, uint32_t cache_size)
+{
+	optimize_vertex_cache_impl(indices, vertex_count, method, cache_size);
+}
+
+void optimize_overdraw(std::span<uint16_t> indices, position_view positions, uint32_t cache_size, float threshold)
+{
+	optimize_overdraw_impl(indices, positions, cache_size, threshold);
+}
+
+void optimize_overdraw(std::span<uint32_t> indices, position_view positions, uint32_t cache_size, float threshold)
+{
+	optimize_overdraw_impl(indices, positions, cache_size, threshold);
+}
+
+uint32_t optimize_vertex_fetch(std::span<uint16_t> indices, std::span<uint32_t> remap)
+{
+	return optimize_vertex_fetch_impl(indices, remap);
+}
+
+uint32_t optimize_vertex_fetch(std::span<uint32_t> indices, std::span<uint32_t> remap)
+{
+	return optimize_vertex_fetch_impl(indices, remap);
+}
+
+mesh_optimize_result optimize_mesh(std::span<uint16_t> indices, std::span<const index_range> submeshes, position_view positions, uint32_t vertex_count, std::span<uint32_t> remap, const mesh_optimize_options& options, thread_pool* pool)
+{
+	return optimize_mesh_impl(indices, submeshes, positions, vertex_count, remap, options, pool);
+}
+
+mesh_optimize_result optimize_mesh(std::span<uint32_t> indices, std::span<const index_range> submeshes, position_view positions, uint32_t vertex_count, std::span<uint32_t> remap, const mesh_optimize_options& options, thread_pool* pool)
+{
+	return optimize_mesh_impl(indices, submeshes, positions, vertex_count, remap, options, pool);
+}
+
+} // namespace geometry
+} // namespace dxlib
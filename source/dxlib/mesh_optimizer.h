@@ -0,0 +1,186 @@
+﻿#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+
+#include "vertex.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+namespace geometry {
+
+// インデックスバッファの最適化
+//
+// 三角形リストのインデックスを次の順で並べ替えます。
+// 1. 頂点キャッシュ: 変換済み頂点の再利用が増える順に三角形を並べ替えます (Forsyth / Tipsify)
+// 2. オーバードロー: 1 の結果をクラスタに分け、外側を向くクラスタから描画する順に並べ替えます (Sander et al. 2007)
+// 3. 頂点フェッチ: 頂点を最初に参照される順に並べ替えます
+//
+// 頂点キャッシュは GPU の post-transform キャッシュを cache_size 要素の FIFO としてモデル化します。
+
+//! \brief 頂点キャッシュの並べ替え方法
+enum class vertex_cache_method : uint8_t
+{
+	forsyth, //!< 32 要素の LRU キャッシュ上のスコアで三角形を選びます (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+	tipsify, //!< 扇状に三角形を辿ります (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+};
+
+//! \brief 頂点キャッシュのシミュレーション結果
+struct vertex_cache_stats
+{
+	uint32_t triangle_count    = 0; //!< 三角形数
+	uint32_t vertex_count      = 0; //!< 参照される頂点数
+	uint32_t transformed_count = 0; //!< キャッシュミスで頂点シェーダを実行した回数
+
+	//! \brief ACMR (三角形あたりの頂点シェーダ実行回数、0.5 ~ 3)
+	[[nodiscard]] float acmr() const noexcept
+	{
+		return triangle_count ? static_cast<float>(transformed_count) / static_cast<float>(triangle_count) : 0.0f;
+	}
+
+	//! \brief ATVR (頂点あたりの頂点シェーダ実行回数、1 が最適)
+	[[nodiscard]] float atvr() const noexcept
+	{
+		return vertex_count ? static_cast<float>(transformed_count) / static_cast<float>(vertex_count) : 0.0f;
+	}
+
+	vertex_cache_stats& operator+=(const vertex_cache_stats& s) noexcept
+	{
+		triangle_count += s.triangle_count;
+		vertex_count += s.vertex_count;
+		transformed_count += s.transformed_count;
+		return *this;
+	}
+};
+
+//! \brief 頂点配列の位置
+//!
+//! stride バイト間隔に並んだ float3 を参照します。
+struct position_view
+{
+	const uint8_t* data   = nullptr;
+	uint32_t       stride = 0;
+	uint32_t       count  = 0;
+
+	position_view() = default;
+
+	position_view(std::span<const float3> positions) noexcept
+	    : data(reinterpret_cast<const uint8_t*>(positions.data()))
+	    , stride(sizeof(float3))
+	    , count(static_cast<uint32_t>(positions.size()))
+	{
+	}
+
+	//! \brief vertex_* の position を参照します
+	template<class V>
+	requires std::same_as<decltype(V::position), float3>
+	position_view(std::span<const V> vertices) noexcept
+	    : data(vertices.empty() ? nullptr : reinterpret_cast<const uint8_t*>(&vertices.front().position))
+	    , stride(sizeof(V))
+	    , count(static_cast<uint32_t>(vertices.size()))
+	{
+	}
+
+	[[nodiscard]] const float3& operator[](size_t i) const noexcept
+	{
+		return *reinterpret_cast<const float3*>(data + i * stride);
+	}
+};
+
+//! \brief インデックスバッファ内の部分メッシュ
+struct index_range
+{
+	uint32_t offset; //!< 先頭のインデックス位置
+	uint32_t count;  //!< インデックス数 (3 の倍数)
+};
+
+//! \brief optimize_mesh の設定
+struct mesh_optimize_options
+{
+	vertex_cache_method method             = vertex_cache_method::tipsify;
+	uint32_t            cache_size         = 16;    //!< 想定する頂点キャッシュの要素数 (4 ~ 64)
+	float               overdraw_threshold = 1.05f; //!< クラスタ分割で許容する ACMR の悪化率 (0 以下の場合はオーバードロー最適化を行いません)
+};
+
+//! \brief optimize_mesh の結果
+struct mesh_optimize_result
+{
+	vertex_cache_stats before;       //!< 最適化前 (部分メッシュごとの合計)
+	vertex_cache_stats after;        //!< 最適化後 (部分メッシュごとの合計)
+	uint32_t           vertex_count; //!< 頂点フェッチ最適化後の頂点数 (参照されない頂点を除いた数)
+};
+
+//! \brief remap で参照されない頂点を表す値
+inline constexpr uint32_t unused_vertex = ~0u;
+
+//! \brief 頂点キャッシュをシミュレーションします
+//!
+//! \param[in] indices      三角形リスト
+//! \param[in] vertex_count 頂点数 (インデックスの最大値 + 1 以上)
+//! \param[in] cache_size   FIFO キャッシュの要素数
+[[nodiscard]] vertex_cache_stats analyze_vertex_cache(std::span<const uint16_t> indices, uint32_t vertex_count, uint32_t cache_size = 16);
+[[nodiscard]] vertex_cache_stats analyze_vertex_cache(std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size = 16);
+
+//! \brief 頂点キャッシュの効率が上がるように三角形を並べ替えます
+//!
+//! \param[in,out] indices      三角形リスト
+//! \param[in]     vertex_count 頂点数
+//! \param[in]     method
+//! \param[in]     cache_size   想定する頂点キャッシュの要素数 (Tipsify のみ使用します)
+void optimize_vertex_cache(std::span<uint16_t> indices, uint32_t vertex_count, vertex_cache_method method = vertex_cache_method::tipsify, uint32_t cache_size = 16);
+void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count, vertex_cache_method method = vertex_cache_method::tipsify, uint32_t cache_size = 16);
+
+//! \brief 頂点キャッシュ最適化済みの三角形リストをクラスタ単位でオーバードローが減る順に並べ替えます
+//!
+//! キャッシュが空になる位置と、クラスタ内の ACMR が全体の threshold 倍以下になる位置で分割し、
+//! メッシュの重心から外側を向くクラスタほど先に描画します。
+//!
+//! \param[in,out] indices    optimize_vertex_cache の結果
+//! \param[in]     positions  頂点の位置
+//! \param[in]     cache_size optimize_vertex_cache と同じ値
+//! \param[in]     threshold  ACMR の悪化をどこまで許容するか (1.05 で約 5%)
+void optimize_overdraw(std::span<uint16_t> indices, position_view positions, uint32_t cache_size = 16, float threshold = 1.05f);
+void optimize_overdraw(std::span<uint32_t> indices, position_view positions, uint32_t cache_size = 16, float threshold = 1.05f);
+
+//! \brief 頂点を最初に参照される順に並べ替える対応表を作り、インデックスを書き換えます
+//!
+//! \param[in,out] indices
+//! \param[out]    remap   remap[元の頂点番号] = 新しい頂点番号 (参照されない頂点は unused_vertex)、頂点数以上の要素数
+//! \return 参照される頂点数
+uint32_t optimize_vertex_fetch(std::span<uint16_t> indices, std::span<uint32_t> remap);
+uint32_t optimize_vertex_fetch(std::span<uint32_t> indices, std::span<uint32_t> remap);
+
+//! \brief remap に従って頂点を並べ替えます
+//!
+//! out[remap[i]] = in[i] です。out は optimize_vertex_fetch の戻り値以上の要素数が必要です。
+template<class V>
+void remap_vertices(std::span<const V> in, std::span<const uint32_t> remap, std::span<V> out) noexcept
+{
+	for (size_t i = 0; i < in.size(); ++i) {
+		if (remap[i] != unused_vertex) {
+			out[remap[i]] = in[i];
+		}
+	}
+}
+
+//! \brief 頂点キャッシュ、オーバードロー、頂点フェッチの順にまとめて最適化します
+//!
+//! 部分メッシュごとの三角形の並べ替えは pool で並列に処理します。部分メッシュの範囲は重ならない必要があります。
+//! vertex_count 以上の頂点番号を含む部分メッシュは並べ替えません (デバッグビルドではアサートします)。
+//! 頂点フェッチの最適化は全ての部分メッシュで共有する頂点バッファに対して行い、remap が空の場合は行いません。
+//!
+//! \param[in,out] indices      三角形リスト
+//! \param[in]     submeshes    部分メッシュ (空の場合は indices 全体を 1 つとして扱います)
+//! \param[in]     positions    頂点の位置 (オーバードロー最適化に使用します)
+//! \param[in]     vertex_count 頂点数
+//! \param[out]    remap        optimize_vertex_fetch の対応表
+//! \param[in]     options
+//! \param[in]     pool         並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+mesh_optimize_result optimize_mesh(std::span<uint16_t> indices, std::span<const index_range> submeshes, position_view positions, uint32_t vertex_count, std::span<uint32_t> remap, const mesh_optimize_options& options = {}, thread_pool* pool = nullptr);
+mesh_optimize_result optimize_mesh(std::span<uint32_t> indices, std::span<const index_range> submeshes, position_view positions, uint32_t vertex_count, std::span<uint32_t> remap, const mesh_optimize_options& options = {}, thread_pool* pool = nullptr);
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,588 @@
+#include "mesh_simplify.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "debug.h"
+#include "vertex_weld.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+constexpr uint32_t invalid = ~0u;
+constexpr uint32_t many    = ~0u - 1;
+
+// 境界と継ぎ目の辺に加える、辺に垂直な平面の重み (辺の長さの 2 乗に掛けます)
+constexpr double edge_weight = 2.0;
+
+// 縮約前後の三角形の法線がなす角の cos の下限 (約 75 度)
+constexpr float max_normal_change = 0.25f;
+
+// --- 二次誤差 ---
+
+// 平面までの距離の 2 乗の重み付き和 (p^T A p + 2 b^T p + c) と重みの合計
+struct quadric
+{
+	double a00, a11, a22, a01, a02, a12;
+	double b0, b1, b2;
+	double c;
+	double weight;
+
+	void add_plane(const float3& n, float d, double w) noexcept
+	{
+		a00 += w * n.x * n.x;
+		a11 += w * n.y * n.y;
+		a22 += w * n.z * n.z;
+		a01 += w * n.x * n.y;
+		a02 += w * n.x * n.z;
+		a12 += w * n.y * n.z;
+		b0 += w * n.x * d;
+		b1 += w * n.y * d;
+		b2 += w * n.z * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	quadric& operator+=(const quadric& q) noexcept
+	{
+		a00 += q.a00;
+		a11 += q.a11;
+		a22 += q.a22;
+		a01 += q.a01;
+		a02 += q.a02;
+		a12 += q.a12;
+		b0 += q.b0;
+		b1 += q.b1;
+		b2 += q.b2;
+		c += q.c;
+		weight += q.weight;
+		return *this;
+	}
+
+	// 平面までの距離の 2 乗の重み付き平均
+	[[nodiscard]] double error(const float3& p) const noexcept
+	{
+		const double x = p.x, y = p.y, z = p.z;
+		const double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+	}
+};
+
+// --- 位相 ---
+
+enum class vertex_kind : uint8_t
+{
+	manifold, // 開いた辺を持たない
+	border,   // 開いた辺を 1 本ずつ持つ境界
+	seam,     // 同じ位置の頂点が 2 つあり、継ぎ目に沿った開いた辺を 1 本ずつ持つ
+	locked,   // 動かさない
+};
+
+// 頂点ごとの隣接三角形 (CSR)
+struct adjacency
+{
+	void build(const std::vector<uint32_t>& indices, size_t vertex_count)
+	{
+		offset.assign(vertex_count + 1, 0);
+		for (const uint32_t v : indices) {
+			++offset[v + 1];
+		}
+		for (size_t v = 0; v < vertex_count; ++v) {
+			offset[v + 1] += offset[v];
+		}
+		triangles.resize(indices.size());
+		cursor.assign(offset.begin(), offset.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	[[nodiscard]] std::span<const uint32_t> operator[](uint32_t v) const noexcept
+	{
+		return { triangles.data() + offset[v], triangles.data() + offset[v + 1] };
+	}
+
+	std::vector<uint32_t> offset;
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> cursor;
+};
+
+class simplifier
+{
+	struct candidate
+	{
+		uint32_t from;
+		uint32_t to;
+		double   error;
+	};
+
+public:
+	simplifier(position_view positions, const simplify_options& options)
+	    : m_positions(positions)
+	    , m_options(options)
+	{
+		// 同じ位置の頂点に同じ位置番号を割り当てます (-0 と +0 は同じ位置として扱われます)
+		const uint32_t      vertex_count = positions.count;
+		std::vector<float3> packed(vertex_count);
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			packed[v] = positions[v];
+		}
+		const vertex_element layout[] = { { vertex_semantic::position, vertex_format::float32x3, 0 } };
+		m_position_id.resize(vertex_count);
+		const uint32_t position_count = generate_weld_remap(packed.data(), sizeof(float3), vertex_count, layout, m_position_id);
+
+		m_quadric.assign(position_count, quadric {});
+		m_wedge.resize(vertex_count);
+		m_open_in.resize(vertex_count);
+		m_open_out.resize(vertex_count);
+		m_kind.resize(vertex_count);
+		m_remap.resize(vertex_count);
+		m_locked.resize(position_count);
+	}
+
+	simplify_result run(std::vector<uint32_t>& indices, uint32_t target_index_count)
+	{
+		classify(indices);
+		accumulate_quadrics(indices);
+
+		const double target_error = static_cast<double>(m_options.target_error) * m_options.target_error;
+		double       max_error    = 0.0;
+		while (indices.size() > target_index_count) {
+			const size_t collapsed = collapse_pass(indices, target_index_count, target_error, max_error);
+			if (collapsed == 0) {
+				break;
+			}
+			classify(indices);
+		}
+		return { static_cast<uint32_t>(indices.size()), static_cast<float>(std::sqrt(max_error)) };
+	}
+
+private:
+	[[nodiscard]] const float3& position(uint32_t v) const noexcept
+	{
+		return m_positions[v];
+	}
+
+	// 頂点番号で a -> b の半辺があるか
+	[[nodiscard]] bool has_edge(const std::vector<uint32_t>& indices, uint32_t a, uint32_t b) const noexcept
+	{
+		for (const uint32_t t : m_adjacency[a]) {
+			const uint32_t* tri = &indices[t * 3];
+			for (uint32_t c = 0; c < 3; ++c) {
+				if (tri[c] == a && tri[(c + 1) % 3] == b) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// 位置番号で a -> b の半辺があるか
+	[[nodiscard]] bool has_position_edge(const std::vector<uint32_t>& indices, uint32_t a, uint32_t b) const noexcept
+	{
+		uint32_t w = a;
+		do {
+			for (const uint32_t t : m_adjacency[w]) {
+				const uint32_t* tri = &indices[t * 3];
+				for (uint32_t c = 0; c < 3; ++c) {
+					if (tri[c] == w && m_position_id[tri[(c + 1) % 3]] == m_position_id[b]) {
+						return true;
+					}
+				}
+			}
+			w = m_wedge[w];
+		} while (w != a);
+		return false;
+	}
+
+	// 現在の三角形から隣接、開いた辺、頂点の種類を求めます
+	void classify(const std::vector<uint32_t>& indices)
+	{
+		const uint32_t vertex_count = m_positions.count;
+		m_adjacency.build(indices, vertex_count);
+
+		// 同じ位置の (三角形から参照される) 頂点を循環リストで繋ぎます
+		std::vector<uint32_t> last(m_quadric.size(), invalid);
+		std::vector<uint32_t> first(m_quadric.size(), invalid);
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			m_wedge[v] = v;
+			if (m_adjacency.offset[v] == m_adjacency.offset[v + 1]) {
+				continue;
+			}
+			const uint32_t p = m_position_id[v];
+			if (last[p] != invalid) {
+				m_wedge[last[p]] = v;
+			}
+			else {
+				first[p] = v;
+			}
+			last[p] = v;
+		}
+		for (uint32_t p = 0; p < last.size(); ++p) {
+			if (last[p] != invalid) {
+				m_wedge[last[p]] = first[p];
+			}
+		}
+
+		std::fill(m_open_in.begin(), m_open_in.end(), invalid);
+		std::fill(m_open_out.begin(), m_open_out.end(), invalid);
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				const uint32_t a = indices[i + c];
+				const uint32_t b = indices[i + (c + 1) % 3];
+				if (!has_edge(indices, b, a)) {
+					m_open_out[a] = m_open_out[a] == invalid ? b : many;
+					m_open_in[b]  = m_open_in[b] == invalid ? a : many;
+				}
+			}
+		}
+
+		auto single = [](uint32_t v)
+		{
+			return v != invalid && v != many;
+		};
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			const uint32_t w = m_wedge[v];
+			if (w == v) {
+				if (m_open_in[v] == invalid && m_open_out[v] == invalid) {
+					m_kind[v] = vertex_kind::manifold;
+				}
+				else if (single(m_open_in[v]) && single(m_open_out[v]) && !m_options.lock_border) {
+					m_kind[v] = vertex_kind::border;
+				}
+				else {
+					m_kind[v] = vertex_kind::locked;
+				}
+			}
+			else if (m_wedge[w] == v && single(m_open_in[v]) && single(m_open_out[v]) && single(m_open_in[w]) && single(m_open_out[w])
+			         && m_position_id[m_open_out[v]] == m_position_id[m_open_in[w]] && m_position_id[m_open_in[v]] == m_position_id[m_open_out[w]]) {
+				m_kind[v] = vertex_kind::seam;
+			}
+			else {
+				m_kind[v] = vertex_kind::locked;
+			}
+		}
+	}
+
+	// 面の平面と、開いた辺に垂直な平面を位置ごとに加えます
+	void accumulate_quadrics(const std::vector<uint32_t>& indices)
+	{
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			const float3& p0   = position(indices[i + 0]);
+			const float3& p1   = position(indices[i + 1]);
+			const float3& p2   = position(indices[i + 2]);
+			const float3  n    = cross(p1 - p0, p2 - p0);
+			const float   area = length(n);
+			if (area <= 0.0f) {
+				continue;
+			}
+			const float3 unit = n * (1.0f / area);
+			const float  d    = -dot(unit, p0);
+			for (uint32_t c = 0; c < 3; ++c) {
+				m_quadric[m_position_id[indices[i + c]]].add_plane(unit, d, area * 0.5);
+			}
+
+			for (uint32_t c = 0; c < 3; ++c) {
+				const uint32_t a = indices[i + c];
+				const uint32_t b = indices[i + (c + 1) % 3];
+				if (m_open_out[a] == invalid || has_edge(indices, b, a)) {
+					continue;
+				}
+				const float3 edge = position(b) - position(a);
+				const float  len  = length(edge);
+				if (len <= 0.0f) {
+					continue;
+				}
+				const float3 m  = normalize(cross(edge, unit));
+				const float  md = -dot(m, position(a));
+				const double w  = edge_weight * len * len;
+				m_quadric[m_position_id[a]].add_plane(m, md, w);
+				m_quadric[m_position_id[b]].add_plane(m, md, w);
+			}
+		}
+	}
+
+	// a を b に寄せられるか (継ぎ目の場合は反対側の組を返します)
+	[[nodiscard]] bool can_collapse(uint32_t a, uint32_t b, uint32_t& wa, uint32_t& wb) const noexcept
+	{
+		wa = invalid;
+		wb = invalid;
+		switch (m_kind[a]) {
+		case vertex_kind::manifold:
+			return true;
+		case vertex_kind::border:
+			return m_kind[b] == vertex_kind::border && (m_open_out[a] == b || m_open_in[a] == b);
+		case vertex_kind::seam:
+			if (m_kind[b] != vertex_kind::seam || (m_open_out[a] != b && m_open_in[a] != b)) {
+				return false;
+			}
+			wa = m_wedge[a];
+			if (m_position_id[m_open_out[wa]] == m_position_id[b]) {
+				wb = m_open_out[wa];
+			}
+			else if (m_position_id[m_open_in[wa]] == m_position_id[b]) {
+				wb = m_open_in[wa];
+			}
+			return wb != invalid && m_kind[wb] == vertex_kind::seam;
+		default:
+			return false;
+		}
+	}
+
+	// a を b に寄せたときに a の周囲の三角形の向きが大きく変わるか
+	[[nodiscard]] bool flips(const std::vector<uint32_t>& indices, uint32_t a, uint32_t b) const noexcept
+	{
+		const float3& pb = position(b);
+		for (const uint32_t t : m_adjacency[a]) {
+			const uint32_t* tri = &indices[t * 3];
+			if (tri[0] == b || tri[1] == b || tri[2] == b) {
+				continue;
+			}
+			float3 p[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+			const float3 n0 = cross(p[1] - p[0], p[2] - p[0]);
+			for (uint32_t c = 0; c < 3; ++c) {
+				if (tri[c] == a) {
+					p[c] = pb;
+				}
+			}
+			const float3 n1 = cross(p[1] - p[0], p[2] - p[0]);
+			const float  d  = dot(n0, n1);
+			if (d <= 0.0f || d * d < max_normal_change * max_normal_change * dot(n0, n0) * dot(n1, n1)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// a を b に寄せたときに、既にある辺と同じ向きの辺 (位置番号で) ができて非多様体になるか
+	[[nodiscard]] bool duplicates_edge(const std::vector<uint32_t>& indices, uint32_t a, uint32_t b) const noexcept
+	{
+		const uint32_t pa = m_position_id[a];
+		const uint32_t pb = m_position_id[b];
+		auto           contains = [&](const uint32_t* tri, uint32_t p)
+		{
+			return m_position_id[tri[0]] == p || m_position_id[tri[1]] == p || m_position_id[tri[2]] == p;
+		};
+
+		for (const uint32_t t : m_adjacency[a]) {
+			const uint32_t* tri = &indices[t * 3];
+			if (contains(tri, pb)) {
+				continue;
+			}
+			const uint32_t c    = tri[0] == a ? 0 : tri[1] == a ? 1 : 2;
+			const uint32_t next = m_position_id[tri[(c + 1) % 3]];
+			const uint32_t prev = m_position_id[tri[(c + 2) % 3]];
+
+			// 縮約後に残る b の周囲の三角形に b -> next または prev -> b があるか
+			uint32_t w = b;
+			do {
+				for (const uint32_t u : m_adjacency[w]) {
+					const uint32_t* other = &indices[u * 3];
+					if (contains(other, pa)) {
+						continue;
+					}
+					for (uint32_t k = 0; k < 3; ++k) {
+						const uint32_t e0 = m_position_id[other[k]];
+						const uint32_t e1 = m_position_id[other[(k + 1) % 3]];
+						if ((e0 == pb && e1 == next) || (e0 == prev && e1 == pb)) {
+							return true;
+						}
+					}
+				}
+				w = m_wedge[w];
+			} while (w != b);
+		}
+		return false;
+	}
+
+	void lock_neighborhood(const std::vector<uint32_t>& indices, uint32_t v) noexcept
+	{
+		for (const uint32_t t : m_adjacency[v]) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				m_locked[m_position_id[indices[t * 3 + c]]] = 1;
+			}
+		}
+	}
+
+	size_t collapse_pass(std::vector<uint32_t>& indices, uint32_t target_index_count, double target_error, double& max_error)
+	{
+		// 三角形の各辺について、縮約できる向きのうち誤差の小さい方を候補にします
+		// 内部の辺は両側の三角形に現れるので、a < b の側だけを使います
+		m_candidates.clear();
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				const uint32_t a = indices[i + c];
+				const uint32_t b = indices[i + (c + 1) % 3];
+				if (a > b && m_open_out[a] != b && m_open_out[a] != many) {
+					continue;
+				}
+				uint32_t     wa, wb;
+				const double eab = can_collapse(a, b, wa, wb) ? m_quadric[m_position_id[a]].error(position(b)) : DBL_MAX;
+				const double eba = can_collapse(b, a, wa, wb) ? m_quadric[m_position_id[b]].error(position(a)) : DBL_MAX;
+				if (eab == DBL_MAX && eba == DBL_MAX) {
+					continue;
+				}
+				m_candidates.push_back(eab <= eba ? candidate { a, b, eab } : candidate { b, a, eba });
+			}
+		}
+		if (m_candidates.empty()) {
+			return 0;
+		}
+
+		// 1 回の縮約で三角形は約 2 つ減ります
+		// 誤差の大きい縮約を同じパスで行わないよう、目標数に対応する候補の誤差の 1.5 倍までに制限し、その範囲だけを並べ替えます
+		auto by_error = [](const candidate& l, const candidate& r)
+		{
+			return l.error < r.error;
+		};
+		const size_t goal = std::max<size_t>((indices.size() - target_index_count) / 6, 1);
+		const auto   nth  = m_candidates.begin() + std::min(goal, m_candidates.size() - 1);
+		std::nth_element(m_candidates.begin(), nth, m_candidates.end(), by_error);
+		const double pass_limit = std::min(target_error, nth->error * 1.5 + DBL_MIN);
+		auto         within     = [pass_limit](const candidate& c)
+		{
+			return c.error <= pass_limit;
+		};
+		m_candidates.erase(std::partition(m_candidates.begin(), m_candidates.end(), within), m_candidates.end());
+		std::sort(m_candidates.begin(), m_candidates.end(), by_error);
+
+		for (uint32_t v = 0; v < m_remap.size(); ++v) {
+			m_remap[v] = v;
+		}
+		std::fill(m_locked.begin(), m_locked.end(), uint8_t(0));
+
+		size_t collapsed = 0;
+		for (const candidate& cand : m_candidates) {
+			if (collapsed >= goal) {
+				break;
+			}
+			const uint32_t pa = m_position_id[cand.from];
+			const uint32_t pb = m_position_id[cand.to];
+			if (m_locked[pa] || m_locked[pb]) {
+				continue;
+			}
+
+			uint32_t wa, wb;
+			if (!can_collapse(cand.from, cand.to, wa, wb) || flips(indices, cand.from, cand.to) || (wa != invalid && flips(indices, wa, wb))
+			    || duplicates_edge(indices, cand.from, cand.to) || (wa != invalid && duplicates_edge(indices, wa, wb))) {
+				continue;
+			}
+
+			// 周囲の三角形が変わるので、このパスでは近傍の縮約を行いません
+			lock_neighborhood(indices, cand.from);
+			lock_neighborhood(indices, cand.to);
+			if (wa != invalid) {
+				lock_neighborhood(indices, wa);
+				lock_neighborhood(indices, wb);
+				m_remap[wa] = wb;
+			}
+			m_remap[cand.from] = cand.to;
+			m_quadric[pb] += m_quadric[pa];
+			max_error = std::max(max_error, cand.error);
+			++collapsed;
+		}
+
+		// 縮約を反映し、潰れた三角形を取り除きます
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			const uint32_t a = m_remap[indices[i + 0]];
+			const uint32_t b = m_remap[indices[i + 1]];
+			const uint32_t c = m_remap[indices[i + 2]];
+			if (a == b || b == c || c == a) {
+				continue;
+			}
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+		return collapsed;
+	}
+
+private:
+	position_view            m_positions;
+	simplify_options         m_options;
+	std::vector<uint32_t>    m_position_id; // 頂点 -> 位置番号
+	std::vector<quadric>     m_quadric;     // 位置番号ごと
+	std::vector<uint32_t>    m_wedge;       // 同じ位置の次の頂点 (循環)
+	std::vector<uint32_t>    m_open_in;     // 開いた辺で入ってくる頂点 (なし: invalid, 複数: many)
+	std::vector<uint32_t>    m_open_out;    // 開いた辺で出ていく頂点
+	std::vector<vertex_kind> m_kind;
+	std::vector<uint32_t>    m_remap;
+	std::vector<uint8_t>     m_locked; // 位置番号ごと
+	adjacency                m_adjacency;
+	std::vector<candidate>   m_candidates;
+};
+
+template<class Index>
+simplify_result simplify_impl(std::span<const Index> indices, position_view positions, uint32_t target_index_count, std::span<Index> out, const simplify_options& options)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0 && out.size() >= indices.size(), {});
+
+	std::vector<uint32_t> work(indices.begin(), indices.end());
+	simplifier            s(positions, options);
+	const simplify_result result = s.run(work, target_index_count);
+	std::copy(work.begin(), work.end(), out.begin());
+	return result;
+}
+
+template<class Index>
+lod_chain<Index> build_lod_chain_impl(std::span<const Index> indices, position_view positions, const lod_chain_options& options)
+{
+	lod_chain<Index> chain;
+	chain.indices.assign(indices.begin(), indices.end());
+	chain.levels.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+	simplify_options simplify_options;
+	simplify_options.lock_border = options.lock_border;
+
+	std::vector<Index> level(indices.begin(), indices.end());
+	while (chain.levels.size() < options.max_levels) {
+		const lod_level& prev   = chain.levels.back();
+		const uint32_t   target = static_cast<uint32_t>(prev.index_count * options.reduction) / 3 * 3;
+		if (target < options.min_index_count) {
+			break;
+		}
+
+		simplify_options.target_error = options.max_error - prev.error;
+		const simplify_result result  = simplify_impl(std::span<const Index>(level), positions, target, std::span<Index>(level), simplify_options);
+
+		// ほとんど減らなかった場合は打ち切ります
+		if (result.index_count == 0 || result.index_count > prev.index_count * 0.95f) {
+			break;
+		}
+		level.resize(result.index_count);
+		chain.levels.push_back({ static_cast<uint32_t>(chain.indices.size()), result.index_count, prev.error + result.error });
+		chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+	}
+	return chain;
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+simplify_result simplify(std::span<const uint16_t> indices, position_view positions, uint32_t target_index_count, std::span<uint16_t> out, const simplify_options& options)
+{
+	return simplify_impl(indices, positions, target_index_count, out, options);
+}
+
+simplify_result simplify(std::span<const uint32_t> indices, position_view positions, uint32_t target_index_count, std::span<uint32_t> out, const simplify_options& options)
+{
+	return simplify_impl(indices, positions, target_index_count, out, options);
+}
+
+lod_chain<uint16_t> build_lod_chain(std::span<const uint16_t> indices, position_view positions, const lod_chain_options& options)
+{
+	return build_lod_chain_impl(indices, positions, options);
+}
+
+lod_chain<uint32_t> build_lod_chain(std::span<const uint32_t> indices, position_view positions, const lod_chain_options& options)
+{
+	return build_lod_chain_impl(indices, positions, options);
+}
+
+} // namespace geometry
+} // namespace dxlib
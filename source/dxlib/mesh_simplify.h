@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mesh_lod.h"
+#include "mesh_optimizer.h"
+
+namespace dxlib {
+namespace geometry {
+
+// 二次誤差 (QEM) によるメッシュの簡略化
+//
+// Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics" の辺の縮約を、
+// 既存の頂点へ寄せる縮約 (half-edge collapse) に限定して行います。新しい頂点を作らないので、全ての LOD で頂点バッファを共有できます。
+//
+// 同じ位置にある頂点 (UV / 法線の継ぎ目) は 1 つの位置として誤差を計算し、次の規則で形状と継ぎ目を保ちます。
+// - 内部の頂点は隣接するどの頂点にも寄せられます
+// - 境界 (開いた辺) の頂点は境界に沿った隣の境界頂点にのみ寄せられます
+// - 継ぎ目の頂点は継ぎ目に沿って、継ぎ目の両側の頂点を同時に寄せます
+// - 3 つ以上の頂点が同じ位置にある場合や開いた辺が枝分かれする場合 (極の頂点を UV ごとに分けた球の極の周りなど) は動かしません
+// 縮約で周囲の三角形の向きが大きく変わる (約 75 度以上) 場合と、同じ向きの辺が重なって非多様体になる場合は縮約しません。
+
+//! \brief simplify の設定
+struct simplify_options
+{
+	float target_error = FLT_MAX; //!< 許容する誤差 (メッシュの座標系での距離)
+	bool  lock_border  = false;   //!< 境界の頂点を動かさない (分割されたメッシュの継ぎ目を保つ場合)
+};
+
+//! \brief simplify の結果
+struct simplify_result
+{
+	uint32_t index_count; //!< 出力したインデックス数
+	float    error;       //!< 縮約した辺の誤差の最大値 (メッシュの座標系での距離)
+};
+
+//! \brief 三角形リストを target_index_count 以下に簡略化します
+//!
+//! target_error を超える縮約は行わないので、target_index_count に届かずに終わる場合があります。
+//!
+//! \param[in]  indices            三角形リスト
+//! \param[in]  positions          頂点の位置 (positions.count が頂点数)
+//! \param[in]  target_index_count 目標のインデックス数
+//! \param[out] out                indices.size() 要素以上 (indices と同じ領域も可)
+//! \param[in]  options
+simplify_result simplify(std::span<const uint16_t> indices, position_view positions, uint32_t target_index_count, std::span<uint16_t> out, const simplify_options& options = {});
+simplify_result simplify(std::span<const uint32_t> indices, position_view positions, uint32_t target_index_count, std::span<uint32_t> out, const simplify_options& options = {});
+
+//! \brief build_lod_chain の設定
+struct lod_chain_options
+{
+	uint32_t max_levels      = 8;       //!< 元のメッシュを含む最大の段数
+	float    reduction       = 0.5f;    //!< 1 段ごとのインデックス数の比率
+	float    max_error       = FLT_MAX; //!< 許容する誤差 (メッシュの座標系での距離)
+	uint32_t min_index_count = 96;      //!< これより少なくなる段は作りません
+	bool     lock_border     = false;   //!< simplify_options::lock_border
+};
+
+//! \brief LOD チェーン
+//!
+//! 全段のインデックスを 1 つの配列に詰め、levels[i] でその範囲を示します。
+//! levels[0] は元のメッシュで、頂点バッファは全段で共有します。
+template<class Index>
+struct lod_chain
+{
+	std::vector<Index>     indices;
+	std::vector<lod_level> levels;
+};
+
+//! \brief 1 つ前の段を reduction 倍に簡略化する手順を繰り返して LOD チェーンを作ります
+//!
+//! 各段の誤差は 1 つ前の段の誤差に今回の簡略化の誤差を加えた値 (元のメッシュに対する誤差の上限の目安) です。
+//! インデックス数がほとんど減らなくなった段、または max_error を超える段で終わります。
+//!
+//! \param[in] indices   元のメッシュの三角形リスト
+//! \param[in] positions 頂点の位置
+//! \param[in] options
+[[nodiscard]] lod_chain<uint16_t> build_lod_chain(std::span<const uint16_t> indices, position_view positions, const lod_chain_options& options = {});
+[[nodiscard]] lod_chain<uint32_t> build_lod_chain(std::span<const uint32_t> indices, position_view positions, const lod_chain_options& options = {});
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,450 @@
+#include "meshlet.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "debug.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+constexpr uint32_t invalid        = ~0u;
+constexpr uint16_t not_in_meshlet = 0xffff;
+
+// 法線がこれ以上広がる (軸との内積の最小値がこれ以下になる) 場合は法線コーンを作りません
+constexpr float min_cone_dot = 0.1f;
+
+inline float component(const float3& v, int axis) noexcept
+{
+	return (&v.x)[axis];
+}
+
+inline float length_sq(const float3& v) noexcept
+{
+	return dot(v, v);
+}
+
+// 点群の境界球 (Ritter)
+bounding_sphere compute_sphere(const float3* points, size_t count) noexcept
+{
+	if (count == 0) {
+		return { float3(0.0f), 0.0f };
+	}
+
+	// 各軸で最も離れた 2 点のうち、最も長い組を初期の直径にします
+	size_t lo[3] = { 0, 0, 0 };
+	size_t hi[3] = { 0, 0, 0 };
+	for (size_t i = 1; i < count; ++i) {
+		for (int a = 0; a < 3; ++a) {
+			if (component(points[i], a) < component(points[lo[a]], a)) {
+				lo[a] = i;
+			}
+			if (component(points[i], a) > component(points[hi[a]], a)) {
+				hi[a] = i;
+			}
+		}
+	}
+	int axis = 0;
+	for (int a = 1; a < 3; ++a) {
+		if (length_sq(points[hi[a]] - points[lo[a]]) > length_sq(points[hi[axis]] - points[lo[axis]])) {
+			axis = a;
+		}
+	}
+
+	float3 center = (points[lo[axis]] + points[hi[axis]]) * 0.5f;
+	float  radius = length(points[hi[axis]] - center);
+
+	// 外側の点を含むように広げます
+	for (size_t i = 0; i < count; ++i) {
+		const float d = length(points[i] - center);
+		if (d > radius) {
+			const float r = (radius + d) * 0.5f;
+			center        = center + (points[i] - center) * ((r - radius) / d);
+			radius        = r;
+		}
+	}
+	return { center, radius };
+}
+
+// 三角形の重心と単位法線
+struct triangle_info
+{
+	float3 centroid;
+	float3 normal;
+};
+
+template<class Index>
+class meshlet_builder
+{
+public:
+	meshlet_builder(std::span<const Index> indices, position_view positions, const meshlet_options& options)
+	    : m_indices(indices)
+	    , m_positions(positions)
+	    , m_options(options)
+	{
+	}
+
+	meshlet_mesh run()
+	{
+		const size_t triangle_count = m_indices.size() / 3;
+		prepare(triangle_count);
+
+		meshlet_mesh mesh;
+		mesh.vertices.reserve(m_indices.size() / 2);
+		mesh.triangles.reserve(m_indices.size() + (m_indices.size() / 3 / m_options.max_triangles + 1) * 4);
+
+		size_t seed = 0;
+		for (;;) {
+			// 隣接する三角形がなければ、新しいメッシュレットは直前のメッシュレットの隣から始め、
+			// それもなければ (作成中のメッシュレットも含めて) まだ使っていない最初の三角形を使います
+			uint32_t t = next_triangle();
+			if (t == invalid && m_triangles.empty()) {
+				t = seed_triangle();
+			}
+			if (t == invalid) {
+				while (seed < triangle_count && m_emitted[seed]) {
+					++seed;
+				}
+				if (seed == triangle_count) {
+					break;
+				}
+				t = static_cast<uint32_t>(seed);
+			}
+
+			const uint32_t* tri   = triangle(t);
+			uint32_t        extra = 0;
+			for (uint32_t c = 0; c < 3; ++c) {
+				extra += m_local[tri[c]] == not_in_meshlet;
+			}
+			if (m_vertices.size() + extra > m_options.max_vertices) {
+				flush(mesh);
+			}
+			add(t);
+			if (m_triangles.size() / 3 == m_options.max_triangles) {
+				flush(mesh);
+			}
+		}
+		flush(mesh);
+
+		mesh.bounds.resize(mesh.meshlets.size());
+		for (size_t i = 0; i < mesh.meshlets.size(); ++i) {
+			mesh.bounds[i] = compute_meshlet_bounds(mesh.meshlet_vertices(i), mesh.meshlet_triangles(i), m_positions);
+		}
+		return mesh;
+	}
+
+private:
+	[[nodiscard]] const uint32_t* triangle(uint32_t t) const noexcept
+	{
+		return &m_triangle_indices[t * 3];
+	}
+
+	void prepare(size_t triangle_count)
+	{
+		const uint32_t vertex_count = m_positions.count;
+		m_triangle_indices.assign(m_indices.begin(), m_indices.end());
+
+		// 頂点ごとの隣接三角形 (CSR)
+		m_offset.assign(vertex_count + 1, 0);
+		for (const uint32_t v : m_triangle_indices) {
+			++m_offset[v + 1];
+		}
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			m_offset[v + 1] += m_offset[v];
+		}
+		m_live.resize(vertex_count);
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			m_live[v] = m_offset[v + 1] - m_offset[v];
+		}
+		m_adjacency.resize(m_triangle_indices.size());
+		std::vector<uint32_t> cursor(m_offset.begin(), m_offset.end() - 1);
+		for (size_t i = 0; i < m_triangle_indices.size(); ++i) {
+			m_adjacency[cursor[m_triangle_indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		m_info.resize(triangle_count);
+		double area_sum = 0.0;
+		for (size_t t = 0; t < triangle_count; ++t) {
+			const uint32_t* tri = triangle(static_cast<uint32_t>(t));
+			const float3    p0  = m_positions[tri[0]];
+			const float3    p1  = m_positions[tri[1]];
+			const float3    p2  = m_positions[tri[2]];
+			const float3    n   = cross(p1 - p0, p2 - p0);
+			const float     len = length(n);
+			m_info[t].centroid  = (p0 + p1 + p2) * (1.0f / 3.0f);
+			m_info[t].normal    = len > 0.0f ? n * (1.0f / len) : float3(0.0f);
+			area_sum += len * 0.5f;
+		}
+
+		// 三角形数の上限まで集めたメッシュレットのおおよその半径
+		const double average_area = triangle_count ? area_sum / static_cast<double>(triangle_count) : 0.0;
+		m_expected_radius         = static_cast<float>(std::sqrt(average_area * m_options.max_triangles) * 0.5);
+
+		m_emitted.assign(triangle_count, 0);
+		m_local.assign(vertex_count, not_in_meshlet);
+		m_vertices.clear();
+		m_triangles.clear();
+		m_centroid_sum = float3(0.0f);
+		m_normal_sum   = float3(0.0f);
+	}
+
+	// 現在のメッシュレットの頂点に隣接する三角形のうち、追加する頂点が少なく、中心に近く、向きの揃ったものを選びます
+	[[nodiscard]] uint32_t next_triangle() const noexcept
+	{
+		if (m_triangles.empty()) {
+			return invalid;
+		}
+
+		const float  inv_count = 3.0f / static_cast<float>(m_triangles.size());
+		const float3 center    = m_centroid_sum * inv_count;
+		const float  axis_len  = length(m_normal_sum);
+		const float3 axis      = axis_len > 0.0f ? m_normal_sum * (1.0f / axis_len) : float3(0.0f);
+		const float  weight    = m_options.cone_weight;
+		const float  inv_r     = m_expected_radius > 0.0f ? 1.0f / m_expected_radius : 0.0f;
+
+		uint32_t best       = invalid;
+		uint32_t best_extra = 4;
+		float    best_score = FLT_MAX;
+		for (const uint32_t v : m_vertices) {
+			for (uint32_t i = m_offset[v], e = m_offset[v] + m_live[v]; i < e; ++i) {
+				const uint32_t  t   = m_adjacency[i];
+				const uint32_t* tri = triangle(t);
+
+				uint32_t extra = 0;
+				for (uint32_t c = 0; c < 3; ++c) {
+					extra += m_local[tri[c]] == not_in_meshlet;
+				}
+				if (m_vertices.size() + extra > m_options.max_vertices || extra > best_extra) {
+					continue;
+				}
+
+				const float distance = length(m_info[t].centroid - center);
+				const float cone     = std::max(1.0f - dot(m_info[t].normal, axis) * weight, 1e-3f);
+				const float score    = (1.0f + distance * inv_r * (1.0f - weight)) * cone;
+				if (extra < best_extra || score < best_score) {
+					best       = t;
+					best_extra = extra;
+					best_score = score;
+				}
+			}
+		}
+		return best;
+	}
+
+	// 直前のメッシュレットの頂点に隣接する三角形のうち、頂点の未使用の隣接三角形が最も少ないもの
+	// 使い残しの三角形の外周から始めることで、孤立した小さなメッシュレットを減らします
+	[[nodiscard]] uint32_t seed_triangle() const noexcept
+	{
+		uint32_t best      = invalid;
+		uint32_t best_live = ~0u;
+		for (const uint32_t v : m_previous) {
+			for (uint32_t i = m_offset[v], e = m_offset[v] + m_live[v]; i < e; ++i) {
+				const uint32_t  t    = m_adjacency[i];
+				const uint32_t* tri  = triangle(t);
+				const uint32_t  live = m_live[tri[0]] + m_live[tri[1]] + m_live[tri[2]];
+				if (live < best_live) {
+					best      = t;
+					best_live = live;
+				}
+			}
+		}
+		return best;
+	}
+
+	void add(uint32_t t)
+	{
+		const uint32_t* tri = triangle(t);
+		for (uint32_t c = 0; c < 3; ++c) {
+			const uint32_t v = tri[c];
+			if (m_local[v] == not_in_meshlet) {
+				m_local[v] = static_cast<uint16_t>(m_vertices.size());
+				m_vertices.push_back(v);
+			}
+			m_triangles.push_back(static_cast<uint8_t>(m_local[v]));
+
+			// 隣接リストの生きている範囲から t を取り除きます
+			uint32_t* adj = &m_adjacency[m_offset[v]];
+			for (uint32_t i = 0; i < m_live[v]; ++i) {
+				if (adj[i] == t) {
+					std::swap(adj[i], adj[m_live[v] - 1]);
+					--m_live[v];
+					break;
+				}
+			}
+		}
+		m_emitted[t] = 1;
+		m_centroid_sum += m_info[t].centroid;
+		m_normal_sum += m_info[t].normal;
+	}
+
+	void flush(meshlet_mesh& mesh)
+	{
+		if (m_triangles.empty()) {
+			return;
+		}
+
+		meshlet m;
+		m.vertex_offset   = static_cast<uint32_t>(mesh.vertices.size());
+		m.triangle_offset = static_cast<uint32_t>(mesh.triangles.size());
+		m.vertex_count    = static_cast<uint32_t>(m_vertices.size());
+		m.triangle_count  = static_cast<uint32_t>(m_triangles.size() / 3);
+		mesh.meshlets.push_back(m);
+
+		mesh.vertices.insert(mesh.vertices.end(), m_vertices.begin(), m_vertices.end());
+		mesh.triangles.insert(mesh.triangles.end(), m_triangles.begin(), m_triangles.end());
+		mesh.triangles.resize((mesh.triangles.size() + 3) & ~size_t(3), 0);
+
+		for (const uint32_t v : m_vertices) {
+			m_local[v] = not_in_meshlet;
+		}
+		m_previous.swap(m_vertices);
+		m_vertices.clear();
+		m_triangles.clear();
+		m_centroid_sum = float3(0.0f);
+		m_normal_sum   = float3(0.0f);
+	}
+
+private:
+	std::span<const Index> m_indices;
+	position_view          m_positions;
+	meshlet_options        m_options;
+
+	std::vector<uint32_t>      m_triangle_indices;
+	std::vector<uint32_t>      m_offset;
+	std::vector<uint32_t>      m_adjacency;
+	std::vector<uint32_t>      m_live; //!< 頂点ごとの未使用の隣接三角形数 (隣接リストの先頭から)
+	std::vector<triangle_info> m_info;
+	std::vector<uint8_t>       m_emitted;
+	float                      m_expected_radius = 0.0f;
+
+	// 作成中のメッシュレット
+	std::vector<uint16_t> m_local; //!< 頂点番号 -> メッシュレット内の番号
+	std::vector<uint32_t> m_vertices;
+	std::vector<uint8_t>  m_triangles;
+	std::vector<uint32_t> m_previous; //!< 直前のメッシュレットの頂点番号
+	float3                m_centroid_sum;
+	float3                m_normal_sum;
+};
+
+template<class Index>
+meshlet_mesh build_meshlets_impl(std::span<const Index> indices, position_view positions, const meshlet_options& options)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0, {});
+	ASSERT_RETURN(options.max_vertices >= 3 && options.max_vertices <= max_meshlet_vertices, {});
+	ASSERT_RETURN(options.max_triangles >= 1 && options.max_triangles <= max_meshlet_triangles, {});
+
+	meshlet_builder<Index> builder(indices, positions, options);
+	return builder.run();
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+meshlet_mesh build_meshlets(std::span<const uint16_t> indices, position_view positions, const meshlet_options& options)
+{
+	return build_meshlets_impl(indices, positions, options);
+}
+
+meshlet_mesh build_meshlets(std::span<const uint32_t> indices, position_view positions, const meshlet_options& options)
+{
+	return build_meshlets_impl(indices, positions, options);
+}
+
+meshlet_bounds compute_meshlet_bounds(std::span<const uint32_t> vertices, std::span<const uint8_t> triangles, position_view positions) noexcept
+{
+	ASSERT_RETURN(vertices.size() <= max_meshlet_vertices && triangles.size() <= max_meshlet_triangles * 3, {});
+
+	float3 points[max_meshlet_vertices];
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		points[i] = positions[vertices[i]];
+	}
+
+	meshlet_bounds bounds;
+	bounds.sphere = compute_sphere(points, vertices.size());
+
+	// 面積のない三角形を除いた単位法線の境界球の中心を軸にします
+	float3 normals[max_meshlet_triangles];
+	size_t normal_count = 0;
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+		const float3& p0  = points[triangles[i + 0]];
+		const float3& p1  = points[triangles[i + 1]];
+		const float3& p2  = points[triangles[i + 2]];
+		const float3  n   = cross(p1 - p0, p2 - p0);
+		const float   len = length(n);
+		if (len > 0.0f) {
+			normals[normal_count++] = n * (1.0f / len);
+		}
+	}
+
+	bounds.cone_apex   = bounds.sphere.center;
+	bounds.cone_axis   = float3(0.0f);
+	bounds.cone_cutoff = 1.0f;
+
+	const bounding_sphere normal_sphere = compute_sphere(normals, normal_count);
+	const float           axis_len      = length(normal_sphere.center);
+	if (normal_count == 0 || axis_len <= 0.0f) {
+		return bounds;
+	}
+	const float3 axis = normal_sphere.center * (1.0f / axis_len);
+
+	float min_dot = 1.0f;
+	for (size_t i = 0; i < normal_count; ++i) {
+		min_dot = std::min(min_dot, dot(normals[i], axis));
+	}
+	if (min_dot <= min_cone_dot) {
+		return bounds;
+	}
+
+	// 全ての三角形の平面の裏側に視点があるための軸上の頂点を、各平面と軸の交点のうち最も後ろの位置にします
+	float  max_t = -FLT_MAX;
+	size_t n     = 0;
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+		const float3& p0 = points[triangles[i + 0]];
+		const float3& p1 = points[triangles[i + 1]];
+		const float3& p2 = points[triangles[i + 2]];
+		if (length(cross(p1 - p0, p2 - p0)) <= 0.0f) {
+			continue;
+		}
+		const float3& normal = normals[n++];
+		max_t                = std::max(max_t, dot(bounds.sphere.center - p0, normal) / dot(axis, normal));
+	}
+
+	bounds.cone_apex   = bounds.sphere.center - axis * max_t;
+	bounds.cone_axis   = axis;
+	bounds.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+	return bounds;
+}
+
+meshlet_cull_stats cull_meshlets(std::span<const meshlet_bounds> bounds, const scene::frustum& frustum, const float3& camera_position, std::span<uint32_t> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= bounds.size(), {});
+
+	meshlet_cull_stats stats;
+	for (size_t i = 0; i < bounds.size(); ++i) {
+		const meshlet_bounds& b = bounds[i];
+
+		bool inside = true;
+		for (const float4& p : frustum.planes) {
+			inside &= p.x * b.sphere.center.x + p.y * b.sphere.center.y + p.z * b.sphere.center.z + p.w >= -b.sphere.radius;
+		}
+		if (!inside) {
+			++stats.frustum_culled;
+			continue;
+		}
+
+		const float3 view = b.cone_apex - camera_position;
+		if (dot(view, b.cone_axis) > b.cone_cutoff * length(view)) {
+			++stats.cone_culled;
+			continue;
+		}
+		out[stats.visible++] = static_cast<uint32_t>(i);
+	}
+	return stats;
+}
+
+} // namespace geometry
+} // namespace dxlib
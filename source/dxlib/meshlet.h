@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bounds.h"
+#include "culling.h"
+#include "mesh_optimizer.h"
+
+namespace dxlib {
+namespace geometry {
+
+// メッシュレット
+//
+// 三角形リストを頂点数と三角形数の上限を持つ小さなクラスタ (メッシュレット) に分割します。
+// メッシュシェーダやクラスタ単位のカリングで使用する形式で、各メッシュレットは
+// - 参照する頂点番号の配列 (vertices)
+// - その配列内の番号 (uint8_t) 3 つで表した三角形の配列 (triangles)
+// を持ちます。triangles の各メッシュレットの先頭は 4 バイト境界に揃えます (ByteAddressBuffer から uint で読めるようにするため)。
+//
+// メッシュレットは隣接する三角形を、新しく追加する頂点が少ない順、次にメッシュレットの中心に近く向きの揃った順に貪欲に集めます。
+
+//! \brief メッシュレットの頂点数の上限の最大値 (uint8_t で参照できる数)
+inline constexpr uint32_t max_meshlet_vertices = 256;
+
+//! \brief メッシュレットの三角形数の上限の最大値 (D3D12 のメッシュシェーダが 1 グループで出力できるプリミティブ数)
+inline constexpr uint32_t max_meshlet_triangles = 256;
+
+//! \brief build_meshlets の設定
+struct meshlet_options
+{
+	uint32_t max_vertices  = 64;   //!< 頂点数の上限 (3 ~ max_meshlet_vertices)
+	uint32_t max_triangles = 124;  //!< 三角形数の上限 (1 ~ max_meshlet_triangles)
+	float    cone_weight   = 0.0f; //!< 0 ~ 1、大きいほど向きの揃った三角形を優先して法線コーンを狭くします (空間的なまとまりは悪くなります)
+};
+
+//! \brief メッシュレット
+struct meshlet
+{
+	uint32_t vertex_offset;   //!< meshlet_mesh::vertices 内の先頭位置
+	uint32_t triangle_offset; //!< meshlet_mesh::triangles 内の先頭位置 (バイト、4 の倍数)
+	uint32_t vertex_count;    //!< 頂点数
+	uint32_t triangle_count;  //!< 三角形数
+};
+
+//! \brief メッシュレットの境界
+//!
+//! 法線コーンは全ての三角形の法線が axis から asin(cone_cutoff) 以内にあることを表します。
+//! 視点から apex への向き v について dot(normalize(v), axis) > cone_cutoff であれば全ての三角形が裏向きです。
+//! 法線が広がっていてコーンを作れない場合は axis を (0, 0, 0)、cone_cutoff を 1 にします (裏面カリングされません)。
+struct meshlet_bounds
+{
+	bounding_sphere sphere;      //!< 境界球
+	float3          cone_apex;   //!< 法線コーンの頂点
+	float3          cone_axis;   //!< 法線コーンの軸 (正規化済み)
+	float           cone_cutoff; //!< 法線コーンの半角の sin
+};
+
+//! \brief メッシュレットに分割したメッシュ
+struct meshlet_mesh
+{
+	std::vector<meshlet>        meshlets;
+	std::vector<meshlet_bounds> bounds;    //!< メッシュレットごとの境界
+	std::vector<uint32_t>       vertices;  //!< 頂点番号
+	std::vector<uint8_t>        triangles; //!< メッシュレット内の頂点番号 3 つずつ
+
+	//! \brief meshlets[i] の頂点番号
+	[[nodiscard]] std::span<const uint32_t> meshlet_vertices(size_t i) const noexcept
+	{
+		return { vertices.data() + meshlets[i].vertex_offset, meshlets[i].vertex_count };
+	}
+
+	//! \brief meshlets[i] の三角形
+	[[nodiscard]] std::span<const uint8_t> meshlet_triangles(size_t i) const noexcept
+	{
+		return { triangles.data() + meshlets[i].triangle_offset, meshlets[i].triangle_count * 3 };
+	}
+};
+
+//! \brief 三角形リストをメッシュレットに分割します
+//!
+//! static_mesh の場合は build_meshlets(mesh.indices, std::span<const Vertex>(mesh.vertices)) のように渡します。
+//!
+//! \param[in] indices   三角形リスト
+//! \param[in] positions 頂点の位置 (positions.count が頂点数)
+//! \param[in] options
+[[nodiscard]] meshlet_mesh build_meshlets(std::span<const uint16_t> indices, position_view positions, const meshlet_options& options = {});
+[[nodiscard]] meshlet_mesh build_meshlets(std::span<const uint32_t> indices, position_view positions, const meshlet_options& options = {});
+
+//! \brief メッシュレットの境界球と法線コーンを計算します
+//!
+//! \param[in] vertices  メッシュレットの頂点番号
+//! \param[in] triangles メッシュレット内の頂点番号 3 つずつ
+//! \param[in] positions 頂点の位置
+[[nodiscard]] meshlet_bounds compute_meshlet_bounds(std::span<const uint32_t> vertices, std::span<const uint8_t> triangles, position_view positions) noexcept;
+
+//! \brief cull_meshlets の結果
+struct meshlet_cull_stats
+{
+	uint32_t frustum_culled = 0; //!< 視錐台の外側にあるメッシュレット数
+	uint32_t cone_culled    = 0; //!< 全ての三角形が裏向きのメッシュレット数
+	uint32_t visible        = 0; //!< 残ったメッシュレット数 (out に書き込んだ数)
+};
+
+//! \brief メッシュレットを視錐台と法線コーンでカリングします (CPU での参照実装)
+//!
+//! GPU のクラスタカリングの検証と比較のための実装です。境界はメッシュの座標系なので、
+//! 視錐台は make_frustum(world * view_proj)、視点はワールド行列の逆行列で変換した位置を渡します。
+//!
+//! \param[in]  bounds          メッシュレットの境界
+//! \param[in]  frustum         メッシュの座標系での視錐台
+//! \param[in]  camera_position メッシュの座標系での視点
+//! \param[out] out             可視なメッシュレットの番号 (昇順)、bounds.size() 要素以上
+meshlet_cull_stats cull_meshlets(std::span<const meshlet_bounds> bounds, const scene::frustum& frustum, const float3& camera_position, std::span<uint32_t> out) noexcept;
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,453 @@
+#include "noise.h"
+
+#include <algorithm>
+
+#include "debug.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+namespace {
+
+using namespace dxlib::math::simd;
+
+// これ以下のサンプル数のタイルは分割しません
+constexpr size_t parallel_grain = 4096;
+
+// オクターブごとにシードをずらす量
+constexpr uint32_t octave_seed_step = 0x9E3779B9u;
+
+// 出力がおおよそ [-1, 1] になるよう実測の最大値から決めた係数
+constexpr float gradient2_scale = 0.66f;
+constexpr float gradient3_scale = 1.0f;
+constexpr float simplex2_scale  = 45.0f;
+constexpr float simplex3_scale  = 76.0f;
+
+// --- ハッシュ/勾配 ---
+
+// 格子座標のハッシュ。各軸に奇数を掛けて混ぜ、lowbias32 (Wellons) で攪拌します
+vint4 mix(vint4 h) noexcept
+{
+	h = vxor(h, vsrl<16>(h));
+	h = vmullo(h, vsplat4i(0x7feb352du));
+	h = vxor(h, vsrl<15>(h));
+	h = vmullo(h, vsplat4i(0x846ca68bu));
+	return vxor(h, vsrl<16>(h));
+}
+
+vint4 hash(vint4 x, vint4 y, vint4 seed) noexcept
+{
+	return mix(vxor(vxor(vmullo(x, vsplat4i(0x8da6b343u)), vmullo(y, vsplat4i(0xd8163841u))), seed));
+}
+
+vint4 hash(vint4 x, vint4 y, vint4 z, vint4 seed) noexcept
+{
+	return mix(vxor(vxor(vxor(vmullo(x, vsplat4i(0x8da6b343u)), vmullo(y, vsplat4i(0xd8163841u))), vmullo(z, vsplat4i(0xcb1ab31fu))), seed));
+}
+
+// h のビット N を全ビットに広げたマスク
+template<int N>
+vint4 bit_mask(vint4 h) noexcept
+{
+	return vsra<31>(vsll<31 - N>(h));
+}
+
+// h のビット N を符号ビットに移したもの (xor で符号を反転します)
+template<int N>
+vfloat4 bit_sign(vint4 h) noexcept
+{
+	return vcast_f32(vand(vsll<31 - N>(h), vsplat4i(0x80000000u)));
+}
+
+// (±1, ±2), (±2, ±1) の 8 方向の勾配との内積
+vfloat4 grad(vint4 h, vfloat4 x, vfloat4 y) noexcept
+{
+	const vfloat4 swap = vcast_f32(bit_mask<2>(h));
+	const vfloat4 u    = vselect(swap, y, x);
+	const vfloat4 v    = vselect(swap, x, y);
+	return vadd(vxor(u, bit_sign<0>(h)), vxor(vadd(v, v), bit_sign<1>(h)));
+}
+
+// 立方体の 12 辺方向の勾配との内積 (Perlin, "Improving Noise")
+vfloat4 grad(vint4 h, vfloat4 x, vfloat4 y, vfloat4 z) noexcept
+{
+	const vint4   b0     = bit_mask<0>(h);
+	const vint4   b2     = bit_mask<2>(h);
+	const vint4   b3     = bit_mask<3>(h);
+	const vfloat4 lt4    = vcast_f32(vxor(vor(b2, b3), vsplat4i(~0u)));
+	const vfloat4 is1214 = vcast_f32(vand(vand(b2, b3), vxor(b0, vsplat4i(~0u))));
+	const vfloat4 u      = vselect(vcast_f32(b3), y, x);
+	const vfloat4 v      = vselect(lt4, y, vselect(is1214, x, z));
+	return vadd(vxor(u, bit_sign<0>(h)), vxor(v, bit_sign<1>(h)));
+}
+
+// 6t^5 - 15t^4 + 10t^3
+vfloat4 fade(vfloat4 t) noexcept
+{
+	const vfloat4 t3 = vmul(vmul(t, t), t);
+	return vmul(t3, vmadd(t, vmadd(t, vsplat4(6.0f), vsplat4(-15.0f)), vsplat4(10.0f)));
+}
+
+vfloat4 lerp(vfloat4 a, vfloat4 b, vfloat4 t) noexcept
+{
+	return vmadd(vsub(b, a), t, a);
+}
+
+// --- カーネル ---
+
+struct gradient_kernel
+{
+	static vfloat4 eval(vfloat4 x, vfloat4 y, vint4 seed) noexcept
+	{
+		const vfloat4 fx  = vfloor(x);
+		const vfloat4 fy  = vfloor(y);
+		const vint4   ix0 = vcvt_i32(fx);
+		const vint4   iy0 = vcvt_i32(fy);
+		const vint4   ix1 = vadd(ix0, vsplat4i(1));
+		const vint4   iy1 = vadd(iy0, vsplat4i(1));
+		const vfloat4 dx0 = vsub(x, fx);
+		const vfloat4 dy0 = vsub(y, fy);
+		const vfloat4 dx1 = vsub(dx0, vsplat4(1.0f));
+		const vfloat4 dy1 = vsub(dy0, vsplat4(1.0f));
+
+		const vfloat4 g00 = grad(hash(ix0, iy0, seed), dx0, dy0);
+		const vfloat4 g10 = grad(hash(ix1, iy0, seed), dx1, dy0);
+		const vfloat4 g01 = grad(hash(ix0, iy1, seed), dx0, dy1);
+		const vfloat4 g11 = grad(hash(ix1, iy1, seed), dx1, dy1);
+
+		const vfloat4 u = fade(dx0);
+		const vfloat4 v = fade(dy0);
+		return vmul(lerp(lerp(g00, g10, u), lerp(g01, g11, u), v), vsplat4(gradient2_scale));
+	}
+
+	static vfloat4 eval(vfloat4 x, vfloat4 y, vfloat4 z, vint4 seed) noexcept
+	{
+		const vfloat4 fx  = vfloor(x);
+		const vfloat4 fy  = vfloor(y);
+		const vfloat4 fz  = vfloor(z);
+		const vint4   ix0 = vcvt_i32(fx);
+		const vint4   iy0 = vcvt_i32(fy);
+		const vint4   iz0 = vcvt_i32(fz);
+		const vint4   ix1 = vadd(ix0, vsplat4i(1));
+		const vint4   iy1 = vadd(iy0, vsplat4i(1));
+		const vint4   iz1 = vadd(iz0, vsplat4i(1));
+		const vfloat4 dx0 = vsub(x, fx);
+		const vfloat4 dy0 = vsub(y, fy);
+		const vfloat4 dz0 = vsub(z, fz);
+		const vfloat4 dx1 = vsub(dx0, vsplat4(1.0f));
+		const vfloat4 dy1 = vsub(dy0, vsplat4(1.0f));
+		const vfloat4 dz1 = vsub(dz0, vsplat4(1.0f));
+
+		const vfloat4 g000 = grad(hash(ix0, iy0, iz0, seed), dx0, dy0, dz0);
+		const vfloat4 g100 = grad(hash(ix1, iy0, iz0, seed), dx1, dy0, dz0);
+		const vfloat4 g010 = grad(hash(ix0, iy1, iz0, seed), dx0, dy1, dz0);
+		const vfloat4 g110 = grad(hash(ix1, iy1, iz0, seed), dx1, dy1, dz0);
+		const vfloat4 g001 = grad(hash(ix0, iy0, iz1, seed), dx0, dy0, dz1);
+		const vfloat4 g101 = grad(hash(ix1, iy0, iz1, seed), dx1, dy0, dz1);
+		const vfloat4 g011 = grad(hash(ix0, iy1, iz1, seed), dx0, dy1, dz1);
+		const vfloat4 g111 = grad(hash(ix1, iy1, iz1, seed), dx1, dy1, dz1);
+
+		const vfloat4 u  = fade(dx0);
+		const vfloat4 v  = fade(dy0);
+		const vfloat4 w  = fade(dz0);
+		const vfloat4 y0 = lerp(lerp(g000, g100, u), lerp(g010, g110, u), v);
+		const vfloat4 y1 = lerp(lerp(g001, g101, u), lerp(g011, g111, u), v);
+		return vmul(lerp(y0, y1, w), vsplat4(gradient3_scale));
+	}
+};
+
+struct simplex_kernel
+{
+	// 頂点からの距離 d^2 による寄与 max(0.5 - d^2, 0)^4 * grad
+	static vfloat4 corner(vfloat4 x, vfloat4 y, vint4 h) noexcept
+	{
+		vfloat4 t = vmax(vnmadd(y, y, vnmadd(x, x, vsplat4(0.5f))), vzero4());
+		t         = vmul(t, t);
+		return vmul(vmul(t, t), grad(h, x, y));
+	}
+
+	static vfloat4 corner(vfloat4 x, vfloat4 y, vfloat4 z, vint4 h) noexcept
+	{
+		vfloat4 t = vmax(vnmadd(z, z, vnmadd(y, y, vnmadd(x, x, vsplat4(0.5f)))), vzero4());
+		t         = vmul(t, t);
+		return vmul(vmul(t, t), grad(h, x, y, z));
+	}
+
+	static vfloat4 eval(vfloat4 x, vfloat4 y, vint4 seed) noexcept
+	{
+		constexpr float f2 = 0.36602540378443865f; // (sqrt(3) - 1) / 2
+		constexpr float g2 = 0.21132486540518712f; // (3 - sqrt(3)) / 6
+
+		// 斜交座標で単体を求めます
+		const vfloat4 s  = vmul(vadd(x, y), vsplat4(f2));
+		const vfloat4 fi = vfloor(vadd(x, s));
+		const vfloat4 fj = vfloor(vadd(y, s));
+		const vfloat4 t  = vmul(vadd(fi, fj), vsplat4(g2));
+		const vfloat4 x0 = vsub(x, vsub(fi, t));
+		const vfloat4 y0 = vsub(y, vsub(fj, t));
+
+		// x0 >= y0 なら (1, 0)、それ以外は (0, 1) が 2 番目の頂点です
+		const vfloat4 xy  = vcmpge(x0, y0);
+		const vfloat4 one = vsplat4(1.0f);
+		const vfloat4 i1  = vand(xy, one);
+		const vfloat4 j1  = vsub(one, i1);
+		const vfloat4 x1  = vadd(vsub(x0, i1), vsplat4(g2));
+		const vfloat4 y1  = vadd(vsub(y0, j1), vsplat4(g2));
+		const vfloat4 x2  = vadd(x0, vsplat4(2.0f * g2 - 1.0f));
+		const vfloat4 y2  = vadd(y0, vsplat4(2.0f * g2 - 1.0f));
+
+		// マスクは整数として -1 なので、引くと +1 になります
+		const vint4 i  = vcvt_i32(fi);
+		const vint4 j  = vcvt_i32(fj);
+		const vint4 m  = vcast_i32(xy);
+		const vint4 h0 = hash(i, j, seed);
+		const vint4 h1 = hash(vsub(i, m), vsub(j, vxor(m, vsplat4i(~0u))), seed);
+		const vint4 h2 = hash(vadd(i, vsplat4i(1)), vadd(j, vsplat4i(1)), seed);
+
+		const vfloat4 n = vadd(vadd(corner(x0, y0, h0), corner(x1, y1, h1)), corner(x2, y2, h2));
+		return vmul(n, vsplat4(simplex2_scale));
+	}
+
+	static vfloat4 eval(vfloat4 x, vfloat4 y, vfloat4 z, vint4 seed) noexcept
+	{
+		constexpr float f3 = 1.0f / 3.0f;
+		constexpr float g3 = 1.0f / 6.0f;
+
+		const vfloat4 s  = vmul(vadd(vadd(x, y), z), vsplat4(f3));
+		const vfloat4 fi = vfloor(vadd(x, s));
+		const vfloat4 fj = vfloor(vadd(y, s));
+		const vfloat4 fk = vfloor(vadd(z, s));
+		const vfloat4 t  = vmul(vadd(vadd(fi, fj), fk), vsplat4(g3));
+		const vfloat4 x0 = vsub(x, vsub(fi, t));
+		const vfloat4 y0 = vsub(y, vsub(fj, t));
+		const vfloat4 z0 = vsub(z, vsub(fk, t));
+
+		// 座標の大小順で 2, 3 番目の頂点を決めます (1 番目は最大の軸、2 番目は上位 2 軸)
+		const vint4 all = vsplat4i(~0u);
+		const vint4 xy  = vcast_i32(vcmpge(x0, y0));
+		const vint4 yz  = vcast_i32(vcmpge(y0, z0));
+		const vint4 xz  = vcast_i32(vcmpge(x0, z0));
+		const vint4 i1  = vand(xy, xz);
+		const vint4 j1  = vand(vxor(xy, all), yz);
+		const vint4 k1  = vxor(vor(xz, yz), all);
+		const vint4 i2  = vor(xy, xz);
+		const vint4 j2  = vor(vxor(xy, all), yz);
+		const vint4 k2  = vxor(vand(xz, yz), all);
+
+		const vfloat4 one = vsplat4(1.0f);
+		const vfloat4 x1  = vadd(vsub(x0, vand(vcast_f32(i1), one)), vsplat4(g3));
+		const vfloat4 y1  = vadd(vsub(y0, vand(vcast_f32(j1), one)), vsplat4(g3));
+		const vfloat4 z1  = vadd(vsub(z0, vand(vcast_f32(k1), one)), vsplat4(g3));
+		const vfloat4 x2  = vadd(vsub(x0, vand(vcast_f32(i2), one)), vsplat4(2.0f * g3));
+		const vfloat4 y2  = vadd(vsub(y0, vand(vcast_f32(j2), one)), vsplat4(2.0f * g3));
+		const vfloat4 z2  = vadd(vsub(z0, vand(vcast_f32(k2), one)), vsplat4(2.0f * g3));
+		const vfloat4 x3  = vadd(x0, vsplat4(3.0f * g3 - 1.0f));
+		const vfloat4 y3  = vadd(y0, vsplat4(3.0f * g3 - 1.0f));
+		const vfloat4 z3  = vadd(z0, vsplat4(3.0f * g3 - 1.0f));
+
+		const vint4 i  = vcvt_i32(fi);
+		const vint4 j  = vcvt_i32(fj);
+		const vint4 k  = vcvt_i32(fk);
+		const vint4 h0 = hash(i, j, k, seed);
+		const vint4 h1 = hash(vsub(i, i1), vsub(j, j1), vsub(k, k1), seed);
+		const vint4 h2 = hash(vsub(i, i2), vsub(j, j2), vsub(k, k2), seed);
+		const vint4 h3 = hash(vadd(i, vsplat4i(1)), vadd(j, vsplat4i(1)), vadd(k, vsplat4i(1)), seed);
+
+		const vfloat4 n = vadd(vadd(corner(x0, y0, z0, h0), corner(x1, y1, z1, h1)), vadd(corner(x2, y2, z2, h2), corner(x3, y3, z3, h3)));
+		return vmul(n, vsplat4(simplex3_scale));
+	}
+};
+
+// --- fBm ---
+
+struct octave_table
+{
+	float    frequency[dxlib::math::max_fbm_octaves];
+	float    amplitude[dxlib::math::max_fbm_octaves];
+	uint32_t count;
+};
+
+octave_table make_octaves(const dxlib::math::fbm_params& params) noexcept
+{
+	ASSERT(params.octaves <= dxlib::math::max_fbm_octaves);
+
+	octave_table table;
+	table.count = std::min(params.octaves, dxlib::math::max_fbm_octaves);
+
+	// 振幅の合計で割って正規化しておきます
+	float frequency = params.frequency;
+	float amplitude = 1.0f;
+	float sum       = 0.0f;
+	for (uint32_t o = 0; o < table.count; ++o) {
+		table.frequency[o] = frequency;
+		table.amplitude[o] = amplitude;
+		sum += amplitude;
+		frequency *= params.lacunarity;
+		amplitude *= params.gain;
+	}
+	const float inv = sum > 0.0f ? 1.0f / sum : 0.0f;
+	for (uint32_t o = 0; o < table.count; ++o) {
+		table.amplitude[o] *= inv;
+	}
+	return table;
+}
+
+template<class Kernel>
+vfloat4 fbm(vfloat4 x, vfloat4 y, uint32_t seed, const octave_table& table) noexcept
+{
+	vfloat4 sum = vzero4();
+	for (uint32_t o = 0; o < table.count; ++o) {
+		const vfloat4 f = vsplat4(table.frequency[o]);
+		const vint4   s = vsplat4i(seed + o * octave_seed_step);
+		sum             = vmadd(Kernel::eval(vmul(x, f), vmul(y, f), s), vsplat4(table.amplitude[o]), sum);
+	}
+	return sum;
+}
+
+template<class Kernel>
+vfloat4 fbm(vfloat4 x, vfloat4 y, vfloat4 z, uint32_t seed, const octave_table& table) noexcept
+{
+	vfloat4 sum = vzero4();
+	for (uint32_t o = 0; o < table.count; ++o) {
+		const vfloat4 f = vsplat4(table.frequency[o]);
+		const vint4   s = vsplat4i(seed + o * octave_seed_step);
+		sum             = vmadd(Kernel::eval(vmul(x, f), vmul(y, f), vmul(z, f), s), vsplat4(table.amplitude[o]), sum);
+	}
+	return sum;
+}
+
+// --- 格子の評価 ---
+
+// 行 [begin, end) を評価します。行 r の座標は (origin + step * x, y(r), z(r))
+template<class Kernel, bool Is3D>
+void evaluate_rows(const float origin[3], const float step[3], uint32_t width, uint32_t height, uint32_t seed, const octave_table& table, float* out, size_t begin, size_t end) noexcept
+{
+	const vfloat4 lane = vset4(0.0f, 1.0f, 2.0f, 3.0f);
+	for (size_t r = begin; r < end; ++r) {
+		const float   py  = origin[1] + step[1] * static_cast<float>(r % height);
+		const float   pz  = origin[2] + step[2] * static_cast<float>(r / height);
+		const vfloat4 vy  = vsplat4(py);
+		const vfloat4 vz  = vsplat4(pz);
+		float*        row = out + r * width;
+		for (uint32_t x = 0; x < width; x += vfloat4_width) {
+			const vfloat4 vx = vmadd(vadd(vsplat4(static_cast<float>(x)), lane), vsplat4(step[0]), vsplat4(origin[0]));
+
+			vfloat4 v;
+			if constexpr (Is3D) {
+				v = fbm<Kernel>(vx, vy, vz, seed, table);
+			}
+			else {
+				v = fbm<Kernel>(vx, vy, seed, table);
+			}
+
+			if (x + vfloat4_width <= width) {
+				vstore4(&row[x], v);
+			}
+			else {
+				float tmp[4];
+				vstore4(tmp, v);
+				std::copy_n(tmp, width - x, &row[x]);
+			}
+		}
+	}
+}
+
+template<class Kernel, bool Is3D>
+void evaluate_grid(const float origin[3], const float step[3], uint32_t width, uint32_t height, size_t rows, uint32_t seed, const dxlib::math::fbm_params& params, float* out, dxlib::thread_pool* pool)
+{
+	const octave_table table = make_octaves(params);
+	const size_t       grain = std::max<size_t>(1, parallel_grain / std::max<uint32_t>(width, 1));
+	if (pool && rows > grain) {
+		pool->parallel_for(rows, grain, [&](size_t b, size_t e)
+		    {
+			    evaluate_rows<Kernel, Is3D>(origin, step, width, height, seed, table, out, b, e);
+		    });
+	}
+	else {
+		evaluate_rows<Kernel, Is3D>(origin, step, width, height, seed, table, out, 0, rows);
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace math {
+
+noise_generator::noise_generator(uint32_t seed) noexcept
+    : m_seed(seed)
+{
+}
+
+uint32_t noise_generator::seed() const noexcept
+{
+	return m_seed;
+}
+
+float noise_generator::gradient(const float2& p) const noexcept
+{
+	return vget_x(gradient_kernel::eval(vsplat4(p.x), vsplat4(p.y), vsplat4i(m_seed)));
+}
+
+float noise_generator::gradient(const float3& p) const noexcept
+{
+	return vget_x(gradient_kernel::eval(vsplat4(p.x), vsplat4(p.y), vsplat4(p.z), vsplat4i(m_seed)));
+}
+
+float noise_generator::simplex(const float2& p) const noexcept
+{
+	return vget_x(simplex_kernel::eval(vsplat4(p.x), vsplat4(p.y), vsplat4i(m_seed)));
+}
+
+float noise_generator::simplex(const float3& p) const noexcept
+{
+	return vget_x(simplex_kernel::eval(vsplat4(p.x), vsplat4(p.y), vsplat4(p.z), vsplat4i(m_seed)));
+}
+
+float noise_generator::fbm(noise_type type, const float2& p, const fbm_params& params) const noexcept
+{
+	const octave_table table = make_octaves(params);
+	const vfloat4      x     = vsplat4(p.x);
+	const vfloat4      y     = vsplat4(p.y);
+	return vget_x(type == noise_type::simplex ? ::fbm<simplex_kernel>(x, y, m_seed, table) : ::fbm<gradient_kernel>(x, y, m_seed, table));
+}
+
+float noise_generator::fbm(noise_type type, const float3& p, const fbm_params& params) const noexcept
+{
+	const octave_table table = make_octaves(params);
+	const vfloat4      x     = vsplat4(p.x);
+	const vfloat4      y     = vsplat4(p.y);
+	const vfloat4      z     = vsplat4(p.z);
+	return vget_x(type == noise_type::simplex ? ::fbm<simplex_kernel>(x, y, z, m_seed, table) : ::fbm<gradient_kernel>(x, y, z, m_seed, table));
+}
+
+void noise_generator::evaluate(noise_type type, const noise_grid2& grid, const fbm_params& params, std::span<float> out, thread_pool* pool) const
+{
+	const size_t rows = grid.height;
+	ASSERT_RETURN(out.size() >= rows * grid.width);
+
+	const float origin[3] = { grid.origin.x, grid.origin.y, 0.0f };
+	const float step[3]   = { grid.step.x, grid.step.y, 0.0f };
+	if (type == noise_type::simplex) {
+		evaluate_grid<simplex_kernel, false>(origin, step, grid.width, std::max<uint32_t>(grid.height, 1), rows, m_seed, params, out.data(), pool);
+	}
+	else {
+		evaluate_grid<gradient_kernel, false>(origin, step, grid.width, std::max<uint32_t>(grid.height, 1), rows, m_seed, params, out.data(), pool);
+	}
+}
+
+void noise_generator::evaluate(noise_type type, const noise_grid3& grid, const fbm_params& params, std::span<float> out, thread_pool* pool) const
+{
+	const size_t rows = static_cast<size_t>(grid.height) * grid.depth;
+	ASSERT_RETURN(out.size() >= rows * grid.width);
+
+	const float origin[3] = { grid.origin.x, grid.origin.y, grid.origin.z };
+	const float step[3]   = { grid.step.x, grid.step.y, grid.step.z };
+	if (type == noise_type::simplex) {
+		evaluate_grid<simplex_kernel, true>(origin, step, grid.width, std::max<uint32_t>(grid.height, 1), rows, m_seed, params, out.data(), pool);
+	}
+	else {
+		evaluate_grid<gradient_kernel, true>(origin, step, grid.width, std::max<uint32_t>(grid.height, 1), rows, m_seed, params, out.data(), pool);
+	}
+}
+
+} // namespace math
+} // namespace dxlib
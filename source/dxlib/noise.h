@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "vector.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+namespace math {
+
+//! \brief ノイズの種類
+enum class noise_type : uint8_t
+{
+	gradient, //!< 格子点の勾配を補間する Perlin ノイズ
+	simplex,  //!< 単体格子の Simplex ノイズ
+};
+
+//! \brief fbm_params::octaves の上限
+constexpr uint32_t max_fbm_octaves = 32;
+
+//! \brief fBm (非整数ブラウン運動) のパラメータ
+//!
+//! オクターブ o の周波数は frequency * lacunarity^o、振幅は gain^o です。結果は振幅の合計で正規化します。
+struct fbm_params
+{
+	uint32_t octaves    = 6; //!< 1 ~ max_fbm_octaves (0 は 0 を返し、上限を超える値はデバッグビルドでアサートし、上限に切り詰めます)
+	float    frequency  = 1.0f;
+	float    lacunarity = 2.0f;
+	float    gain       = 0.5f;
+};
+
+//! \brief 2D の評価格子
+//!
+//! out[y * width + x] に origin + step * (x, y) の値を書き込みます。
+struct noise_grid2
+{
+	float2   origin;
+	float2   step;
+	uint32_t width;
+	uint32_t height;
+};
+
+//! \brief 3D の評価格子
+//!
+//! out[(z * height + y) * width + x] に origin + step * (x, y, z) の値を書き込みます。
+struct noise_grid3
+{
+	float3   origin;
+	float3   step;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+};
+
+//! \brief 勾配/Simplex ノイズと fBm
+//!
+//! 格子点の勾配は seed と格子座標の整数ハッシュで決まり、置換テーブルを持ちません。
+//! 出力はおおよそ [-1, 1] で、格子点上では 0 になります。
+//! 1 点ずつの関数は格子評価と同じ 4 要素の SIMD カーネルの 1 要素目を返すので、同じ座標には同じ値を返します。
+class noise_generator
+{
+public:
+	//! \brief コンストラクタ
+	//!
+	//! \param[in] seed
+	explicit noise_generator(uint32_t seed = 0) noexcept;
+
+	//! \brief シード
+	[[nodiscard]] uint32_t seed() const noexcept;
+
+	//! \brief Perlin ノイズ
+	[[nodiscard]] float gradient(const float2& p) const noexcept;
+	[[nodiscard]] float gradient(const float3& p) const noexcept;
+
+	//! \brief Simplex ノイズ
+	[[nodiscard]] float simplex(const float2& p) const noexcept;
+	[[nodiscard]] float simplex(const float3& p) const noexcept;
+
+	//! \brief fBm
+	//!
+	//! オクターブごとにシードを変えて重ねます。
+	[[nodiscard]] float fbm(noise_type type, const float2& p, const fbm_params& params) const noexcept;
+	[[nodiscard]] float fbm(noise_type type, const float3& p, const fbm_params& params) const noexcept;
+
+	//! \brief 格子上の fBm をまとめて評価します
+	//!
+	//! 行単位のタイルに分けて 4 点ずつ SIMD で評価します。
+	//!
+	//! \param[in]  type
+	//! \param[in]  grid
+	//! \param[in]  params
+	//! \param[out] out    grid.width * grid.height 要素以上
+	//! \param[in]  pool   並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+	void evaluate(noise_type type, const noise_grid2& grid, const fbm_params& params, std::span<float> out, thread_pool* pool = nullptr) const;
+
+	//! \copydoc evaluate(noise_type, const noise_grid2&, const fbm_params&, std::span<float>, thread_pool*) const
+	//!
+	//! out は grid.width * grid.height * grid.depth 要素以上が必要です。
+	void evaluate(noise_type type, const noise_grid3& grid, const fbm_params& params, std::span<float> out, thread_pool* pool = nullptr) const;
+
+private:
+	uint32_t m_seed;
+};
+
+} // namespace math
+} // namespace dxlib
@@ -0,0 +1,458 @@
+#include "primitives.h"
+
+#include <cmath>
+#include <limits>
+
+#include "debug.h"
+#include "math.h"
+#include "vertex_layout.h"
+#include "vertex_packing.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+constexpr float pi     = dxlib::math::pi<float>;
+constexpr float two_pi = 2.0f * pi;
+
+// 周方向の cos / sin (継ぎ目の s 番目は 0 番目と同じ値)
+struct ring_table
+{
+	explicit ring_table(uint32_t slices) noexcept
+	{
+		for (uint32_t i = 0; i < slices; ++i) {
+			const float a = two_pi * static_cast<float>(i) / static_cast<float>(slices);
+			cos[i]        = std::cos(a);
+			sin[i]        = std::sin(a);
+		}
+		cos[slices] = cos[0];
+		sin[slices] = sin[0];
+	}
+
+	float cos[max_primitive_tessellation + 1];
+	float sin[max_primitive_tessellation + 1];
+};
+
+// --- 頂点の書き込み ---
+
+template<class V>
+concept packed_vertex = requires { typename vertex_traits<V>::source_type; };
+
+template<class V>
+struct source_of
+{
+	using type = V;
+};
+
+template<packed_vertex V>
+struct source_of<V>
+{
+	using type = source_vertex_t<V>;
+};
+
+// 生成した頂点を出力フォーマットに変換して先頭から順に書き込みます
+// 量子化フォーマットは元のフォーマットで chunk_size 個ずつ溜めてから pack します
+template<class V>
+class vertex_writer
+{
+public:
+	using source_type = typename source_of<V>::type;
+
+	vertex_writer(std::span<V> out, const float4& color) noexcept
+	    : m_out(out)
+	    , m_color(color)
+	{
+	}
+
+	void operator()(const float3& position, const float3& normal, const float2& uv) noexcept
+	{
+		source_type& v = next();
+		v.position     = position;
+		if constexpr (has_semantic<source_type>(vertex_semantic::normal)) {
+			v.normal = normal;
+		}
+		if constexpr (has_semantic<source_type>(vertex_semantic::texcoord)) {
+			v.uv = uv;
+		}
+		if constexpr (has_semantic<source_type>(vertex_semantic::color)) {
+			v.color = m_color;
+		}
+	}
+
+	void flush() noexcept
+	{
+		if constexpr (packed_vertex<V>) {
+			pack(std::span<const source_type>(m_chunk, m_count), m_out.subspan(m_written, m_count));
+			m_written += m_count;
+			m_count = 0;
+		}
+	}
+
+private:
+	source_type& next() noexcept
+	{
+		if constexpr (packed_vertex<V>) {
+			if (m_count == chunk_size) {
+				flush();
+			}
+			return m_chunk[m_count++];
+		}
+		else {
+			return m_out[m_written++];
+		}
+	}
+
+private:
+	static constexpr size_t chunk_size = 64;
+
+	std::span<V> m_out;
+	float4       m_color;
+	size_t       m_written = 0;
+	size_t       m_count   = 0;
+	source_type  m_chunk[packed_vertex<V> ? chunk_size : 1];
+};
+
+// --- 頂点の生成 ---
+
+// 列 i の u
+// 極の頂点は i 番目と i + 1 番目の間の三角形だけが使用するので、u をその中間にします
+float column_u(uint32_t i, uint32_t s, bool pole) noexcept
+{
+	return (static_cast<float>(i) + (pole ? 0.5f : 0.0f)) / static_cast<float>(s);
+}
+
+template<class Emit>
+void sphere_vertices(const primitive_desc& desc, uint32_t s, uint32_t t, const ring_table& ring, Emit& emit) noexcept
+{
+	for (uint32_t j = 0; j <= t; ++j) {
+		const bool  pole = j == 0 || j == t;
+		const float v    = static_cast<float>(j) / static_cast<float>(t);
+		const float phi  = pi * v;
+		// 極は正確に (0, +-1, 0) にします
+		const float y = j == 0 ? 1.0f : (j == t ? -1.0f : std::cos(phi));
+		const float r = pole ? 0.0f : std::sin(phi);
+		for (uint32_t i = 0; i <= s; ++i) {
+			const float3 n(r * ring.cos[i], y, r * ring.sin[i]);
+			emit(n * desc.radius, n, float2(column_u(i, s, pole), v));
+		}
+	}
+}
+
+template<class Emit>
+void capsule_vertices(const primitive_desc& desc, uint32_t s, uint32_t t, const ring_table& ring, Emit& emit) noexcept
+{
+	// v は外形線に沿った長さで割り当てます
+	const float half   = desc.height * 0.5f;
+	const float length = pi * desc.radius + desc.height;
+	for (uint32_t j = 0; j <= 2 * t + 1; ++j) {
+		const bool     upper  = j <= t;
+		const uint32_t k      = upper ? j : j - 1;
+		const bool     pole   = k == 0 || k == 2 * t;
+		const float    phi    = pi * 0.5f * static_cast<float>(k) / static_cast<float>(t);
+		const float    y      = k == 0 ? 1.0f : (k == 2 * t ? -1.0f : std::cos(phi));
+		const float    r      = pole ? 0.0f : std::sin(phi);
+		const float    offset = upper ? half : -half;
+		const float    v      = (desc.radius * phi + (upper ? 0.0f : desc.height)) / length;
+		for (uint32_t i = 0; i <= s; ++i) {
+			const float3 n(r * ring.cos[i], y, r * ring.sin[i]);
+			emit(n * desc.radius + float3(0.0f, offset, 0.0f), n, float2(column_u(i, s, pole), v));
+		}
+	}
+}
+
+// 中心 1 + 周 s の蓋
+template<class Emit>
+void cap_vertices(float radius, float y, float direction, uint32_t s, const ring_table& ring, Emit& emit) noexcept
+{
+	const float3 n(0.0f, direction, 0.0f);
+	emit(float3(0.0f, y, 0.0f), n, float2(0.5f, 0.5f));
+	for (uint32_t i = 0; i < s; ++i) {
+		emit(float3(radius * ring.cos[i], y, radius * ring.sin[i]), n, float2(0.5f + 0.5f * ring.cos[i], 0.5f - 0.5f * direction * ring.sin[i]));
+	}
+}
+
+template<class Emit>
+void cylinder_vertices(const primitive_desc& desc, uint32_t s, const ring_table& ring, Emit& emit) noexcept
+{
+	const float half = desc.height * 0.5f;
+	for (uint32_t j = 0; j < 2; ++j) {
+		const float y = j == 0 ? half : -half;
+		for (uint32_t i = 0; i <= s; ++i) {
+			const float3 n(ring.cos[i], 0.0f, ring.sin[i]);
+			emit(float3(desc.radius * ring.cos[i], y, desc.radius * ring.sin[i]), n, float2(static_cast<float>(i) / static_cast<float>(s), static_cast<float>(j)));
+		}
+	}
+	cap_vertices(desc.radius, +half, +1.0f, s, ring, emit);
+	cap_vertices(desc.radius, -half, -1.0f, s, ring, emit);
+}
+
+template<class Emit>
+void grid_vertices(const primitive_desc& desc, uint32_t t, Emit& emit) noexcept
+{
+	const float3 n(0.0f, 1.0f, 0.0f);
+	for (uint32_t j = 0; j <= t; ++j) {
+		const float v = static_cast<float>(j) / static_cast<float>(t);
+		const float z = desc.size.y * (0.5f - v);
+		for (uint32_t i = 0; i <= t; ++i) {
+			const float u = static_cast<float>(i) / static_cast<float>(t);
+			emit(float3(desc.size.x * (u - 0.5f), 0.0f, z), n, float2(u, v));
+		}
+	}
+}
+
+template<class Emit>
+void torus_vertices(const primitive_desc& desc, uint32_t s, uint32_t t, const ring_table& ring, Emit& emit) noexcept
+{
+	// 行は管の外側 -> 下面 -> 内側 -> 上面の順に回ります (球と同じく行が進むと -Y 側へ進む向き)
+	for (uint32_t j = 0; j <= t; ++j) {
+		const float v   = static_cast<float>(j) / static_cast<float>(t);
+		const float psi = two_pi * v;
+		const float c   = j == t ? 1.0f : std::cos(psi);
+		const float y   = j == t ? 0.0f : -std::sin(psi);
+		for (uint32_t i = 0; i <= s; ++i) {
+			const float3 n(c * ring.cos[i], y, c * ring.sin[i]);
+			const float3 center(desc.radius * ring.cos[i], 0.0f, desc.radius * ring.sin[i]);
+			emit(center + n * desc.thickness, n, float2(static_cast<float>(i) / static_cast<float>(s), v));
+		}
+	}
+}
+
+template<class Emit>
+void cone_vertices(const primitive_desc& desc, uint32_t s, const ring_table& ring, Emit& emit) noexcept
+{
+	// 側面の法線は (h cos, r, h sin) 方向で、頂点の法線は担当する三角形の中央の向きにします
+	const float half = desc.height * 0.5f;
+	const float len  = std::sqrt(desc.height * desc.height + desc.radius * desc.radius);
+	const float nh   = len > 0.0f ? desc.height / len : 0.0f;
+	const float ny   = len > 0.0f ? desc.radius / len : 1.0f;
+	for (uint32_t i = 0; i <= s; ++i) {
+		const float a = two_pi * (static_cast<float>(i) + 0.5f) / static_cast<float>(s);
+		emit(float3(0.0f, half, 0.0f), float3(nh * std::cos(a), ny, nh * std::sin(a)), float2(column_u(i, s, true), 0.0f));
+	}
+	for (uint32_t i = 0; i <= s; ++i) {
+		emit(float3(desc.radius * ring.cos[i], -half, desc.radius * ring.sin[i]), float3(nh * ring.cos[i], ny, nh * ring.sin[i]), float2(static_cast<float>(i) / static_cast<float>(s), 1.0f));
+	}
+	cap_vertices(desc.radius, -half, -1.0f, s, ring, emit);
+}
+
+template<class V>
+void generate_vertices_impl(const primitive_desc& desc, std::span<V> out) noexcept
+{
+	const primitive_counts counts = primitive_count(desc);
+	ASSERT_RETURN(desc.tessellation <= max_primitive_tessellation);
+	ASSERT_RETURN(out.size() >= counts.vertex_count);
+
+	const uint32_t s = detail::primitive_slices(desc);
+	const uint32_t t = detail::primitive_stacks(desc);
+
+	vertex_writer<V> emit(out.first(counts.vertex_count), desc.color);
+	if (desc.type == primitive_type::grid) {
+		grid_vertices(desc, t, emit);
+	}
+	else {
+		const ring_table ring(s);
+		switch (desc.type) {
+		case primitive_type::sphere:
+			sphere_vertices(desc, s, t, ring, emit);
+			break;
+		case primitive_type::capsule:
+			capsule_vertices(desc, s, t, ring, emit);
+			break;
+		case primitive_type::cylinder:
+			cylinder_vertices(desc, s, ring, emit);
+			break;
+		case primitive_type::torus:
+			torus_vertices(desc, s, t, ring, emit);
+			break;
+		case primitive_type::cone:
+			cone_vertices(desc, s, ring, emit);
+			break;
+		default:
+			break;
+		}
+	}
+	emit.flush();
+}
+
+// --- インデックスの生成 ---
+
+template<class Index>
+class index_writer
+{
+public:
+	index_writer(Index* out, uint32_t base_vertex) noexcept
+	    : m_out(out)
+	    , m_base(base_vertex)
+	{
+	}
+
+	void operator()(uint32_t a, uint32_t b, uint32_t c) noexcept
+	{
+		m_out[0] = static_cast<Index>(m_base + a);
+		m_out[1] = static_cast<Index>(m_base + b);
+		m_out[2] = static_cast<Index>(m_base + c);
+		m_out += 3;
+	}
+
+private:
+	Index*   m_out;
+	uint32_t m_base;
+};
+
+// 1 行 columns + 1 頂点の行列を四角形で繋ぎます
+// 0 行目と最終行が極 (全頂点が同じ位置) の場合は、その帯の縮退三角形を省き、極の列 i を i ~ i + 1 の三角形に使用します
+template<class Index>
+void grid_indices(index_writer<Index>& emit, uint32_t first, uint32_t columns, uint32_t rows, bool top_pole, bool bottom_pole) noexcept
+{
+	const uint32_t stride = columns + 1;
+	for (uint32_t j = 0; j < rows; ++j) {
+		const uint32_t row = first + j * stride;
+		for (uint32_t i = 0; i < columns; ++i) {
+			const uint32_t a = row + i;
+			const uint32_t b = a + 1;
+			const uint32_t c = a + stride;
+			const uint32_t d = c + 1;
+			if (top_pole && j == 0) {
+				emit(a, d, c);
+			}
+			else if (bottom_pole && j == rows - 1) {
+				emit(a, b, c);
+			}
+			else {
+				emit(a, b, c);
+				emit(b, d, c);
+			}
+		}
+	}
+}
+
+// 中心 center と周 center + 1 ~ center + s の蓋
+template<class Index>
+void cap_indices(index_writer<Index>& emit, uint32_t center, uint32_t s, bool up) noexcept
+{
+	for (uint32_t i = 0; i < s; ++i) {
+		const uint32_t a = center + 1 + i;
+		const uint32_t b = center + 1 + (i + 1) % s;
+		if (up) {
+			emit(center, b, a);
+		}
+		else {
+			emit(center, a, b);
+		}
+	}
+}
+
+template<class Index>
+void generate_indices_impl(const primitive_desc& desc, std::span<Index> out, uint32_t base_vertex) noexcept
+{
+	const primitive_counts counts = primitive_count(desc);
+	ASSERT_RETURN(desc.tessellation <= max_primitive_tessellation);
+	ASSERT_RETURN(out.size() >= counts.index_count);
+	ASSERT_RETURN(static_cast<uint64_t>(base_vertex) + counts.vertex_count <= static_cast<uint64_t>(std::numeric_limits<Index>::max()) + 1);
+
+	const uint32_t s = detail::primitive_slices(desc);
+	const uint32_t t = detail::primitive_stacks(desc);
+
+	index_writer<Index> emit(out.data(), base_vertex);
+	switch (desc.type) {
+	case primitive_type::sphere:
+		grid_indices(emit, 0, s, t, true, true);
+		break;
+	case primitive_type::capsule:
+		grid_indices(emit, 0, s, 2 * t + 1, true, true);
+		break;
+	case primitive_type::cylinder:
+		grid_indices(emit, 0, s, 1, false, false);
+		cap_indices(emit, 2 * (s + 1), s, true);
+		cap_indices(emit, 2 * (s + 1) + s + 1, s, false);
+		break;
+	case primitive_type::grid:
+		grid_indices(emit, 0, t, t, false, false);
+		break;
+	case primitive_type::torus:
+		grid_indices(emit, 0, s, t, false, false);
+		break;
+	case primitive_type::cone:
+		grid_indices(emit, 0, s, 1, true, false);
+		cap_indices(emit, 2 * (s + 1), s, false);
+		break;
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_p> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pc> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pu> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_puc> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pn> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pnu> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_p> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pc> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pu> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_puc> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pn> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pnu> out) noexcept
+{
+	generate_vertices_impl(desc, out);
+}
+
+void generate_indices(const primitive_desc& desc, std::span<uint16_t> out, uint32_t base_vertex) noexcept
+{
+	generate_indices_impl(desc, out, base_vertex);
+}
+
+void generate_indices(const primitive_desc& desc, std::span<uint32_t> out, uint32_t base_vertex) noexcept
+{
+	generate_indices_impl(desc, out, base_vertex);
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,145 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "vertex.h"
+
+namespace dxlib {
+namespace geometry {
+
+// 基本形状の生成
+//
+// 頂点数/インデックス数を事前に求め、呼び出し側が用意したバッファに直接書き込みます。
+// 出力は先頭から順に書き込むだけで読み戻さないので、Map した upload ヒープ (write-combined) を span で渡せます。
+//
+// 形状は原点中心の Y 軸上向きで、三角形 (a, b, c) は cross(b - a, c - a) が外向きになる順 (D3D の表面 = 時計回り) です。
+// UV の v は上から下に 0 ~ 1 で、周方向に分割する形状は u = 1 の継ぎ目の頂点を重複して持ちます。
+
+//! \brief 形状の種類
+enum class primitive_type : uint8_t
+{
+	sphere,   //!< 緯度経度で分割した球
+	capsule,  //!< 円柱の両端に半球を付けた形状
+	cylinder, //!< 上下に蓋のある円柱
+	grid,     //!< XZ 平面上の格子 (+Y 向き)
+	torus,    //!< Y 軸周りのトーラス
+	cone,     //!< 底面のある円錐
+};
+
+//! \brief 形状のパラメータ
+//!
+//! tessellation から各方向の分割数を次のように決めます (s = max(tessellation, 3))。
+//! - sphere   : 経度 s, 緯度 max(s / 2, 2)
+//! - capsule  : 経度 s, 半球ごとに緯度 max(s / 4, 1)
+//! - cylinder : 経度 s
+//! - grid     : 各辺 max(tessellation, 1)
+//! - torus    : 中心円の周方向 s, 管の周方向 max(s / 2, 3)
+//! - cone     : 経度 s
+struct primitive_desc
+{
+	primitive_type type         = primitive_type::sphere;
+	uint32_t       tessellation = 16;
+	float          radius       = 0.5f;          //!< sphere / capsule / cylinder / cone の半径、torus の中心円の半径
+	float          height       = 1.0f;          //!< capsule の円柱部、cylinder / cone の高さ
+	float          thickness    = 0.25f;         //!< torus の管の半径
+	float2         size         = float2(1.0f);  //!< grid の X / Z 方向の大きさ
+	float4         color        = float4(1.0f);  //!< color を持つ頂点フォーマットに書き込む色
+};
+
+//! \brief tessellation の上限
+inline constexpr uint32_t max_primitive_tessellation = 1024;
+
+//! \brief 頂点数とインデックス数
+struct primitive_counts
+{
+	uint32_t vertex_count;
+	uint32_t index_count;
+};
+
+namespace detail {
+
+[[nodiscard]] constexpr uint32_t primitive_slices(const primitive_desc& desc) noexcept
+{
+	return desc.tessellation > 3 ? desc.tessellation : 3;
+}
+
+[[nodiscard]] constexpr uint32_t primitive_stacks(const primitive_desc& desc) noexcept
+{
+	const uint32_t s = primitive_slices(desc);
+	switch (desc.type) {
+	case primitive_type::sphere:
+		return s / 2 > 2 ? s / 2 : 2;
+	case primitive_type::capsule:
+		return s / 4 > 1 ? s / 4 : 1;
+	case primitive_type::grid:
+		return desc.tessellation > 1 ? desc.tessellation : 1;
+	case primitive_type::torus:
+		return s / 2 > 3 ? s / 2 : 3;
+	default:
+		return 1;
+	}
+}
+
+} // namespace detail
+
+//! \brief desc の形状の頂点数とインデックス数
+//!
+//! generate_vertices / generate_indices が書き込む要素数と一致します。
+[[nodiscard]] constexpr primitive_counts primitive_count(const primitive_desc& desc) noexcept
+{
+	const uint32_t s = detail::primitive_slices(desc);
+	const uint32_t t = detail::primitive_stacks(desc);
+	switch (desc.type) {
+	case primitive_type::sphere:
+		// 極の帯は 1 周あたり三角形 1 つ
+		return { (s + 1) * (t + 1), 6 * s * (t - 1) };
+	case primitive_type::capsule:
+		// 赤道の行を上下の半球で重複して持ちます
+		return { (s + 1) * (2 * t + 2), 12 * s * t };
+	case primitive_type::cylinder:
+		// 側面 2 行 + 蓋ごとに中心 1 + 周 s
+		return { 4 * s + 4, 12 * s };
+	case primitive_type::grid:
+		return { (t + 1) * (t + 1), 6 * t * t };
+	case primitive_type::torus:
+		return { (s + 1) * (t + 1), 6 * s * t };
+	case primitive_type::cone:
+		// 頂点の行 + 底面の行 + 底面の蓋
+		return { 3 * s + 3, 6 * s };
+	}
+	return { 0, 0 };
+}
+
+//! \brief 頂点を書き込みます
+//!
+//! 頂点フォーマットにない要素は書き込みません。量子化フォーマットは元のフォーマットで生成して pack します。
+//!
+//! \param[in]  desc
+//! \param[out] out  primitive_count(desc).vertex_count 要素以上
+void generate_vertices(const primitive_desc& desc, std::span<vertex_p> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pc> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pu> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<vertex_puc> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pn> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<vertex_pnu> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_p> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pc> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pu> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_puc> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pn> out) noexcept;
+void generate_vertices(const primitive_desc& desc, std::span<packed_vertex_pnu> out) noexcept;
+
+//! \brief インデックスを書き込みます
+//!
+//! 1 つのバッファに複数の形状を詰める場合は、先に書き込んだ頂点数を base_vertex に渡します。
+//! 16 ビットの場合は base_vertex + 頂点数が 65536 以下である必要があります。
+//!
+//! \param[in]  desc
+//! \param[out] out         primitive_count(desc).index_count 要素以上
+//! \param[in]  base_vertex 各インデックスに加算する値
+void generate_indices(const primitive_desc& desc, std::span<uint16_t> out, uint32_t base_vertex = 0) noexcept;
+void generate_indices(const primitive_desc& desc, std::span<uint32_t> out, uint32_t base_vertex = 0) noexcept;
+
+} // namespace geometry
+} // namespace dxlib
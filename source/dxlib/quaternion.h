@@ -0,0 +1,292 @@
+﻿#pragma once
+
+#include <cmath>
+
+#include "matrix.h"
+#include "vector.h"
+
+namespace dxlib {
+namespace math {
+
+// 回転を表す単位クォータニオン
+//
+// matrix.h と同じく行ベクトル・左手座標系で扱い、to_mat4(q) は DirectXMath の XMMatrixRotationQuaternion と一致します。
+// a * b は「a の回転の後に b の回転」を表し、to_mat4(a * b) == to_mat4(a) * to_mat4(b) となります。
+template<class T>
+struct quaternion
+{
+	T x, y, z, w;
+
+	quaternion() = default;
+
+	constexpr quaternion(T x, T y, T z, T w) noexcept
+	    : x(x)
+	    , y(y)
+	    , z(z)
+	    , w(w)
+	{
+	}
+
+	constexpr explicit quaternion(const vec4<T>& v) noexcept
+	    : x(v.x)
+	    , y(v.y)
+	    , z(v.z)
+	    , w(v.w)
+	{
+	}
+
+	constexpr explicit operator vec4<T>() const noexcept
+	{
+		return { x, y, z, w };
+	}
+
+	[[nodiscard]] static constexpr quaternion identity() noexcept
+	{
+		return { T(0), T(0), T(0), T(1) };
+	}
+
+	[[nodiscard]] constexpr vec3<T> xyz() const noexcept
+	{
+		return { x, y, z };
+	}
+
+	[[nodiscard]] constexpr quaternion operator-() const noexcept
+	{
+		return { -x, -y, -z, -w };
+	}
+};
+
+template<class T>
+[[nodiscard]] constexpr bool operator==(const quaternion<T>& a, const quaternion<T>& b) noexcept
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+//! \brief a の回転の後に b の回転を行うクォータニオン (ハミルトン積 b * a)
+template<class T>
+[[nodiscard]] constexpr quaternion<T> operator*(const quaternion<T>& a, const quaternion<T>& b) noexcept
+{
+	return {
+		b.w * a.x + b.x * a.w + b.y * a.z - b.z * a.y,
+		b.w * a.y - b.x * a.z + b.y * a.w + b.z * a.x,
+		b.w * a.z + b.x * a.y - b.y * a.x + b.z * a.w,
+		b.w * a.w - b.x * a.x - b.y * a.y - b.z * a.z
+	};
+}
+
+template<class T>
+[[nodiscard]] constexpr T dot(const quaternion<T>& a, const quaternion<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+template<class T>
+[[nodiscard]] constexpr quaternion<T> conjugate(const quaternion<T>& q) noexcept
+{
+	return { -q.x, -q.y, -q.z, q.w };
+}
+
+template<class T>
+[[nodiscard]] constexpr quaternion<T> inverse(const quaternion<T>& q) noexcept
+{
+	const T inv = T(1) / dot(q, q);
+	return { -q.x * inv, -q.y * inv, -q.z * inv, q.w * inv };
+}
+
+template<class T>
+[[nodiscard]] inline T length(const quaternion<T>& q) noexcept
+{
+	return std::sqrt(dot(q, q));
+}
+
+template<class T>
+[[nodiscard]] inline quaternion<T> normalize(const quaternion<T>& q) noexcept
+{
+	const T inv = T(1) / length(q);
+	return { q.x * inv, q.y * inv, q.z * inv, q.w * inv };
+}
+
+//! \brief 任意軸回転
+//!
+//! \param[in] axis  回転軸 (正規化済み)
+//! \param[in] angle 回転角 (ラジアン)
+//!
+//! \ret quaternion
+template<class T>
+[[nodiscard]] inline quaternion<T> rotation_axis(const vec3<T>& axis, T angle) noexcept
+{
+	const T s = std::sin(angle * T(0.5));
+	return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * T(0.5)) };
+}
+
+//! \brief ロール (Z) -> ピッチ (X) -> ヨー (Y) の順に回転するクォータニオン
+//!
+//! \param[in] pitch X 軸回転 (ラジアン)
+//! \param[in] yaw   Y 軸回転 (ラジアン)
+//! \param[in] roll  Z 軸回転 (ラジアン)
+//!
+//! \ret quaternion
+template<class T>
+[[nodiscard]] inline quaternion<T> rotation_euler(T pitch, T yaw, T roll) noexcept
+{
+	return rotation_axis(vec3<T>(T(0), T(0), T(1)), roll)
+	    * rotation_axis(vec3<T>(T(1), T(0), T(0)), pitch)
+	    * rotation_axis(vec3<T>(T(0), T(1), T(0)), yaw);
+}
+
+//! \brief ベクトルを回転します
+template<class T>
+[[nodiscard]] constexpr vec3<T> rotate(const vec3<T>& v, const quaternion<T>& q) noexcept
+{
+	const vec3<T> u = q.xyz();
+	const vec3<T> c = cross(u, v);
+	return v + (c * vec3<T>(q.w) + cross(u, c)) * vec3<T>(T(2));
+}
+
+//! \brief 最短経路で正規化線形補間します
+template<class T>
+[[nodiscard]] inline quaternion<T> nlerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept
+{
+	const T s = dot(a, b) < T(0) ? -t : t;
+	const T r = T(1) - t;
+	return normalize(quaternion<T>(a.x * r + b.x * s, a.y * r + b.y * s, a.z * r + b.z * s, a.w * r + b.w * s));
+}
+
+//! \brief 最短経路で球面線形補間します
+template<class T>
+[[nodiscard]] inline quaternion<T> slerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept
+{
+	T cos_theta = dot(a, b);
+	T sign      = T(1);
+	if (cos_theta < T(0)) {
+		cos_theta = -cos_theta;
+		sign      = T(-1);
+	}
+	// ほぼ同じ向きでは sin(theta) が 0 に近づくため線形補間にします
+	if (cos_theta > T(0.9995)) {
+		return nlerp(a, b, t);
+	}
+	const T theta   = std::acos(cos_theta);
+	const T inv_sin = T(1) / std::sin(theta);
+	const T r       = std::sin((T(1) - t) * theta) * inv_sin;
+	const T s       = std::sin(t * theta) * inv_sin * sign;
+	return { a.x * r + b.x * s, a.y * r + b.y * s, a.z * r + b.z * s, a.w * r + b.w * s };
+}
+
+//! \brief 回転行列に変換します
+template<class T>
+[[nodiscard]] constexpr mat3<T> to_mat3(const quaternion<T>& q) noexcept
+{
+	const T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	const T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	const T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	return {
+		T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy),
+		T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx),
+		T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy)
+	};
+}
+
+//! \brief 回転行列に変換します
+template<class T>
+[[nodiscard]] constexpr mat4<T> to_mat4(const quaternion<T>& q) noexcept
+{
+	const mat3<T> r = to_mat3(q);
+	return {
+		r._00, r._01, r._02, T(0),
+		r._10, r._11, r._12, T(0),
+		r._20, r._21, r._22, T(0),
+		T(0), T(0), T(0), T(1)
+	};
+}
+
+namespace detail {
+
+template<class T>
+[[nodiscard]] inline quaternion<T> to_quaternion(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21, T m22) noexcept
+{
+	// 対角成分の最も大きい要素から求めて桁落ちを避けます
+	const T trace = m00 + m11 + m22;
+	if (trace > T(0)) {
+		const T s = std::sqrt(trace + T(1)) * T(2);
+		return { (m12 - m21) / s, (m20 - m02) / s, (m01 - m10) / s, s * T(0.25) };
+	}
+	if (m00 > m11 && m00 > m22) {
+		const T s = std::sqrt(T(1) + m00 - m11 - m22) * T(2);
+		return { s * T(0.25), (m01 + m10) / s, (m02 + m20) / s, (m12 - m21) / s };
+	}
+	if (m11 > m22) {
+		const T s = std::sqrt(T(1) + m11 - m00 - m22) * T(2);
+		return { (m01 + m10) / s, s * T(0.25), (m12 + m21) / s, (m20 - m02) / s };
+	}
+	const T s = std::sqrt(T(1) + m22 - m00 - m11) * T(2);
+	return { (m02 + m20) / s, (m12 + m21) / s, s * T(0.25), (m01 - m10) / s };
+}
+
+} // namespace detail
+
+//! \brief 回転行列 (スケールを含まないこと) をクォータニオンに変換します
+template<class T>
+[[nodiscard]] inline quaternion<T> to_quaternion(const mat3<T>& m) noexcept
+{
+	return detail::to_quaternion(m._00, m._01, m._02, m._10, m._11, m._12, m._20, m._21, m._22);
+}
+
+//! \brief 行列の回転部分 (スケールを含まないこと) をクォータニオンに変換します
+template<class T>
+[[nodiscard]] inline quaternion<T> to_quaternion(const mat4<T>& m) noexcept
+{
+	return detail::to_quaternion(m._00, m._01, m._02, m._10, m._11, m._12, m._20, m._21, m._22);
+}
+
+//! \brief スケール -> 回転 -> 平行移動の順に変換する行列
+//!
+//! \param[in] scale
+//! \param[in] rotation
+//! \param[in] translation
+//!
+//! \ret mat4
+template<class T>
+[[nodiscard]] constexpr mat4<T> compose_trs(const vec3<T>& scale, const quaternion<T>& rotation, const vec3<T>& translation) noexcept
+{
+	const mat3<T> r = to_mat3(rotation);
+	return {
+		r._00 * scale.x, r._01 * scale.x, r._02 * scale.x, T(0),
+		r._10 * scale.y, r._11 * scale.y, r._12 * scale.y, T(0),
+		r._20 * scale.z, r._21 * scale.z, r._22 * scale.z, T(0),
+		translation.x, translation.y, translation.z, T(1)
+	};
+}
+
+//! \brief compose_trs() で作成した行列をスケール・回転・平行移動に分解します
+//!
+//! せん断を含む行列は正しく分解できません。
+//!
+//! \param[in]  m
+//! \param[out] scale
+//! \param[out] rotation
+//! \param[out] translation
+template<class T>
+inline void decompose_trs(const mat4<T>& m, vec3<T>& scale, quaternion<T>& rotation, vec3<T>& translation) noexcept
+{
+	const vec3<T> r0(m._00, m._01, m._02);
+	const vec3<T> r1(m._10, m._11, m._12);
+	const vec3<T> r2(m._20, m._21, m._22);
+
+	scale = vec3<T>(length(r0), length(r1), length(r2));
+	// 鏡映を含む場合は X のスケールを負にして、行列式が正の回転行列に戻します
+	if (dot(cross(r0, r1), r2) < T(0)) {
+		scale.x = -scale.x;
+	}
+
+	const vec3<T> x = r0 * vec3<T>(T(1) / scale.x);
+	const vec3<T> y = r1 * vec3<T>(T(1) / scale.y);
+	const vec3<T> z = r2 * vec3<T>(T(1) / scale.z);
+	rotation        = detail::to_quaternion(x.x, x.y, x.z, y.x, y.y, y.z, z.x, z.y, z.z);
+	translation     = vec3<T>(m._30, m._31, m._32);
+}
+
+} // namespace math
+} // namespace dxlib
+
+using quat = dxlib::math::quaternion<float>;
@@ -0,0 +1,254 @@
+#include "quaternion_batch.h"
+
+#include "debug.h"
+#include "simd.h"
+
+namespace {
+
+using namespace dxlib::math::simd;
+
+static_assert(sizeof(quat) == sizeof(float) * 4);
+
+// 4 個の quat を成分ごとに転置したもの
+struct quat4
+{
+	vfloat4 x, y, z, w;
+};
+
+quat4 load(const quat* q) noexcept
+{
+	quat4 r = { vload4(&q[0].x), vload4(&q[1].x), vload4(&q[2].x), vload4(&q[3].x) };
+	vtranspose(r.x, r.y, r.z, r.w);
+	return r;
+}
+
+void store(quat* q, quat4 r) noexcept
+{
+	vtranspose(r.x, r.y, r.z, r.w);
+	vstore4(&q[0].x, r.x);
+	vstore4(&q[1].x, r.y);
+	vstore4(&q[2].x, r.z);
+	vstore4(&q[3].x, r.w);
+}
+
+vfloat4 dot(const quat4& a, const quat4& b) noexcept
+{
+	return vmadd(a.w, b.w, vmadd(a.z, b.z, vmadd(a.y, b.y, vmul(a.x, b.x))));
+}
+
+quat4 scale(const quat4& q, vfloat4 s) noexcept
+{
+	return { vmul(q.x, s), vmul(q.y, s), vmul(q.z, s), vmul(q.w, s) };
+}
+
+// a * s + b * t
+quat4 blend(const quat4& a, vfloat4 s, const quat4& b, vfloat4 t) noexcept
+{
+	return {
+		vmadd(b.x, t, vmul(a.x, s)),
+		vmadd(b.y, t, vmul(a.y, s)),
+		vmadd(b.z, t, vmul(a.z, s)),
+		vmadd(b.w, t, vmul(a.w, s))
+	};
+}
+
+quat4 normalize(const quat4& q) noexcept
+{
+	return scale(q, vrsqrt(dot(q, q)));
+}
+
+// 内積が負の場合は b を反転して最短経路にし、反転後の内積を返します
+vfloat4 shortest(const quat4& a, quat4& b) noexcept
+{
+	const vfloat4 d    = dot(a, b);
+	const vfloat4 sign = vand(d, vsplat4(-0.0f));
+	b                  = { vxor(b.x, sign), vxor(b.y, sign), vxor(b.z, sign), vxor(b.w, sign) };
+	return vxor(d, sign);
+}
+
+struct normalize_op
+{
+	quat4 operator()(const quat4& a, const quat4&, vfloat4) const noexcept
+	{
+		return normalize(a);
+	}
+};
+
+struct nlerp_op
+{
+	quat4 operator()(const quat4& a, quat4 b, vfloat4 t) const noexcept
+	{
+		shortest(a, b);
+		return normalize(blend(a, vsub(vsplat4(1.0f), t), b, t));
+	}
+};
+
+struct slerp_op
+{
+	// Eberly の多項式近似 (n = 8)
+	// c(t) = t * (1 + b[0] * (1 + b[1] * (... (1 + b[7])))), b[i] = (u[i] * t^2 - v[i]) * (cos(theta) - 1)
+	// u[i] = 1 / ((i + 1) * (2i + 3)), v[i] = (i + 1) / (2i + 3) で、最終項のみ誤差を最小化する係数 mu を掛けます。
+	static constexpr float mu   = 1.85298109240830f;
+	static constexpr float u[8] = {
+		1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+		1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), mu / (8 * 17)
+	};
+	static constexpr float v[8] = {
+		1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+		5.0f / 11, 6.0f / 13, 7.0f / 15, mu * 8 / 17
+	};
+
+	static vfloat4 coefficient(vfloat4 t, vfloat4 x_minus_1) noexcept
+	{
+		const vfloat4 tt  = vmul(t, t);
+		const vfloat4 one = vsplat4(1.0f);
+		vfloat4       c   = one;
+		for (int i = 7; i >= 0; --i) {
+			const vfloat4 b = vmul(vsub(vmul(vsplat4(u[i]), tt), vsplat4(v[i])), x_minus_1);
+			c               = vmadd(b, c, one);
+		}
+		return vmul(t, c);
+	}
+
+	quat4 operator()(const quat4& a, quat4 b, vfloat4 t) const noexcept
+	{
+		const vfloat4 x_minus_1 = vsub(shortest(a, b), vsplat4(1.0f));
+		const vfloat4 ct        = coefficient(t, x_minus_1);
+		const vfloat4 cs        = coefficient(vsub(vsplat4(1.0f), t), x_minus_1);
+		return blend(a, cs, b, ct);
+	}
+};
+
+struct uniform_t
+{
+	float t;
+
+	vfloat4 operator()(size_t) const noexcept
+	{
+		return vsplat4(t);
+	}
+
+	float operator[](size_t) const noexcept
+	{
+		return t;
+	}
+};
+
+struct varying_t
+{
+	const float* t;
+
+	vfloat4 operator()(size_t i) const noexcept
+	{
+		return vload4(t + i);
+	}
+
+	float operator[](size_t i) const noexcept
+	{
+		return t[i];
+	}
+};
+
+// 端数は単位クォータニオンで埋めた一時領域に移して同じカーネルで処理します。
+// スカラー版と混在させないことで、要素の位置によって結果が変わらないようにしています。
+template<class Op, class T>
+void binary(const quat* a, const quat* b, T t, quat* out, size_t n, Op op) noexcept
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		store(out + i, op(load(a + i), load(b + i), t(i)));
+	}
+	if (i < n) {
+		quat  ta[4], tb[4], tout[4];
+		float tt[4] = {};
+		for (size_t k = 0; k < 4; ++k) {
+			ta[k] = i + k < n ? a[i + k] : quat::identity();
+			tb[k] = i + k < n ? b[i + k] : quat::identity();
+			tt[k] = i + k < n ? t[i + k] : 0.0f;
+		}
+		store(tout, op(load(ta), load(tb), vload4(tt)));
+		for (size_t k = 0; i + k < n; ++k) {
+			out[i + k] = tout[k];
+		}
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace math {
+namespace batch {
+
+void normalize(std::span<const quat> q, std::span<quat> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= q.size());
+	binary(q.data(), q.data(), uniform_t { 0.0f }, out.data(), q.size(), normalize_op {});
+}
+
+void nlerp(std::span<const quat> a, std::span<const quat> b, float t, std::span<quat> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && out.size() >= a.size());
+	binary(a.data(), b.data(), uniform_t { t }, out.data(), a.size(), nlerp_op {});
+}
+
+void nlerp(std::span<const quat> a, std::span<const quat> b, std::span<const float> t, std::span<quat> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && t.size() >= a.size() && out.size() >= a.size());
+	binary(a.data(), b.data(), varying_t { t.data() }, out.data(), a.size(), nlerp_op {});
+}
+
+void slerp(std::span<const quat> a, std::span<const quat> b, float t, std::span<quat> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && out.size() >= a.size());
+	binary(a.data(), b.data(), uniform_t { t }, out.data(), a.size(), slerp_op {});
+}
+
+void slerp(std::span<const quat> a, std::span<const quat> b, std::span<const float> t, std::span<quat> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && t.size() >= a.size() && out.size() >= a.size());
+	binary(a.data(), b.data(), varying_t { t.data() }, out.data(), a.size(), slerp_op {});
+}
+
+void compose_trs(std::span<const float3> scale, std::span<const quat> rotation, std::span<const float3> translation, std::span<float4x4> out) noexcept
+{
+	const size_t n = scale.size();
+	ASSERT_RETURN(rotation.size() >= n && translation.size() >= n && out.size() >= n);
+
+	const vfloat4 zero = vzero4();
+	const vfloat4 one  = vsplat4(1.0f);
+	const vfloat4 two  = vsplat4(2.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const quat4 q = load(&rotation[i]);
+		vfloat4     sx, sy, sz, tx, ty, tz;
+		vload_aos3(&scale[i].x, sx, sy, sz);
+		vload_aos3(&translation[i].x, tx, ty, tz);
+
+		const vfloat4 xx = vmul(q.x, q.x), yy = vmul(q.y, q.y), zz = vmul(q.z, q.z);
+		const vfloat4 xy = vmul(q.x, q.y), xz = vmul(q.x, q.z), yz = vmul(q.y, q.z);
+		const vfloat4 wx = vmul(q.w, q.x), wy = vmul(q.w, q.y), wz = vmul(q.w, q.z);
+
+		vfloat4 r[4][4] = {
+			{ vmul(sx, vnmadd(two, vadd(yy, zz), one)), vmul(sx, vmul(two, vadd(xy, wz))), vmul(sx, vmul(two, vsub(xz, wy))), zero },
+			{ vmul(sy, vmul(two, vsub(xy, wz))), vmul(sy, vnmadd(two, vadd(xx, zz), one)), vmul(sy, vmul(two, vadd(yz, wx))), zero },
+			{ vmul(sz, vmul(two, vadd(xz, wy))), vmul(sz, vmul(two, vsub(yz, wx))), vmul(sz, vnmadd(two, vadd(xx, yy), one)), zero },
+			{ tx, ty, tz, one },
+		};
+
+		// r[row][col] の各レーンが 4 個の行列に対応するので、行ごとに転置して書き込みます
+		for (int row = 0; row < 4; ++row) {
+			vtranspose(r[row][0], r[row][1], r[row][2], r[row][3]);
+			for (int k = 0; k < 4; ++k) {
+				math::detail::store_row(out[i + k], row, r[row][k]);
+			}
+		}
+	}
+	for (; i < n; ++i) {
+		out[i] = math::compose_trs(scale[i], rotation[i], translation[i]);
+	}
+}
+
+} // namespace batch
+} // namespace math
+} // namespace dxlib
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <span>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "vector.h"
+
+namespace dxlib {
+namespace math {
+namespace batch {
+
+// quat の配列をまとめて処理するカーネル群
+//
+// 4 要素ずつ SoA に転置して処理します。出力 span は入力と同じ要素数以上が必要です。
+// 出力と入力が完全に同じ領域 (インプレース) であることは許可しますが、部分的な重なりは未定義です。
+
+//! \brief out[i] = normalize(q[i])
+void normalize(std::span<const quat> q, std::span<quat> out) noexcept;
+
+//! \brief out[i] = nlerp(a[i], b[i], t)
+void nlerp(std::span<const quat> a, std::span<const quat> b, float t, std::span<quat> out) noexcept;
+
+//! \brief out[i] = nlerp(a[i], b[i], t[i])
+void nlerp(std::span<const quat> a, std::span<const quat> b, std::span<const float> t, std::span<quat> out) noexcept;
+
+//! \brief out[i] = slerp(a[i], b[i], t)
+//!
+//! acos / sin を使わない多項式近似 (Eberly, "A Fast and Accurate Algorithm for Computing SLERP") で計算します。
+//! 単位クォータニオンと t in [0, 1] に対して、厳密な slerp との誤差は成分あたり最大 3e-5 程度です。
+void slerp(std::span<const quat> a, std::span<const quat> b, float t, std::span<quat> out) noexcept;
+
+//! \brief out[i] = slerp(a[i], b[i], t[i])
+void slerp(std::span<const quat> a, std::span<const quat> b, std::span<const float> t, std::span<quat> out) noexcept;
+
+//! \brief out[i] = compose_trs(scale[i], rotation[i], translation[i])
+void compose_trs(std::span<const float3> scale, std::span<const quat> rotation, std::span<const float3> translation, std::span<float4x4> out) noexcept;
+
+} // namespace batch
+} // namespace math
+} // namespace dxlib
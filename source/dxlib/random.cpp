@@ -0,0 +1,205 @@
+#include "random.h"
+
+#include <algorithm>
+
+#include "simd.h"
+
+namespace {
+
+using namespace dxlib::math::simd;
+
+constexpr uint32_t philox_m0 = 0xD2511F53u;
+constexpr uint32_t philox_m1 = 0xCD9E8D57u;
+constexpr uint32_t philox_w0 = 0x9E3779B9u;
+constexpr uint32_t philox_w1 = 0xBB67AE85u;
+constexpr int      rounds    = 10;
+
+// uint32 の上位 24 ビットを [0, 1) に変換する係数
+constexpr float to_unit = 1.0f / 16777216.0f;
+
+std::array<uint32_t, 4> philox(std::array<uint32_t, 4> c, uint32_t k0, uint32_t k1) noexcept
+{
+	for (int r = 0; r < rounds; ++r) {
+		const uint64_t p0 = static_cast<uint64_t>(philox_m0) * c[0];
+		const uint64_t p1 = static_cast<uint64_t>(philox_m1) * c[2];
+		c                 = { static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1), static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0) };
+		k0 += philox_w0;
+		k1 += philox_w1;
+	}
+	return c;
+}
+
+// 1 回の生成で処理するブロック数と要素数
+constexpr size_t chunk_blocks = vfloat4_width;
+constexpr size_t chunk_size   = chunk_blocks * 4;
+
+// counter から連続する chunk_blocks 個のブロックを生成し、index 順 (block 0 の 4 要素, block 1 の 4 要素, ...) に r へ格納します
+void philox_chunk(const uint32_t key[2], const uint32_t stream[2], uint64_t counter, vint4 r[chunk_blocks]) noexcept
+{
+	// 4 ブロックを SoA に並べて同時に処理します
+	uint32_t lo[4], hi[4];
+	for (size_t k = 0; k < 4; ++k) {
+		lo[k] = static_cast<uint32_t>(counter + k);
+		hi[k] = static_cast<uint32_t>((counter + k) >> 32);
+	}
+	vint4 x0 = vload4i(lo);
+	vint4 x1 = vload4i(hi);
+	vint4 x2 = vsplat4i(stream[0]);
+	vint4 x3 = vsplat4i(stream[1]);
+
+	const vint4 m0 = vsplat4i(philox_m0);
+	const vint4 m1 = vsplat4i(philox_m1);
+	uint32_t    k0 = key[0];
+	uint32_t    k1 = key[1];
+	for (int i = 0; i < rounds; ++i) {
+		vint4 hi0, lo0, hi1, lo1;
+		vmulhilo(m0, x0, hi0, lo0);
+		vmulhilo(m1, x2, hi1, lo1);
+		x0 = vxor(vxor(hi1, x1), vsplat4i(k0));
+		x1 = lo1;
+		x2 = vxor(vxor(hi0, x3), vsplat4i(k1));
+		x3 = lo0;
+		k0 += philox_w0;
+		k1 += philox_w1;
+	}
+
+	// SoA から index 順に戻します
+	vfloat4 t0 = vcast_f32(x0);
+	vfloat4 t1 = vcast_f32(x1);
+	vfloat4 t2 = vcast_f32(x2);
+	vfloat4 t3 = vcast_f32(x3);
+	vtranspose(t0, t1, t2, t3);
+	r[0] = vcast_i32(t0);
+	r[1] = vcast_i32(t1);
+	r[2] = vcast_i32(t2);
+	r[3] = vcast_i32(t3);
+}
+
+// 上位 24 ビットを [0, 1) に変換します
+vfloat4 unit(vint4 v) noexcept
+{
+	return vmul(vcvt_f32(vsrl<8>(v)), vsplat4(to_unit));
+}
+
+// offset 番目から count 個を chunk_size 個単位で生成し、fn(out の位置, index 順の chunk_size 個, 先頭の読み飛ばし数, 個数) に渡します
+template<class Fn>
+void generate(const uint32_t key[2], const uint32_t stream[2], size_t count, uint64_t offset, Fn&& fn) noexcept
+{
+	for (size_t i = 0; i < count;) {
+		const uint64_t index = offset + i;
+		const size_t   skip  = static_cast<size_t>(index % chunk_size);
+		const size_t   take  = std::min<size_t>(chunk_size - skip, count - i);
+
+		vint4 r[chunk_blocks];
+		philox_chunk(key, stream, (index - skip) / 4, r);
+		fn(i, r, skip, take);
+		i += take;
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace math {
+
+philox_random::philox_random(uint64_t seed, uint64_t stream) noexcept
+    : m_key { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) }
+    , m_stream { static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32) }
+{
+}
+
+std::array<uint32_t, 4> philox_random::block(uint64_t counter) const noexcept
+{
+	return philox({ static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), m_stream[0], m_stream[1] }, m_key[0], m_key[1]);
+}
+
+uint32_t philox_random::u32(uint64_t index) const noexcept
+{
+	return block(index / 4)[index % 4];
+}
+
+float philox_random::uniform(uint64_t index) const noexcept
+{
+	return static_cast<float>(u32(index) >> 8) * to_unit;
+}
+
+void philox_random::fill(std::span<uint32_t> out, uint64_t offset) const noexcept
+{
+	generate(m_key, m_stream, out.size(), offset, [&](size_t i, const vint4 r[chunk_blocks], size_t skip, size_t take)
+	    {
+		    if (take == chunk_size) {
+			    for (size_t k = 0; k < chunk_blocks; ++k) {
+				    vstore4i(&out[i + k * 4], r[k]);
+			    }
+		    }
+		    else {
+			    uint32_t tmp[chunk_size];
+			    for (size_t k = 0; k < chunk_blocks; ++k) {
+				    vstore4i(&tmp[k * 4], r[k]);
+			    }
+			    std::copy_n(&tmp[skip], take, &out[i]);
+		    }
+	    });
+}
+
+void philox_random::fill_uniform(std::span<float> out, float lo, float hi, uint64_t offset) const noexcept
+{
+	const float scale = hi - lo;
+	fill_uniform(out.data(), out.size(), &lo, &scale, 1, offset);
+}
+
+void philox_random::fill_uniform(std::span<float2> out, const float2& lo, const float2& hi, uint64_t offset) const noexcept
+{
+	static_assert(sizeof(float2) == sizeof(float) * 2);
+	const float l[2] = { lo.x, lo.y };
+	const float s[2] = { hi.x - lo.x, hi.y - lo.y };
+	fill_uniform(&out.data()->x, out.size() * 2, l, s, 2, offset);
+}
+
+void philox_random::fill_uniform(std::span<float3> out, const float3& lo, const float3& hi, uint64_t offset) const noexcept
+{
+	static_assert(sizeof(float3) == sizeof(float) * 3);
+	const float l[3] = { lo.x, lo.y, lo.z };
+	const float s[3] = { hi.x - lo.x, hi.y - lo.y, hi.z - lo.z };
+	fill_uniform(&out.data()->x, out.size() * 3, l, s, 3, offset);
+}
+
+void philox_random::fill_uniform(float* out, size_t count, const float* lo, const float* scale, size_t components, uint64_t offset) const noexcept
+{
+	// 成分は out の位置で決まるので、4 要素の先頭位置 % components ごとに lo / scale を並べておきます
+	vfloat4 lo4[3];
+	vfloat4 scale4[3];
+	for (size_t phase = 0; phase < components; ++phase) {
+		float l[4], s[4];
+		for (size_t k = 0; k < 4; ++k) {
+			l[k] = lo[(phase + k) % components];
+			s[k] = scale[(phase + k) % components];
+		}
+		lo4[phase]    = vload4(l);
+		scale4[phase] = vload4(s);
+	}
+
+	generate(m_key, m_stream, count, offset, [&](size_t i, const vint4 r[chunk_blocks], size_t skip, size_t take)
+	    {
+		    if (take == chunk_size) {
+			    for (size_t k = 0; k < chunk_blocks; ++k) {
+				    const size_t phase = (i + k * 4) % components;
+				    vstore4(&out[i + k * 4], vmadd(unit(r[k]), scale4[phase], lo4[phase]));
+			    }
+		    }
+		    else {
+			    // 端数も同じ演算 (vmadd) を通して、分割位置によって結果が変わらないようにします
+			    alignas(alignment) float tmp[chunk_size];
+			    for (size_t k = 0; k < chunk_blocks; ++k) {
+				    vstore4(&tmp[k * 4], unit(r[k]));
+			    }
+			    for (size_t t = 0; t < take; ++t) {
+				    const size_t c = (i + t) % components;
+				    out[i + t]     = vget_x(vmadd(vsplat4(tmp[skip + t]), vsplat4(scale[c]), vsplat4(lo[c])));
+			    }
+		    }
+	    });
+}
+
+} // namespace math
+} // namespace dxlib
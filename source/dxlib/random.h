@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "vector.h"
+
+namespace dxlib {
+namespace math {
+
+//! \brief カウンタベースの乱数生成器 (Philox4x32-10)
+//!
+//! Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" の Philox4x32-10 です。
+//! 状態を持たず、(seed, stream, counter) から 4 つの uint32 を決定的に生成します。
+//! index 番目の値は block(index / 4)[index % 4] で、fill 系は offset 番目から順に書き込みます。
+//! そのため範囲を分割して並列に生成しても、一括で生成した場合と同じ値になります。
+class philox_random
+{
+public:
+	//! \brief コンストラクタ
+	//!
+	//! \param[in] seed   鍵
+	//! \param[in] stream 同じ seed で独立した系列が必要な場合に変えます
+	explicit philox_random(uint64_t seed, uint64_t stream = 0) noexcept;
+
+	//! \brief counter 番目のブロック (uint32 x4)
+	[[nodiscard]] std::array<uint32_t, 4> block(uint64_t counter) const noexcept;
+
+	//! \brief index 番目の uint32
+	[[nodiscard]] uint32_t u32(uint64_t index) const noexcept;
+
+	//! \brief index 番目の uint32 を [0, 1) の float に変換した値
+	//!
+	//! 上位 24 ビットを使用するので、0 ~ 1 - 2^-24 の 2^-24 刻みになります。
+	[[nodiscard]] float uniform(uint64_t index) const noexcept;
+
+	//! \brief out[i] = u32(offset + i)
+	void fill(std::span<uint32_t> out, uint64_t offset = 0) const noexcept;
+
+	//! \brief out[i] = lo + (hi - lo) * uniform(offset + i)
+	void fill_uniform(std::span<float> out, float lo = 0.0f, float hi = 1.0f, uint64_t offset = 0) const noexcept;
+
+	//! \brief out[i] を成分ごとに [lo, hi) の一様乱数で埋めます
+	//!
+	//! out[i].x, out[i].y は uniform(offset + 2 * i), uniform(offset + 2 * i + 1) を使用します。
+	void fill_uniform(std::span<float2> out, const float2& lo, const float2& hi, uint64_t offset = 0) const noexcept;
+
+	//! \brief out[i] を成分ごとに [lo, hi) の一様乱数で埋めます
+	//!
+	//! out[i].x, out[i].y, out[i].z は uniform(offset + 3 * i) から順に使用します。
+	void fill_uniform(std::span<float3> out, const float3& lo, const float3& hi, uint64_t offset = 0) const noexcept;
+
+private:
+	void fill_uniform(float* out, size_t count, const float* lo, const float* scale, size_t components, uint64_t offset) const noexcept;
+
+private:
+	uint32_t m_key[2];
+	uint32_t m_stream[2];
+};
+
+} // namespace math
+} // namespace dxlib
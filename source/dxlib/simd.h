@@ -0,0 +1,1575 @@
+﻿#pragma once
+
+// SIMD バックエンドの選択
+//
+// コンパイラのターゲット設定から AVX / SSE / NEON を自動で選択します。
+// _DISABLE_SIMD を定義するとスカラー実装に、_DISABLE_SIMD_AVX を定義すると SSE までに制限されます。
+#if !defined(_DISABLE_SIMD)
+#if (defined(__AVX__) || defined(__AVX2__)) && !defined(_DISABLE_SIMD_AVX)
+#define _ENABLE_SIMD_AVX
+#define _ENABLE_SIMD_SSE
+#if defined(__FMA__) || defined(__AVX2__)
+#define _ENABLE_SIMD_FMA
+#endif
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define _ENABLE_SIMD_F16C
+#endif
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _ENABLE_SIMD_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _ENABLE_SIMD_NEON
+#endif
+#endif
+
+#if defined(_ENABLE_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(_ENABLE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "half.h"
+
+namespace dxlib {
+namespace math {
+namespace simd {
+
+#if defined(_ENABLE_SIMD_SSE)
+using vfloat4 = __m128;
+#elif defined(_ENABLE_SIMD_NEON)
+using vfloat4 = float32x4_t;
+#else
+struct vfloat4
+{
+	float f[4];
+};
+#endif
+
+#if defined(_ENABLE_SIMD_AVX)
+using vfloat8 = __m256;
+#else
+struct vfloat8
+{
+	vfloat4 lo, hi;
+};
+#endif
+
+#if defined(_ENABLE_SIMD_SSE)
+using vint4 = __m128i;
+#elif defined(_ENABLE_SIMD_NEON)
+using vint4 = uint32x4_t;
+#else
+struct vint4
+{
+	uint32_t i[4];
+};
+#endif
+
+//! \brief vfloat4 の要素数
+inline constexpr size_t vfloat4_width = 4;
+
+//! \brief vfloat8 の要素数
+inline constexpr size_t vfloat8_width = 8;
+
+//! \brief アライン済みロード/ストアに必要なアライメント
+#if defined(_ENABLE_SIMD_AVX)
+inline constexpr size_t alignment = 32;
+#else
+inline constexpr size_t alignment = 16;
+#endif
+
+//! \brief ポインタが alignment 境界に揃っているかを判定します
+inline bool is_aligned(const void* p) noexcept
+{
+	return (reinterpret_cast<uintptr_t>(p) & (alignment - 1)) == 0;
+}
+
+// --- vfloat4 ---
+
+#if defined(_ENABLE_SIMD_SSE)
+
+inline vfloat4 vzero4() noexcept
+{
+	return _mm_setzero_ps();
+}
+
+inline vfloat4 vset4(float x, float y, float z, float w) noexcept
+{
+	return _mm_setr_ps(x, y, z, w);
+}
+
+inline vfloat4 vsplat4(float v) noexcept
+{
+	return _mm_set1_ps(v);
+}
+
+inline vfloat4 vload4(const float* p) noexcept
+{
+	return _mm_loadu_ps(p);
+}
+
+inline vfloat4 vload4a(const float* p) noexcept
+{
+	return _mm_load_ps(p);
+}
+
+inline void vstore4(float* p, vfloat4 v) noexcept
+{
+	_mm_storeu_ps(p, v);
+}
+
+inline void vstore4a(float* p, vfloat4 v) noexcept
+{
+	_mm_store_ps(p, v);
+}
+
+inline vfloat4 vadd(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_add_ps(a, b);
+}
+
+inline vfloat4 vsub(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_sub_ps(a, b);
+}
+
+inline vfloat4 vmul(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_mul_ps(a, b);
+}
+
+inline vfloat4 vdiv(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_div_ps(a, b);
+}
+
+//! \brief a * b + c
+inline vfloat4 vmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+#if defined(_ENABLE_SIMD_FMA)
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+//! \brief c - a * b
+inline vfloat4 vnmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+#if defined(_ENABLE_SIMD_FMA)
+	return _mm_fnmadd_ps(a, b, c);
+#else
+	return _mm_sub_ps(c, _mm_mul_ps(a, b));
+#endif
+}
+
+inline vfloat4 vmin(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_min_ps(a, b);
+}
+
+inline vfloat4 vmax(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_max_ps(a, b);
+}
+
+inline vfloat4 vsqrt(vfloat4 v) noexcept
+{
+	return _mm_sqrt_ps(v);
+}
+
+inline vfloat4 vneg(vfloat4 v) noexcept
+{
+	return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+}
+
+inline vfloat4 vabs(vfloat4 v) noexcept
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+inline vfloat4 vand(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_and_ps(a, b);
+}
+
+inline vfloat4 vor(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_or_ps(a, b);
+}
+
+inline vfloat4 vxor(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_xor_ps(a, b);
+}
+
+inline vfloat4 vcmplt(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_cmplt_ps(a, b);
+}
+
+inline vfloat4 vcmpge(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_cmpge_ps(a, b);
+}
+
+//! \brief mask が立っている要素は a、それ以外は b を選択します
+inline vfloat4 vselect(vfloat4 mask, vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//! \brief 各要素の符号ビットを下位ビットから詰めて返します
+inline int vmask(vfloat4 v) noexcept
+{
+	return _mm_movemask_ps(v);
+}
+
+inline float vget_x(vfloat4 v) noexcept
+{
+	return _mm_cvtss_f32(v);
+}
+
+//! \brief (a[X], a[Y], b[Z], b[W]) を返します
+template<int X, int Y, int Z, int W>
+inline vfloat4 vshuffle(vfloat4 a, vfloat4 b) noexcept
+{
+	return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+#elif defined(_ENABLE_SIMD_NEON)
+
+inline vfloat4 vzero4() noexcept
+{
+	return vdupq_n_f32(0.0f);
+}
+
+inline vfloat4 vset4(float x, float y, float z, float w) noexcept
+{
+	const float f[4] = { x, y, z, w };
+	return vld1q_f32(f);
+}
+
+inline vfloat4 vsplat4(float v) noexcept
+{
+	return vdupq_n_f32(v);
+}
+
+inline vfloat4 vload4(const float* p) noexcept
+{
+	return vld1q_f32(p);
+}
+
+inline vfloat4 vload4a(const float* p) noexcept
+{
+	return vld1q_f32(p);
+}
+
+inline void vstore4(float* p, vfloat4 v) noexcept
+{
+	vst1q_f32(p, v);
+}
+
+inline void vstore4a(float* p, vfloat4 v) noexcept
+{
+	vst1q_f32(p, v);
+}
+
+inline vfloat4 vadd(vfloat4 a, vfloat4 b) noexcept
+{
+	return vaddq_f32(a, b);
+}
+
+inline vfloat4 vsub(vfloat4 a, vfloat4 b) noexcept
+{
+	return vsubq_f32(a, b);
+}
+
+inline vfloat4 vmul(vfloat4 a, vfloat4 b) noexcept
+{
+	return vmulq_f32(a, b);
+}
+
+inline vfloat4 vdiv(vfloat4 a, vfloat4 b) noexcept
+{
+	return vdivq_f32(a, b);
+}
+
+//! \brief a * b + c
+inline vfloat4 vmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+	return vfmaq_f32(c, a, b);
+}
+
+//! \brief c - a * b
+inline vfloat4 vnmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+	return vfmsq_f32(c, a, b);
+}
+
+inline vfloat4 vmin(vfloat4 a, vfloat4 b) noexcept
+{
+	return vminq_f32(a, b);
+}
+
+inline vfloat4 vmax(vfloat4 a, vfloat4 b) noexcept
+{
+	return vmaxq_f32(a, b);
+}
+
+inline vfloat4 vsqrt(vfloat4 v) noexcept
+{
+	return vsqrtq_f32(v);
+}
+
+inline vfloat4 vneg(vfloat4 v) noexcept
+{
+	return vnegq_f32(v);
+}
+
+inline vfloat4 vabs(vfloat4 v) noexcept
+{
+	return vabsq_f32(v);
+}
+
+inline vfloat4 vand(vfloat4 a, vfloat4 b) noexcept
+{
+	return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline vfloat4 vor(vfloat4 a, vfloat4 b) noexcept
+{
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline vfloat4 vxor(vfloat4 a, vfloat4 b) noexcept
+{
+	return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline vfloat4 vcmplt(vfloat4 a, vfloat4 b) noexcept
+{
+	return vreinterpretq_f32_u32(vcltq_f32(a, b));
+}
+
+inline vfloat4 vcmpge(vfloat4 a, vfloat4 b) noexcept
+{
+	return vreinterpretq_f32_u32(vcgeq_f32(a, b));
+}
+
+//! \brief mask が立っている要素は a、それ以外は b を選択します
+inline vfloat4 vselect(vfloat4 mask, vfloat4 a, vfloat4 b) noexcept
+{
+	return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+}
+
+//! \brief 各要素の符号ビットを下位ビットから詰めて返します
+inline int vmask(vfloat4 v) noexcept
+{
+	const int32_t shift[4] = { 0, 1, 2, 3 };
+	uint32x4_t    bits     = vshrq_n_u32(vreinterpretq_u32_f32(v), 31);
+	return static_cast<int>(vaddvq_u32(vshlq_u32(bits, vld1q_s32(shift))));
+}
+
+inline float vget_x(vfloat4 v) noexcept
+{
+	return vgetq_lane_f32(v, 0);
+}
+
+//! \brief (a[X], a[Y], b[Z], b[W]) を返します
+template<int X, int Y, int Z, int W>
+inline vfloat4 vshuffle(vfloat4 a, vfloat4 b) noexcept
+{
+	float fa[4], fb[4];
+	vst1q_f32(fa, a);
+	vst1q_f32(fb, b);
+	return vset4(fa[X], fa[Y], fb[Z], fb[W]);
+}
+
+#else
+
+inline vfloat4 vzero4() noexcept
+{
+	return { 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+inline vfloat4 vset4(float x, float y, float z, float w) noexcept
+{
+	return { x, y, z, w };
+}
+
+inline vfloat4 vsplat4(float v) noexcept
+{
+	return { v, v, v, v };
+}
+
+inline vfloat4 vload4(const float* p) noexcept
+{
+	return { p[0], p[1], p[2], p[3] };
+}
+
+inline vfloat4 vload4a(const float* p) noexcept
+{
+	return { p[0], p[1], p[2], p[3] };
+}
+
+inline void vstore4(float* p, vfloat4 v) noexcept
+{
+	p[0] = v.f[0];
+	p[1] = v.f[1];
+	p[2] = v.f[2];
+	p[3] = v.f[3];
+}
+
+inline void vstore4a(float* p, vfloat4 v) noexcept
+{
+	vstore4(p, v);
+}
+
+namespace detail {
+
+inline float vbits(uint32_t u) noexcept
+{
+	float f;
+	std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+inline uint32_t vbits(float f) noexcept
+{
+	uint32_t u;
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+} // namespace detail
+
+inline vfloat4 vadd(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3] };
+}
+
+inline vfloat4 vsub(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3] };
+}
+
+inline vfloat4 vmul(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3] };
+}
+
+inline vfloat4 vdiv(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] / b.f[0], a.f[1] / b.f[1], a.f[2] / b.f[2], a.f[3] / b.f[3] };
+}
+
+//! \brief a * b + c
+inline vfloat4 vmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+	return vadd(vmul(a, b), c);
+}
+
+//! \brief c - a * b
+inline vfloat4 vnmadd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept
+{
+	return vsub(c, vmul(a, b));
+}
+
+inline vfloat4 vmin(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] < b.f[0] ? a.f[0] : b.f[0], a.f[1] < b.f[1] ? a.f[1] : b.f[1], a.f[2] < b.f[2] ? a.f[2] : b.f[2], a.f[3] < b.f[3] ? a.f[3] : b.f[3] };
+}
+
+inline vfloat4 vmax(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[0] > b.f[0] ? a.f[0] : b.f[0], a.f[1] > b.f[1] ? a.f[1] : b.f[1], a.f[2] > b.f[2] ? a.f[2] : b.f[2], a.f[3] > b.f[3] ? a.f[3] : b.f[3] };
+}
+
+inline vfloat4 vsqrt(vfloat4 v) noexcept
+{
+	return { std::sqrt(v.f[0]), std::sqrt(v.f[1]), std::sqrt(v.f[2]), std::sqrt(v.f[3]) };
+}
+
+inline vfloat4 vneg(vfloat4 v) noexcept
+{
+	return { -v.f[0], -v.f[1], -v.f[2], -v.f[3] };
+}
+
+inline vfloat4 vabs(vfloat4 v) noexcept
+{
+	return { std::fabs(v.f[0]), std::fabs(v.f[1]), std::fabs(v.f[2]), std::fabs(v.f[3]) };
+}
+
+inline vfloat4 vand(vfloat4 a, vfloat4 b) noexcept
+{
+	return { detail::vbits(detail::vbits(a.f[0]) & detail::vbits(b.f[0])), detail::vbits(detail::vbits(a.f[1]) & detail::vbits(b.f[1])), detail::vbits(detail::vbits(a.f[2]) & detail::vbits(b.f[2])), detail::vbits(detail::vbits(a.f[3]) & detail::vbits(b.f[3])) };
+}
+
+inline vfloat4 vor(vfloat4 a, vfloat4 b) noexcept
+{
+	return { detail::vbits(detail::vbits(a.f[0]) | detail::vbits(b.f[0])), detail::vbits(detail::vbits(a.f[1]) | detail::vbits(b.f[1])), detail::vbits(detail::vbits(a.f[2]) | detail::vbits(b.f[2])), detail::vbits(detail::vbits(a.f[3]) | detail::vbits(b.f[3])) };
+}
+
+inline vfloat4 vxor(vfloat4 a, vfloat4 b) noexcept
+{
+	return { detail::vbits(detail::vbits(a.f[0]) ^ detail::vbits(b.f[0])), detail::vbits(detail::vbits(a.f[1]) ^ detail::vbits(b.f[1])), detail::vbits(detail::vbits(a.f[2]) ^ detail::vbits(b.f[2])), detail::vbits(detail::vbits(a.f[3]) ^ detail::vbits(b.f[3])) };
+}
+
+inline vfloat4 vcmplt(vfloat4 a, vfloat4 b) noexcept
+{
+	return { detail::vbits(a.f[0] < b.f[0] ? 0xffffffffu : 0u), detail::vbits(a.f[1] < b.f[1] ? 0xffffffffu : 0u), detail::vbits(a.f[2] < b.f[2] ? 0xffffffffu : 0u), detail::vbits(a.f[3] < b.f[3] ? 0xffffffffu : 0u) };
+}
+
+inline vfloat4 vcmpge(vfloat4 a, vfloat4 b) noexcept
+{
+	return { detail::vbits(a.f[0] >= b.f[0] ? 0xffffffffu : 0u), detail::vbits(a.f[1] >= b.f[1] ? 0xffffffffu : 0u), detail::vbits(a.f[2] >= b.f[2] ? 0xffffffffu : 0u), detail::vbits(a.f[3] >= b.f[3] ? 0xffffffffu : 0u) };
+}
+
+//! \brief mask が立っている要素は a、それ以外は b を選択します
+inline vfloat4 vselect(vfloat4 mask, vfloat4 a, vfloat4 b) noexcept
+{
+	vfloat4 r;
+	for (int i = 0; i < 4; ++i) {
+		r.f[i] = (detail::vbits(mask.f[i]) & 0x80000000u) ? a.f[i] : b.f[i];
+	}
+	return r;
+}
+
+//! \brief 各要素の符号ビットを下位ビットから詰めて返します
+inline int vmask(vfloat4 v) noexcept
+{
+	int r = 0;
+	for (int i = 0; i < 4; ++i) {
+		r |= static_cast<int>(detail::vbits(v.f[i]) >> 31) << i;
+	}
+	return r;
+}
+
+inline float vget_x(vfloat4 v) noexcept
+{
+	return v.f[0];
+}
+
+//! \brief (a[X], a[Y], b[Z], b[W]) を返します
+template<int X, int Y, int Z, int W>
+inline vfloat4 vshuffle(vfloat4 a, vfloat4 b) noexcept
+{
+	return { a.f[X], a.f[Y], b.f[Z], b.f[W] };
+}
+
+#endif
+
+//! \brief v[I] を全要素に複製します
+template<int I>
+inline vfloat4 vsplat(vfloat4 v) noexcept
+{
+	return vshuffle<I, I, I, I>(v, v);
+}
+
+//! \brief 全要素の総和
+inline float vhsum(vfloat4 v) noexcept
+{
+	vfloat4 t = vadd(v, vshuffle<2, 3, 0, 1>(v, v));
+	t         = vadd(t, vshuffle<1, 0, 3, 2>(t, t));
+	return vget_x(t);
+}
+
+//! \brief 4 要素の内積
+inline float vdot4(vfloat4 a, vfloat4 b) noexcept
+{
+	return vhsum(vmul(a, b));
+}
+
+//! \brief 1 / sqrt(v)
+inline vfloat4 vrsqrt(vfloat4 v) noexcept
+{
+	return vdiv(vsplat4(1.0f), vsqrt(v));
+}
+
+//! \brief 4x4 の転置
+inline void vtranspose(vfloat4& r0, vfloat4& r1, vfloat4& r2, vfloat4& r3) noexcept
+{
+	vfloat4 t0 = vshuffle<0, 1, 0, 1>(r0, r1);
+	vfloat4 t1 = vshuffle<2, 3, 2, 3>(r0, r1);
+	vfloat4 t2 = vshuffle<0, 1, 0, 1>(r2, r3);
+	vfloat4 t3 = vshuffle<2, 3, 2, 3>(r2, r3);
+	r0         = vshuffle<0, 2, 0, 2>(t0, t2);
+	r1         = vshuffle<1, 3, 1, 3>(t0, t2);
+	r2         = vshuffle<0, 2, 0, 2>(t1, t3);
+	r3         = vshuffle<1, 3, 1, 3>(t1, t3);
+}
+
+//! \brief float3 x4 (12 float) を SoA の x, y, z に分解してロードします
+inline void vload_aos3(const float* p, vfloat4& x, vfloat4& y, vfloat4& z) noexcept
+{
+	const vfloat4 v0 = vload4(p + 0);
+	const vfloat4 v1 = vload4(p + 4);
+	const vfloat4 v2 = vload4(p + 8);
+	x                = vshuffle<0, 3, 0, 2>(v0, vshuffle<2, 2, 1, 1>(v1, v2));
+	y                = vshuffle<0, 2, 0, 2>(vshuffle<1, 1, 0, 0>(v0, v1), vshuffle<3, 3, 2, 2>(v1, v2));
+	z                = vshuffle<0, 2, 0, 3>(vshuffle<2, 2, 1, 1>(v0, v1), v2);
+}
+
+//! \brief SoA の x, y, z を float3 x4 (12 float) に詰めてストアします
+inline void vstore_aos3(float* p, vfloat4 x, vfloat4 y, vfloat4 z) noexcept
+{
+	vstore4(p + 0, vshuffle<0, 2, 0, 2>(vshuffle<0, 0, 0, 0>(x, y), vshuffle<0, 0, 1, 1>(z, x)));
+	vstore4(p + 4, vshuffle<0, 2, 0, 2>(vshuffle<1, 1, 1, 1>(y, z), vshuffle<2, 2, 2, 2>(x, y)));
+	vstore4(p + 8, vshuffle<0, 2, 0, 2>(vshuffle<2, 2, 3, 3>(z, x), vshuffle<3, 3, 3, 3>(y, z)));
+}
+
+// --- 半精度/整数との変換 ---
+//
+// 頂点の量子化に使用します。整数への変換は最近接偶数丸めで、型の範囲に飽和します。
+
+#if defined(_ENABLE_SIMD_SSE)
+
+//! \brief 半精度 x4 をロードします
+inline vfloat4 vload_half4(const uint16_t* p) noexcept
+{
+	const __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+#if defined(_ENABLE_SIMD_F16C)
+	return _mm_cvtph_ps(h);
+#else
+	// half_to_float と同じ手順を 4 要素まとめて行います
+	const __m128i wide   = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+	const __m128i abs    = _mm_and_si128(wide, _mm_set1_epi32(0x7fff));
+	const __m128i sign   = _mm_slli_epi32(_mm_xor_si128(wide, abs), 16);
+	const __m128  scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(abs, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	const __m128i infnan = _mm_and_si128(_mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(255 << 23));
+	const __m128i quiet  = _mm_and_si128(_mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7c00)), _mm_set1_epi32(0x00400000));
+	return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, _mm_or_si128(infnan, quiet))));
+#endif
+}
+
+//! \brief 半精度 x4 に変換してストアします
+inline void vstore_half4(uint16_t* p, vfloat4 v) noexcept
+{
+#if defined(_ENABLE_SIMD_F16C)
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#else
+	// float_to_half と同じ手順を 4 要素まとめて行います
+	const __m128i magic   = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128  sign    = _mm_and_ps(v, _mm_set1_ps(-0.0f));
+	const __m128  absf    = _mm_xor_ps(v, sign);
+	const __m128i abs     = _mm_castps_si128(absf);
+	const __m128i is_nan  = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+	const __m128i is_reg  = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), abs);
+	const __m128i is_sub  = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), abs);
+	const __m128i payload = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(abs, 13), _mm_set1_epi32(0x3ff)), _mm_set1_epi32(0x200));
+	const __m128i special = _mm_or_si128(_mm_and_si128(is_nan, payload), _mm_set1_epi32(0x7c00));
+	const __m128i subnorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(magic))), magic);
+	const __m128i odd     = _mm_srai_epi32(_mm_slli_epi32(abs, 31 - 13), 31);
+	const __m128i normal  = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(abs, _mm_set1_epi32(static_cast<int>(0xc8000fffu))), odd), 13);
+	const __m128i finite  = _mm_or_si128(_mm_and_si128(is_sub, subnorm), _mm_andnot_si128(is_sub, normal));
+	const __m128i joined  = _mm_or_si128(_mm_and_si128(is_reg, finite), _mm_andnot_si128(is_reg, special));
+	const __m128i result  = _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(result, result));
+#endif
+}
+
+//! \brief int16 x4 をロードします
+inline vfloat4 vload_i16x4(const int16_t* p) noexcept
+{
+	const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+	return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+//! \brief int16 x4 に変換してストアします
+inline void vstore_i16x4(int16_t* p, vfloat4 v) noexcept
+{
+	const __m128i i = _mm_cvtps_epi32(v);
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(i, i));
+}
+
+//! \brief uint8 x4 をロードします
+inline vfloat4 vload_u8x4(const uint8_t* p) noexcept
+{
+	int32_t bits;
+	std::memcpy(&bits, p, sizeof(bits));
+	const __m128i zero = _mm_setzero_si128();
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero));
+}
+
+//! \brief uint8 x4 に変換してストアします
+inline void vstore_u8x4(uint8_t* p, vfloat4 v) noexcept
+{
+	const __m128i i    = _mm_cvtps_epi32(v);
+	const __m128i w    = _mm_packs_epi32(i, i);
+	const int32_t bits = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+	std::memcpy(p, &bits, sizeof(bits));
+}
+
+#elif defined(_ENABLE_SIMD_NEON)
+
+//! \brief 半精度 x4 をロードします
+inline vfloat4 vload_half4(const uint16_t* p) noexcept
+{
+	return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p)));
+}
+
+//! \brief 半精度 x4 に変換してストアします
+inline void vstore_half4(uint16_t* p, vfloat4 v) noexcept
+{
+	vst1_u16(p, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+}
+
+//! \brief int16 x4 をロードします
+inline vfloat4 vload_i16x4(const int16_t* p) noexcept
+{
+	return vcvtq_f32_s32(vmovl_s16(vld1_s16(p)));
+}
+
+//! \brief int16 x4 に変換してストアします
+inline void vstore_i16x4(int16_t* p, vfloat4 v) noexcept
+{
+	vst1_s16(p, vqmovn_s32(vcvtnq_s32_f32(v)));
+}
+
+//! \brief uint8 x4 をロードします
+inline vfloat4 vload_u8x4(const uint8_t* p) noexcept
+{
+	uint32_t bits;
+	std::memcpy(&bits, p, sizeof(bits));
+	const uint16x8_t w = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bits)));
+	return vcvtq_f32_u32(vmovl_u16(vget_low_u16(w)));
+}
+
+//! \brief uint8 x4 に変換してストアします
+inline void vstore_u8x4(uint8_t* p, vfloat4 v) noexcept
+{
+	const uint16x4_t w    = vqmovun_s32(vcvtnq_s32_f32(v));
+	const uint8x8_t  b    = vqmovn_u16(vcombine_u16(w, w));
+	const uint32_t   bits = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+	std::memcpy(p, &bits, sizeof(bits));
+}
+
+#else
+
+namespace detail {
+
+template<class T>
+inline T vconvert(float v, float lo, float hi) noexcept
+{
+	// NaN は lo になります
+	v = v >= lo ? (v <= hi ? v : hi) : lo;
+	return static_cast<T>(std::nearbyint(v));
+}
+
+} // namespace detail
+
+//! \brief 半精度 x4 をロードします
+inline vfloat4 vload_half4(const uint16_t* p) noexcept
+{
+	return { half_to_float(p[0]), half_to_float(p[1]), half_to_float(p[2]), half_to_float(p[3]) };
+}
+
+//! \brief 半精度 x4 に変換してストアします
+inline void vstore_half4(uint16_t* p, vfloat4 v) noexcept
+{
+	for (int i = 0; i < 4; ++i) {
+		p[i] = float_to_half(v.f[i]);
+	}
+}
+
+//! \brief int16 x4 をロードします
+inline vfloat4 vload_i16x4(const int16_t* p) noexcept
+{
+	return { float(p[0]), float(p[1]), float(p[2]), float(p[3]) };
+}
+
+//! \brief int16 x4 に変換してストアします
+inline void vstore_i16x4(int16_t* p, vfloat4 v) noexcept
+{
+	for (int i = 0; i < 4; ++i) {
+		p[i] = detail::vconvert<int16_t>(v.f[i], -32768.0f, 32767.0f);
+	}
+}
+
+//! \brief uint8 x4 をロードします
+inline vfloat4 vload_u8x4(const uint8_t* p) noexcept
+{
+	return { float(p[0]), float(p[1]), float(p[2]), float(p[3]) };
+}
+
+//! \brief uint8 x4 に変換してストアします
+inline void vstore_u8x4(uint8_t* p, vfloat4 v) noexcept
+{
+	for (int i = 0; i < 4; ++i) {
+		p[i] = detail::vconvert<uint8_t>(v.f[i], 0.0f, 255.0f);
+	}
+}
+
+#endif
+
+// --- 丸め/指数 ---
+//
+// 近似関数の範囲縮小に使用します。
+
+#if defined(_ENABLE_SIMD_SSE)
+
+//! \brief 最近接偶数に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat4 vround(vfloat4 v) noexcept
+{
+#if defined(__SSE4_1__) || defined(_ENABLE_SIMD_AVX)
+	return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+	return _mm_cvtepi32_ps(_mm_cvtps_epi32(v));
+#endif
+}
+
+//! \brief 整数値 n (-126 <= n <= 127) に対して 2^n を返します
+inline vfloat4 vpow2i(vfloat4 n) noexcept
+{
+	return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+}
+
+//! \brief 1 / sqrt(v) の推定値 (相対誤差 1.5 * 2^-12 以下)
+inline vfloat4 vrsqrt_est(vfloat4 v) noexcept
+{
+	return _mm_rsqrt_ps(v);
+}
+
+#elif defined(_ENABLE_SIMD_NEON)
+
+//! \brief 最近接偶数に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat4 vround(vfloat4 v) noexcept
+{
+	return vrndnq_f32(v);
+}
+
+//! \brief 整数値 n (-126 <= n <= 127) に対して 2^n を返します
+inline vfloat4 vpow2i(vfloat4 n) noexcept
+{
+	return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtnq_s32_f32(n), vdupq_n_s32(127)), 23));
+}
+
+//! \brief 1 / sqrt(v) の推定値 (相対誤差 1.5 * 2^-12 以下)
+inline vfloat4 vrsqrt_est(vfloat4 v) noexcept
+{
+	// vrsqrteq は 8 ビット程度なので、1 回だけ補正して SSE と精度を揃えます
+	const float32x4_t e = vrsqrteq_f32(v);
+	return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+}
+
+#else
+
+//! \brief 最近接偶数に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat4 vround(vfloat4 v) noexcept
+{
+	return { std::nearbyint(v.f[0]), std::nearbyint(v.f[1]), std::nearbyint(v.f[2]), std::nearbyint(v.f[3]) };
+}
+
+//! \brief 整数値 n (-126 <= n <= 127) に対して 2^n を返します
+inline vfloat4 vpow2i(vfloat4 n) noexcept
+{
+	vfloat4 r;
+	for (int i = 0; i < 4; ++i) {
+		r.f[i] = detail::vbits(static_cast<uint32_t>(static_cast<int32_t>(n.f[i]) + 127) << 23);
+	}
+	return r;
+}
+
+//! \brief 1 / sqrt(v) の推定値 (相対誤差 1.5 * 2^-12 以下)
+inline vfloat4 vrsqrt_est(vfloat4 v) noexcept
+{
+	return vrsqrt(v);
+}
+
+#endif
+
+//! \brief 負の無限大方向に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat4 vfloor(vfloat4 v) noexcept
+{
+	const vfloat4 r = vround(v);
+	return vsub(r, vand(vcmplt(v, r), vsplat4(1.0f)));
+}
+
+// --- vint4 ---
+//
+// 乱数やハッシュ用の 32 ビット整数 x4 です。各要素は uint32_t として扱います。
+
+#if defined(_ENABLE_SIMD_SSE)
+
+inline vint4 vsplat4i(uint32_t v) noexcept
+{
+	return _mm_set1_epi32(static_cast<int>(v));
+}
+
+inline vint4 vset4i(uint32_t x, uint32_t y, uint32_t z, uint32_t w) noexcept
+{
+	return _mm_setr_epi32(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z), static_cast<int>(w));
+}
+
+inline vint4 vload4i(const uint32_t* p) noexcept
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void vstore4i(uint32_t* p, vint4 v) noexcept
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+inline vint4 vadd(vint4 a, vint4 b) noexcept
+{
+	return _mm_add_epi32(a, b);
+}
+
+inline vint4 vsub(vint4 a, vint4 b) noexcept
+{
+	return _mm_sub_epi32(a, b);
+}
+
+inline vint4 vand(vint4 a, vint4 b) noexcept
+{
+	return _mm_and_si128(a, b);
+}
+
+inline vint4 vor(vint4 a, vint4 b) noexcept
+{
+	return _mm_or_si128(a, b);
+}
+
+inline vint4 vxor(vint4 a, vint4 b) noexcept
+{
+	return _mm_xor_si128(a, b);
+}
+
+//! \brief 論理左シフト
+template<int N>
+inline vint4 vsll(vint4 v) noexcept
+{
+	return _mm_slli_epi32(v, N);
+}
+
+//! \brief 論理右シフト
+template<int N>
+inline vint4 vsrl(vint4 v) noexcept
+{
+	return _mm_srli_epi32(v, N);
+}
+
+//! \brief 算術右シフト
+template<int N>
+inline vint4 vsra(vint4 v) noexcept
+{
+	return _mm_srai_epi32(v, N);
+}
+
+//! \brief a * b の下位 32 ビット
+inline vint4 vmullo(vint4 a, vint4 b) noexcept
+{
+#if defined(__SSE4_1__) || defined(_ENABLE_SIMD_AVX)
+	return _mm_mullo_epi32(a, b);
+#else
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+//! \brief a * b (符号なし 64 ビット) を上位/下位 32 ビットに分けて返します
+inline void vmulhilo(vint4 a, vint4 b, vint4& hi, vint4& lo) noexcept
+{
+	// 偶数/奇数要素の 64 ビット積から上位と下位を集めます
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	lo                 = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	hi                 = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+//! \brief 0 方向に丸めて int32 に変換します (int32 の範囲で有効)
+inline vint4 vcvt_i32(vfloat4 v) noexcept
+{
+	return _mm_cvttps_epi32(v);
+}
+
+//! \brief 各要素を int32 とみなして float に変換します
+inline vfloat4 vcvt_f32(vint4 v) noexcept
+{
+	return _mm_cvtepi32_ps(v);
+}
+
+//! \brief ビット列をそのまま整数として扱います
+inline vint4 vcast_i32(vfloat4 v) noexcept
+{
+	return _mm_castps_si128(v);
+}
+
+//! \brief ビット列をそのまま float として扱います
+inline vfloat4 vcast_f32(vint4 v) noexcept
+{
+	return _mm_castsi128_ps(v);
+}
+
+#elif defined(_ENABLE_SIMD_NEON)
+
+inline vint4 vsplat4i(uint32_t v) noexcept
+{
+	return vdupq_n_u32(v);
+}
+
+inline vint4 vset4i(uint32_t x, uint32_t y, uint32_t z, uint32_t w) noexcept
+{
+	const uint32_t v[4] = { x, y, z, w };
+	return vld1q_u32(v);
+}
+
+inline vint4 vload4i(const uint32_t* p) noexcept
+{
+	return vld1q_u32(p);
+}
+
+inline void vstore4i(uint32_t* p, vint4 v) noexcept
+{
+	vst1q_u32(p, v);
+}
+
+inline vint4 vadd(vint4 a, vint4 b) noexcept
+{
+	return vaddq_u32(a, b);
+}
+
+inline vint4 vsub(vint4 a, vint4 b) noexcept
+{
+	return vsubq_u32(a, b);
+}
+
+inline vint4 vand(vint4 a, vint4 b) noexcept
+{
+	return vandq_u32(a, b);
+}
+
+inline vint4 vor(vint4 a, vint4 b) noexcept
+{
+	return vorrq_u32(a, b);
+}
+
+inline vint4 vxor(vint4 a, vint4 b) noexcept
+{
+	return veorq_u32(a, b);
+}
+
+//! \brief 論理左シフト
+template<int N>
+inline vint4 vsll(vint4 v) noexcept
+{
+	return vshlq_n_u32(v, N);
+}
+
+//! \brief 論理右シフト
+template<int N>
+inline vint4 vsrl(vint4 v) noexcept
+{
+	return vshrq_n_u32(v, N);
+}
+
+//! \brief 算術右シフト
+template<int N>
+inline vint4 vsra(vint4 v) noexcept
+{
+	return vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(v), N));
+}
+
+//! \brief a * b の下位 32 ビット
+inline vint4 vmullo(vint4 a, vint4 b) noexcept
+{
+	return vmulq_u32(a, b);
+}
+
+//! \brief a * b (符号なし 64 ビット) を上位/下位 32 ビットに分けて返します
+inline void vmulhilo(vint4 a, vint4 b, vint4& hi, vint4& lo) noexcept
+{
+	const uint64x2_t p0 = vmull_u32(vget_low_u32(a), vget_low_u32(b));
+	const uint64x2_t p1 = vmull_high_u32(a, b);
+	hi                  = vuzp2q_u32(vreinterpretq_u32_u64(p0), vreinterpretq_u32_u64(p1));
+	lo                  = vmulq_u32(a, b);
+}
+
+//! \brief 0 方向に丸めて int32 に変換します (int32 の範囲で有効)
+inline vint4 vcvt_i32(vfloat4 v) noexcept
+{
+	return vreinterpretq_u32_s32(vcvtq_s32_f32(v));
+}
+
+//! \brief 各要素を int32 とみなして float に変換します
+inline vfloat4 vcvt_f32(vint4 v) noexcept
+{
+	return vcvtq_f32_s32(vreinterpretq_s32_u32(v));
+}
+
+//! \brief ビット列をそのまま整数として扱います
+inline vint4 vcast_i32(vfloat4 v) noexcept
+{
+	return vreinterpretq_u32_f32(v);
+}
+
+//! \brief ビット列をそのまま float として扱います
+inline vfloat4 vcast_f32(vint4 v) noexcept
+{
+	return vreinterpretq_f32_u32(v);
+}
+
+#else
+
+inline vint4 vsplat4i(uint32_t v) noexcept
+{
+	return { v, v, v, v };
+}
+
+inline vint4 vset4i(uint32_t x, uint32_t y, uint32_t z, uint32_t w) noexcept
+{
+	return { x, y, z, w };
+}
+
+inline vint4 vload4i(const uint32_t* p) noexcept
+{
+	return { p[0], p[1], p[2], p[3] };
+}
+
+inline void vstore4i(uint32_t* p, vint4 v) noexcept
+{
+	std::memcpy(p, v.i, sizeof(v.i));
+}
+
+inline vint4 vadd(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] + b.i[0], a.i[1] + b.i[1], a.i[2] + b.i[2], a.i[3] + b.i[3] };
+}
+
+inline vint4 vsub(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] - b.i[0], a.i[1] - b.i[1], a.i[2] - b.i[2], a.i[3] - b.i[3] };
+}
+
+inline vint4 vand(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] & b.i[0], a.i[1] & b.i[1], a.i[2] & b.i[2], a.i[3] & b.i[3] };
+}
+
+inline vint4 vor(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] | b.i[0], a.i[1] | b.i[1], a.i[2] | b.i[2], a.i[3] | b.i[3] };
+}
+
+inline vint4 vxor(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] ^ b.i[0], a.i[1] ^ b.i[1], a.i[2] ^ b.i[2], a.i[3] ^ b.i[3] };
+}
+
+//! \brief 論理左シフト
+template<int N>
+inline vint4 vsll(vint4 v) noexcept
+{
+	return { v.i[0] << N, v.i[1] << N, v.i[2] << N, v.i[3] << N };
+}
+
+//! \brief 論理右シフト
+template<int N>
+inline vint4 vsrl(vint4 v) noexcept
+{
+	return { v.i[0] >> N, v.i[1] >> N, v.i[2] >> N, v.i[3] >> N };
+}
+
+//! \brief 算術右シフト
+template<int N>
+inline vint4 vsra(vint4 v) noexcept
+{
+	vint4 r;
+	for (int k = 0; k < 4; ++k) {
+		r.i[k] = static_cast<uint32_t>(static_cast<int32_t>(v.i[k]) >> N);
+	}
+	return r;
+}
+
+//! \brief a * b の下位 32 ビット
+inline vint4 vmullo(vint4 a, vint4 b) noexcept
+{
+	return { a.i[0] * b.i[0], a.i[1] * b.i[1], a.i[2] * b.i[2], a.i[3] * b.i[3] };
+}
+
+//! \brief a * b (符号なし 64 ビット) を上位/下位 32 ビットに分けて返します
+inline void vmulhilo(vint4 a, vint4 b, vint4& hi, vint4& lo) noexcept
+{
+	for (int k = 0; k < 4; ++k) {
+		const uint64_t p = static_cast<uint64_t>(a.i[k]) * b.i[k];
+		hi.i[k]          = static_cast<uint32_t>(p >> 32);
+		lo.i[k]          = static_cast<uint32_t>(p);
+	}
+}
+
+//! \brief 0 方向に丸めて int32 に変換します (int32 の範囲で有効)
+inline vint4 vcvt_i32(vfloat4 v) noexcept
+{
+	vint4 r;
+	for (int k = 0; k < 4; ++k) {
+		r.i[k] = static_cast<uint32_t>(static_cast<int32_t>(v.f[k]));
+	}
+	return r;
+}
+
+//! \brief 各要素を int32 とみなして float に変換します
+inline vfloat4 vcvt_f32(vint4 v) noexcept
+{
+	vfloat4 r;
+	for (int k = 0; k < 4; ++k) {
+		r.f[k] = static_cast<float>(static_cast<int32_t>(v.i[k]));
+	}
+	return r;
+}
+
+//! \brief ビット列をそのまま整数として扱います
+inline vint4 vcast_i32(vfloat4 v) noexcept
+{
+	return { detail::vbits(v.f[0]), detail::vbits(v.f[1]), detail::vbits(v.f[2]), detail::vbits(v.f[3]) };
+}
+
+//! \brief ビット列をそのまま float として扱います
+inline vfloat4 vcast_f32(vint4 v) noexcept
+{
+	return { detail::vbits(v.i[0]), detail::vbits(v.i[1]), detail::vbits(v.i[2]), detail::vbits(v.i[3]) };
+}
+
+#endif
+
+// --- vfloat8 ---
+
+#if defined(_ENABLE_SIMD_AVX)
+
+inline vfloat8 vzero8() noexcept
+{
+	return _mm256_setzero_ps();
+}
+
+inline vfloat8 vsplat8(float v) noexcept
+{
+	return _mm256_set1_ps(v);
+}
+
+inline vfloat8 vload8(const float* p) noexcept
+{
+	return _mm256_loadu_ps(p);
+}
+
+inline vfloat8 vload8a(const float* p) noexcept
+{
+	return _mm256_load_ps(p);
+}
+
+inline void vstore8(float* p, vfloat8 v) noexcept
+{
+	_mm256_storeu_ps(p, v);
+}
+
+inline void vstore8a(float* p, vfloat8 v) noexcept
+{
+	_mm256_store_ps(p, v);
+}
+
+inline vfloat8 vadd(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_add_ps(a, b);
+}
+
+inline vfloat8 vsub(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_sub_ps(a, b);
+}
+
+inline vfloat8 vmul(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_mul_ps(a, b);
+}
+
+inline vfloat8 vdiv(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_div_ps(a, b);
+}
+
+//! \brief a * b + c
+inline vfloat8 vmadd(vfloat8 a, vfloat8 b, vfloat8 c) noexcept
+{
+#if defined(_ENABLE_SIMD_FMA)
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+//! \brief c - a * b
+inline vfloat8 vnmadd(vfloat8 a, vfloat8 b, vfloat8 c) noexcept
+{
+#if defined(_ENABLE_SIMD_FMA)
+	return _mm256_fnmadd_ps(a, b, c);
+#else
+	return _mm256_sub_ps(c, _mm256_mul_ps(a, b));
+#endif
+}
+
+inline vfloat8 vmin(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_min_ps(a, b);
+}
+
+inline vfloat8 vmax(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_max_ps(a, b);
+}
+
+inline vfloat8 vsqrt(vfloat8 v) noexcept
+{
+	return _mm256_sqrt_ps(v);
+}
+
+inline vfloat8 vneg(vfloat8 v) noexcept
+{
+	return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f));
+}
+
+inline vfloat8 vabs(vfloat8 v) noexcept
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+inline vfloat8 vand(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_and_ps(a, b);
+}
+
+inline vfloat8 vor(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_or_ps(a, b);
+}
+
+inline vfloat8 vxor(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_xor_ps(a, b);
+}
+
+inline vfloat8 vcmplt(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+
+inline vfloat8 vcmpge(vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+}
+
+//! \brief mask が立っている要素は a、それ以外は b を選択します
+inline vfloat8 vselect(vfloat8 mask, vfloat8 a, vfloat8 b) noexcept
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+//! \brief 各要素の符号ビットを下位ビットから詰めて返します
+inline int vmask(vfloat8 v) noexcept
+{
+	return _mm256_movemask_ps(v);
+}
+
+//! \brief 全要素の総和
+inline float vhsum(vfloat8 v) noexcept
+{
+	return vhsum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+//! \brief 最近接偶数に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat8 vround(vfloat8 v) noexcept
+{
+	return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+//! \brief 整数値 n (-126 <= n <= 127) に対して 2^n を返します
+inline vfloat8 vpow2i(vfloat8 n) noexcept
+{
+#if defined(__AVX2__)
+	return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+#else
+	// AVX には 256 ビットの整数演算が無いので 128 ビットずつ処理します
+	return _mm256_set_m128(vpow2i(_mm256_extractf128_ps(n, 1)), vpow2i(_mm256_castps256_ps128(n)));
+#endif
+}
+
+//! \brief 1 / sqrt(v) の推定値 (相対誤差 1.5 * 2^-12 以下)
+inline vfloat8 vrsqrt_est(vfloat8 v) noexcept
+{
+	return _mm256_rsqrt_ps(v);
+}
+
+#else
+
+inline vfloat8 vzero8() noexcept
+{
+	return { vzero4(), vzero4() };
+}
+
+inline vfloat8 vsplat8(float v) noexcept
+{
+	return { vsplat4(v), vsplat4(v) };
+}
+
+inline vfloat8 vload8(const float* p) noexcept
+{
+	return { vload4(p), vload4(p + 4) };
+}
+
+inline vfloat8 vload8a(const float* p) noexcept
+{
+	return { vload4a(p), vload4a(p + 4) };
+}
+
+inline void vstore8(float* p, vfloat8 v) noexcept
+{
+	vstore4(p, v.lo);
+	vstore4(p + 4, v.hi);
+}
+
+inline void vstore8a(float* p, vfloat8 v) noexcept
+{
+	vstore4a(p, v.lo);
+	vstore4a(p + 4, v.hi);
+}
+
+inline vfloat8 vadd(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vadd(a.lo, b.lo), vadd(a.hi, b.hi) };
+}
+
+inline vfloat8 vsub(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vsub(a.lo, b.lo), vsub(a.hi, b.hi) };
+}
+
+inline vfloat8 vmul(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vmul(a.lo, b.lo), vmul(a.hi, b.hi) };
+}
+
+inline vfloat8 vdiv(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vdiv(a.lo, b.lo), vdiv(a.hi, b.hi) };
+}
+
+//! \brief a * b + c
+inline vfloat8 vmadd(vfloat8 a, vfloat8 b, vfloat8 c) noexcept
+{
+	return { vmadd(a.lo, b.lo, c.lo), vmadd(a.hi, b.hi, c.hi) };
+}
+
+//! \brief c - a * b
+inline vfloat8 vnmadd(vfloat8 a, vfloat8 b, vfloat8 c) noexcept
+{
+	return { vnmadd(a.lo, b.lo, c.lo), vnmadd(a.hi, b.hi, c.hi) };
+}
+
+inline vfloat8 vmin(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vmin(a.lo, b.lo), vmin(a.hi, b.hi) };
+}
+
+inline vfloat8 vmax(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vmax(a.lo, b.lo), vmax(a.hi, b.hi) };
+}
+
+inline vfloat8 vsqrt(vfloat8 v) noexcept
+{
+	return { vsqrt(v.lo), vsqrt(v.hi) };
+}
+
+inline vfloat8 vneg(vfloat8 v) noexcept
+{
+	return { vneg(v.lo), vneg(v.hi) };
+}
+
+inline vfloat8 vabs(vfloat8 v) noexcept
+{
+	return { vabs(v.lo), vabs(v.hi) };
+}
+
+inline vfloat8 vand(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vand(a.lo, b.lo), vand(a.hi, b.hi) };
+}
+
+inline vfloat8 vor(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vor(a.lo, b.lo), vor(a.hi, b.hi) };
+}
+
+inline vfloat8 vxor(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vxor(a.lo, b.lo), vxor(a.hi, b.hi) };
+}
+
+inline vfloat8 vcmplt(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vcmplt(a.lo, b.lo), vcmplt(a.hi, b.hi) };
+}
+
+inline vfloat8 vcmpge(vfloat8 a, vfloat8 b) noexcept
+{
+	return { vcmpge(a.lo, b.lo), vcmpge(a.hi, b.hi) };
+}
+
+//! \brief mask が立っている要素は a、それ以外は b を選択します
+inline vfloat8 vselect(vfloat8 mask, vfloat8 a, vfloat8 b) noexcept
+{
+	return { vselect(mask.lo, a.lo, b.lo), vselect(mask.hi, a.hi, b.hi) };
+}
+
+//! \brief 各要素の符号ビットを下位ビットから詰めて返します
+inline int vmask(vfloat8 v) noexcept
+{
+	return vmask(v.lo) | (vmask(v.hi) << 4);
+}
+
+//! \brief 全要素の総和
+inline float vhsum(vfloat8 v) noexcept
+{
+	return vhsum(vadd(v.lo, v.hi));
+}
+
+//! \brief 最近接偶数に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat8 vround(vfloat8 v) noexcept
+{
+	return { vround(v.lo), vround(v.hi) };
+}
+
+//! \brief 整数値 n (-126 <= n <= 127) に対して 2^n を返します
+inline vfloat8 vpow2i(vfloat8 n) noexcept
+{
+	return { vpow2i(n.lo), vpow2i(n.hi) };
+}
+
+//! \brief 1 / sqrt(v) の推定値 (相対誤差 1.5 * 2^-12 以下)
+inline vfloat8 vrsqrt_est(vfloat8 v) noexcept
+{
+	return { vrsqrt_est(v.lo), vrsqrt_est(v.hi) };
+}
+
+#endif
+
+//! \brief 1 / sqrt(v)
+inline vfloat8 vrsqrt(vfloat8 v) noexcept
+{
+	return vdiv(vsplat8(1.0f), vsqrt(v));
+}
+
+//! \brief 負の無限大方向に丸めます (|v| < 2^31 の範囲で有効)
+inline vfloat8 vfloor(vfloat8 v) noexcept
+{
+	const vfloat8 r = vround(v);
+	return vsub(r, vand(vcmplt(v, r), vsplat8(1.0f)));
+}
+
+} // namespace simd
+} // namespace math
+} // namespace dxlib
@@ -0,0 +1,512 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.h"
+#include "bounds.h"
+#include "debug.h"
+#include "light.h"
+#include "simd.h"
+#include "vertex.h"
+
+namespace dxlib {
+namespace container {
+
+//! \brief soa_vector に格納する構造体のフィールド定義
+//!
+//! fields にメンバポインタのタプルを定義して特殊化します。
+//! フィールドの型は float / float2 / float3 / float4 のいずれかです。
+template<class T>
+struct soa_traits;
+
+namespace detail {
+
+template<class M>
+struct member_type;
+
+template<class C, class F>
+struct member_type<F C::*>
+{
+	using type = F;
+};
+
+template<class F>
+struct soa_field_traits;
+
+template<>
+struct soa_field_traits<float>
+{
+	static constexpr size_t components = 1;
+};
+
+template<>
+struct soa_field_traits<float2>
+{
+	static constexpr size_t components = 2;
+};
+
+template<>
+struct soa_field_traits<float3>
+{
+	static constexpr size_t components = 3;
+};
+
+template<>
+struct soa_field_traits<float4>
+{
+	static constexpr size_t components = 4;
+};
+
+template<class T>
+using soa_fields_t = std::remove_cvref_t<decltype(soa_traits<T>::fields)>;
+
+template<class T, size_t I>
+using soa_field_t = typename member_type<std::tuple_element_t<I, soa_fields_t<T>>>::type;
+
+template<class T, size_t I>
+inline constexpr size_t soa_field_components = soa_field_traits<soa_field_t<T, I>>::components;
+
+template<class T, size_t... I>
+constexpr std::array<size_t, sizeof...(I) + 1> soa_plane_offsets(std::index_sequence<I...>) noexcept
+{
+	std::array<size_t, sizeof...(I) + 1> offsets = {};
+	const size_t                          comps[] = { soa_field_components<T, I>... };
+	for (size_t i = 0; i < sizeof...(I); ++i) {
+		offsets[i + 1] = offsets[i] + comps[i];
+	}
+	return offsets;
+}
+
+} // namespace detail
+
+//! \brief 構造体をフィールドの成分ごとの配列 (プレーン) に分割して保持するコンテナ
+//!
+//! 例えば point_light は position.x / position.y / ... / range の 8 本の float 配列になります。
+//! 各プレーンは simd::alignment に揃えられ、要素数は Block の倍数まで 0 で埋められるため、
+//! カリングやライティングのループは読むフィールドのプレーンだけを端数処理なしで SIMD ロードできます。
+//! GPU に渡す際は gather でインターリーブされた元の構造体配列に戻します。
+template<class T, size_t Block = math::simd::vfloat8_width>
+class soa_vector
+{
+	using fields_type = detail::soa_fields_t<T>;
+	using plane_type  = aligned_vector<float, math::simd::alignment>;
+
+	static_assert(sizeof(T) % sizeof(float) == 0);
+	static constexpr size_t stride = sizeof(T) / sizeof(float);
+
+public:
+	using value_type = T;
+
+	//! \brief SIMD ループの 1 ブロックの要素数
+	static constexpr size_t block_size = Block;
+
+	//! \brief フィールド数
+	static constexpr size_t field_count = std::tuple_size_v<fields_type>;
+
+	//! \brief フィールドごとの先頭プレーン番号
+	static constexpr auto plane_offsets = detail::soa_plane_offsets<T>(std::make_index_sequence<field_count>());
+
+	//! \brief プレーン数 (全フィールドの成分数の合計)
+	static constexpr size_t plane_count = plane_offsets[field_count];
+
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type        = T;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = void;
+		using reference         = T;
+
+		const_iterator() = default;
+
+		const_iterator(const soa_vector* owner, size_t index) noexcept
+		    : m_owner(owner)
+		    , m_index(index)
+		{
+		}
+
+		[[nodiscard]] T operator*() const noexcept
+		{
+			return m_owner->get(m_index);
+		}
+
+		const_iterator& operator++() noexcept
+		{
+			++m_index;
+			return *this;
+		}
+
+		const_iterator operator++(int) noexcept
+		{
+			const_iterator it = *this;
+			++m_index;
+			return it;
+		}
+
+		[[nodiscard]] bool operator==(const const_iterator& it) const noexcept
+		{
+			return m_index == it.m_index;
+		}
+
+	private:
+		const soa_vector* m_owner = nullptr;
+		size_t            m_index = 0;
+	};
+
+	soa_vector() = default;
+
+	explicit soa_vector(std::span<const T> values)
+	{
+		assign(values);
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+
+	//! \brief Block 単位に切り上げた要素数 (プレーンの実長)
+	[[nodiscard]] size_t padded_size() const noexcept
+	{
+		return round_up(m_size);
+	}
+
+	//! \brief SIMD ループのブロック数
+	[[nodiscard]] size_t block_count() const noexcept
+	{
+		return round_up(m_size) / Block;
+	}
+
+	void reserve(size_t n)
+	{
+		for (auto& plane : m_planes) {
+			plane.reserve(round_up(n));
+		}
+	}
+
+	void resize(size_t n)
+	{
+		for (auto& plane : m_planes) {
+			plane.resize(round_up(n), 0.0f);
+			// 縮小時はパディング部分を 0 に戻す
+			std::fill(plane.begin() + n, plane.end(), 0.0f);
+		}
+		m_size = n;
+	}
+
+	void clear() noexcept
+	{
+		for (auto& plane : m_planes) {
+			plane.clear();
+		}
+		m_size = 0;
+	}
+
+	void push_back(const T& value)
+	{
+		if (m_size == padded_size()) {
+			for (auto& plane : m_planes) {
+				plane.resize(m_size + Block, 0.0f);
+			}
+		}
+		set(m_size++, value);
+	}
+
+	//! \brief i 番目の要素を構造体として取り出します
+	[[nodiscard]] T get(size_t i) const noexcept
+	{
+		const auto& offsets = component_offsets();
+		T           value   = {};
+		float*      dst     = reinterpret_cast<float*>(&value);
+		for (size_t p = 0; p < plane_count; ++p) {
+			dst[offsets[p]] = m_planes[p][i];
+		}
+		return value;
+	}
+
+	//! \brief i 番目の要素を書き換えます
+	void set(size_t i, const T& value) noexcept
+	{
+		const auto&  offsets = component_offsets();
+		const float* src     = reinterpret_cast<const float*>(&value);
+		for (size_t p = 0; p < plane_count; ++p) {
+			m_planes[p][i] = src[offsets[p]];
+		}
+	}
+
+	//! \brief フィールド Field の成分 Component のプレーン
+	//!
+	//! 長さは padded_size() で、先頭は simd::alignment に揃っています。
+	template<size_t Field, size_t Component = 0>
+	[[nodiscard]] std::span<float> plane() noexcept
+	{
+		static_assert(Component < detail::soa_field_components<T, Field>);
+		return m_planes[plane_offsets[Field] + Component];
+	}
+
+	template<size_t Field, size_t Component = 0>
+	[[nodiscard]] std::span<const float> plane() const noexcept
+	{
+		static_assert(Component < detail::soa_field_components<T, Field>);
+		return m_planes[plane_offsets[Field] + Component];
+	}
+
+	//! \brief 構造体配列から全要素を置き換えます
+	void assign(std::span<const T> values)
+	{
+		resize(values.size());
+
+		const auto&  offsets = component_offsets();
+		const float* src     = reinterpret_cast<const float*>(values.data());
+		for (size_t p = 0; p < plane_count; ++p) {
+			float* dst = m_planes[p].data();
+			for (size_t i = 0; i < values.size(); ++i) {
+				dst[i] = src[i * stride + offsets[p]];
+			}
+		}
+	}
+
+	//! \brief 全要素を GPU 向けのインターリーブされた構造体配列に書き戻します
+	void gather(std::span<T> out) const noexcept
+	{
+		ASSERT_RETURN(out.size() >= m_size);
+
+		const auto& offsets = component_offsets();
+		float*      dst     = reinterpret_cast<float*>(out.data());
+		for (size_t p = 0; p < plane_count; ++p) {
+			const float* src = m_planes[p].data();
+			for (size_t i = 0; i < m_size; ++i) {
+				dst[i * stride + offsets[p]] = src[i];
+			}
+		}
+	}
+
+	//! \brief indices で指定した要素だけを構造体配列に詰めて書き出します
+	//!
+	//! カリング結果の可視インデックスから GPU 用のライト配列を作る用途を想定しています。
+	void gather(std::span<const uint32_t> indices, std::span<T> out) const noexcept
+	{
+		ASSERT_RETURN(out.size() >= indices.size());
+
+		const auto& offsets = component_offsets();
+		float*      dst     = reinterpret_cast<float*>(out.data());
+		for (size_t p = 0; p < plane_count; ++p) {
+			const float* src = m_planes[p].data();
+			for (size_t i = 0; i < indices.size(); ++i) {
+				dst[i * stride + offsets[p]] = src[indices[i]];
+			}
+		}
+	}
+
+	[[nodiscard]] const_iterator begin() const noexcept
+	{
+		return const_iterator(this, 0);
+	}
+
+	[[nodiscard]] const_iterator end() const noexcept
+	{
+		return const_iterator(this, m_size);
+	}
+
+private:
+	static constexpr size_t round_up(size_t n) noexcept
+	{
+		return (n + Block - 1) / Block * Block;
+	}
+
+	template<size_t F>
+	static size_t field_offset(const T& value) noexcept
+	{
+		const auto* field = &(value.*std::get<F>(soa_traits<T>::fields));
+		return static_cast<size_t>(reinterpret_cast<const float*>(field) - reinterpret_cast<const float*>(&value));
+	}
+
+	template<size_t... F>
+	static std::array<size_t, plane_count> make_component_offsets(std::index_sequence<F...>) noexcept
+	{
+		const T      value  = {};
+		const size_t base[] = { field_offset<F>(value)... };
+
+		std::array<size_t, plane_count> offsets = {};
+		for (size_t f = 0; f < field_count; ++f) {
+			for (size_t p = plane_offsets[f]; p < plane_offsets[f + 1]; ++p) {
+				offsets[p] = base[f] + (p - plane_offsets[f]);
+			}
+		}
+		return offsets;
+	}
+
+	//! \brief プレーンごとの構造体先頭からの float オフセット
+	static const std::array<size_t, plane_count>& component_offsets() noexcept
+	{
+		static const auto offsets = make_component_offsets(std::make_index_sequence<field_count>());
+		return offsets;
+	}
+
+private:
+	std::array<plane_type, plane_count> m_planes;
+	size_t                              m_size = 0;
+};
+
+// --- geometry ---
+
+template<>
+struct soa_traits<geometry::vertex_p>
+{
+	enum : size_t
+	{
+		position,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_p::position);
+};
+
+template<>
+struct soa_traits<geometry::vertex_pc>
+{
+	enum : size_t
+	{
+		position,
+		color,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_pc::position, &geometry::vertex_pc::color);
+};
+
+template<>
+struct soa_traits<geometry::vertex_pu>
+{
+	enum : size_t
+	{
+		position,
+		uv,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_pu::position, &geometry::vertex_pu::uv);
+};
+
+template<>
+struct soa_traits<geometry::vertex_puc>
+{
+	enum : size_t
+	{
+		position,
+		uv,
+		color,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_puc::position, &geometry::vertex_puc::uv, &geometry::vertex_puc::color);
+};
+
+template<>
+struct soa_traits<geometry::vertex_pn>
+{
+	enum : size_t
+	{
+		position,
+		normal,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_pn::position, &geometry::vertex_pn::normal);
+};
+
+template<>
+struct soa_traits<geometry::vertex_pnu>
+{
+	enum : size_t
+	{
+		position,
+		normal,
+		uv,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_pnu::position, &geometry::vertex_pnu::normal, &geometry::vertex_pnu::uv);
+};
+
+template<>
+struct soa_traits<geometry::vertex_pntu>
+{
+	enum : size_t
+	{
+		position,
+		normal,
+		tangent,
+		uv,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::vertex_pntu::position, &geometry::vertex_pntu::normal, &geometry::vertex_pntu::tangent, &geometry::vertex_pntu::uv);
+};
+
+template<>
+struct soa_traits<geometry::bounding_sphere>
+{
+	enum : size_t
+	{
+		center,
+		radius,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::bounding_sphere::center, &geometry::bounding_sphere::radius);
+};
+
+template<>
+struct soa_traits<geometry::bounding_box>
+{
+	enum : size_t
+	{
+		min,
+		max,
+	};
+	static constexpr auto fields = std::make_tuple(&geometry::bounding_box::min, &geometry::bounding_box::max);
+};
+
+// --- scene ---
+
+template<>
+struct soa_traits<scene::directional_light>
+{
+	enum : size_t
+	{
+		direction,
+		intensity,
+		color,
+	};
+	static constexpr auto fields = std::make_tuple(&scene::directional_light::direction, &scene::directional_light::intensity, &scene::directional_light::color);
+};
+
+template<>
+struct soa_traits<scene::point_light>
+{
+	enum : size_t
+	{
+		position,
+		intensity,
+		color,
+		range,
+	};
+	static constexpr auto fields = std::make_tuple(&scene::point_light::position, &scene::point_light::intensity, &scene::point_light::color, &scene::point_light::range);
+};
+
+template<>
+struct soa_traits<scene::spot_light>
+{
+	enum : size_t
+	{
+		position,
+		intensity,
+		direction,
+		angle,
+		color,
+		range,
+	};
+	static constexpr auto fields = std::make_tuple(&scene::spot_light::position, &scene::spot_light::intensity, &scene::spot_light::direction, &scene::spot_light::angle, &scene::spot_light::color, &scene::spot_light::range);
+};
+
+} // namespace container
+} // namespace dxlib
@@ -1,247 +1,206 @@
 ﻿#pragma once
 
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include "vertex.h"
+#include "vertex_layout.h"
 
 namespace dxlib {
 namespace geometry {
 
-struct static_mesh_quad_p
+//! \brief 頂点数から選ぶインデックスの型 (65536 頂点以下は 16 ビット)
+template<size_t NV>
+using static_mesh_index_t = std::conditional_t<(NV <= 65536), uint16_t, uint32_t>;
+
+//! \brief コンパイル時に内容が決まるメッシュ
+//!
+//! 頂点とインデックスを std::array で保持します。
+//! inline constexpr の変数として定義すると読み取り専用データに配置され、起動時の確保や構築は行われません。
+//! vertices.data() から vertex_size バイトをそのまま upload バッファにコピーできます。
+//!
+//! \tparam Vertex 頂点フォーマット
+//! \tparam NV     頂点数
+//! \tparam NI     インデックス数
+template<class Vertex, size_t NV, size_t NI>
+struct static_mesh
 {
-	constexpr static_mesh_quad_p()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_p) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
-	}
+	static_assert(std::is_trivially_copyable_v<Vertex>);
 
-	std::vector<vertex_p> vertices;
-	std::vector<uint16_t> indices;
-	uint32_t              vertex_size;
-	uint32_t              index_size;
-};
+	using vertex_type = Vertex;
+	using index_type  = static_mesh_index_t<NV>;
 
-struct static_mesh_quad_pc
-{
-	constexpr static_mesh_quad_pc()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f), float4(1.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f), float4(1.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f), float4(1.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f), float4(1.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_pc) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
-	}
+	static constexpr uint32_t vertex_count = static_cast<uint32_t>(NV);
+	static constexpr uint32_t index_count  = static_cast<uint32_t>(NI);
+	static constexpr uint32_t vertex_size  = static_cast<uint32_t>(sizeof(Vertex) * NV);
+	static constexpr uint32_t index_size   = static_cast<uint32_t>(sizeof(index_type) * NI);
 
-	std::vector<vertex_pc> vertices;
-	std::vector<uint16_t>  indices;
-	uint32_t               vertex_size;
-	uint32_t               index_size;
+	std::array<Vertex, NV>     vertices;
+	std::array<index_type, NI> indices;
 };
 
-struct static_mesh_quad_pu
+//! \brief 位置と位置以外の要素を別々の配列に分けたコンパイル時のメッシュ
+//!
+//! positions はスロット 0、attributes はスロット 1 にそのままコピーできます (vertex_streams::split_position)。
+//! attributes の各頂点は Vertex の位置以外の要素を同じ順に並べた float の配列です。
+//!
+//! \tparam Vertex 頂点フォーマット (float の要素のみ)
+//! \tparam NV     頂点数
+//! \tparam NI     インデックス数
+template<class Vertex, size_t NV, size_t NI>
+struct static_split_mesh
 {
-	constexpr static_mesh_quad_pu()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f), float2(0.0f, 0.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f), float2(1.0f, 0.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f), float2(0.0f, 1.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f), float2(1.0f, 1.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_pu) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
-	}
-
-	std::vector<vertex_pu> vertices;
-	std::vector<uint16_t>  indices;
-	uint32_t               vertex_size;
-	uint32_t               index_size;
+	static_assert(sizeof(Vertex) > sizeof(float3) && sizeof(Vertex) % sizeof(float) == 0);
+
+	using vertex_type    = Vertex;
+	using index_type     = static_mesh_index_t<NV>;
+	using attribute_type = std::array<float, (sizeof(Vertex) - sizeof(float3)) / sizeof(float)>;
+
+	static constexpr uint32_t vertex_count     = static_cast<uint32_t>(NV);
+	static constexpr uint32_t index_count      = static_cast<uint32_t>(NI);
+	static constexpr uint32_t position_stride  = static_cast<uint32_t>(sizeof(float3));
+	static constexpr uint32_t attribute_stride = static_cast<uint32_t>(sizeof(attribute_type));
+	static constexpr uint32_t position_size    = position_stride * vertex_count;
+	static constexpr uint32_t attribute_size   = attribute_stride * vertex_count;
+	static constexpr uint32_t index_size       = static_cast<uint32_t>(sizeof(index_type) * NI);
+
+	std::array<float3, NV>         positions;
+	std::array<attribute_type, NV> attributes;
+	std::array<index_type, NI>     indices;
 };
 
-struct static_mesh_quad_puc
-{
-	constexpr static_mesh_quad_puc()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f), float2(0.0f, 0.0f), float4(1.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f), float2(1.0f, 0.0f), float4(1.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f), float2(0.0f, 1.0f), float4(1.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f), float2(1.0f, 1.0f), float4(1.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_puc) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
-	}
+namespace detail {
 
-	std::vector<vertex_puc> vertices;
-	std::vector<uint16_t>   indices;
-	uint32_t                vertex_size;
-	uint32_t                index_size;
+// 面の 4 頂点 (UV の左上, 右上, 左下, 右下) と法線
+// 三角形は (0, 1, 2), (1, 3, 2) で、flip の場合は (0, 2, 1), (1, 2, 3) です
+struct static_mesh_face
+{
+	float3 positions[4];
+	float3 normal;
+	bool   flip;
 };
 
-struct static_mesh_quad_pn
+template<class Vertex>
+constexpr Vertex make_static_mesh_vertex(const float3& position, const float3& normal, const float2& uv) noexcept
 {
-	constexpr static_mesh_quad_pn()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_pn) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
+	Vertex v {};
+	v.position = position;
+	if constexpr (has_semantic<Vertex>(vertex_semantic::normal)) {
+		v.normal = normal;
 	}
+	if constexpr (has_semantic<Vertex>(vertex_semantic::texcoord)) {
+		v.uv = uv;
+	}
+	if constexpr (has_semantic<Vertex>(vertex_semantic::color)) {
+		v.color = float4(1.0f);
+	}
+	return v;
+}
 
-	std::vector<vertex_pn> vertices;
-	std::vector<uint16_t>  indices;
-	uint32_t               vertex_size;
-	uint32_t               index_size;
-};
-
-struct static_mesh_quad_pnu
+template<class Vertex, size_t NF>
+constexpr static_mesh<Vertex, NF * 4, NF * 6> make_static_mesh(const std::array<static_mesh_face, NF>& faces) noexcept
 {
-	constexpr static_mesh_quad_pnu()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f), float2(0.0f, 0.0f) });
-		vertices.push_back({ float3(+0.5f, +0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f), float2(1.0f, 0.0f) });
-		vertices.push_back({ float3(-0.5f, -0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f), float2(0.0f, 1.0f) });
-		vertices.push_back({ float3(+0.5f, -0.5f, 0.0f), float3(0.0f, 0.0f, -1.0f), float2(1.0f, 1.0f) });
-
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(1);
-		indices.push_back(3);
-		indices.push_back(2);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_pnu) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
+	constexpr float2   uvs[4]     = { float2(0.0f, 0.0f), float2(1.0f, 0.0f), float2(0.0f, 1.0f), float2(1.0f, 1.0f) };
+	constexpr uint16_t quad[2][6] = {
+		{ 0, 1, 2, 1, 3, 2 },
+		{ 0, 2, 1, 1, 2, 3 },
+	};
+
+	static_mesh<Vertex, NF * 4, NF * 6> mesh {};
+	for (size_t f = 0; f < NF; ++f) {
+		for (size_t k = 0; k < 4; ++k) {
+			mesh.vertices[f * 4 + k] = make_static_mesh_vertex<Vertex>(faces[f].positions[k], faces[f].normal, uvs[k]);
+		}
+		for (size_t k = 0; k < 6; ++k) {
+			mesh.indices[f * 6 + k] = static_cast<static_mesh_index_t<NF * 4>>(f * 4 + quad[faces[f].flip][k]);
+		}
 	}
+	return mesh;
+}
+
+// XY 平面の 1 x 1 の四角形 (-Z 向き)
+inline constexpr std::array<static_mesh_face, 1> quad_faces = { {
+    { { float3(-0.5f, +0.5f, 0.0f), float3(+0.5f, +0.5f, 0.0f), float3(-0.5f, -0.5f, 0.0f), float3(+0.5f, -0.5f, 0.0f) }, float3(0.0f, 0.0f, -1.0f), false },
+} };
+
+// 1 x 1 x 1 の立方体 (各面を外側から見て時計回り)
+inline constexpr std::array<static_mesh_face, 6> cube_faces = { {
+    { { float3(-0.5f, +0.5f, +0.5f), float3(+0.5f, +0.5f, +0.5f), float3(-0.5f, +0.5f, -0.5f), float3(+0.5f, +0.5f, -0.5f) }, float3(0.0f, +1.0f, 0.0f), false },
+    { { float3(-0.5f, -0.5f, +0.5f), float3(+0.5f, -0.5f, +0.5f), float3(-0.5f, -0.5f, -0.5f), float3(+0.5f, -0.5f, -0.5f) }, float3(0.0f, -1.0f, 0.0f), true },
+    { { float3(-0.5f, +0.5f, -0.5f), float3(+0.5f, +0.5f, -0.5f), float3(-0.5f, -0.5f, -0.5f), float3(+0.5f, -0.5f, -0.5f) }, float3(0.0f, 0.0f, -1.0f), false },
+    { { float3(-0.5f, +0.5f, +0.5f), float3(+0.5f, +0.5f, +0.5f), float3(-0.5f, -0.5f, +0.5f), float3(+0.5f, -0.5f, +0.5f) }, float3(0.0f, 0.0f, +1.0f), true },
+    { { float3(+0.5f, +0.5f, -0.5f), float3(+0.5f, +0.5f, +0.5f), float3(+0.5f, -0.5f, -0.5f), float3(+0.5f, -0.5f, +0.5f) }, float3(+1.0f, 0.0f, 0.0f), false },
+    { { float3(-0.5f, +0.5f, -0.5f), float3(-0.5f, +0.5f, +0.5f), float3(-0.5f, -0.5f, -0.5f), float3(-0.5f, -0.5f, +0.5f) }, float3(-1.0f, 0.0f, 0.0f), true },
+} };
+
+// 頂点の I 番目の要素を位置以外の要素の配列に書き込みます
+template<class Vertex, size_t I, size_t N>
+constexpr void store_static_mesh_attribute(const Vertex& v, std::array<float, N>& out) noexcept
+{
+	constexpr vertex_element e = vertex_traits<Vertex>::elements[I];
+	constexpr size_t         o = (e.offset - sizeof(float3)) / sizeof(float);
+	if constexpr (e.semantic == vertex_semantic::normal) {
+		out[o + 0] = v.normal.x;
+		out[o + 1] = v.normal.y;
+		out[o + 2] = v.normal.z;
+	}
+	else if constexpr (e.semantic == vertex_semantic::texcoord) {
+		out[o + 0] = v.uv.x;
+		out[o + 1] = v.uv.y;
+	}
+	else if constexpr (e.semantic == vertex_semantic::color) {
+		out[o + 0] = v.color.x;
+		out[o + 1] = v.color.y;
+		out[o + 2] = v.color.z;
+		out[o + 3] = v.color.w;
+	}
+	else if constexpr (e.semantic == vertex_semantic::tangent) {
+		out[o + 0] = v.tangent.x;
+		out[o + 1] = v.tangent.y;
+		out[o + 2] = v.tangent.z;
+		out[o + 3] = v.tangent.w;
+	}
+}
 
-	std::vector<vertex_pnu> vertices;
-	std::vector<uint16_t>   indices;
-	uint32_t                vertex_size;
-	uint32_t                index_size;
-};
+template<class Vertex, size_t N, size_t... I>
+constexpr std::array<float, N> make_static_mesh_attributes(const Vertex& v, std::index_sequence<I...>) noexcept
+{
+	std::array<float, N> out {};
+	(store_static_mesh_attribute<Vertex, I + 1>(v, out), ...);
+	return out;
+}
+
+} // namespace detail
 
-struct static_mesh_cube_pn
+//! \brief 位置と位置以外の要素を別々の配列に分けます
+template<class Vertex, size_t NV, size_t NI>
+[[nodiscard]] constexpr static_split_mesh<Vertex, NV, NI> split_position_stream(const static_mesh<Vertex, NV, NI>& mesh) noexcept
 {
-	constexpr static_mesh_cube_pn()
-	{
-		vertices.push_back({ float3(-0.5f, +0.5f, +0.5f), float3(0, 1, 0) });
-		vertices.push_back({ float3(+0.5f, +0.5f, +0.5f), float3(0, 1, 0) });
-		vertices.push_back({ float3(-0.5f, +0.5f, -0.5f), float3(0, 1, 0) });
-		vertices.push_back({ float3(+0.5f, +0.5f, -0.5f), float3(0, 1, 0) });
-		indices.push_back(0 * 4 + 0);
-		indices.push_back(0 * 4 + 1);
-		indices.push_back(0 * 4 + 2);
-		indices.push_back(0 * 4 + 1);
-		indices.push_back(0 * 4 + 3);
-		indices.push_back(0 * 4 + 2);
-
-		vertices.push_back({ float3(-0.5f, -0.5f, +0.5f), float3(0, -1, 0) });
-		vertices.push_back({ float3(+0.5f, -0.5f, +0.5f), float3(0, -1, 0) });
-		vertices.push_back({ float3(-0.5f, -0.5f, -0.5f), float3(0, -1, 0) });
-		vertices.push_back({ float3(+0.5f, -0.5f, -0.5f), float3(0, -1, 0) });
-		indices.push_back(1 * 4 + 0);
-		indices.push_back(1 * 4 + 2);
-		indices.push_back(1 * 4 + 1);
-		indices.push_back(1 * 4 + 1);
-		indices.push_back(1 * 4 + 2);
-		indices.push_back(1 * 4 + 3);
-
-		vertices.push_back({ float3(-0.5f, +0.5f, -0.5f), float3(0, 0, -1) });
-		vertices.push_back({ float3(+0.5f, +0.5f, -0.5f), float3(0, 0, -1) });
-		vertices.push_back({ float3(-0.5f, -0.5f, -0.5f), float3(0, 0, -1) });
-		vertices.push_back({ float3(+0.5f, -0.5f, -0.5f), float3(0, 0, -1) });
-		indices.push_back(2 * 4 + 0);
-		indices.push_back(2 * 4 + 1);
-		indices.push_back(2 * 4 + 2);
-		indices.push_back(2 * 4 + 1);
-		indices.push_back(2 * 4 + 3);
-		indices.push_back(2 * 4 + 2);
-
-		vertices.push_back({ float3(-0.5f, +0.5f, +0.5f), float3(0, 0, 1) });
-		vertices.push_back({ float3(+0.5f, +0.5f, +0.5f), float3(0, 0, 1) });
-		vertices.push_back({ float3(-0.5f, -0.5f, +0.5f), float3(0, 0, 1) });
-		vertices.push_back({ float3(+0.5f, -0.5f, +0.5f), float3(0, 0, 1) });
-		indices.push_back(3 * 4 + 0);
-		indices.push_back(3 * 4 + 2);
-		indices.push_back(3 * 4 + 1);
-		indices.push_back(3 * 4 + 1);
-		indices.push_back(3 * 4 + 2);
-		indices.push_back(3 * 4 + 3);
-
-		vertices.push_back({ float3(+0.5f, +0.5f, -0.5f), float3(1, 0, 0) });
-		vertices.push_back({ float3(+0.5f, +0.5f, +0.5f), float3(1, 0, 0) });
-		vertices.push_back({ float3(+0.5f, -0.5f, -0.5f), float3(1, 0, 0) });
-		vertices.push_back({ float3(+0.5f, -0.5f, +0.5f), float3(1, 0, 0) });
-		indices.push_back(4 * 4 + 0);
-		indices.push_back(4 * 4 + 1);
-		indices.push_back(4 * 4 + 2);
-		indices.push_back(4 * 4 + 1);
-		indices.push_back(4 * 4 + 3);
-		indices.push_back(4 * 4 + 2);
-
-		vertices.push_back({ float3(-0.5f, +0.5f, -0.5f), float3(-1, 0, 0) });
-		vertices.push_back({ float3(-0.5f, +0.5f, +0.5f), float3(-1, 0, 0) });
-		vertices.push_back({ float3(-0.5f, -0.5f, -0.5f), float3(-1, 0, 0) });
-		vertices.push_back({ float3(-0.5f, -0.5f, +0.5f), float3(-1, 0, 0) });
-		indices.push_back(5 * 4 + 0);
-		indices.push_back(5 * 4 + 2);
-		indices.push_back(5 * 4 + 1);
-		indices.push_back(5 * 4 + 1);
-		indices.push_back(5 * 4 + 2);
-		indices.push_back(5 * 4 + 3);
-
-		vertex_size = static_cast<uint32_t>(sizeof(vertex_pn) * vertices.size());
-		index_size  = static_cast<uint32_t>(sizeof(uint16_t) * indices.size());
-	}
+	using mesh_type = static_split_mesh<Vertex, NV, NI>;
 
-	std::vector<vertex_pn> vertices;
-	std::vector<uint16_t>  indices;
-	uint32_t               vertex_size;
-	uint32_t               index_size;
-};
+	constexpr size_t attribute_count = vertex_traits<Vertex>::elements.size() - 1;
+
+	mesh_type split {};
+	for (size_t i = 0; i < NV; ++i) {
+		split.positions[i]  = mesh.vertices[i].position;
+		split.attributes[i] = detail::make_static_mesh_attributes<Vertex, std::tuple_size_v<typename mesh_type::attribute_type>>(mesh.vertices[i], std::make_index_sequence<attribute_count>());
+	}
+	split.indices = mesh.indices;
+	return split;
+}
+
+inline constexpr auto static_mesh_quad_p   = detail::make_static_mesh<vertex_p>(detail::quad_faces);
+inline constexpr auto static_mesh_quad_pc  = detail::make_static_mesh<vertex_pc>(detail::quad_faces);
+inline constexpr auto static_mesh_quad_pu  = detail::make_static_mesh<vertex_pu>(detail::quad_faces);
+inline constexpr auto static_mesh_quad_puc = detail::make_static_mesh<vertex_puc>(detail::quad_faces);
+inline constexpr auto static_mesh_quad_pn  = detail::make_static_mesh<vertex_pn>(detail::quad_faces);
+inline constexpr auto static_mesh_quad_pnu = detail::make_static_mesh<vertex_pnu>(detail::quad_faces);
+inline constexpr auto static_mesh_cube_pn  = detail::make_static_mesh<vertex_pn>(detail::cube_faces);
+
+inline constexpr auto static_split_mesh_quad_pnu = split_position_stream(static_mesh_quad_pnu);
+inline constexpr auto static_split_mesh_cube_pn  = split_position_stream(static_mesh_cube_pn);
 
 } // namespace geometry
 } // namespace dxlib
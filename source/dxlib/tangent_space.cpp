@@ -0,0 +1,353 @@
+#include "tangent_space.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "thread_pool.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+// 並列化する場合の 1 タスクあたりの要素数
+constexpr size_t parallel_grain = 4096;
+
+template<class Fn>
+void parallel(dxlib::thread_pool* pool, size_t count, Fn&& fn)
+{
+	if (pool && count > parallel_grain) {
+		pool->parallel_for(count, parallel_grain, fn);
+	}
+	else {
+		fn(0, count);
+	}
+}
+
+// MikkTSpace の NotZero と同じ判定
+inline bool not_zero(float v) noexcept
+{
+	return std::abs(v) > FLT_MIN;
+}
+
+// p での角 (a - p と b - p のなす角)
+float corner_angle(const float3& p, const float3& a, const float3& b) noexcept
+{
+	const float3 u = a - p;
+	const float3 v = b - p;
+	const float  d = length(u) * length(v);
+	return d > 0.0f ? std::acos(std::clamp(dot(u, v) / d, -1.0f, 1.0f)) : 0.0f;
+}
+
+// 法線に垂直な任意の単位ベクトル
+float3 perpendicular(const float3& n) noexcept
+{
+	const float3 axis = std::abs(n.x) < 0.9f ? float3(1.0f, 0.0f, 0.0f) : float3(0.0f, 1.0f, 0.0f);
+	const float3 t    = axis - n * dot(n, axis);
+	const float  len  = length(t);
+	return len > 0.0f ? t * (1.0f / len) : float3(1.0f, 0.0f, 0.0f);
+}
+
+// キーごとの角の一覧 (CSR)
+// 各キーの角は昇順に並ぶので、この順で足し合わせればスレッド数によらず同じ結果になります
+struct corner_groups
+{
+	void build(std::span<const uint32_t> keys, uint32_t key_count)
+	{
+		offset.assign(key_count + 1, 0);
+		for (const uint32_t k : keys) {
+			++offset[k + 1];
+		}
+		for (uint32_t k = 0; k < key_count; ++k) {
+			offset[k + 1] += offset[k];
+		}
+		corners.resize(keys.size());
+		std::vector<uint32_t> cursor(offset.begin(), offset.end() - 1);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			corners[cursor[keys[i]]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	[[nodiscard]] std::span<const uint32_t> operator[](uint32_t k) const noexcept
+	{
+		return { corners.data() + offset[k], corners.data() + offset[k + 1] };
+	}
+
+	std::vector<uint32_t> offset;
+	std::vector<uint32_t> corners;
+};
+
+// 頂点ごとの位置番号
+uint32_t weld_positions(position_view positions, std::vector<uint32_t>& position_id)
+{
+	std::vector<vertex_p> packed(positions.count);
+	for (uint32_t v = 0; v < positions.count; ++v) {
+		packed[v].position = positions[v];
+	}
+	position_id.resize(positions.count);
+	return generate_weld_remap(std::span<const vertex_p>(packed), std::span<uint32_t>(position_id));
+}
+
+// 三角形ごとの単位法線と、角ごとの重み
+template<class Index>
+void face_normals(std::span<const Index> indices, position_view positions, normal_weight weight, std::vector<float3>& faces, std::vector<float>& weights, dxlib::thread_pool* pool)
+{
+	faces.resize(indices.size() / 3);
+	weights.resize(indices.size());
+	parallel(pool, faces.size(), [&](size_t begin, size_t end)
+	    {
+		    for (size_t t = begin; t < end; ++t) {
+			    const float3& p0  = positions[indices[t * 3 + 0]];
+			    const float3& p1  = positions[indices[t * 3 + 1]];
+			    const float3& p2  = positions[indices[t * 3 + 2]];
+			    const float3  n   = cross(p1 - p0, p2 - p0);
+			    const float   len = length(n);
+			    faces[t]          = len > 0.0f ? n * (1.0f / len) : float3(0.0f);
+			    if (weight == normal_weight::area || len <= 0.0f) {
+				    weights[t * 3 + 0] = weights[t * 3 + 1] = weights[t * 3 + 2] = len;
+			    }
+			    else {
+				    weights[t * 3 + 0] = corner_angle(p0, p1, p2);
+				    weights[t * 3 + 1] = corner_angle(p1, p2, p0);
+				    weights[t * 3 + 2] = corner_angle(p2, p0, p1);
+			    }
+		    }
+	    });
+}
+
+template<class Index>
+void smooth_normals_impl(std::span<const Index> indices, position_view positions, std::span<float3> normals, const normal_options& options, dxlib::thread_pool* pool)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0 && normals.size() >= positions.count);
+
+	std::vector<float3> faces;
+	std::vector<float>  weights;
+	face_normals(indices, positions, options.weight, faces, weights, pool);
+
+	// 位置を共有する場合は位置番号、しない場合は頂点番号ごとに足し合わせます
+	std::vector<uint32_t> keys(indices.size());
+	uint32_t              key_count = positions.count;
+	if (options.weld_positions) {
+		std::vector<uint32_t> position_id;
+		key_count = weld_positions(positions, position_id);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			keys[i] = position_id[indices[i]];
+		}
+	}
+	else {
+		keys.assign(indices.begin(), indices.end());
+	}
+	corner_groups groups;
+	groups.build(keys, key_count);
+
+	std::vector<float3> sums(key_count);
+	parallel(pool, key_count, [&](size_t begin, size_t end)
+	    {
+		    for (size_t k = begin; k < end; ++k) {
+			    float3 s(0.0f);
+			    for (const uint32_t c : groups[static_cast<uint32_t>(k)]) {
+				    s += faces[c / 3] * weights[c];
+			    }
+			    const float len = length(s);
+			    sums[k]         = len > 0.0f ? s * (1.0f / len) : float3(0.0f);
+		    }
+	    });
+
+	std::fill_n(normals.begin(), positions.count, float3(0.0f));
+	for (size_t i = 0; i < indices.size(); ++i) {
+		normals[indices[i]] = sums[keys[i]];
+	}
+}
+
+template<class Index>
+void crease_normals_impl(std::span<const Index> indices, position_view positions, float crease_angle, std::span<float3> normals, const normal_options& options, dxlib::thread_pool* pool)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0 && normals.size() >= indices.size());
+
+	std::vector<float3> faces;
+	std::vector<float>  weights;
+	face_normals(indices, positions, options.weight, faces, weights, pool);
+
+	std::vector<uint32_t> position_id;
+	const uint32_t        key_count = weld_positions(positions, position_id);
+	std::vector<uint32_t> keys(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		keys[i] = position_id[indices[i]];
+	}
+	corner_groups groups;
+	groups.build(keys, key_count);
+
+	// 自身の三角形は常に含めるので、crease_angle が 0 でも面の法線になります
+	const float threshold = std::cos(crease_angle);
+	parallel(pool, indices.size(), [&](size_t begin, size_t end)
+	    {
+		    for (size_t c = begin; c < end; ++c) {
+			    const size_t  t = c / 3;
+			    const float3& n = faces[t];
+			    float3        s(0.0f);
+			    for (const uint32_t o : groups[keys[c]]) {
+				    if (o / 3 == t || dot(faces[o / 3], n) >= threshold) {
+					    s += faces[o / 3] * weights[o];
+				    }
+			    }
+			    const float len = length(s);
+			    normals[c]      = len > 0.0f ? s * (1.0f / len) : n;
+		    }
+	    });
+}
+
+template<class Index>
+void corner_tangents_impl(std::span<const Index> indices, std::span<const vertex_pntu> vertices, std::span<float4> tangents, dxlib::thread_pool* pool)
+{
+	ASSERT_RETURN(indices.size() % 3 == 0 && tangents.size() >= indices.size());
+
+	const size_t triangle_count = indices.size() / 3;
+
+	// 三角形ごとの dP/du の向きと UV の向き
+	struct triangle_info
+	{
+		float3 os;
+		bool   preserving; //!< UV の向きが保たれる
+		bool   valid;      //!< UV の面積がある
+	};
+	std::vector<triangle_info> triangles(triangle_count);
+	std::vector<float3>        contribution(indices.size());
+	parallel(pool, triangle_count, [&](size_t begin, size_t end)
+	    {
+		    for (size_t t = begin; t < end; ++t) {
+			    const vertex_pntu& v0 = vertices[indices[t * 3 + 0]];
+			    const vertex_pntu& v1 = vertices[indices[t * 3 + 1]];
+			    const vertex_pntu& v2 = vertices[indices[t * 3 + 2]];
+
+			    const float3 d1  = v1.position - v0.position;
+			    const float3 d2  = v2.position - v0.position;
+			    const float  t21x = v1.uv.x - v0.uv.x;
+			    const float  t21y = v1.uv.y - v0.uv.y;
+			    const float  t31x = v2.uv.x - v0.uv.x;
+			    const float  t31y = v2.uv.y - v0.uv.y;
+			    const float  area = t21x * t31y - t21y * t31x;
+
+			    triangle_info& info = triangles[t];
+			    info.preserving     = area > 0.0f;
+			    info.valid          = not_zero(area);
+			    info.os             = float3(0.0f);
+			    if (info.valid) {
+				    const float3 os  = d1 * t31y - d2 * t21y;
+				    const float  len = length(os);
+				    if (not_zero(len)) {
+					    info.os = os * ((info.preserving ? 1.0f : -1.0f) / len);
+				    }
+			    }
+
+			    // 角ごとに法線に垂直な平面へ射影し、射影した角の角度で重み付けします
+			    const vertex_pntu* corner[3] = { &v0, &v1, &v2 };
+			    for (uint32_t c = 0; c < 3; ++c) {
+				    const float3& n  = corner[c]->normal;
+				    const float3& p  = corner[c]->position;
+				    float3        os = info.os - n * dot(n, info.os);
+				    float3        e1 = corner[(c + 2) % 3]->position - p;
+				    float3        e2 = corner[(c + 1) % 3]->position - p;
+				    e1               = e1 - n * dot(n, e1);
+				    e2               = e2 - n * dot(n, e2);
+
+				    const float os_len = length(os);
+				    const float e1_len = length(e1);
+				    const float e2_len = length(e2);
+				    os                 = not_zero(os_len) ? os * (1.0f / os_len) : os;
+				    e1                 = not_zero(e1_len) ? e1 * (1.0f / e1_len) : e1;
+				    e2                 = not_zero(e2_len) ? e2 * (1.0f / e2_len) : e2;
+
+				    const float angle           = std::acos(std::clamp(dot(e1, e2), -1.0f, 1.0f));
+				    contribution[t * 3 + c] = os * angle;
+			    }
+		    }
+	    });
+
+	// 位置、法線、UV が同じ頂点を 1 つとし、UV の向きごとに分けて足し合わせます
+	std::vector<vertex_pnu> keys_source(vertices.size());
+	for (size_t v = 0; v < vertices.size(); ++v) {
+		keys_source[v].position = vertices[v].position;
+		keys_source[v].normal   = vertices[v].normal;
+		keys_source[v].uv       = vertices[v].uv;
+	}
+	std::vector<uint32_t> vertex_id(vertices.size());
+	const uint32_t        vertex_count = generate_weld_remap(std::span<const vertex_pnu>(keys_source), std::span<uint32_t>(vertex_id));
+
+	// UV の面積のない三角形は、その頂点で使われている向き (両方ある場合は保たれる向き) に合わせます
+	std::vector<uint8_t> orientation(vertex_count, 0);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		const triangle_info& info = triangles[i / 3];
+		if (info.valid) {
+			orientation[vertex_id[indices[i]]] |= info.preserving ? 2 : 1;
+		}
+	}
+	std::vector<uint32_t> keys(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		const triangle_info& info       = triangles[i / 3];
+		const uint32_t       id         = vertex_id[indices[i]];
+		const bool           preserving = info.valid ? info.preserving : (orientation[id] & 2) != 0 || orientation[id] == 0;
+		keys[i]                         = id * 2 + (preserving ? 1 : 0);
+	}
+	corner_groups groups;
+	groups.build(keys, vertex_count * 2);
+
+	std::vector<float3> sums(vertex_count * 2);
+	parallel(pool, sums.size(), [&](size_t begin, size_t end)
+	    {
+		    for (size_t k = begin; k < end; ++k) {
+			    float3 s(0.0f);
+			    for (const uint32_t c : groups[static_cast<uint32_t>(k)]) {
+				    s += contribution[c];
+			    }
+			    const float len = length(s);
+			    sums[k]         = not_zero(len) ? s * (1.0f / len) : float3(0.0f);
+		    }
+	    });
+
+	parallel(pool, indices.size(), [&](size_t begin, size_t end)
+	    {
+		    for (size_t c = begin; c < end; ++c) {
+			    const float3& s = sums[keys[c]];
+			    const float3  t = dot(s, s) > 0.0f ? s : perpendicular(vertices[indices[c]].normal);
+			    tangents[c]     = float4(t.x, t.y, t.z, (keys[c] & 1) ? 1.0f : -1.0f);
+		    }
+	    });
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+void generate_smooth_normals(std::span<const uint16_t> indices, position_view positions, std::span<float3> normals, const normal_options& options, thread_pool* pool)
+{
+	smooth_normals_impl(indices, positions, normals, options, pool);
+}
+
+void generate_smooth_normals(std::span<const uint32_t> indices, position_view positions, std::span<float3> normals, const normal_options& options, thread_pool* pool)
+{
+	smooth_normals_impl(indices, positions, normals, options, pool);
+}
+
+void generate_crease_normals(std::span<const uint16_t> indices, position_view positions, float crease_angle, std::span<float3> normals, const normal_options& options, thread_pool* pool)
+{
+	crease_normals_impl(indices, positions, crease_angle, normals, options, pool);
+}
+
+void generate_crease_normals(std::span<const uint32_t> indices, position_view positions, float crease_angle, std::span<float3> normals, const normal_options& options, thread_pool* pool)
+{
+	crease_normals_impl(indices, positions, crease_angle, normals, options, pool);
+}
+
+void generate_corner_tangents(std::span<const uint16_t> indices, std::span<const vertex_pntu> vertices, std::span<float4> tangents, thread_pool* pool)
+{
+	corner_tangents_impl(indices, vertices, tangents, pool);
+}
+
+void generate_corner_tangents(std::span<const uint32_t> indices, std::span<const vertex_pntu> vertices, std::span<float4> tangents, thread_pool* pool)
+{
+	corner_tangents_impl(indices, vertices, tangents, pool);
+}
+
+} // namespace geometry
+} // namespace dxlib
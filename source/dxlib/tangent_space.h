@@ -0,0 +1,158 @@
+﻿#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "debug.h"
+#include "mesh_optimizer.h"
+#include "vertex.h"
+#include "vertex_weld.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+namespace geometry {
+
+// 法線と接線の生成
+//
+// 三角形ごとの寄与 (面の法線、接線) を並列に計算し、頂点ごとに三角形の順で足し合わせます。
+// 足し合わせる順番はスレッド数に依存しないので、pool の有無やスレッド数によらず結果はビット単位で一致します。
+//
+// 接線は MikkTSpace (Mikkelsen, "Simulation of Wrinkled Surfaces Revisited") と同じ規則で計算します。
+// - 三角形の UV から求めた dP/du を頂点の法線に垂直な平面に射影し、角の角度で重み付けして足し合わせます
+// - 位置、法線、UV が同じ頂点は 1 つとして扱い、UV の向き (表裏) が異なる三角形の間では共有しません
+// - tangent.w は UV の向きが保たれる三角形で 1、反転する三角形で -1 です
+// UV の向きが異なる三角形が同じ頂点を共有する場合 (ミラーした UV の継ぎ目) は頂点を分割します。
+// 1 つの頂点の周りが辺で繋がっていない (非多様体の) 場合は MikkTSpace と結果が異なることがあります。
+
+//! \brief 法線を平均するときの三角形の重み
+enum class normal_weight : uint8_t
+{
+	area,  //!< 面積 (大きな三角形の向きを優先します)
+	angle, //!< 頂点での角の角度 (分割の仕方に依存しにくい)
+};
+
+//! \brief 法線の生成の設定
+struct normal_options
+{
+	normal_weight weight         = normal_weight::angle;
+	bool          weld_positions = true; //!< 同じ位置の頂点 (UV の継ぎ目) で法線を共有する (generate_smooth_normals のみ)
+};
+
+//! \brief 頂点ごとの滑らかな法線を求めます
+//!
+//! 三角形から参照されない頂点と、面積のある三角形に接しない頂点は (0, 0, 0) になります。
+//!
+//! \param[in]  indices   三角形リスト
+//! \param[in]  positions 頂点の位置
+//! \param[out] normals   正規化済みの法線、positions.count 要素以上
+//! \param[in]  options
+//! \param[in]  pool      並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+void generate_smooth_normals(std::span<const uint16_t> indices, position_view positions, std::span<float3> normals, const normal_options& options = {}, thread_pool* pool = nullptr);
+void generate_smooth_normals(std::span<const uint32_t> indices, position_view positions, std::span<float3> normals, const normal_options& options = {}, thread_pool* pool = nullptr);
+
+//! \brief 角ごとの法線を求めます
+//!
+//! 同じ位置を共有する三角形のうち、面の法線のなす角が crease_angle 以下のものだけを平均します。
+//! crease_angle が 0 の場合は面の法線 (フラットシェーディング) になります。
+//!
+//! \param[in]  indices      三角形リスト
+//! \param[in]  positions    頂点の位置
+//! \param[in]  crease_angle 平滑化する最大の角度 (ラジアン)
+//! \param[out] normals      角 (indices の要素) ごとの法線、indices.size() 要素以上
+//! \param[in]  options
+//! \param[in]  pool
+void generate_crease_normals(std::span<const uint16_t> indices, position_view positions, float crease_angle, std::span<float3> normals, const normal_options& options = {}, thread_pool* pool = nullptr);
+void generate_crease_normals(std::span<const uint32_t> indices, position_view positions, float crease_angle, std::span<float3> normals, const normal_options& options = {}, thread_pool* pool = nullptr);
+
+//! \brief 角ごとの接線を MikkTSpace と同じ規則で求めます
+//!
+//! UV の面積のない三角形だけに接する角は、法線に垂直な任意の単位ベクトルになります。
+//!
+//! \param[in]  indices  三角形リスト
+//! \param[in]  vertices 位置、法線 (正規化済み)、UV (tangent は使用しません)
+//! \param[out] tangents 角 (indices の要素) ごとの接線、indices.size() 要素以上
+//! \param[in]  pool
+void generate_corner_tangents(std::span<const uint16_t> indices, std::span<const vertex_pntu> vertices, std::span<float4> tangents, thread_pool* pool = nullptr);
+void generate_corner_tangents(std::span<const uint32_t> indices, std::span<const vertex_pntu> vertices, std::span<float4> tangents, thread_pool* pool = nullptr);
+
+namespace detail {
+
+//! \brief 角ごとに頂点を複製して set(vertex, corner) で値を設定し、同じ頂点を溶接します
+//!
+//! 頂点は最初に参照される順に並び、参照されない頂点は取り除かれます。
+template<class V, class Index, class Fn>
+std::vector<V> expand_corners(std::span<const V> vertices, std::span<Index> indices, Fn&& set)
+{
+	std::vector<V> expanded(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		expanded[i] = vertices[indices[i]];
+		set(expanded[i], i);
+	}
+
+	std::vector<uint32_t> remap(expanded.size());
+	const uint32_t        count = generate_weld_remap(std::span<const V>(expanded), std::span<uint32_t>(remap));
+	if (count == 0) {
+		return {};
+	}
+	ASSERT_RETURN(count - 1 <= static_cast<uint32_t>(static_cast<Index>(~Index(0))), {});
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = static_cast<Index>(remap[i]);
+	}
+	expanded.resize(compact_vertices(std::span<V>(expanded), std::span<const uint32_t>(remap)));
+	return expanded;
+}
+
+} // namespace detail
+
+//! \brief 頂点の法線を滑らかな法線で置き換えます
+template<class V, class Index>
+requires std::same_as<decltype(V::normal), float3>
+void generate_smooth_normals(std::span<const Index> indices, std::span<V> vertices, const normal_options& options = {}, thread_pool* pool = nullptr)
+{
+	std::vector<float3> normals(vertices.size());
+	generate_smooth_normals(indices, position_view(std::span<const V>(vertices)), std::span<float3>(normals), options, pool);
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		vertices[i].normal = normals[i];
+	}
+}
+
+//! \brief 角ごとの法線 (generate_crease_normals) を設定し、法線の異なる角で頂点を分割します
+//!
+//! \param[in]     vertices
+//! \param[in,out] indices      分割後の頂点番号に書き換えます
+//! \param[in]     crease_angle 平滑化する最大の角度 (0 でフラットシェーディング)
+//! \return 分割後の頂点 (最初に参照される順)
+template<class V, class Index>
+requires std::same_as<decltype(V::normal), float3>
+std::vector<V> split_normals(std::span<const V> vertices, std::span<Index> indices, float crease_angle, const normal_options& options = {}, thread_pool* pool = nullptr)
+{
+	std::vector<float3> normals(indices.size());
+	generate_crease_normals(std::span<const Index>(indices), position_view(vertices), crease_angle, std::span<float3>(normals), options, pool);
+	return detail::expand_corners(vertices, indices, [&](V& v, size_t corner)
+	    {
+		    v.normal = normals[corner];
+	    });
+}
+
+//! \brief 接線を設定し、接線の異なる角 (ミラーした UV の継ぎ目など) で頂点を分割します
+//!
+//! \param[in]     vertices 位置、法線 (正規化済み)、UV
+//! \param[in,out] indices  分割後の頂点番号に書き換えます
+//! \return 分割後の頂点 (最初に参照される順)
+template<class Index>
+std::vector<vertex_pntu> generate_tangents(std::span<const vertex_pntu> vertices, std::span<Index> indices, thread_pool* pool = nullptr)
+{
+	std::vector<float4> tangents(indices.size());
+	generate_corner_tangents(std::span<const Index>(indices), vertices, std::span<float4>(tangents), pool);
+	return detail::expand_corners(vertices, indices, [&](vertex_pntu& v, size_t corner)
+	    {
+		    v.tangent = tangents[corner];
+	    });
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,127 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace dxlib {
+
+thread_pool::thread_pool(uint32_t thread_count)
+    : m_threads()
+    , m_tasks()
+    , m_mutex()
+    , m_condition()
+    , m_stop(false)
+{
+	if (thread_count == 0) {
+		const uint32_t hw = std::thread::hardware_concurrency();
+		thread_count      = hw > 1 ? hw - 1 : 1;
+	}
+	m_threads.reserve(thread_count);
+	for (uint32_t i = 0; i < thread_count; ++i) {
+		m_threads.emplace_back(&thread_pool::worker_main, this);
+	}
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_all();
+	for (auto& thread : m_threads) {
+		thread.join();
+	}
+}
+
+uint32_t thread_pool::thread_count() const noexcept
+{
+	return static_cast<uint32_t>(m_threads.size());
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+}
+
+void thread_pool::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+	if (count == 0) {
+		return;
+	}
+	grain               = std::max<size_t>(grain, 1);
+	const size_t chunks = (count + grain - 1) / grain;
+	if (chunks == 1 || m_threads.empty()) {
+		fn(0, count);
+		return;
+	}
+
+	// ワーカーは呼び出し元が戻った後にも状態を参照し得るため共有所有にします
+	struct state
+	{
+		std::atomic<size_t> next = 0;
+		std::atomic<size_t> done = 0;
+		std::mutex          mutex;
+		std::condition_variable finished;
+	};
+	auto shared = std::make_shared<state>();
+
+	auto run = [shared, count, grain, chunks, &fn]()
+	{
+		size_t completed = 0;
+		for (size_t chunk = shared->next++; chunk < chunks; chunk = shared->next++) {
+			const size_t begin = chunk * grain;
+			fn(begin, std::min(begin + grain, count));
+			++completed;
+		}
+		if (completed > 0 && shared->done.fetch_add(completed) + completed == chunks) {
+			std::lock_guard lock(shared->mutex);
+			shared->finished.notify_all();
+		}
+	};
+
+	const size_t helpers = std::min<size_t>(m_threads.size(), chunks - 1);
+	for (size_t i = 0; i < helpers; ++i) {
+		submit(run);
+	}
+	run();
+
+	std::unique_lock lock(shared->mutex);
+	shared->finished.wait(lock, [&]()
+	    {
+		    return shared->done.load() == chunks;
+	    });
+}
+
+thread_pool& thread_pool::shared()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+void thread_pool::worker_main()
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(lock, [this]()
+			    {
+				    return m_stop || !m_tasks.empty();
+			    });
+			if (m_stop && m_tasks.empty()) {
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // namespace dxlib
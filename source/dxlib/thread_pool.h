@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dxlib {
+
+//! \brief 固定数のワーカースレッドでタスクを処理するスレッドプール
+class thread_pool
+{
+public:
+	//! \brief コンストラクタ
+	//!
+	//! \param[in] thread_count ワーカー数 (0 の場合は論理コア数 - 1)
+	explicit thread_pool(uint32_t thread_count = 0);
+
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	//! \brief ワーカー数
+	[[nodiscard]] uint32_t thread_count() const noexcept;
+
+	//! \brief タスクを追加します
+	//!
+	//! \param[in] task
+	void submit(std::function<void()> task);
+
+	//! \brief [0, count) を grain 単位に分割して並列に処理します
+	//!
+	//! 呼び出しスレッドも処理に参加し、全ての範囲が終わるまで戻りません。
+	//! タスク内から呼び出しても (ワーカーが埋まっていても) デッドロックしません。
+	//!
+	//! \param[in] count
+	//! \param[in] grain 1 回の fn 呼び出しで処理する最大要素数
+	//! \param[in] fn    fn(begin, end)
+	void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+	//! \brief プロセス共有のスレッドプール
+	[[nodiscard]] static thread_pool& shared();
+
+private:
+	void worker_main();
+
+private:
+	std::vector<std::thread>          m_threads;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex                        m_mutex;
+	std::condition_variable           m_condition;
+	bool                              m_stop;
+};
+
+} // namespace dxlib
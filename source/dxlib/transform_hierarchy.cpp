@@ -0,0 +1,306 @@
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+
+#include "debug.h"
+#include "thread_pool.h"
+
+namespace {
+
+// これ以下のノード数の深さは呼び出しスレッドのみで処理します
+constexpr size_t parallel_grain = 256;
+
+// 削除済みノードの親として設定します
+constexpr uint32_t destroyed_index = ~0u - 1;
+
+template<class T>
+void permute(std::vector<T>& v, const std::vector<uint32_t>& order)
+{
+	std::vector<T> sorted;
+	sorted.reserve(order.size());
+	for (uint32_t i : order) {
+		sorted.push_back(v[i]);
+	}
+	v = std::move(sorted);
+}
+
+} // namespace
+
+namespace dxlib {
+namespace scene {
+
+transform_hierarchy::handle transform_hierarchy::create(handle parent)
+{
+	const uint32_t parent_index = parent == invalid_handle ? invalid_index : index_of(parent);
+	ASSERT_RETURN(parent == invalid_handle || parent_index != invalid_index, invalid_handle);
+
+	handle node;
+	if (m_free.empty()) {
+		node = static_cast<handle>(m_index.size());
+		m_index.push_back(invalid_index);
+	}
+	else {
+		node = m_free.back();
+		m_free.pop_back();
+	}
+
+	const uint32_t index = static_cast<uint32_t>(m_parent.size());
+	m_index[node]        = index;
+	m_parent.push_back(parent_index);
+	m_node.push_back(node);
+	m_position.push_back(float3(0.0f));
+	m_rotation.push_back(quat::identity());
+	m_scale.push_back(float3(1.0f));
+	m_world.push_back(float4x4::identity());
+	m_dirty.push_back(1);
+
+	// 末尾の深さ以上であれば並び順を保ったまま追加できます
+	if (m_sorted) {
+		if (m_level.empty()) {
+			m_level.push_back(0);
+		}
+		const size_t deepest = m_level.size() - 2;
+		if (parent_index == invalid_index) {
+			if (m_level.size() == 1 || deepest == 0) {
+				m_level.resize(2);
+				m_level[1] = index + 1;
+			}
+			else {
+				m_sorted = false;
+			}
+		}
+		else if (parent_index >= m_level[deepest]) {
+			m_level.push_back(index + 1);
+		}
+		else if (deepest > 0 && parent_index >= m_level[deepest - 1]) {
+			m_level.back() = index + 1;
+		}
+		else {
+			m_sorted = false;
+		}
+	}
+	return node;
+}
+
+void transform_hierarchy::destroy(handle node)
+{
+	const uint32_t index = index_of(node);
+	ASSERT_RETURN(index != invalid_index);
+
+	// 子孫は rebuild() で親をたどって削除します
+	m_parent[index] = destroyed_index;
+	m_sorted        = false;
+}
+
+void transform_hierarchy::set_parent(handle node, handle parent)
+{
+	const uint32_t index        = index_of(node);
+	const uint32_t parent_index = parent == invalid_handle ? invalid_index : index_of(parent);
+	ASSERT_RETURN(index != invalid_index);
+	ASSERT_RETURN(parent == invalid_handle || parent_index != invalid_index);
+
+	// 自身の子孫を親にすると循環するので禁止します
+	for (uint32_t i = parent_index; i < m_parent.size(); i = m_parent[i]) {
+		ASSERT_RETURN(i != index);
+	}
+
+	m_parent[index] = parent_index;
+	m_dirty[index]  = 1;
+	m_sorted        = false;
+}
+
+void transform_hierarchy::set_position(handle node, const float3& position)
+{
+	const uint32_t index = index_of(node);
+	ASSERT_RETURN(index != invalid_index);
+	m_position[index] = position;
+	m_dirty[index]    = 1;
+}
+
+void transform_hierarchy::set_rotation(handle node, const quat& rotation)
+{
+	const uint32_t index = index_of(node);
+	ASSERT_RETURN(index != invalid_index);
+	m_rotation[index] = rotation;
+	m_dirty[index]    = 1;
+}
+
+void transform_hierarchy::set_scale(handle node, const float3& scale)
+{
+	const uint32_t index = index_of(node);
+	ASSERT_RETURN(index != invalid_index);
+	m_scale[index] = scale;
+	m_dirty[index] = 1;
+}
+
+const float3& transform_hierarchy::position(handle node) const noexcept
+{
+	return m_position[index_of(node)];
+}
+
+const quat& transform_hierarchy::rotation(handle node) const noexcept
+{
+	return m_rotation[index_of(node)];
+}
+
+const float3& transform_hierarchy::scale(handle node) const noexcept
+{
+	return m_scale[index_of(node)];
+}
+
+transform_hierarchy::handle transform_hierarchy::parent(handle node) const noexcept
+{
+	const uint32_t parent_index = m_parent[index_of(node)];
+	return parent_index < m_node.size() ? m_node[parent_index] : invalid_handle;
+}
+
+const float4x4& transform_hierarchy::world(handle node) const noexcept
+{
+	return m_world[index_of(node)];
+}
+
+std::span<const float4x4> transform_hierarchy::world_matrices() const noexcept
+{
+	return m_world;
+}
+
+transform_hierarchy::handle transform_hierarchy::node_at(size_t i) const noexcept
+{
+	return m_node[i];
+}
+
+size_t transform_hierarchy::size() const noexcept
+{
+	return m_node.size();
+}
+
+void transform_hierarchy::update(thread_pool* pool)
+{
+	if (!m_sorted) {
+		rebuild();
+	}
+
+	// 親は子より前にあるので 1 回の走査で子孫まで伝搬します
+	const size_t n = m_node.size();
+	for (size_t i = m_level.size() > 1 ? m_level[1] : n; i < n; ++i) {
+		m_dirty[i] |= m_dirty[m_parent[i]];
+	}
+
+	for (size_t d = 0; d + 1 < m_level.size(); ++d) {
+		const size_t begin = m_level[d];
+		const size_t end   = m_level[d + 1];
+		if (pool && end - begin > parallel_grain) {
+			pool->parallel_for(end - begin, parallel_grain, [this, begin](size_t b, size_t e)
+			    {
+				    update_range(begin + b, begin + e);
+			    });
+		}
+		else {
+			update_range(begin, end);
+		}
+	}
+
+	std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(0));
+}
+
+uint32_t transform_hierarchy::index_of(handle node) const noexcept
+{
+	ASSERT_RETURN(node < m_index.size() && m_index[node] != invalid_index, invalid_index);
+	return m_index[node];
+}
+
+void transform_hierarchy::rebuild()
+{
+	constexpr uint32_t unknown   = ~0u;
+	constexpr uint32_t destroyed = ~0u - 1;
+
+	const uint32_t n = static_cast<uint32_t>(m_node.size());
+
+	// 親をたどって深さを求めます (削除済みノードの子孫も削除扱い)
+	std::vector<uint32_t> depth(n, unknown);
+	std::vector<uint32_t> stack;
+	uint32_t              levels = 0;
+	for (uint32_t i = 0; i < n; ++i) {
+		uint32_t next = 0;
+		for (uint32_t j = i;;) {
+			if (depth[j] != unknown) {
+				next = depth[j] == destroyed ? destroyed : depth[j] + 1;
+				break;
+			}
+			stack.push_back(j);
+			const uint32_t p = m_parent[j];
+			if (p == invalid_index) {
+				next = 0;
+				break;
+			}
+			if (p == destroyed_index) {
+				next = destroyed;
+				break;
+			}
+			j = p;
+		}
+		while (!stack.empty()) {
+			depth[stack.back()] = next;
+			stack.pop_back();
+			if (next != destroyed) {
+				levels = std::max(levels, next + 1);
+				++next;
+			}
+		}
+	}
+
+	// 深さごとの計数ソート (同じ深さの中では元の順序を保ちます)
+	m_level.assign(levels + 1, 0);
+	for (uint32_t i = 0; i < n; ++i) {
+		if (depth[i] != destroyed) {
+			++m_level[depth[i] + 1];
+		}
+	}
+	for (uint32_t d = 0; d < levels; ++d) {
+		m_level[d + 1] += m_level[d];
+	}
+
+	std::vector<uint32_t> order(m_level[levels]);
+	std::vector<uint32_t> remap(n, invalid_index);
+	std::vector<uint32_t> cursor(m_level.begin(), m_level.end() - 1);
+	for (uint32_t i = 0; i < n; ++i) {
+		if (depth[i] == destroyed) {
+			m_index[m_node[i]] = invalid_index;
+			m_free.push_back(m_node[i]);
+			continue;
+		}
+		const uint32_t to = cursor[depth[i]]++;
+		order[to]         = i;
+		remap[i]          = to;
+	}
+
+	permute(m_parent, order);
+	permute(m_node, order);
+	permute(m_position, order);
+	permute(m_rotation, order);
+	permute(m_scale, order);
+	permute(m_world, order);
+	permute(m_dirty, order);
+
+	for (uint32_t i = 0; i < order.size(); ++i) {
+		if (m_parent[i] != invalid_index) {
+			m_parent[i] = remap[m_parent[i]];
+		}
+		m_index[m_node[i]] = i;
+	}
+	m_sorted = true;
+}
+
+void transform_hierarchy::update_range(size_t begin, size_t end) noexcept
+{
+	for (size_t i = begin; i < end; ++i) {
+		if (!m_dirty[i]) {
+			continue;
+		}
+		const float4x4 local = math::compose_trs(m_scale[i], m_rotation[i], m_position[i]);
+		m_world[i]           = m_parent[i] == invalid_index ? local : math::mul(local, m_world[m_parent[i]]);
+	}
+}
+
+} // namespace scene
+} // namespace dxlib
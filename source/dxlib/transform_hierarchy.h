@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "vector.h"
+
+namespace dxlib {
+
+class thread_pool;
+
+namespace scene {
+
+//! \brief 親子関係を持つトランスフォームの集合
+//!
+//! ノードは深さ順に並べたフラットな配列で保持します。
+//! 親は常に子より前に位置するため、ワールド行列は配列を 1 回走査するだけで更新できます。
+//! 同じ深さのノード同士は互いに依存しないので、深さごとに並列で更新します。
+class transform_hierarchy
+{
+public:
+	using handle = uint32_t;
+
+	static constexpr handle invalid_handle = ~0u;
+
+public:
+	transform_hierarchy() = default;
+
+	//! \brief ノードを作成します
+	//!
+	//! \param[in] parent 親ノード (invalid_handle の場合はルート)
+	//!
+	//! \ret 作成したノード
+	[[nodiscard]] handle create(handle parent = invalid_handle);
+
+	//! \brief ノードとその子孫を削除します
+	//!
+	//! \param[in] node
+	void destroy(handle node);
+
+	//! \brief 親ノードを変更します
+	//!
+	//! \param[in] node
+	//! \param[in] parent 新しい親ノード (invalid_handle の場合はルート)
+	void set_parent(handle node, handle parent);
+
+	//! \brief ローカル座標を設定します
+	void set_position(handle node, const float3& position);
+
+	//! \brief ローカル回転を設定します
+	void set_rotation(handle node, const quat& rotation);
+
+	//! \brief ローカルスケールを設定します
+	void set_scale(handle node, const float3& scale);
+
+	//! \brief ローカル座標
+	[[nodiscard]] const float3& position(handle node) const noexcept;
+
+	//! \brief ローカル回転
+	[[nodiscard]] const quat& rotation(handle node) const noexcept;
+
+	//! \brief ローカルスケール
+	[[nodiscard]] const float3& scale(handle node) const noexcept;
+
+	//! \brief 親ノード
+	[[nodiscard]] handle parent(handle node) const noexcept;
+
+	//! \brief ワールド行列
+	//!
+	//! update() 以降の変更は反映されていません。
+	[[nodiscard]] const float4x4& world(handle node) const noexcept;
+
+	//! \brief 深さ順に並んだ全ノードのワールド行列
+	[[nodiscard]] std::span<const float4x4> world_matrices() const noexcept;
+
+	//! \brief world_matrices() の i 番目に対応するノード
+	[[nodiscard]] handle node_at(size_t i) const noexcept;
+
+	//! \brief ノード数
+	[[nodiscard]] size_t size() const noexcept;
+
+	//! \brief 変更のあったノードとその子孫のワールド行列を更新します
+	//!
+	//! \param[in] pool 並列化に使用するスレッドプール (nullptr の場合は呼び出しスレッドのみで処理)
+	void update(thread_pool* pool = nullptr);
+
+private:
+	[[nodiscard]] uint32_t index_of(handle node) const noexcept;
+
+	void rebuild();
+
+	void update_range(size_t begin, size_t end) noexcept;
+
+private:
+	static constexpr uint32_t invalid_index = ~0u;
+
+	// 深さ順に並べた配列 (インデックスは m_index で引きます)
+	std::vector<uint32_t> m_parent;
+	std::vector<handle>   m_node;
+	std::vector<float3>   m_position;
+	std::vector<quat>     m_rotation;
+	std::vector<float3>   m_scale;
+	std::vector<float4x4> m_world;
+	std::vector<uint8_t>  m_dirty;
+
+	// 深さ d のノードは [m_level[d], m_level[d + 1]) に並びます
+	std::vector<uint32_t> m_level;
+
+	// ハンドル -> 配列インデックス
+	std::vector<uint32_t> m_index;
+	std::vector<handle>   m_free;
+	bool                  m_sorted = true;
+};
+
+} // namespace scene
+} // namespace dxlib
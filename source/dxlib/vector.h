@@ -4,6 +4,7 @@
 #include <DirectXMath.h>
 #endif
 
+#include <cmath>
 #include <cstdint>
 #include <type_traits>
 
@@ -372,6 +373,16 @@ struct vec3 : public detail::vec3_traits<T>
 		return x != v.x && y != v.y && z != v.z;
 	}
 
+	[[nodiscard]] constexpr vec3 operator+() const noexcept
+	{
+		return *this;
+	}
+
+	[[nodiscard]] constexpr vec3 operator-() const noexcept
+	{
+		return { -x, -y, -z };
+	}
+
 	[[nodiscard]] constexpr vec3 operator+(const vec3& v) const noexcept
 	{
 		return { x + v.x, y + v.y, z + v.z };
@@ -625,6 +636,16 @@ struct vec4 : public detail::vec4_traits<T>
 		return x != v.x && y != v.y && z != v.z && w != v.w;
 	}
 
+	[[nodiscard]] constexpr vec4 operator+() const noexcept
+	{
+		return *this;
+	}
+
+	[[nodiscard]] constexpr vec4 operator-() const noexcept
+	{
+		return { -x, -y, -z, -w };
+	}
+
 	[[nodiscard]] constexpr vec4 operator+(const vec4& v) const noexcept
 	{
 		return { x + v.x, y + v.y, z + v.z, w + v.w };
@@ -770,6 +791,86 @@ struct vec4 : public detail::vec4_traits<T>
 #endif
 };
 
+// --- vector functions ---
+
+template<class T>
+[[nodiscard]] constexpr T dot(const vec2<T>& a, const vec2<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+template<class T>
+[[nodiscard]] constexpr T dot(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<class T>
+[[nodiscard]] constexpr T dot(const vec4<T>& a, const vec4<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+template<class T>
+[[nodiscard]] constexpr vec3<T> cross(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+template<template<class> class V, class T>
+[[nodiscard]] inline T length(const V<T>& v) noexcept
+{
+	return std::sqrt(dot(v, v));
+}
+
+template<template<class> class V, class T>
+[[nodiscard]] inline V<T> normalize(const V<T>& v) noexcept
+{
+	return v * V<T>(T(1) / length(v));
+}
+
+template<template<class> class V, class T>
+[[nodiscard]] constexpr V<T> lerp(const V<T>& a, const V<T>& b, T t) noexcept
+{
+	return a + (b - a) * V<T>(t);
+}
+
+template<class T>
+[[nodiscard]] constexpr vec2<T> component_min(const vec2<T>& a, const vec2<T>& b) noexcept
+{
+	return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y };
+}
+
+template<class T>
+[[nodiscard]] constexpr vec3<T> component_min(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z };
+}
+
+template<class T>
+[[nodiscard]] constexpr vec4<T> component_min(const vec4<T>& a, const vec4<T>& b) noexcept
+{
+	return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z, a.w < b.w ? a.w : b.w };
+}
+
+template<class T>
+[[nodiscard]] constexpr vec2<T> component_max(const vec2<T>& a, const vec2<T>& b) noexcept
+{
+	return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y };
+}
+
+template<class T>
+[[nodiscard]] constexpr vec3<T> component_max(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z };
+}
+
+template<class T>
+[[nodiscard]] constexpr vec4<T> component_max(const vec4<T>& a, const vec4<T>& b) noexcept
+{
+	return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z, a.w > b.w ? a.w : b.w };
+}
+
 } // namespace math
 } // namespace dxlib
 
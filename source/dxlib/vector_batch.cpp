@@ -0,0 +1,331 @@
+#include "vector_batch.h"
+
+#include <cfloat>
+
+#include "debug.h"
+#include "simd.h"
+
+namespace {
+
+using namespace dxlib::math::simd;
+
+static_assert(sizeof(float2) == sizeof(float) * 2);
+static_assert(sizeof(float3) == sizeof(float) * 3);
+static_assert(sizeof(float4) == sizeof(float) * 4);
+
+struct add_op
+{
+	float operator()(float a, float b) const noexcept
+	{
+		return a + b;
+	}
+
+	vfloat4 operator()(vfloat4 a, vfloat4 b) const noexcept
+	{
+		return vadd(a, b);
+	}
+
+	vfloat8 operator()(vfloat8 a, vfloat8 b) const noexcept
+	{
+		return vadd(a, b);
+	}
+};
+
+struct lerp_op
+{
+	float t;
+
+	float operator()(float a, float b) const noexcept
+	{
+		return a + (b - a) * t;
+	}
+
+	vfloat4 operator()(vfloat4 a, vfloat4 b) const noexcept
+	{
+		return vmadd(vsub(b, a), vsplat4(t), a);
+	}
+
+	vfloat8 operator()(vfloat8 a, vfloat8 b) const noexcept
+	{
+		return vmadd(vsub(b, a), vsplat8(t), a);
+	}
+};
+
+struct scale_op
+{
+	float s;
+
+	float operator()(float a, float) const noexcept
+	{
+		return a * s;
+	}
+
+	vfloat4 operator()(vfloat4 a, vfloat4) const noexcept
+	{
+		return vmul(a, vsplat4(s));
+	}
+
+	vfloat8 operator()(vfloat8 a, vfloat8) const noexcept
+	{
+		return vmul(a, vsplat8(s));
+	}
+};
+
+// 成分を区別しない演算は float 配列として処理します。
+// 出力がアライン境界に揃うまでスカラーで進め、本体はアライン済みストア、端数はスカラーで処理します。
+template<class Op>
+void flat_binary(const float* a, const float* b, float* out, size_t n, Op op) noexcept
+{
+	size_t i = 0;
+	for (; i < n && !is_aligned(out + i); ++i) {
+		out[i] = op(a[i], b[i]);
+	}
+	for (; i + vfloat8_width <= n; i += vfloat8_width) {
+		vstore8a(out + i, op(vload8(a + i), vload8(b + i)));
+	}
+	if (i + vfloat4_width <= n) {
+		vstore4a(out + i, op(vload4(a + i), vload4(b + i)));
+		i += vfloat4_width;
+	}
+	for (; i < n; ++i) {
+		out[i] = op(a[i], b[i]);
+	}
+}
+
+template<class V>
+const float* flat(std::span<const V> v) noexcept
+{
+	return reinterpret_cast<const float*>(v.data());
+}
+
+template<class V>
+float* flat(std::span<V> v) noexcept
+{
+	return reinterpret_cast<float*>(v.data());
+}
+
+template<class V, class Op>
+void flat_binary(std::span<const V> a, std::span<const V> b, std::span<V> out, Op op) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && out.size() >= a.size());
+	flat_binary(flat(a), flat(b), flat(out), a.size() * sizeof(V) / sizeof(float), op);
+}
+
+template<class V>
+void scale_impl(std::span<const V> v, float s, std::span<V> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= v.size());
+	flat_binary(flat(v), flat(v), flat(out), v.size() * sizeof(V) / sizeof(float), scale_op { s });
+}
+
+} // namespace
+
+namespace dxlib {
+namespace math {
+namespace batch {
+
+void add(std::span<const float2> a, std::span<const float2> b, std::span<float2> out) noexcept
+{
+	flat_binary(a, b, out, add_op {});
+}
+
+void add(std::span<const float3> a, std::span<const float3> b, std::span<float3> out) noexcept
+{
+	flat_binary(a, b, out, add_op {});
+}
+
+void add(std::span<const float4> a, std::span<const float4> b, std::span<float4> out) noexcept
+{
+	flat_binary(a, b, out, add_op {});
+}
+
+void scale(std::span<const float2> v, float s, std::span<float2> out) noexcept
+{
+	scale_impl(v, s, out);
+}
+
+void scale(std::span<const float3> v, float s, std::span<float3> out) noexcept
+{
+	scale_impl(v, s, out);
+}
+
+void scale(std::span<const float4> v, float s, std::span<float4> out) noexcept
+{
+	scale_impl(v, s, out);
+}
+
+void lerp(std::span<const float2> a, std::span<const float2> b, float t, std::span<float2> out) noexcept
+{
+	flat_binary(a, b, out, lerp_op { t });
+}
+
+void lerp(std::span<const float3> a, std::span<const float3> b, float t, std::span<float3> out) noexcept
+{
+	flat_binary(a, b, out, lerp_op { t });
+}
+
+void lerp(std::span<const float4> a, std::span<const float4> b, float t, std::span<float4> out) noexcept
+{
+	flat_binary(a, b, out, lerp_op { t });
+}
+
+void dot(std::span<const float3> a, std::span<const float3> b, std::span<float> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && out.size() >= a.size());
+
+	const size_t n = a.size();
+	size_t       i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vfloat4 ax, ay, az, bx, by, bz;
+		vload_aos3(&a[i].x, ax, ay, az);
+		vload_aos3(&b[i].x, bx, by, bz);
+		vstore4(&out[i], vmadd(az, bz, vmadd(ay, by, vmul(ax, bx))));
+	}
+	for (; i < n; ++i) {
+		out[i] = math::dot(a[i], b[i]);
+	}
+}
+
+void cross(std::span<const float3> a, std::span<const float3> b, std::span<float3> out) noexcept
+{
+	ASSERT_RETURN(b.size() >= a.size() && out.size() >= a.size());
+
+	const size_t n = a.size();
+	size_t       i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vfloat4 ax, ay, az, bx, by, bz;
+		vload_aos3(&a[i].x, ax, ay, az);
+		vload_aos3(&b[i].x, bx, by, bz);
+		vstore_aos3(
+		    &out[i].x,
+		    vnmadd(az, by, vmul(ay, bz)),
+		    vnmadd(ax, bz, vmul(az, bx)),
+		    vnmadd(ay, bx, vmul(ax, by)));
+	}
+	for (; i < n; ++i) {
+		out[i] = math::cross(a[i], b[i]);
+	}
+}
+
+void normalize(std::span<const float3> v, std::span<float3> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= v.size());
+
+	const size_t n = v.size();
+	size_t       i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vfloat4 x, y, z;
+		vload_aos3(&v[i].x, x, y, z);
+		const vfloat4 inv_len = vrsqrt(vmadd(z, z, vmadd(y, y, vmul(x, x))));
+		vstore_aos3(&out[i].x, vmul(x, inv_len), vmul(y, inv_len), vmul(z, inv_len));
+	}
+	for (; i < n; ++i) {
+		out[i] = math::normalize(v[i]);
+	}
+}
+
+// float3 x4 = vfloat4 x3 なので、3 本のアキュムレータの各レーンは常に同じ成分に対応します。
+template<bool Min>
+float3 reduce_impl(std::span<const float3> v) noexcept
+{
+	const float init = Min ? FLT_MAX : -FLT_MAX;
+	vfloat4     m0   = vsplat4(init);
+	vfloat4     m1   = m0;
+	vfloat4     m2   = m0;
+
+	const size_t n = v.size();
+	const float* p = reinterpret_cast<const float*>(v.data());
+	size_t       i = 0;
+	for (; i + 4 <= n; i += 4, p += 12) {
+		if constexpr (Min) {
+			m0 = vmin(m0, vload4(p + 0));
+			m1 = vmin(m1, vload4(p + 4));
+			m2 = vmin(m2, vload4(p + 8));
+		}
+		else {
+			m0 = vmax(m0, vload4(p + 0));
+			m1 = vmax(m1, vload4(p + 4));
+			m2 = vmax(m2, vload4(p + 8));
+		}
+	}
+
+	float lanes[12];
+	vstore4(lanes + 0, m0);
+	vstore4(lanes + 4, m1);
+	vstore4(lanes + 8, m2);
+
+	float3 r(init);
+	for (size_t k = 0; k < 12; k += 3) {
+		const float3 l(lanes[k + 0], lanes[k + 1], lanes[k + 2]);
+		r = Min ? component_min(r, l) : component_max(r, l);
+	}
+	for (; i < n; ++i) {
+		r = Min ? component_min(r, v[i]) : component_max(r, v[i]);
+	}
+	return r;
+}
+
+float3 reduce_min(std::span<const float3> v) noexcept
+{
+	return reduce_impl<true>(v);
+}
+
+float3 reduce_max(std::span<const float3> v) noexcept
+{
+	return reduce_impl<false>(v);
+}
+
+template<bool Point>
+void transform_impl(std::span<const float3> v, const float4x4& m, std::span<float3> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= v.size());
+
+	const vfloat4 m00 = vsplat4(m._00), m01 = vsplat4(m._01), m02 = vsplat4(m._02);
+	const vfloat4 m10 = vsplat4(m._10), m11 = vsplat4(m._11), m12 = vsplat4(m._12);
+	const vfloat4 m20 = vsplat4(m._20), m21 = vsplat4(m._21), m22 = vsplat4(m._22);
+	const vfloat4 m30 = vsplat4(Point ? m._30 : 0.0f);
+	const vfloat4 m31 = vsplat4(Point ? m._31 : 0.0f);
+	const vfloat4 m32 = vsplat4(Point ? m._32 : 0.0f);
+
+	const size_t n = v.size();
+	size_t       i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vfloat4 x, y, z;
+		vload_aos3(&v[i].x, x, y, z);
+		vstore_aos3(
+		    &out[i].x,
+		    vmadd(z, m20, vmadd(y, m10, vmadd(x, m00, m30))),
+		    vmadd(z, m21, vmadd(y, m11, vmadd(x, m01, m31))),
+		    vmadd(z, m22, vmadd(y, m12, vmadd(x, m02, m32))));
+	}
+	for (; i < n; ++i) {
+		out[i] = Point ? transform_point(v[i], m) : transform_vector(v[i], m);
+	}
+}
+
+void transform_points(std::span<const float3> p, const float4x4& m, std::span<float3> out) noexcept
+{
+	transform_impl<true>(p, m, out);
+}
+
+void transform_vectors(std::span<const float3> v, const float4x4& m, std::span<float3> out) noexcept
+{
+	transform_impl<false>(v, m, out);
+}
+
+void transform(std::span<const float4> v, const float4x4& m, std::span<float4> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= v.size());
+
+	const vfloat4 r0 = math::detail::load_row(m, 0);
+	const vfloat4 r1 = math::detail::load_row(m, 1);
+	const vfloat4 r2 = math::detail::load_row(m, 2);
+	const vfloat4 r3 = math::detail::load_row(m, 3);
+	for (size_t i = 0; i < v.size(); ++i) {
+		vstore4(&out[i].x, math::detail::transform(vload4(&v[i].x), r0, r1, r2, r3));
+	}
+}
+
+} // namespace batch
+} // namespace math
+} // namespace dxlib
@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include <span>
+
+#include "matrix.h"
+#include "vector.h"
+
+namespace dxlib {
+namespace math {
+namespace batch {
+
+// float2 / float3 / float4 の配列をまとめて処理するカーネル群
+//
+// 出力 span は入力と同じ要素数以上が必要です。
+// 出力と入力が完全に同じ領域 (インプレース) であることは許可しますが、部分的な重なりは未定義です。
+
+//! \brief out[i] = a[i] + b[i]
+void add(std::span<const float2> a, std::span<const float2> b, std::span<float2> out) noexcept;
+void add(std::span<const float3> a, std::span<const float3> b, std::span<float3> out) noexcept;
+void add(std::span<const float4> a, std::span<const float4> b, std::span<float4> out) noexcept;
+
+//! \brief out[i] = v[i] * s
+void scale(std::span<const float2> v, float s, std::span<float2> out) noexcept;
+void scale(std::span<const float3> v, float s, std::span<float3> out) noexcept;
+void scale(std::span<const float4> v, float s, std::span<float4> out) noexcept;
+
+//! \brief out[i] = a[i] + (b[i] - a[i]) * t
+void lerp(std::span<const float2> a, std::span<const float2> b, float t, std::span<float2> out) noexcept;
+void lerp(std::span<const float3> a, std::span<const float3> b, float t, std::span<float3> out) noexcept;
+void lerp(std::span<const float4> a, std::span<const float4> b, float t, std::span<float4> out) noexcept;
+
+//! \brief out[i] = dot(a[i], b[i])
+void dot(std::span<const float3> a, std::span<const float3> b, std::span<float> out) noexcept;
+
+//! \brief out[i] = cross(a[i], b[i])
+void cross(std::span<const float3> a, std::span<const float3> b, std::span<float3> out) noexcept;
+
+//! \brief out[i] = normalize(v[i])
+void normalize(std::span<const float3> v, std::span<float3> out) noexcept;
+
+//! \brief 全要素の成分ごとの最小値 (空の場合は +FLT_MAX)
+[[nodiscard]] float3 reduce_min(std::span<const float3> v) noexcept;
+
+//! \brief 全要素の成分ごとの最大値 (空の場合は -FLT_MAX)
+[[nodiscard]] float3 reduce_max(std::span<const float3> v) noexcept;
+
+//! \brief out[i] = transform_point(p[i], m)
+void transform_points(std::span<const float3> p, const float4x4& m, std::span<float3> out) noexcept;
+
+//! \brief out[i] = transform_vector(v[i], m)
+void transform_vectors(std::span<const float3> v, const float4x4& m, std::span<float3> out) noexcept;
+
+//! \brief out[i] = transform(v[i], m)
+void transform(std::span<const float4> v, const float4x4& m, std::span<float4> out) noexcept;
+
+} // namespace batch
+} // namespace math
+} // namespace dxlib
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <cstdint>
+
 #include "vector.h"
 
 namespace dxlib {
@@ -35,5 +37,75 @@ struct vertex_pnu : public vertex_pn
 	float2 uv;
 };
 
+//! \brief 接線付きの頂点
+//!
+//! tangent.w は従接線の向き (bitangent = tangent.w * cross(normal, tangent.xyz)) で、±1 です。
+struct vertex_pntu : public vertex_pn
+{
+	float4 tangent;
+	float2 uv;
+};
+
+// --- packed ---
+//
+// 頂点メモリとフェッチ帯域を削減するための量子化された頂点フォーマット
+// 位置と UV は半精度、法線は八面体エンコードの snorm16、カラーは RGBA8 で保持します。
+// 位置の w は常に 1 です。半精度の位置は原点から 2048 を超えると 1 以上の誤差が出るため、ローカル座標のメッシュに使用します。
+// 変換は vertex_packing.h の pack / unpack で行います。
+
+//! \brief 半精度 x2 (R16G16_FLOAT)
+struct half2
+{
+	uint16_t x, y;
+};
+
+//! \brief 半精度 x4 (R16G16B16A16_FLOAT)
+struct half4
+{
+	uint16_t x, y, z, w;
+};
+
+//! \brief 符号付き正規化 16 bit x2 (R16G16_SNORM)
+struct snorm16x2
+{
+	int16_t x, y;
+};
+
+//! \brief 正規化 8 bit x4 (R8G8B8A8_UNORM)
+struct unorm8x4
+{
+	uint8_t x, y, z, w;
+};
+
+struct packed_vertex_p
+{
+	half4 position;
+};
+
+struct packed_vertex_pc : public packed_vertex_p
+{
+	unorm8x4 color;
+};
+
+struct packed_vertex_pu : public packed_vertex_p
+{
+	half2 uv;
+};
+
+struct packed_vertex_puc : public packed_vertex_pu
+{
+	unorm8x4 color;
+};
+
+struct packed_vertex_pn : public packed_vertex_p
+{
+	snorm16x2 normal;
+};
+
+struct packed_vertex_pnu : public packed_vertex_pn
+{
+	half2 uv;
+};
+
 } // namespace geometry
 } // namespace dxlib
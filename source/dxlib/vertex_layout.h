@@ -0,0 +1,384 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+
+#if defined(_ENABLE_D3D11) || defined(_ENABLE_D3D12) || __has_include(<dxgiformat.h>)
+#include <dxgiformat.h>
+#endif
+
+#include "vertex.h"
+
+namespace dxlib {
+namespace geometry {
+
+//! \brief 頂点要素の用途
+enum class vertex_semantic : uint8_t
+{
+	position,
+	normal,
+	texcoord,
+	color,
+	tangent,
+};
+
+//! \brief 頂点要素のフォーマット
+enum class vertex_format : uint8_t
+{
+	float32x2,
+	float32x3,
+	float32x4,
+	float16x2,
+	float16x4,
+	snorm16x2,
+	unorm8x4,
+};
+
+//! \brief 頂点要素
+struct vertex_element
+{
+	vertex_semantic semantic;
+	vertex_format   format;
+	uint32_t        offset; //!< 頂点先頭からのバイトオフセット
+};
+
+//! \brief フォーマットのバイトサイズ
+[[nodiscard]] constexpr uint32_t format_size(vertex_format format) noexcept
+{
+	switch (format) {
+	case vertex_format::float32x2:
+		return 8;
+	case vertex_format::float32x3:
+		return 12;
+	case vertex_format::float32x4:
+		return 16;
+	case vertex_format::float16x2:
+		return 4;
+	case vertex_format::float16x4:
+		return 8;
+	case vertex_format::snorm16x2:
+		return 4;
+	case vertex_format::unorm8x4:
+		return 4;
+	}
+	return 0;
+}
+
+//! \brief HLSL のセマンティクス名
+[[nodiscard]] constexpr const char* semantic_name(vertex_semantic semantic) noexcept
+{
+	switch (semantic) {
+	case vertex_semantic::position:
+		return "POSITION";
+	case vertex_semantic::normal:
+		return "NORMAL";
+	case vertex_semantic::texcoord:
+		return "TEXCOORD";
+	case vertex_semantic::color:
+		return "COLOR";
+	case vertex_semantic::tangent:
+		return "TANGENT";
+	}
+	return "";
+}
+
+#if defined(_ENABLE_D3D11) || defined(_ENABLE_D3D12) || __has_include(<dxgiformat.h>)
+//! \brief DXGI_FORMAT
+[[nodiscard]] constexpr DXGI_FORMAT to_dxgi_format(vertex_format format) noexcept
+{
+	switch (format) {
+	case vertex_format::float32x2:
+		return DXGI_FORMAT_R32G32_FLOAT;
+	case vertex_format::float32x3:
+		return DXGI_FORMAT_R32G32B32_FLOAT;
+	case vertex_format::float32x4:
+		return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	case vertex_format::float16x2:
+		return DXGI_FORMAT_R16G16_FLOAT;
+	case vertex_format::float16x4:
+		return DXGI_FORMAT_R16G16B16A16_FLOAT;
+	case vertex_format::snorm16x2:
+		return DXGI_FORMAT_R16G16_SNORM;
+	case vertex_format::unorm8x4:
+		return DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+	return DXGI_FORMAT_UNKNOWN;
+}
+#endif
+
+//! \brief 頂点フォーマットのレイアウト定義
+//!
+//! elements に要素をオフセット順に定義して特殊化します。
+//! 量子化フォーマットには変換元の source_type を、量子化フォーマットを持つ元のフォーマットには packed_type を定義します。
+template<class V>
+struct vertex_traits;
+
+template<>
+struct vertex_traits<vertex_p>
+{
+	using packed_type = packed_vertex_p;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3, 0 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_pc>
+{
+	using packed_type = packed_vertex_pc;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element {    vertex_semantic::color, vertex_format::float32x4, 12 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_pu>
+{
+	using packed_type = packed_vertex_pu;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float32x2, 12 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_puc>
+{
+	using packed_type = packed_vertex_puc;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float32x2, 12 },
+		vertex_element {    vertex_semantic::color, vertex_format::float32x4, 20 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_pn>
+{
+	using packed_type = packed_vertex_pn;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element {   vertex_semantic::normal, vertex_format::float32x3, 12 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_pnu>
+{
+	using packed_type = packed_vertex_pnu;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element {   vertex_semantic::normal, vertex_format::float32x3, 12 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float32x2, 24 },
+	};
+};
+
+template<>
+struct vertex_traits<vertex_pntu>
+{
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float32x3,  0 },
+		vertex_element {   vertex_semantic::normal, vertex_format::float32x3, 12 },
+		vertex_element {  vertex_semantic::tangent, vertex_format::float32x4, 24 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float32x2, 40 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_p>
+{
+	using source_type = vertex_p;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4, 0 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_pc>
+{
+	using source_type = vertex_pc;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4, 0 },
+		vertex_element {    vertex_semantic::color,  vertex_format::unorm8x4, 8 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_pu>
+{
+	using source_type = vertex_pu;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4, 0 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float16x2, 8 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_puc>
+{
+	using source_type = vertex_puc;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4,  0 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float16x2,  8 },
+		vertex_element {    vertex_semantic::color,  vertex_format::unorm8x4, 12 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_pn>
+{
+	using source_type = vertex_pn;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4, 0 },
+		vertex_element {   vertex_semantic::normal, vertex_format::snorm16x2, 8 },
+	};
+};
+
+template<>
+struct vertex_traits<packed_vertex_pnu>
+{
+	using source_type = vertex_pnu;
+
+	static constexpr std::array elements = {
+		vertex_element { vertex_semantic::position, vertex_format::float16x4,  0 },
+		vertex_element {   vertex_semantic::normal, vertex_format::snorm16x2,  8 },
+		vertex_element { vertex_semantic::texcoord, vertex_format::float16x2, 12 },
+	};
+};
+
+//! \brief 量子化フォーマット
+template<class V>
+using packed_vertex_t = typename vertex_traits<V>::packed_type;
+
+//! \brief 量子化フォーマットの変換元
+template<class V>
+using source_vertex_t = typename vertex_traits<V>::source_type;
+
+//! \brief elements から求めた頂点のバイトサイズ
+template<class V>
+[[nodiscard]] constexpr uint32_t vertex_stride() noexcept
+{
+	const auto& last = vertex_traits<V>::elements.back();
+	return last.offset + format_size(last.format);
+}
+
+//! \brief semantic の要素を持つか
+template<class V>
+[[nodiscard]] constexpr bool has_semantic(vertex_semantic semantic) noexcept
+{
+	for (const auto& e : vertex_traits<V>::elements) {
+		if (e.semantic == semantic) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//! \brief 頂点ストリームの構成
+enum class vertex_streams : uint8_t
+{
+	interleaved,    //!< 全ての要素をスロット 0 に置きます
+	split_position, //!< 位置をスロット 0、それ以外の要素をスロット 1 に詰めて置きます
+};
+
+//! \brief 入力スロットを指定した頂点要素
+struct vertex_input_element
+{
+	vertex_semantic semantic;
+	vertex_format   format;
+	uint32_t        slot;
+	uint32_t        offset; //!< スロットの頂点先頭からのバイトオフセット
+};
+
+//! \brief 位置の要素のバイトサイズ
+//!
+//! 位置は全てのフォーマットで先頭の要素です。
+template<class V>
+[[nodiscard]] constexpr uint32_t position_size() noexcept
+{
+	constexpr auto& position = vertex_traits<V>::elements.front();
+	static_assert(position.semantic == vertex_semantic::position && position.offset == 0);
+	return format_size(position.format);
+}
+
+//! \brief 入力スロットの頂点のバイトサイズ (使用しないスロットは 0)
+template<class V>
+[[nodiscard]] constexpr uint32_t stream_stride(vertex_streams streams, uint32_t slot) noexcept
+{
+	if (streams == vertex_streams::interleaved) {
+		return slot == 0 ? vertex_stride<V>() : 0;
+	}
+	switch (slot) {
+	case 0:
+		return position_size<V>();
+	case 1:
+		return vertex_stride<V>() - position_size<V>();
+	}
+	return 0;
+}
+
+//! \brief 入力レイアウトの要素
+//!
+//! split_position では位置以外の要素のオフセットを位置のサイズだけ詰めます。
+template<class V>
+[[nodiscard]] constexpr auto input_elements(vertex_streams streams) noexcept
+{
+	constexpr auto& elements = vertex_traits<V>::elements;
+
+	std::array<vertex_input_element, elements.size()> out = {};
+	for (size_t i = 0; i < elements.size(); ++i) {
+		const bool split = streams == vertex_streams::split_position && i > 0;
+		out[i].semantic  = elements[i].semantic;
+		out[i].format    = elements[i].format;
+		out[i].slot      = split ? 1 : 0;
+		out[i].offset    = split ? elements[i].offset - position_size<V>() : elements[i].offset;
+	}
+	return out;
+}
+
+//! \brief 位置だけを読むパス (深度プリパス、シャドウ) の入力レイアウトの要素
+//!
+//! どちらの構成でも位置はスロット 0 の先頭にあるので、スロット 0 のストライドだけが異なります。
+template<class V>
+[[nodiscard]] constexpr std::array<vertex_input_element, 1> position_input_elements() noexcept
+{
+	constexpr auto& position = vertex_traits<V>::elements.front();
+	return { vertex_input_element { position.semantic, position.format, 0, 0 } };
+}
+
+namespace detail {
+
+template<class V>
+constexpr bool validate_layout() noexcept
+{
+	uint32_t offset = 0;
+	for (const auto& e : vertex_traits<V>::elements) {
+		if (e.offset != offset) {
+			return false;
+		}
+		offset += format_size(e.format);
+	}
+	return offset == sizeof(V);
+}
+
+static_assert(validate_layout<vertex_p>() && validate_layout<vertex_pc>() && validate_layout<vertex_pu>());
+static_assert(validate_layout<vertex_puc>() && validate_layout<vertex_pn>() && validate_layout<vertex_pnu>() && validate_layout<vertex_pntu>());
+static_assert(validate_layout<packed_vertex_p>() && validate_layout<packed_vertex_pc>() && validate_layout<packed_vertex_pu>());
+static_assert(validate_layout<packed_vertex_puc>() && validate_layout<packed_vertex_pn>() && validate_layout<packed_vertex_pnu>());
+
+} // namespace detail
+
+} // namespace geometry
+} // namespace dxlib
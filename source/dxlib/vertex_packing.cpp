@@ -0,0 +1,300 @@
+#include "vertex_packing.h"
+
+#include <cstring>
+
+#include "debug.h"
+#include "simd.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+using namespace dxlib::math::simd;
+
+template<class V>
+constexpr bool has_normal = has_semantic<V>(vertex_semantic::normal);
+
+template<class V>
+constexpr bool has_uv = has_semantic<V>(vertex_semantic::texcoord);
+
+template<class V>
+constexpr bool has_color = has_semantic<V>(vertex_semantic::color);
+
+// --- 1 頂点ずつ (端数処理) ---
+
+template<class In, class Out>
+void pack_one(const In& in, Out& out) noexcept
+{
+	out.position = {
+		dxlib::math::float_to_half(in.position.x),
+		dxlib::math::float_to_half(in.position.y),
+		dxlib::math::float_to_half(in.position.z),
+		dxlib::math::float_to_half(1.0f)
+	};
+	if constexpr (has_normal<In>) {
+		out.normal = encode_octahedral(in.normal);
+	}
+	if constexpr (has_uv<In>) {
+		out.uv = { dxlib::math::float_to_half(in.uv.x), dxlib::math::float_to_half(in.uv.y) };
+	}
+	if constexpr (has_color<In>) {
+		out.color = encode_color(in.color);
+	}
+}
+
+template<class In, class Out>
+void unpack_one(const In& in, Out& out) noexcept
+{
+	out.position = {
+		dxlib::math::half_to_float(in.position.x),
+		dxlib::math::half_to_float(in.position.y),
+		dxlib::math::half_to_float(in.position.z)
+	};
+	if constexpr (has_normal<In>) {
+		out.normal = decode_octahedral(in.normal);
+	}
+	if constexpr (has_uv<In>) {
+		out.uv = { dxlib::math::half_to_float(in.uv.x), dxlib::math::half_to_float(in.uv.y) };
+	}
+	if constexpr (has_color<In>) {
+		out.color = decode_color(in.color);
+	}
+}
+
+// --- 4 頂点ずつ ---
+//
+// 入力の float3 / float2 は 16 バイト単位でロードするため、次の頂点の先頭まで読み込みます。
+// 呼び出し側は後続の頂点が存在する範囲 (i + 4 < n) でのみ使用します。
+
+// SoA の単位ベクトル x4 を八面体エンコードし、(x0, y0, x1, y1, ...) の順に並べた snorm16 x8 を書き込みます
+void encode_octahedral4(vfloat4 x, vfloat4 y, vfloat4 z, int16_t* out) noexcept
+{
+	const vfloat4 sign_mask = vsplat4(-0.0f);
+	const vfloat4 one       = vsplat4(1.0f);
+
+	const vfloat4 sum = vmax(vadd(vadd(vabs(x), vabs(y)), vabs(z)), vsplat4(1e-30f));
+	const vfloat4 inv = vdiv(one, sum);
+	vfloat4       px  = vmul(x, inv);
+	vfloat4       py  = vmul(y, inv);
+
+	// 下半球は対角線で折り返します
+	const vfloat4 fx = vmul(vsub(one, vabs(py)), vor(vand(px, sign_mask), one));
+	const vfloat4 fy = vmul(vsub(one, vabs(px)), vor(vand(py, sign_mask), one));
+	const vfloat4 lo = vcmplt(z, vzero4());
+	px               = vselect(lo, fx, px);
+	py               = vselect(lo, fy, py);
+
+	const vfloat4 scale = vsplat4(32767.0f);
+	px                  = vmul(px, scale);
+	py                  = vmul(py, scale);
+	const vfloat4 t     = vshuffle<0, 1, 0, 1>(px, py);
+	const vfloat4 u     = vshuffle<2, 3, 2, 3>(px, py);
+	vstore_i16x4(out + 0, vshuffle<0, 2, 1, 3>(t, t));
+	vstore_i16x4(out + 4, vshuffle<0, 2, 1, 3>(u, u));
+}
+
+// (x0, y0, x1, y1, ...) の snorm16 x8 を SoA の単位ベクトル x4 に復元します
+void decode_octahedral4(const int16_t* in, vfloat4& x, vfloat4& y, vfloat4& z) noexcept
+{
+	const vfloat4 scale = vsplat4(1.0f / 32767.0f);
+	const vfloat4 neg   = vsplat4(-1.0f);
+	const vfloat4 a     = vmax(vmul(vload_i16x4(in + 0), scale), neg);
+	const vfloat4 b     = vmax(vmul(vload_i16x4(in + 4), scale), neg);
+	x                   = vshuffle<0, 2, 0, 2>(a, b);
+	y                   = vshuffle<1, 3, 1, 3>(a, b);
+	z                   = vsub(vsub(vsplat4(1.0f), vabs(x)), vabs(y));
+
+	const vfloat4 sign_mask = vsplat4(-0.0f);
+	const vfloat4 t         = vmax(vneg(z), vzero4());
+	x                       = vsub(x, vor(t, vand(x, sign_mask)));
+	y                       = vsub(y, vor(t, vand(y, sign_mask)));
+
+	const vfloat4 inv_len = vdiv(vsplat4(1.0f), vsqrt(vmadd(z, z, vmadd(y, y, vmul(x, x)))));
+	x                     = vmul(x, inv_len);
+	y                     = vmul(y, inv_len);
+	z                     = vmul(z, inv_len);
+}
+
+template<class In, class Out>
+void pack4(const In* in, Out* out) noexcept
+{
+	const vfloat4 one = vsplat4(1.0f);
+	uint16_t      half[4];
+
+	for (int k = 0; k < 4; ++k) {
+		// (x, y, z, 1)
+		const vfloat4 p = vload4(&in[k].position.x);
+		vstore_half4(half, vshuffle<0, 1, 0, 2>(p, vshuffle<2, 2, 0, 0>(p, one)));
+		std::memcpy(&out[k].position, half, sizeof(half4));
+	}
+
+	if constexpr (has_normal<In>) {
+		vfloat4 x = vload4(&in[0].normal.x);
+		vfloat4 y = vload4(&in[1].normal.x);
+		vfloat4 z = vload4(&in[2].normal.x);
+		vfloat4 w = vload4(&in[3].normal.x);
+		vtranspose(x, y, z, w);
+
+		int16_t encoded[8];
+		encode_octahedral4(x, y, z, encoded);
+		for (int k = 0; k < 4; ++k) {
+			std::memcpy(&out[k].normal, &encoded[k * 2], sizeof(snorm16x2));
+		}
+	}
+
+	if constexpr (has_uv<In>) {
+		for (int k = 0; k < 4; k += 2) {
+			vstore_half4(half, vshuffle<0, 1, 0, 1>(vload4(&in[k].uv.x), vload4(&in[k + 1].uv.x)));
+			std::memcpy(&out[k].uv, &half[0], sizeof(half2));
+			std::memcpy(&out[k + 1].uv, &half[2], sizeof(half2));
+		}
+	}
+
+	if constexpr (has_color<In>) {
+		const vfloat4 scale = vsplat4(255.0f);
+		for (int k = 0; k < 4; ++k) {
+			// 1 を超える値は 1 に、負の値と NaN は整数変換の飽和で 0 になります (vmin は NaN の場合に第 2 引数を返します)
+			vstore_u8x4(&out[k].color.x, vmul(vmin(one, vload4(&in[k].color.x)), scale));
+		}
+	}
+}
+
+template<class In, class Out>
+void unpack4(const In* in, Out* out) noexcept
+{
+	float f[4];
+
+	for (int k = 0; k < 4; ++k) {
+		vstore4(f, vload_half4(&in[k].position.x));
+		std::memcpy(&out[k].position, f, sizeof(float3));
+	}
+
+	if constexpr (has_normal<In>) {
+		int16_t encoded[8];
+		for (int k = 0; k < 4; ++k) {
+			std::memcpy(&encoded[k * 2], &in[k].normal, sizeof(snorm16x2));
+		}
+
+		vfloat4 x, y, z;
+		decode_octahedral4(encoded, x, y, z);
+
+		float n[12];
+		vstore_aos3(n, x, y, z);
+		for (int k = 0; k < 4; ++k) {
+			std::memcpy(&out[k].normal, &n[k * 3], sizeof(float3));
+		}
+	}
+
+	if constexpr (has_uv<In>) {
+		for (int k = 0; k < 4; k += 2) {
+			uint16_t half[4];
+			std::memcpy(&half[0], &in[k].uv, sizeof(half2));
+			std::memcpy(&half[2], &in[k + 1].uv, sizeof(half2));
+			vstore4(f, vload_half4(half));
+			std::memcpy(&out[k].uv, &f[0], sizeof(float2));
+			std::memcpy(&out[k + 1].uv, &f[2], sizeof(float2));
+		}
+	}
+
+	if constexpr (has_color<In>) {
+		const vfloat4 scale = vsplat4(1.0f / 255.0f);
+		for (int k = 0; k < 4; ++k) {
+			vstore4(&out[k].color.x, vmul(vload_u8x4(&in[k].color.x), scale));
+		}
+	}
+}
+
+template<class In, class Out>
+void pack_impl(std::span<const In> in, std::span<Out> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= in.size());
+
+	size_t i = 0;
+	for (; i + 4 < in.size(); i += 4) {
+		pack4(&in[i], &out[i]);
+	}
+	for (; i < in.size(); ++i) {
+		pack_one(in[i], out[i]);
+	}
+}
+
+template<class In, class Out>
+void unpack_impl(std::span<const In> in, std::span<Out> out) noexcept
+{
+	ASSERT_RETURN(out.size() >= in.size());
+
+	size_t i = 0;
+	for (; i + 4 <= in.size(); i += 4) {
+		unpack4(&in[i], &out[i]);
+	}
+	for (; i < in.size(); ++i) {
+		unpack_one(in[i], out[i]);
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+void pack(std::span<const vertex_p> in, std::span<packed_vertex_p> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void pack(std::span<const vertex_pc> in, std::span<packed_vertex_pc> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void pack(std::span<const vertex_pu> in, std::span<packed_vertex_pu> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void pack(std::span<const vertex_puc> in, std::span<packed_vertex_puc> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void pack(std::span<const vertex_pn> in, std::span<packed_vertex_pn> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void pack(std::span<const vertex_pnu> in, std::span<packed_vertex_pnu> out) noexcept
+{
+	pack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_p> in, std::span<vertex_p> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_pc> in, std::span<vertex_pc> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_pu> in, std::span<vertex_pu> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_puc> in, std::span<vertex_puc> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_pn> in, std::span<vertex_pn> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+void unpack(std::span<const packed_vertex_pnu> in, std::span<vertex_pnu> out) noexcept
+{
+	unpack_impl(in, out);
+}
+
+} // namespace geometry
+} // namespace dxlib
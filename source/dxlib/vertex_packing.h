@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <cmath>
+#include <span>
+
+#include "half.h"
+#include "vertex.h"
+#include "vertex_layout.h"
+
+namespace dxlib {
+namespace geometry {
+
+// --- scalar ---
+
+//! \brief 単位ベクトルを八面体エンコードします
+//!
+//! 単位球を八面体に射影して [-1, 1]^2 に展開し、snorm16 に量子化します。
+//! 復元後の角度誤差は最大 0.005 度程度です。長さ 0 のベクトルは (0, 0, 1) として扱います。
+[[nodiscard]] inline snorm16x2 encode_octahedral(const float3& n) noexcept
+{
+	const float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	const float inv = 1.0f / (sum > 1e-30f ? sum : 1e-30f);
+	float       x   = n.x * inv;
+	float       y   = n.y * inv;
+	if (n.z < 0.0f) {
+		const float ox = x;
+		x              = (1.0f - std::abs(y)) * std::copysign(1.0f, ox);
+		y              = (1.0f - std::abs(ox)) * std::copysign(1.0f, y);
+	}
+	return { static_cast<int16_t>(std::nearbyint(x * 32767.0f)), static_cast<int16_t>(std::nearbyint(y * 32767.0f)) };
+}
+
+//! \brief 八面体エンコードされた単位ベクトルを復元します
+[[nodiscard]] inline float3 decode_octahedral(const snorm16x2& e) noexcept
+{
+	float       x = std::fmax(e.x / 32767.0f, -1.0f);
+	float       y = std::fmax(e.y / 32767.0f, -1.0f);
+	const float z = 1.0f - std::abs(x) - std::abs(y);
+	const float t = std::fmax(-z, 0.0f);
+	x -= std::copysign(t, x);
+	y -= std::copysign(t, y);
+	return normalize(float3(x, y, z));
+}
+
+//! \brief 0 ~ 1 の色を RGBA8 に量子化します
+[[nodiscard]] inline unorm8x4 encode_color(const float4& c) noexcept
+{
+	auto q = [](float v)
+	{
+		v = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+		return static_cast<uint8_t>(std::nearbyint(v * 255.0f));
+	};
+	return { q(c.x), q(c.y), q(c.z), q(c.w) };
+}
+
+//! \brief RGBA8 を 0 ~ 1 の色に戻します
+[[nodiscard]] inline float4 decode_color(const unorm8x4& c) noexcept
+{
+	constexpr float s = 1.0f / 255.0f;
+	return { c.x * s, c.y * s, c.z * s, c.w * s };
+}
+
+// --- batch ---
+//
+// 頂点配列を量子化フォーマットとの間でまとめて変換します。
+// 4 頂点ずつ SIMD で処理し、出力 span は入力と同じ要素数以上が必要です。
+// pack の結果は上のスカラー関数と float_to_half で 1 頂点ずつ変換した結果とビット単位で一致します。
+
+void pack(std::span<const vertex_p> in, std::span<packed_vertex_p> out) noexcept;
+void pack(std::span<const vertex_pc> in, std::span<packed_vertex_pc> out) noexcept;
+void pack(std::span<const vertex_pu> in, std::span<packed_vertex_pu> out) noexcept;
+void pack(std::span<const vertex_puc> in, std::span<packed_vertex_puc> out) noexcept;
+void pack(std::span<const vertex_pn> in, std::span<packed_vertex_pn> out) noexcept;
+void pack(std::span<const vertex_pnu> in, std::span<packed_vertex_pnu> out) noexcept;
+
+void unpack(std::span<const packed_vertex_p> in, std::span<vertex_p> out) noexcept;
+void unpack(std::span<const packed_vertex_pc> in, std::span<vertex_pc> out) noexcept;
+void unpack(std::span<const packed_vertex_pu> in, std::span<vertex_pu> out) noexcept;
+void unpack(std::span<const packed_vertex_puc> in, std::span<vertex_puc> out) noexcept;
+void unpack(std::span<const packed_vertex_pn> in, std::span<vertex_pn> out) noexcept;
+void unpack(std::span<const packed_vertex_pnu> in, std::span<vertex_pnu> out) noexcept;
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,93 @@
+#include "vertex_stream.h"
+
+#include <cstring>
+
+namespace {
+
+using namespace dxlib::geometry;
+
+// サイズが定数の memcpy はロードとストアに展開されるので、既知のフォーマットは専用のループで処理します
+template<uint32_t Stride, uint32_t PositionSize>
+void deinterleave_fixed(const uint8_t* vertices, size_t count, uint8_t* positions, uint8_t* attributes) noexcept
+{
+	constexpr uint32_t attribute_size = Stride - PositionSize;
+	for (size_t i = 0; i < count; ++i) {
+		std::memcpy(positions + i * PositionSize, vertices + i * Stride, PositionSize);
+		std::memcpy(attributes + i * attribute_size, vertices + i * Stride + PositionSize, attribute_size);
+	}
+}
+
+template<uint32_t Stride, uint32_t PositionSize>
+void interleave_fixed(const uint8_t* positions, const uint8_t* attributes, size_t count, uint8_t* vertices) noexcept
+{
+	constexpr uint32_t attribute_size = Stride - PositionSize;
+	for (size_t i = 0; i < count; ++i) {
+		std::memcpy(vertices + i * Stride, positions + i * PositionSize, PositionSize);
+		std::memcpy(vertices + i * Stride + PositionSize, attributes + i * attribute_size, attribute_size);
+	}
+}
+
+// stride と position_size が一致するフォーマットがあれば fn<Stride, PositionSize>() を呼びます
+template<class... V, class Fn>
+bool dispatch_format(uint32_t stride, uint32_t position_size, Fn&& fn) noexcept
+{
+	return ((stride == sizeof(V) && position_size == dxlib::geometry::position_size<V>() && (fn.template operator()<sizeof(V), dxlib::geometry::position_size<V>()>(), true)) || ...);
+}
+
+template<class Fn>
+bool dispatch_known_format(uint32_t stride, uint32_t position_size, Fn&& fn) noexcept
+{
+	return dispatch_format<
+	    vertex_pc, vertex_pu, vertex_puc, vertex_pn, vertex_pnu, vertex_pntu,
+	    packed_vertex_pc, packed_vertex_pu, packed_vertex_puc, packed_vertex_pnu>(stride, position_size, fn);
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+void deinterleave_position(const void* vertices, uint32_t stride, uint32_t position_size, size_t count, void* positions, void* attributes) noexcept
+{
+	ASSERT_RETURN(position_size <= stride);
+
+	const auto in   = static_cast<const uint8_t*>(vertices);
+	const auto pos  = static_cast<uint8_t*>(positions);
+	const auto attr = static_cast<uint8_t*>(attributes);
+
+	const bool known = dispatch_known_format(stride, position_size, [&]<uint32_t Stride, uint32_t PositionSize>()
+	    {
+		    deinterleave_fixed<Stride, PositionSize>(in, count, pos, attr);
+	    });
+	if (!known) {
+		const uint32_t attribute_size = stride - position_size;
+		for (size_t i = 0; i < count; ++i) {
+			std::memcpy(pos + i * position_size, in + i * stride, position_size);
+			std::memcpy(attr + i * attribute_size, in + i * stride + position_size, attribute_size);
+		}
+	}
+}
+
+void interleave_position(const void* positions, const void* attributes, uint32_t stride, uint32_t position_size, size_t count, void* vertices) noexcept
+{
+	ASSERT_RETURN(position_size <= stride);
+
+	const auto pos  = static_cast<const uint8_t*>(positions);
+	const auto attr = static_cast<const uint8_t*>(attributes);
+	const auto out  = static_cast<uint8_t*>(vertices);
+
+	const bool known = dispatch_known_format(stride, position_size, [&]<uint32_t Stride, uint32_t PositionSize>()
+	    {
+		    interleave_fixed<Stride, PositionSize>(pos, attr, count, out);
+	    });
+	if (!known) {
+		const uint32_t attribute_size = stride - position_size;
+		for (size_t i = 0; i < count; ++i) {
+			std::memcpy(out + i * stride, pos + i * position_size, position_size);
+			std::memcpy(out + i * stride + position_size, attr + i * attribute_size, attribute_size);
+		}
+	}
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "debug.h"
+#include "vertex_layout.h"
+
+namespace dxlib {
+namespace geometry {
+
+// 位置ストリームの分割
+//
+// 深度プリパスやシャドウのパスは位置しか読まないので、インターリーブされた頂点では
+// 1 頂点あたり stride バイトのうち位置の 12 バイト (量子化フォーマットでは 8 バイト) しか使いません。
+// 位置を別のストリーム (スロット 0) に詰めると、これらのパスの頂点フェッチは position_size / stride に減り、
+// 通常のパスはスロット 0 と 1 の両方をバインドして読みます (vertex_streams::split_position)。
+//
+// 出力は先頭から順に書き込むだけで読み戻さないので、Map した upload ヒープ (write-combined) を渡せます。
+
+//! \brief インターリーブされた頂点を位置ストリームと属性ストリームに分けます
+//!
+//! \param[in]  vertices      頂点配列の先頭
+//! \param[in]  stride        頂点のバイトサイズ
+//! \param[in]  position_size 頂点先頭の位置のバイトサイズ
+//! \param[in]  count         頂点数
+//! \param[out] positions     count * position_size バイト以上
+//! \param[out] attributes    count * (stride - position_size) バイト以上
+void deinterleave_position(const void* vertices, uint32_t stride, uint32_t position_size, size_t count, void* positions, void* attributes) noexcept;
+
+//! \brief 位置ストリームと属性ストリームをインターリーブされた頂点に戻します
+//!
+//! \param[in]  positions     count * position_size バイト以上
+//! \param[in]  attributes    count * (stride - position_size) バイト以上
+//! \param[in]  stride        頂点のバイトサイズ
+//! \param[in]  position_size 頂点先頭の位置のバイトサイズ
+//! \param[in]  count         頂点数
+//! \param[out] vertices      count * stride バイト以上
+void interleave_position(const void* positions, const void* attributes, uint32_t stride, uint32_t position_size, size_t count, void* vertices) noexcept;
+
+//! \copydoc deinterleave_position(const void*, uint32_t, uint32_t, size_t, void*, void*)
+template<class V>
+void deinterleave_position(std::span<const V> vertices, void* positions, void* attributes) noexcept
+{
+	deinterleave_position(vertices.data(), sizeof(V), position_size<V>(), vertices.size(), positions, attributes);
+}
+
+//! \copydoc interleave_position(const void*, const void*, uint32_t, uint32_t, size_t, void*)
+template<class V>
+void interleave_position(const void* positions, const void* attributes, std::span<V> vertices) noexcept
+{
+	interleave_position(positions, attributes, sizeof(V), position_size<V>(), vertices.size(), vertices.data());
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,208 @@
+#include "vertex_weld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "debug.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+constexpr uint32_t empty = ~0u;
+
+// 4 バイト単位のキーのハッシュ
+uint64_t hash_key(const uint8_t* key, size_t words) noexcept
+{
+	uint64_t h = 0x9E3779B97F4A7C15ull ^ words;
+	for (size_t i = 0; i < words; ++i) {
+		uint32_t w;
+		std::memcpy(&w, key + i * 4, 4);
+		h = (h ^ w) * 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 29;
+	}
+	h ^= h >> 32;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 29;
+	return h;
+}
+
+// キー (stride バイト、4 バイト単位) が等しい頂点に同じ番号を割り当てます
+// 表は頂点数の 2 倍以上の 2 のべき乗で、線形探索で衝突を解決します
+uint32_t build_remap(const uint8_t* keys, size_t stride, size_t count, uint32_t* remap)
+{
+	const size_t words = stride / 4;
+
+	size_t capacity = 16;
+	while (capacity < count * 2) {
+		capacity *= 2;
+	}
+	const size_t          mask = capacity - 1;
+	std::vector<uint32_t> table(capacity, empty);
+
+	uint32_t unique = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const uint8_t* key  = keys + i * stride;
+		size_t         slot = static_cast<size_t>(hash_key(key, words)) & mask;
+		for (;;) {
+			const uint32_t v = table[slot];
+			if (v == empty) {
+				table[slot] = static_cast<uint32_t>(i);
+				remap[i]    = unique++;
+				break;
+			}
+			if (std::memcmp(keys + v * stride, key, stride) == 0) {
+				remap[i] = remap[v];
+				break;
+			}
+			slot = (slot + 1) & mask;
+		}
+	}
+	return unique;
+}
+
+// epsilon 間隔に量子化した値
+// 範囲外の値と無限大は ±2^62 に飽和させ、NaN は他の値と重ならない範囲にビット列をそのまま割り当てます
+int64_t quantize(float v, double scale) noexcept
+{
+	if (std::isnan(v)) {
+		uint32_t bits;
+		std::memcpy(&bits, &v, 4);
+		return INT64_MIN + bits;
+	}
+	constexpr double limit = 0x1p62;
+	return static_cast<int64_t>(std::floor(std::clamp(static_cast<double>(v) * scale, -limit, limit) + 0.5));
+}
+
+// 比較に使うキーを作ります
+// float32 の要素は -0 を +0 に揃え、epsilon が 0 より大きい要素は epsilon 間隔の int64 に量子化します。
+// 量子化した値の下位 32 ビットは要素の位置に、上位 32 ビットは頂点の後ろに追加した領域に書き込みます。
+// それ以外のバイトはそのままコピーします。float32 の要素がない場合は空の配列を返します。
+std::vector<uint8_t> make_keys(const uint8_t* vertices, size_t stride, size_t count, std::span<const vertex_element> layout, const weld_options& options, size_t& key_stride)
+{
+	struct range
+	{
+		uint32_t offset;
+		uint32_t count;
+		double   scale;       // 0 の場合は量子化しません
+		uint32_t high_offset; // 量子化した値の上位 32 ビットの位置
+	};
+	std::vector<range> ranges;
+	key_stride = stride;
+	for (const vertex_element& e : layout) {
+		uint32_t components = 0;
+		switch (e.format) {
+		case vertex_format::float32x2:
+			components = 2;
+			break;
+		case vertex_format::float32x3:
+			components = 3;
+			break;
+		case vertex_format::float32x4:
+			components = 4;
+			break;
+		default:
+			break;
+		}
+		if (components == 0) {
+			continue;
+		}
+		const float eps = e.semantic == vertex_semantic::position ? options.position_epsilon : options.attribute_epsilon;
+		if (eps > 0.0f) {
+			ranges.push_back({ e.offset, components, 1.0 / eps, static_cast<uint32_t>(key_stride) });
+			key_stride += components * 4;
+		}
+		else {
+			ranges.push_back({ e.offset, components, 0.0, 0 });
+		}
+	}
+	if (ranges.empty()) {
+		return {};
+	}
+
+	// 量子化しない場合、-0 を含まなければ頂点のバイト列をそのままキーにします
+	if (key_stride == stride) {
+		bool negative_zero = false;
+		for (size_t i = 0; i < count && !negative_zero; ++i) {
+			for (const range& r : ranges) {
+				for (uint32_t c = 0; c < r.count; ++c) {
+					uint32_t bits;
+					std::memcpy(&bits, vertices + i * stride + r.offset + c * 4, 4);
+					negative_zero |= bits == 0x80000000u;
+				}
+			}
+		}
+		if (!negative_zero) {
+			return {};
+		}
+	}
+
+	std::vector<uint8_t> keys(key_stride * count);
+	for (size_t i = 0; i < count; ++i) {
+		uint8_t* key = keys.data() + i * key_stride;
+		std::memcpy(key, vertices + i * stride, stride);
+		for (const range& r : ranges) {
+			for (uint32_t c = 0; c < r.count; ++c) {
+				uint8_t* word = key + r.offset + c * 4;
+				if (r.scale > 0.0) {
+					float v;
+					std::memcpy(&v, word, 4);
+					const uint64_t q    = static_cast<uint64_t>(quantize(v, r.scale));
+					const uint32_t low  = static_cast<uint32_t>(q);
+					const uint32_t high = static_cast<uint32_t>(q >> 32);
+					std::memcpy(word, &low, 4);
+					std::memcpy(key + r.high_offset + c * 4, &high, 4);
+				}
+				else {
+					uint32_t bits;
+					std::memcpy(&bits, word, 4);
+					if (bits == 0x80000000u) {
+						bits = 0;
+						std::memcpy(word, &bits, 4);
+					}
+				}
+			}
+		}
+	}
+	return keys;
+}
+
+template<class Index>
+void remap_indices_impl(std::span<Index> indices, std::span<const uint32_t> remap) noexcept
+{
+	for (Index& i : indices) {
+		i = static_cast<Index>(remap[i]);
+	}
+}
+
+} // namespace
+
+namespace dxlib {
+namespace geometry {
+
+uint32_t generate_weld_remap(const void* vertices, uint32_t stride, size_t count, std::span<const vertex_element> layout, std::span<uint32_t> remap, const weld_options& options)
+{
+	ASSERT_RETURN(stride % 4 == 0 && remap.size() >= count, 0);
+
+	const uint8_t*             data = static_cast<const uint8_t*>(vertices);
+	size_t                     key_stride;
+	const std::vector<uint8_t> keys = make_keys(data, stride, count, layout, options, key_stride);
+	if (!keys.empty()) {
+		return build_remap(keys.data(), key_stride, count, remap.data());
+	}
+	return build_remap(data, stride, count, remap.data());
+}
+
+void remap_indices(std::span<uint16_t> indices, std::span<const uint32_t> remap) noexcept
+{
+	remap_indices_impl(indices, remap);
+}
+
+void remap_indices(std::span<uint32_t> indices, std::span<const uint32_t> remap) noexcept
+{
+	remap_indices_impl(indices, remap);
+}
+
+} // namespace geometry
+} // namespace dxlib
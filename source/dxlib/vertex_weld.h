@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "vertex_layout.h"
+
+namespace dxlib {
+namespace geometry {
+
+// 頂点の溶接 (重複頂点の統合)
+//
+// 頂点のバイト列 (または量子化した値) をキーにしたオープンアドレス法のハッシュ表で、同じ頂点に同じ番号を割り当てます。
+// 番号は最初に出現した順で、統合後の頂点はその番号の最初の頂点です。
+
+//! \brief 溶接の設定
+//!
+//! epsilon が 0 の要素はビット単位で比較します。ただし float32 の要素では -0 と +0 を同じ値として扱います。
+//! 0 より大きい場合は float32 の要素を epsilon 間隔に量子化した値 (64 ビット整数) で比較します。
+//! 量子化の境界をまたぐ 2 つの頂点は、差が epsilon 未満でも統合されません。
+//! 量子化した値が ±2^62 を超える要素はその値に飽和させるので、epsilon * 2^62 より遠い頂点は区別されません。
+struct weld_options
+{
+	float position_epsilon  = 0.0f; //!< position の許容誤差
+	float attribute_epsilon = 0.0f; //!< position 以外 (normal, texcoord, color) の許容誤差
+};
+
+//! \brief 溶接の対応表を作ります
+//!
+//! \param[in]  vertices 頂点配列の先頭
+//! \param[in]  stride   頂点のバイトサイズ
+//! \param[in]  count    頂点数
+//! \param[in]  layout   頂点の要素 (epsilon を使用する場合の要素の判定に使用します)
+//! \param[out] remap    remap[i] = 統合後の頂点番号、count 要素以上
+//! \param[in]  options
+//! \return 統合後の頂点数
+uint32_t generate_weld_remap(const void* vertices, uint32_t stride, size_t count, std::span<const vertex_element> layout, std::span<uint32_t> remap, const weld_options& options = {});
+
+//! \copydoc generate_weld_remap(const void*, uint32_t, size_t, std::span<const vertex_element>, std::span<uint32_t>, const weld_options&)
+template<class V>
+uint32_t generate_weld_remap(std::span<const V> vertices, std::span<uint32_t> remap, const weld_options& options = {})
+{
+	return generate_weld_remap(vertices.data(), sizeof(V), vertices.size(), vertex_traits<V>::elements, remap, options);
+}
+
+//! \brief indices[i] = remap[indices[i]]
+void remap_indices(std::span<uint16_t> indices, std::span<const uint32_t> remap) noexcept;
+void remap_indices(std::span<uint32_t> indices, std::span<const uint32_t> remap) noexcept;
+
+//! \brief generate_weld_remap の対応表で頂点配列をその場で詰めます
+//!
+//! 各番号の最初の頂点を残します。番号は出現順なので前から順に移動するだけで済みます。
+//!
+//! \return 統合後の頂点数
+template<class V>
+uint32_t compact_vertices(std::span<V> vertices, std::span<const uint32_t> remap) noexcept
+{
+	uint32_t count = 0;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		if (remap[i] == count) {
+			vertices[count++] = vertices[i];
+		}
+	}
+	return count;
+}
+
+//! \brief 頂点とインデックスを溶接します
+//!
+//! vertices は先頭から戻り値の要素数に詰められ、indices は詰めた後の番号に書き換えられます。
+//!
+//! \return 統合後の頂点数
+template<class V, class Index>
+uint32_t weld_vertices(std::span<V> vertices, std::span<Index> indices, const weld_options& options = {})
+{
+	std::vector<uint32_t> remap(vertices.size());
+	generate_weld_remap(std::span<const V>(vertices), std::span<uint32_t>(remap), options);
+	remap_indices(indices, remap);
+	return compact_vertices(vertices, std::span<const uint32_t>(remap));
+}
+
+} // namespace geometry
+} // namespace dxlib
@@ -0,0 +1,153 @@
+// asset_cooker
+//
+// asset/ ディレクトリ以下のソースを実行時の形式に変換します。変更のあったソースと、
+// 変更のあったファイルに (#include で) 依存するソースだけを全てのコアで並列に変換します。
+//
+//   asset_cooker <asset directory> <output directory> [--force] [--copy <extension>]...
+//
+//   --force 前回の結果によらず全て変換します
+//   --copy  指定した拡張子のファイルをそのままコピーします (asset_packer でまとめる場合など)
+//
+// 規則
+//   *_vs.hlsl, *_ps.hlsl, ... : D3DCompile で .cso にコンパイルします (Windows のみ)
+//                               create_*_shader_from_hlsl に .cso を渡すとコンパイルせずに読み込みます。
+//
+// app のシーンは asset_cooker ../../asset ../../cooked の出力 (../../cooked/shader/*.cso) があれば読み込み、
+// 無ければ asset/shader/*.hlsl を起動時にコンパイルします。
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#endif
+
+#include "dxlib/asset_cooker.h"
+#include "dxlib/thread_pool.h"
+
+namespace {
+
+#if defined(_WIN32)
+// シェーダーモデル 5.0、エントリーポイント main でコンパイルします
+constexpr const char* shader_entry_point = "main";
+constexpr UINT        shader_flags       = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+
+// ファイル名の末尾 (_vs など) からプロファイルを決めます
+const char* shader_profile(const std::filesystem::path& source)
+{
+	constexpr const char* profiles[][2] = {
+		{ "_vs", "vs_5_0" },
+		{ "_hs", "hs_5_0" },
+		{ "_ds", "ds_5_0" },
+		{ "_gs", "gs_5_0" },
+		{ "_ps", "ps_5_0" },
+		{ "_cs", "cs_5_0" },
+	};
+	const std::string stem = source.stem().string();
+	for (const auto& profile : profiles) {
+		if (stem.size() > 3 && stem.compare(stem.size() - 3, 3, profile[0]) == 0) {
+			return profile[1];
+		}
+	}
+	return nullptr;
+}
+
+dxlib::cook_rule shader_rule()
+{
+	dxlib::cook_rule rule;
+	rule.name             = "hlsl";
+	rule.parameters       = std::string(shader_entry_point) + ";5_0;" + std::to_string(shader_flags);
+	rule.extensions       = { ".hlsl" };
+	rule.output_extension = ".cso";
+	rule.scan             = dxlib::scan_hlsl_includes;
+	rule.cook             = [](const std::filesystem::path& source, std::span<const uint8_t> data, std::vector<uint8_t>& output)
+	{
+		const char* profile = shader_profile(source);
+		if (!profile) {
+			std::fprintf(stderr, "%s: unknown shader stage.\n", source.string().c_str());
+			return false;
+		}
+
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+		Microsoft::WRL::ComPtr<ID3DBlob> error;
+
+		HRESULT hr = D3DCompile(
+		    data.data(),
+		    data.size(),
+		    source.string().c_str(),
+		    nullptr,
+		    D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		    shader_entry_point,
+		    profile,
+		    shader_flags,
+		    0,
+		    blob.GetAddressOf(),
+		    error.GetAddressOf());
+		if (FAILED(hr)) {
+			if (error) {
+				std::fprintf(stderr, "%s", static_cast<const char*>(error->GetBufferPointer()));
+			}
+			return false;
+		}
+
+		const auto* bytes = static_cast<const uint8_t*>(blob->GetBufferPointer());
+		output.assign(bytes, bytes + blob->GetBufferSize());
+		return true;
+	};
+	return rule;
+}
+#endif
+
+int usage()
+{
+	std::fprintf(stderr, "usage: asset_cooker <asset directory> <output directory> [--force] [--copy <extension>]...\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) {
+		return usage();
+	}
+
+	dxlib::cook_options      options;
+	std::vector<std::string> copy_extensions;
+	for (int i = 3; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--force") == 0) {
+			options.force = true;
+		}
+		else if (std::strcmp(argv[i], "--copy") == 0 && i + 1 < argc) {
+			std::string extension = argv[++i];
+			for (char& c : extension) {
+				c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+			}
+			copy_extensions.push_back(extension.starts_with('.') ? extension : '.' + extension);
+		}
+		else {
+			return usage();
+		}
+	}
+
+	dxlib::asset_cooker cooker;
+#if defined(_WIN32)
+	cooker.add_rule(shader_rule());
+#endif
+	if (!copy_extensions.empty()) {
+		cooker.add_rule(dxlib::copy_rule(copy_extensions));
+	}
+
+	const auto report = cooker.cook(argv[1], argv[2], options, &dxlib::thread_pool::shared());
+	std::printf("%u cooked, %u up to date, %u removed, %zu failed\n", report.cooked, report.up_to_date, report.removed, report.failed.size());
+	for (const auto& source : report.failed) {
+		std::fprintf(stderr, "failed: %s\n", source.c_str());
+	}
+
+	return report.failed.empty() ? 0 : 1;
+}
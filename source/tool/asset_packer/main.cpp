@@ -0,0 +1,85 @@
+// asset_packer
+//
+// asset/ ディレクトリ以下のファイルを 1 つのアーカイブにまとめます。
+//
+//   asset_packer <asset directory> <output archive> [--alignment <bytes>] [--store]
+//
+//   --alignment 圧縮しないエントリのデータの配置 (既定は 512)
+//   --store     圧縮せずに格納します
+//
+// 実行時は dxlib::mount_archive(<output archive>, <asset directory>) でマウントすると、
+// <asset directory> 以下のパスに対する load_file がアーカイブから読み込まれます。
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "dxlib/asset_archive.h"
+#include "dxlib/thread_pool.h"
+
+namespace {
+
+int usage()
+{
+	std::fprintf(stderr, "usage: asset_packer <asset directory> <output archive> [--alignment <bytes>] [--store]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) {
+		return usage();
+	}
+
+	const std::filesystem::path input(argv[1]);
+	const std::filesystem::path output(argv[2]);
+	dxlib::archive_options      options;
+	for (int i = 3; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--alignment") == 0 && i + 1 < argc) {
+			options.alignment = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--store") == 0) {
+			options.compress = false;
+		}
+		else {
+			return usage();
+		}
+	}
+	if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0) {
+		std::fprintf(stderr, "alignment must be a power of two.\n");
+		return 1;
+	}
+
+	dxlib::archive_builder builder;
+	if (!builder.add_directory(input.wstring().c_str())) {
+		std::fprintf(stderr, "failed to read %s.\n", argv[1]);
+		return 1;
+	}
+	if (!builder.write(output.wstring().c_str(), options, &dxlib::thread_pool::shared())) {
+		std::fprintf(stderr, "failed to write %s.\n", argv[2]);
+		return 1;
+	}
+
+	// 結果を表示します
+	dxlib::asset_archive archive;
+	if (!archive.open(output.wstring().c_str())) {
+		std::fprintf(stderr, "failed to verify %s.\n", argv[2]);
+		return 1;
+	}
+	uint64_t raw_size   = 0;
+	size_t   compressed = 0;
+	for (const auto& entry : archive.entries()) {
+		raw_size += entry.size;
+		compressed += entry.block_count != 0;
+	}
+	std::printf("%zu entries (%zu compressed), %llu bytes -> %llu bytes\n",
+	    archive.entries().size(),
+	    compressed,
+	    static_cast<unsigned long long>(raw_size),
+	    static_cast<unsigned long long>(std::filesystem::file_size(output)));
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+// async_io_benchmark
+//
+// 複数のファイルの読み込みを、load_file で 1 つずつ読む場合と async_io でまとめて発行する場合で比べます。
+// 読み込んだ内容が書き込んだ内容と一致することも確認します。
+//
+//   async_io_benchmark <work directory> [--files <count>] [--size <KiB>] [--repeat <count>] [--workers <count>] [--queue-depth <count>]
+//
+//   <work directory> 計測用のファイルを作るディレクトリ (終了時に削除します)
+//   --files          ファイル数 (既定は 256)
+//   --size           ファイルごとのサイズ (既定は 1024 KiB)
+//   --repeat         計測の繰り返し回数、最小の時間を表示します (既定は 5)
+//   --workers        async_io_options::worker_count (既定は 4)
+//   --queue-depth    async_io_options::queue_depth (既定は 64)
+//
+// 2 回目以降はページキャッシュから読むので、デバイスの待ち時間を含む計測ではありません。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dxlib/async_io.h"
+#include "dxlib/file.h"
+
+namespace {
+
+//! \brief ファイル i の j バイト目の内容
+uint8_t pattern(size_t i, size_t j)
+{
+	return static_cast<uint8_t>((i * 131 + j * 7 + (j >> 12)) & 0xff);
+}
+
+bool verify(size_t i, const uint8_t* data, size_t size)
+{
+	for (size_t j = 0; j < size; ++j) {
+		if (data[j] != pattern(i, j)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! \brief fn を repeat 回実行した中で最小の時間 (ミリ秒)
+template<class Fn>
+double measure(int repeat, Fn&& fn)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeat; ++i) {
+		const auto begin = std::chrono::steady_clock::now();
+		fn();
+		const auto end = std::chrono::steady_clock::now();
+		best           = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+	}
+	return best;
+}
+
+void report(const char* name, double ms, uint64_t total_bytes, bool passed)
+{
+	std::printf("%-22s %9.2f ms %9.1f MiB/s%s\n", name, ms, static_cast<double>(total_bytes) / (1024.0 * 1024.0) / (ms * 1e-3), passed ? "" : "  FAILED");
+}
+
+//! \brief async_io で全てのファイルをまとめて読みます
+bool read_async(dxlib::async_io& io, const std::vector<std::wstring>& paths, std::vector<std::unique_ptr<uint8_t[]>>& buffers, size_t size)
+{
+	std::vector<dxlib::read_request> requests(paths.size());
+	for (size_t i = 0; i < paths.size(); ++i) {
+		requests[i].path        = paths[i];
+		requests[i].destination = std::span<uint8_t>(buffers[i].get(), size);
+	}
+	bool succeeded = true;
+	for (const dxlib::io_request& request : io.submit(requests)) {
+		const dxlib::io_result result = request.wait();
+		succeeded &= result.status == dxlib::io_status::completed && result.bytes == size;
+	}
+	return succeeded;
+}
+
+int usage()
+{
+	std::fprintf(stderr, "usage: async_io_benchmark <work directory> [--files <count>] [--size <KiB>] [--repeat <count>] [--workers <count>] [--queue-depth <count>]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		return usage();
+	}
+
+	size_t                  file_count = 256;
+	size_t                  size       = 1024 * 1024;
+	int                     repeat     = 5;
+	dxlib::async_io_options options;
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--files") == 0 && i + 1 < argc) {
+			file_count = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			size = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10)) * 1024;
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+			options.worker_count = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--queue-depth") == 0 && i + 1 < argc) {
+			options.queue_depth = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else {
+			return usage();
+		}
+	}
+
+	// 計測用のファイルを作ります
+	const std::filesystem::path directory = std::filesystem::path(argv[1]) / "async_io_benchmark";
+	std::error_code             ec;
+	std::filesystem::create_directories(directory, ec);
+	std::vector<std::wstring> paths(file_count);
+	{
+		std::vector<char> data(size);
+		for (size_t i = 0; i < file_count; ++i) {
+			const std::filesystem::path path = directory / ("file_" + std::to_string(i) + ".bin");
+			for (size_t j = 0; j < size; ++j) {
+				data[j] = static_cast<char>(pattern(i, j));
+			}
+			std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+			stream.write(data.data(), static_cast<std::streamsize>(size));
+			if (!stream) {
+				std::fprintf(stderr, "failed to write %s.\n", path.string().c_str());
+				std::filesystem::remove_all(directory, ec);
+				return 1;
+			}
+			paths[i] = path.wstring();
+		}
+	}
+
+	const uint64_t total_bytes = static_cast<uint64_t>(file_count) * size;
+	std::printf("%zu files x %zu KiB, best of %d\n", file_count, size / 1024, repeat);
+
+	bool passed = true;
+
+	// load_file で 1 つずつ読みます (内容の確認は計測の外で行います)
+	{
+		std::vector<std::unique_ptr<uint8_t[]>> loaded(file_count);
+		bool                                    succeeded = true;
+		auto                                    read      = [&]()
+		{
+			for (size_t i = 0; i < file_count; ++i) {
+				uint64_t file_size = 0;
+				succeeded &= dxlib::load_file(paths[i].c_str(), loaded[i], file_size) && file_size == size;
+			}
+		};
+		const double ms = measure(repeat, read);
+		for (size_t i = 0; i < file_count && succeeded; ++i) {
+			succeeded &= verify(i, loaded[i].get(), size);
+		}
+		report("load_file sequential", ms, total_bytes, succeeded);
+		passed &= succeeded;
+	}
+
+	// async_io でまとめて読みます
+	std::vector<std::unique_ptr<uint8_t[]>> buffers(file_count);
+	for (auto& buffer : buffers) {
+		buffer = std::make_unique<uint8_t[]>(size);
+	}
+	const bool uring_options[] = { true, false };
+	for (const bool use_io_uring : uring_options) {
+		options.use_io_uring = use_io_uring;
+		dxlib::async_io io(options);
+		if (use_io_uring && io.backend() != dxlib::io_backend::io_uring) {
+			std::printf("%-22s unavailable\n", "async_io io_uring");
+			continue;
+		}
+
+		bool succeeded = true;
+		auto read      = [&]()
+		{
+			succeeded &= read_async(io, paths, buffers, size);
+		};
+		const double ms = measure(repeat, read);
+		for (size_t i = 0; i < file_count; ++i) {
+			succeeded &= verify(i, buffers[i].get(), size);
+		}
+		report(use_io_uring ? "async_io io_uring" : "async_io workers", ms, total_bytes, succeeded);
+		passed &= succeeded;
+	}
+
+	std::filesystem::remove_all(directory, ec);
+	return passed ? 0 : 1;
+}
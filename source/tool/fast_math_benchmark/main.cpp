@@ -0,0 +1,338 @@
+// fast_math_benchmark
+//
+// math::fast の関数の誤差を倍精度の <cmath> と比べて検査し、float の <cmath> との速度を比べます。
+// 検査した最大誤差が fast_math.h に記載の上限を超えた場合は 1 を返します。
+//
+//   fast_math_benchmark [--stride <count>] [--pairs <count>] [--repeat <count>]
+//
+//   --stride 1 変数の関数で検査する float のビット列の間隔 (既定は 61、1 で全ての値)
+//   --pairs  atan2 で検査する乱数の組の数 (既定は 10000000)
+//   --repeat 速度の計測の繰り返し回数、最小の時間を表示します (既定は 20)
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "dxlib/fast_math.h"
+
+namespace {
+
+using namespace dxlib::math;
+
+int repeat = 20;
+
+//! \brief got と ref の差を ref の位置での float の ULP で表します
+double ulp_error(float got, double ref)
+{
+	if (std::isnan(ref)) {
+		return std::isnan(got) ? 0.0 : HUGE_VAL;
+	}
+	if (std::isinf(static_cast<float>(ref))) {
+		return got == static_cast<float>(ref) ? 0.0 : HUGE_VAL;
+	}
+	int exponent;
+	std::frexp(ref, &exponent);
+	const double ulp = std::ldexp(1.0, std::max(exponent - 24, -149));
+	return std::fabs(static_cast<double>(got) - ref) / ulp;
+}
+
+//! \brief 検査の結果
+struct accuracy
+{
+	double ulp      = 0.0; //!< 最大誤差 (ULP)
+	double absolute = 0.0; //!< 最大の絶対誤差
+	float  x        = 0.0f;
+	float  y        = 0.0f;
+};
+
+bool check(const char* name, const char* range, const accuracy& a, double ulp_bound, double absolute_bound = HUGE_VAL)
+{
+	const bool passed = a.ulp <= ulp_bound && a.absolute <= absolute_bound;
+	std::printf("%-6s %-20s max %7.3f ulp  abs %-10.3g at (%a, %a)%s\n", name, range, a.ulp, a.absolute, a.x, a.y, passed ? "" : "  FAILED");
+	return passed;
+}
+
+//! \brief [lo, hi] (0 <= lo) とその符号を反転した範囲の float を stride 個おきに検査します
+template<class Fast, class Reference>
+accuracy sweep(float lo, float hi, uint32_t stride, bool negative, Fast&& fast, Reference&& reference)
+{
+	accuracy       result;
+	const uint64_t begin = std::bit_cast<uint32_t>(lo);
+	const uint64_t end   = std::bit_cast<uint32_t>(hi);
+	for (uint64_t u = begin; u <= end; u += stride) {
+		const float x = std::bit_cast<float>(static_cast<uint32_t>(u));
+		for (const float v : { x, -x }) {
+			if (v < 0.0f && !negative) {
+				continue;
+			}
+			const float  got = fast(v);
+			const double ref = reference(static_cast<double>(v));
+			const double ulp = ulp_error(got, ref);
+			if (ulp > result.ulp) {
+				result.ulp = ulp;
+				result.x   = v;
+			}
+			if (std::isfinite(ref)) {
+				result.absolute = std::max(result.absolute, std::fabs(static_cast<double>(got) - ref));
+			}
+		}
+	}
+	return result;
+}
+
+//! \brief 指数が [-60, 60] の正規化数の組で atan2 を検査します
+accuracy sweep_atan2(uint64_t pairs)
+{
+	std::mt19937_64                       engine(1);
+	std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+	std::uniform_int_distribution<int>    exponent(-60, 60);
+
+	accuracy result;
+	for (uint64_t i = 0; i < pairs; ++i) {
+		// 半分は指数を揃えて、比が 1 に近い (atan の多項式の端を通る) 組を増やします
+		const int    ey  = exponent(engine);
+		const int    ex  = (i & 1) ? ey : exponent(engine);
+		const float  y   = std::ldexp(mantissa(engine), ey);
+		const float  x   = std::ldexp(mantissa(engine), ex);
+		const double ulp = ulp_error(fast::atan2(y, x), std::atan2(static_cast<double>(y), static_cast<double>(x)));
+		if (ulp > result.ulp) {
+			result.ulp = ulp;
+			result.x   = y;
+			result.y   = x;
+		}
+	}
+	return result;
+}
+
+//! \brief fn を repeat 回実行した中で最小の時間 (要素あたりのナノ秒)
+template<class Fn>
+double measure(size_t count, Fn&& fn)
+{
+	double best = HUGE_VAL;
+	for (int i = 0; i < repeat; ++i) {
+		const auto begin = std::chrono::steady_clock::now();
+		fn();
+		const auto end = std::chrono::steady_clock::now();
+		best           = std::min(best, std::chrono::duration<double, std::nano>(end - begin).count());
+	}
+	return best / static_cast<double>(count);
+}
+
+//! \brief <cmath> のループと fast の vfloat4 / vfloat8 版の速度を比べます
+//!
+//! input は 8 の倍数の要素数です。
+template<class Std, class Fast>
+void benchmark(const char* name, std::span<const float> input, std::span<float> output, Std&& reference, Fast&& fast)
+{
+	using namespace simd;
+
+	const size_t count   = input.size();
+	const double libm_ns = measure(count, [&]()
+	    {
+		    for (size_t i = 0; i < count; ++i) {
+			    output[i] = reference(input[i]);
+		    }
+	    });
+	const double fast4_ns = measure(count, [&]()
+	    {
+		    for (size_t i = 0; i < count; i += 4) {
+			    vstore4(&output[i], fast(vload4(&input[i])));
+		    }
+	    });
+	const double fast8_ns = measure(count, [&]()
+	    {
+		    for (size_t i = 0; i < count; i += 8) {
+			    vstore8(&output[i], fast(vload8(&input[i])));
+		    }
+	    });
+	std::printf("%-6s %8.3f ns %8.3f ns (%5.1fx) %8.3f ns (%5.1fx)\n", name, libm_ns, fast4_ns, libm_ns / fast4_ns, fast8_ns, libm_ns / fast8_ns);
+}
+
+int usage()
+{
+	std::fprintf(stderr, "usage: fast_math_benchmark [--stride <count>] [--pairs <count>] [--repeat <count>]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	uint32_t stride = 61;
+	uint64_t pairs  = 10000000;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--stride") == 0 && i + 1 < argc) {
+			stride = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--pairs") == 0 && i + 1 < argc) {
+			pairs = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, std::atoi(argv[++i]));
+		}
+		else {
+			return usage();
+		}
+	}
+
+	// 記載の上限は fast_math.h の各関数のコメントと同じです
+	std::printf("accuracy (stride %u, %llu atan2 pairs)\n", stride, static_cast<unsigned long long>(pairs));
+	const float pi = dxlib::math::pi<float>;
+	auto sin = [](float x)
+	{
+		return fast::sin(x);
+	};
+	auto cos = [](float x)
+	{
+		return fast::cos(x);
+	};
+	auto atan = [](float x)
+	{
+		return fast::atan(x);
+	};
+	auto exp = [](float x)
+	{
+		return fast::exp(x);
+	};
+	auto exp_negative = [](float x)
+	{
+		return fast::exp(-x);
+	};
+	auto rsqrt = [](float x)
+	{
+		return fast::rsqrt(x);
+	};
+	auto std_sin = [](double x)
+	{
+		return std::sin(x);
+	};
+	auto std_cos = [](double x)
+	{
+		return std::cos(x);
+	};
+	auto std_atan = [](double x)
+	{
+		return std::atan(x);
+	};
+	auto std_exp = [](double x)
+	{
+		return std::exp(x);
+	};
+	auto std_exp_negative = [](double x)
+	{
+		return std::exp(-x);
+	};
+	auto std_rsqrt = [](double x)
+	{
+		return 1.0 / std::sqrt(x);
+	};
+
+	bool passed = true;
+	passed &= check("sin", "|x| <= pi", sweep(0.0f, pi, stride, true, sin, std_sin), 2.0);
+	passed &= check("sin", "|x| <= 8192", sweep(pi, 8192.0f, stride, true, sin, std_sin), HUGE_VAL, 1e-7);
+	passed &= check("cos", "|x| <= pi", sweep(0.0f, pi, stride, true, cos, std_cos), 2.0);
+	passed &= check("cos", "|x| <= 8192", sweep(pi, 8192.0f, stride, true, cos, std_cos), HUGE_VAL, 1e-7);
+	passed &= check("atan", "all", sweep(0.0f, INFINITY, stride, true, atan, std_atan), 3.0);
+	passed &= check("atan2", "normal", sweep_atan2(pairs), 4.0);
+	passed &= check("exp", "0 <= x <= 88.72", sweep(0.0f, 88.72f, stride, false, exp, std_exp), 2.0);
+	passed &= check("exp", "-87.33 <= x <= 0", sweep(0.0f, 87.33f, stride, false, exp_negative, std_exp_negative), 2.0);
+	passed &= check("rsqrt", "normal", sweep(FLT_MIN, FLT_MAX, stride, false, rsqrt, std_rsqrt), 4.0);
+
+	// スカラー版と vfloat8 版が同じ結果を返すこと
+	{
+		std::mt19937                          engine(2);
+		std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+		size_t                                mismatches = 0;
+		for (int i = 0; i < 100000; ++i) {
+			float x[8], y[8], s[8], e[8], a[8];
+			for (int k = 0; k < 8; ++k) {
+				x[k] = dist(engine);
+				y[k] = dist(engine);
+			}
+			simd::vstore8(s, fast::sin(simd::vload8(x)));
+			simd::vstore8(e, fast::exp(simd::vload8(x)));
+			simd::vstore8(a, fast::atan2(simd::vload8(y), simd::vload8(x)));
+			for (int k = 0; k < 8; ++k) {
+				mismatches += s[k] != fast::sin(x[k]);
+				mismatches += e[k] != fast::exp(x[k]);
+				mismatches += a[k] != fast::atan2(y[k], x[k]);
+			}
+		}
+		std::printf("vfloat8 / scalar mismatches: %zu%s\n", mismatches, mismatches == 0 ? "" : "  FAILED");
+		passed &= mismatches == 0;
+	}
+
+	// 速度
+	constexpr size_t   count = size_t(1) << 20;
+	std::vector<float> angle(count), value(count), positive(count), output(count);
+	{
+		std::mt19937                          engine(3);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		for (size_t i = 0; i < count; ++i) {
+			angle[i]    = dist(engine) * 100.0f;
+			value[i]    = dist(engine) * 80.0f;
+			positive[i] = std::fabs(dist(engine)) * 1000.0f + 1e-3f;
+		}
+	}
+	std::printf("\n%zu elements, best of %d, per element\n", count, repeat);
+	std::printf("%-6s %11s %20s %20s\n", "", "<cmath>", "fast vfloat4", "fast vfloat8");
+	benchmark("sin", angle, output, [](float x)
+	    {
+		    return std::sin(x);
+	    },
+	    [](auto v)
+	    {
+		    return fast::sin(v);
+	    });
+	benchmark("cos", angle, output, [](float x)
+	    {
+		    return std::cos(x);
+	    },
+	    [](auto v)
+	    {
+		    return fast::cos(v);
+	    });
+	benchmark("atan", value, output, [](float x)
+	    {
+		    return std::atan(x);
+	    },
+	    [](auto v)
+	    {
+		    return fast::atan(v);
+	    });
+	benchmark("atan2", value, output, [&](float y)
+	    {
+		    return std::atan2(y, 1.5f - y);
+	    },
+	    [](auto v)
+	    {
+		    using V = decltype(v);
+		    return fast::atan2(v, simd::vsub(fast::detail::splat(V {}, 1.5f), v));
+	    });
+	benchmark("exp", value, output, [](float x)
+	    {
+		    return std::exp(x);
+	    },
+	    [](auto v)
+	    {
+		    return fast::exp(v);
+	    });
+	benchmark("rsqrt", positive, output, [](float x)
+	    {
+		    return 1.0f / std::sqrt(x);
+	    },
+	    [](auto v)
+	    {
+		    return fast::rsqrt(v);
+	    });
+
+	return passed ? 0 : 1;
+}
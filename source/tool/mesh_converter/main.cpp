@@ -0,0 +1,75 @@
+// mesh_converter
+//
+// static_mesh.h のメッシュをメッシュファイル (mesh_file.h) に変換します。
+//
+//   mesh_converter <output directory> [--split]
+//
+//   --split 位置とそれ以外の要素を別の頂点ストリームに分けます (vertex_streams::split_position)
+//
+// 出力したファイルは asset_cooker の --copy .mesh や asset_packer でアーカイブにまとめられます。
+// 実行時は geometry::mapped_mesh で開き、頂点データとインデックスデータをそのまま upload バッファにコピーします。
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "dxlib/mesh_file.h"
+
+namespace {
+
+bool write(const std::filesystem::path& filename, const std::vector<uint8_t>& data)
+{
+	std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	stream.close();
+	if (!stream || data.empty()) {
+		std::fprintf(stderr, "failed to write %s.\n", filename.string().c_str());
+		return false;
+	}
+	std::printf("%s: %zu bytes\n", filename.string().c_str(), data.size());
+	return true;
+}
+
+int usage()
+{
+	std::fprintf(stderr, "usage: mesh_converter <output directory> [--split]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	using namespace dxlib::geometry;
+
+	if (argc < 2) {
+		return usage();
+	}
+
+	mesh_file_options options;
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--split") == 0) {
+			options.streams = vertex_streams::split_position;
+		}
+		else {
+			return usage();
+		}
+	}
+
+	const std::filesystem::path output(argv[1]);
+	std::error_code             ec;
+	std::filesystem::create_directories(output, ec);
+
+	bool succeeded = true;
+	succeeded &= write(output / "static_mesh_quad_p.mesh", write_mesh_file(static_mesh_quad_p, options));
+	succeeded &= write(output / "static_mesh_quad_pc.mesh", write_mesh_file(static_mesh_quad_pc, options));
+	succeeded &= write(output / "static_mesh_quad_pu.mesh", write_mesh_file(static_mesh_quad_pu, options));
+	succeeded &= write(output / "static_mesh_quad_puc.mesh", write_mesh_file(static_mesh_quad_puc, options));
+	succeeded &= write(output / "static_mesh_quad_pn.mesh", write_mesh_file(static_mesh_quad_pn, options));
+	succeeded &= write(output / "static_mesh_quad_pnu.mesh", write_mesh_file(static_mesh_quad_pnu, options));
+	succeeded &= write(output / "static_mesh_cube_pn.mesh", write_mesh_file(static_mesh_cube_pn, options));
+
+	return succeeded ? 0 : 1;
+}
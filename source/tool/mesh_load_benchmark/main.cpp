@@ -0,0 +1,312 @@
+// mesh_load_benchmark
+//
+// メッシュファイル (mesh_file.h) の読み込みと、同じ頂点とインデックスをテキストから解析する場合の時間を比べます。
+// 読み込んだ頂点データと最も細かい段のインデックスが変換前と一致することも確認します。
+//
+//   mesh_load_benchmark <work directory> [--tessellation <count>] [--repeat <count>] [--split]
+//
+//   <work directory> 計測用のメッシュファイルを作るディレクトリ (終了時に削除します)
+//   --tessellation   トーラスの primitive_desc::tessellation (既定は 1024)
+//   --repeat         計測の繰り返し回数、最小の時間を表示します (既定は 20)
+//   --split          位置とそれ以外の要素を別の頂点ストリームに分けます (vertex_streams::split_position)
+//
+// メッシュは vertex_pnu のトーラスを 2 つの部分メッシュに分けたもので、LOD とメッシュレットを含みます。
+// テキストの解析はメモリ上の文字列から行うので、ファイルの読み込み時間を含みません。
+// 2 回目以降はページキャッシュから読むので、デバイスの待ち時間を含む計測ではありません。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dxlib/file.h"
+#include "dxlib/mesh_file.h"
+#include "dxlib/primitives.h"
+
+namespace {
+
+using namespace dxlib::geometry;
+
+//! \brief fn を repeat 回実行した中で最小の時間 (ミリ秒)
+template<class Fn>
+double measure(int repeat, Fn&& fn)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeat; ++i) {
+		const auto begin = std::chrono::steady_clock::now();
+		fn();
+		const auto end = std::chrono::steady_clock::now();
+		best           = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+	}
+	return best;
+}
+
+void report(const char* name, double ms, bool passed)
+{
+	std::printf("%-28s %10.3f ms%s\n", name, ms, passed ? "" : "  FAILED");
+}
+
+//! \brief 頂点データとインデックスが変換前と一致するか確認します
+bool verify(const mesh_view& view, const std::vector<vertex_pnu>& vertices, const std::vector<uint32_t>& indices, const index_range (&submeshes)[2])
+{
+	if (view.header->vertex_count != vertices.size() || view.submeshes.size() != 2) {
+		return false;
+	}
+
+	// 頂点データをストリームから vertex_pnu に組み立てて比べます
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		vertex_pnu vertex = {};
+		for (const vertex_input_element& element : view.elements) {
+			const uint8_t* source = view.stream_data(element.slot).data() + i * view.streams[element.slot].stride + element.offset;
+			switch (element.semantic) {
+			case vertex_semantic::position:
+				std::memcpy(&vertex.position, source, sizeof(vertex.position));
+				break;
+			case vertex_semantic::normal:
+				std::memcpy(&vertex.normal, source, sizeof(vertex.normal));
+				break;
+			case vertex_semantic::texcoord:
+				std::memcpy(&vertex.uv, source, sizeof(vertex.uv));
+				break;
+			default:
+				return false;
+			}
+		}
+		if (std::memcmp(&vertex, &vertices[i], sizeof(vertex)) != 0) {
+			return false;
+		}
+	}
+
+	for (size_t s = 0; s < 2; ++s) {
+		const index_submesh& submesh = view.submeshes[s].indices;
+		const lod_level&     lod     = view.submesh_lods(s).front();
+		if (lod.index_count != submeshes[s].count) {
+			return false;
+		}
+		for (uint32_t i = 0; i < lod.index_count; ++i) {
+			const size_t offset = (static_cast<size_t>(lod.index_offset) + i) * index_size(submesh.format);
+			uint32_t     index  = 0;
+			if (submesh.format == index_format::uint16) {
+				uint16_t value;
+				std::memcpy(&value, view.index_data.data() + offset, sizeof(value));
+				index = value;
+			}
+			else {
+				std::memcpy(&index, view.index_data.data() + offset, sizeof(index));
+			}
+			if (index + submesh.base_vertex != indices[submeshes[s].offset + i]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//! \brief 頂点 (v) と三角形 (f) を 1 行ずつ書いたテキスト
+std::string make_text(const std::vector<vertex_pnu>& vertices, const std::vector<uint32_t>& indices)
+{
+	std::string text;
+	char        line[160];
+	for (const vertex_pnu& v : vertices) {
+		std::snprintf(line, sizeof(line), "v %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n", v.position.x, v.position.y, v.position.z, v.normal.x, v.normal.y, v.normal.z, v.uv.x, v.uv.y);
+		text += line;
+	}
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		std::snprintf(line, sizeof(line), "f %u %u %u\n", indices[i], indices[i + 1], indices[i + 2]);
+		text += line;
+	}
+	return text;
+}
+
+void parse_text(const std::string& text, std::vector<vertex_pnu>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	const char* p = text.c_str();
+	char*       end;
+	while (*p) {
+		if (*p == 'v') {
+			vertex_pnu v;
+			v.position.x = std::strtof(p + 1, &end);
+			v.position.y = std::strtof(end, &end);
+			v.position.z = std::strtof(end, &end);
+			v.normal.x   = std::strtof(end, &end);
+			v.normal.y   = std::strtof(end, &end);
+			v.normal.z   = std::strtof(end, &end);
+			v.uv.x       = std::strtof(end, &end);
+			v.uv.y       = std::strtof(end, &end);
+			vertices.push_back(v);
+			p = end;
+		}
+		else if (*p == 'f') {
+			end = const_cast<char*>(p + 1);
+			for (int i = 0; i < 3; ++i) {
+				indices.push_back(static_cast<uint32_t>(std::strtoul(end, &end, 10)));
+			}
+			p = end;
+		}
+		else {
+			++p;
+		}
+	}
+}
+
+int usage()
+{
+	std::fprintf(stderr, "usage: mesh_load_benchmark <work directory> [--tessellation <count>] [--repeat <count>] [--split]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		return usage();
+	}
+
+	primitive_desc desc;
+	desc.type         = primitive_type::torus;
+	desc.tessellation = max_primitive_tessellation;
+	int               repeat = 20;
+	mesh_file_options options;
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--tessellation") == 0 && i + 1 < argc) {
+			desc.tessellation = std::clamp(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 3u, max_primitive_tessellation);
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--split") == 0) {
+			options.streams = vertex_streams::split_position;
+		}
+		else {
+			return usage();
+		}
+	}
+
+	// トーラスを三角形の前半と後半の 2 つの部分メッシュに分けます
+	const primitive_counts  counts = primitive_count(desc);
+	std::vector<vertex_pnu> vertices(counts.vertex_count);
+	std::vector<uint32_t>   indices(counts.index_count);
+	generate_vertices(desc, vertices);
+	generate_indices(desc, indices);
+	const uint32_t    half         = counts.index_count / 6 * 3;
+	const index_range submeshes[2] = {
+		{ 0, half },
+		{ half, counts.index_count - half },
+	};
+
+	mesh_source source;
+	source.elements     = vertex_traits<vertex_pnu>::elements;
+	source.vertices     = vertices.data();
+	source.stride       = sizeof(vertex_pnu);
+	source.vertex_count = counts.vertex_count;
+	source.indices      = indices;
+	source.submeshes    = submeshes;
+	const std::vector<uint8_t> file = write_mesh_file(source, options);
+	if (file.empty()) {
+		std::fprintf(stderr, "write_mesh_file failed.\n");
+		return 1;
+	}
+
+	const std::filesystem::path directory = std::filesystem::path(argv[1]) / "mesh_load_benchmark";
+	const std::filesystem::path path      = directory / "torus.mesh";
+	const std::wstring          filename  = path.wstring();
+	std::error_code             ec;
+	std::filesystem::create_directories(directory, ec);
+	{
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+		if (!stream) {
+			std::fprintf(stderr, "failed to write %s.\n", path.string().c_str());
+			std::filesystem::remove_all(directory, ec);
+			return 1;
+		}
+	}
+
+	std::printf("torus %u vertices, %u triangles, %.1f MiB, best of %d\n", counts.vertex_count, counts.index_count / 3, static_cast<double>(file.size()) / (1024.0 * 1024.0), repeat);
+
+	bool passed = true;
+
+	// マップして開きます (ページは触れたときに読まれるので、コピーの時間に含まれます)
+	{
+		bool succeeded = true;
+		auto open      = [&]()
+		{
+			mapped_mesh mesh;
+			succeeded &= mesh.open(filename.c_str());
+		};
+		const double ms = measure(repeat, open);
+
+		mapped_mesh mesh;
+		succeeded &= mesh.open(filename.c_str()) && verify(mesh.view(), vertices, indices, submeshes);
+		report("mapped_mesh::open", ms, succeeded);
+		passed &= succeeded;
+	}
+
+	// 頂点ストリームとインデックスを upload バッファの大きさの領域にコピーします
+	{
+		mapped_mesh          mesh;
+		bool                 succeeded = mesh.open(filename.c_str());
+		const mesh_view&     view      = mesh.view();
+		std::vector<uint8_t> upload(succeeded ? view.vertex_data.size() + view.index_data.size() : 0);
+		auto                 copy = [&]()
+		{
+			if (!succeeded) {
+				return;
+			}
+			size_t offset = 0;
+			for (size_t i = 0; i < view.streams.size(); ++i) {
+				const std::span<const uint8_t> stream = view.stream_data(i);
+				std::memcpy(upload.data() + offset, stream.data(), stream.size());
+				offset += stream.size();
+			}
+			std::memcpy(upload.data() + offset, view.index_data.data(), view.index_data.size());
+		};
+		const double ms = measure(repeat, copy);
+		report("copy to upload buffer", ms, succeeded);
+		passed &= succeeded;
+	}
+
+	// ヒープに読み込んで開きます
+	{
+		bool succeeded = true;
+		auto load      = [&]()
+		{
+			std::unique_ptr<uint8_t[]> data;
+			uint64_t                   size = 0;
+			mesh_view                  view;
+			succeeded &= dxlib::load_file(filename.c_str(), data, size) && open_mesh(std::span<const uint8_t>(data.get(), static_cast<size_t>(size)), view);
+		};
+		const double ms = measure(repeat, load);
+		report("load_file + open_mesh", ms, succeeded);
+		passed &= succeeded;
+	}
+
+	// 同じ頂点とインデックスをテキストから解析します
+	{
+		const std::string       text = make_text(vertices, indices);
+		std::vector<vertex_pnu> parsed_vertices;
+		std::vector<uint32_t>   parsed_indices;
+		parsed_vertices.reserve(vertices.size());
+		parsed_indices.reserve(indices.size());
+		auto parse = [&]()
+		{
+			parse_text(text, parsed_vertices, parsed_indices);
+		};
+		const double ms        = measure(repeat, parse);
+		const bool   succeeded = parsed_vertices.size() == vertices.size() && parsed_indices == indices;
+		report("text parse (in memory)", ms, succeeded);
+		passed &= succeeded;
+	}
+
+	std::filesystem::remove_all(directory, ec);
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+// vector_batch_benchmark
+//
+// math::batch のカーネルと、同じ処理を要素ごとの演算子で書いたループの速度を比べます。
+// 結果が要素ごとのループと一致する (許容誤差内) ことも確認します。
+//
+//   vector_batch_benchmark [<element count>] [--repeat <count>]
+//
+//   <element count> 配列の要素数 (既定は 1048576)
+//   --repeat        計測の繰り返し回数、最小の時間を表示します (既定は 20)
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "dxlib/vector_batch.h"
+
+namespace {
+
+using namespace dxlib::math;
+
+int repeat = 20;
+
+//! \brief fn を repeat 回実行した中で最小の時間 (ミリ秒)
+template<class Fn>
+double measure(Fn&& fn)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeat; ++i) {
+		const auto begin = std::chrono::steady_clock::now();
+		fn();
+		const auto end = std::chrono::steady_clock::now();
+		best           = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+	}
+	return best;
+}
+
+float max_error(const float* a, const float* b, size_t count)
+{
+	float error = 0.0f;
+	for (size_t i = 0; i < count; ++i) {
+		error = std::max(error, std::fabs(a[i] - b[i]));
+	}
+	return error;
+}
+
+//! \brief scalar と simd の時間と、結果 (expected, actual) の最大誤差を表示します
+template<class Scalar, class Simd>
+bool compare(const char* name, Scalar&& scalar, Simd&& simd, const float* expected, const float* actual, size_t count, float tolerance)
+{
+	const double scalar_ms = measure(scalar);
+	const double batch_ms  = measure(simd);
+	const float  error     = max_error(expected, actual, count);
+	const bool   passed    = error <= tolerance;
+	std::printf("%-18s %9.3f ms %9.3f ms %6.2fx  max error %g%s\n", name, scalar_ms, batch_ms, scalar_ms / batch_ms, error, passed ? "" : "  FAILED");
+	return passed;
+}
+
+int usage()
+{
+	std::fprintf(stderr, "usage: vector_batch_benchmark [<element count>] [--repeat <count>]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	size_t count = size_t(1) << 20;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (argv[i][0] != '-') {
+			count = static_cast<size_t>(std::strtoull(argv[i], nullptr, 10));
+		}
+		else {
+			return usage();
+		}
+	}
+
+	std::mt19937                          engine(1);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+	std::vector<float3> a3(count), b3(count), r3(count), s3(count);
+	std::vector<float4> a4(count), r4(count), s4(count);
+	std::vector<float>  r1(count), s1(count);
+	for (size_t i = 0; i < count; ++i) {
+		a3[i] = float3(dist(engine), dist(engine), dist(engine));
+		b3[i] = float3(dist(engine), dist(engine), dist(engine));
+		a4[i] = float4(dist(engine), dist(engine), dist(engine), dist(engine));
+	}
+
+	// 回転 + 平行移動 + 射影の w を含む行列
+	const float4x4 m = {
+		0.8f, 0.1f, -0.5f, 0.0f,
+		-0.2f, 0.9f, 0.3f, 0.0f,
+		0.5f, -0.3f, 0.8f, 0.1f,
+		1.0f, 2.0f, 3.0f, 1.0f
+	};
+
+	std::printf("%zu elements, best of %d\n", count, repeat);
+	std::printf("%-18s %12s %12s %7s\n", "kernel", "per-element", "batch", "speedup");
+
+	bool passed = true;
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = a3[i] + b3[i];
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::add(a3, b3, s3);
+		};
+		passed &= compare("add float3", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 0.0f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r4[i] = a4[i] * 0.5f;
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::scale(a4, 0.5f, s4);
+		};
+		passed &= compare("scale float4", scalar, simd, &r4[0].x, &s4[0].x, count * 4, 0.0f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = lerp(a3[i], b3[i], 0.25f);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::lerp(a3, b3, 0.25f, s3);
+		};
+		passed &= compare("lerp float3", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 1e-5f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r1[i] = dot(a3[i], b3[i]);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::dot(a3, b3, s1);
+		};
+		passed &= compare("dot float3", scalar, simd, r1.data(), s1.data(), count, 1e-4f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = cross(a3[i], b3[i]);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::cross(a3, b3, s3);
+		};
+		passed &= compare("cross float3", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 1e-4f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = normalize(a3[i]);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::normalize(a3, s3);
+		};
+		passed &= compare("normalize float3", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 1e-6f);
+	}
+
+	{
+		float3 scalar_min;
+		float3 batch_min;
+		auto   scalar = [&]()
+		{
+			scalar_min = float3(FLT_MAX);
+			for (size_t i = 0; i < count; ++i) {
+				scalar_min = float3(std::min(scalar_min.x, a3[i].x), std::min(scalar_min.y, a3[i].y), std::min(scalar_min.z, a3[i].z));
+			}
+		};
+		auto simd = [&]()
+		{
+			batch_min = batch::reduce_min(a3);
+		};
+		passed &= compare("reduce_min float3", scalar, simd, &scalar_min.x, &batch_min.x, 3, 0.0f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = transform_point(a3[i], m);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::transform_points(a3, m, s3);
+		};
+		passed &= compare("transform_points", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 1e-3f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r3[i] = transform_vector(a3[i], m);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::transform_vectors(a3, m, s3);
+		};
+		passed &= compare("transform_vectors", scalar, simd, &r3[0].x, &s3[0].x, count * 3, 1e-4f);
+	}
+
+	{
+		auto scalar = [&]()
+		{
+			for (size_t i = 0; i < count; ++i) {
+				r4[i] = transform(a4[i], m);
+			}
+		};
+		auto simd = [&]()
+		{
+			batch::transform(a4, m, s4);
+		};
+		passed &= compare("transform float4", scalar, simd, &r4[0].x, &s4[0].x, count * 4, 1e-4f);
+	}
+
+	return passed ? 0 : 1;
+}